@@ -8,14 +8,25 @@
 //	Created for CS-330-Computational Graphics and Visualization, Nov. 7th, 2022
 ///////////////////////////////////////////////////////////////////////////////
 
-#include "shapemeshes.h"
+#include "ShapeMeshes.h"
+#include "ShaderManager.h"
+#include "RenderStats.h"
+#include "TraceZones.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <string>
 #include <vector>
+#include <algorithm>
+#include <cfloat>
+
+// some C libraries define these as macros, which would break the
+// constants below
+#undef M_PI
+#undef M_PI_2
 
 namespace
 {
@@ -29,6 +40,420 @@ namespace
 ShapeMeshes::ShapeMeshes()
 {
 	m_bMemoryLayoutDone = false;
+	m_pShaderManager = NULL;
+	m_pRecords = NULL;
+	m_bSharedVerticesDirty = false;
+	m_bSharedIndicesDirty = false;
+}
+
+///////////////////////////////////////////////////
+//	SetShaderManager()
+//
+//	Set the shader manager whose packed per-draw
+//	parameters are uploaded before each draw call.
+//	Projects that set their uniforms directly never
+//	need to call this.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetShaderManager(ShaderManager* pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+}
+
+///////////////////////////////////////////////////
+//	FlushDrawParameters()
+//
+//	Upload the pending per-draw parameters, if a
+//	shader manager has been set.
+///////////////////////////////////////////////////
+void ShapeMeshes::FlushDrawParameters()
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->flushDrawParameters();
+	}
+}
+
+///////////////////////////////////////////////////
+//	StoreMeshData()
+//
+//	Append the vertices of a freshly loaded mesh to
+//	the shared vertex data and keep a copy of its
+//	indices, so recorded draws of every mesh can be
+//	issued from one pair of buffers. The VAO and
+//	VBOs are labeled with the name of the mesh for
+//	the debug output and frame debuggers.
+///////////////////////////////////////////////////
+void ShapeMeshes::StoreMeshData(GLMesh& mesh, const char* name, const GLfloat* vertices, size_t floatCount,
+	const GLuint* indices, size_t indexCount)
+{
+	const GLuint floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	std::string label = std::string(name) + " mesh";
+	mesh.vao.SetLabel(label.c_str());
+	mesh.vbos[0].SetLabel((label + " vertices").c_str());
+	mesh.vbos[1].SetLabel((label + " indices").c_str());
+
+	mesh.baseVertex = (GLint)(m_sharedVertices.size() / floatsPerVertex);
+	mesh.nStoredVertices = (GLint)(floatCount / floatsPerVertex);
+	m_sharedVertices.insert(m_sharedVertices.end(), vertices, vertices + mesh.nStoredVertices * floatsPerVertex);
+
+	mesh.indexData.clear();
+	if (NULL != indices)
+	{
+		mesh.indexData.assign(indices, indices + indexCount);
+	}
+
+	m_bSharedVerticesDirty = true;
+}
+
+///////////////////////////////////////////////////
+//	BeginRecording()
+//
+//	Start capturing the filled mesh draws into the
+//	passed list instead of drawing them.
+///////////////////////////////////////////////////
+void ShapeMeshes::BeginRecording(std::vector<DrawRecord>* pRecords)
+{
+	m_pRecords = pRecords;
+}
+
+///////////////////////////////////////////////////
+//	EndRecording()
+//
+//	Go back to drawing the meshes immediately.
+///////////////////////////////////////////////////
+void ShapeMeshes::EndRecording()
+{
+	m_pRecords = NULL;
+}
+
+///////////////////////////////////////////////////
+//	BeginMeshDraw()
+//
+//	Called at the start of each filled mesh draw.
+//	When drawing immediately the draw parameters are
+//	uploaded and the mesh VAO is bound.
+///////////////////////////////////////////////////
+void ShapeMeshes::BeginMeshDraw(const GLMesh& mesh)
+{
+	if (NULL == m_pRecords)
+	{
+		FlushDrawParameters();
+		glBindVertexArray(mesh.vao);
+		RenderStats::Frame().vertexArrayBinds++;
+	}
+}
+
+///////////////////////////////////////////////////
+//	EndMeshDraw()
+//
+//	Called at the end of each filled mesh draw.
+///////////////////////////////////////////////////
+void ShapeMeshes::EndMeshDraw()
+{
+	if (NULL == m_pRecords)
+	{
+		glBindVertexArray(0);
+	}
+}
+
+///////////////////////////////////////////////////
+//	DrawMeshArrays()
+//
+//	Draw or record a range of the mesh vertices.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMeshArrays(const GLMesh& mesh, GLenum mode, GLint first, GLsizei count)
+{
+	if (NULL != m_pRecords)
+	{
+		RecordMeshRange(mesh, mode, first, count, false);
+		return;
+	}
+
+	glDrawArrays(mode, first, count);
+	RenderStats::Frame().drawCalls++;
+	RenderStats::Frame().triangles += RenderStats::CountTriangles(mode, count);
+}
+
+///////////////////////////////////////////////////
+//	DrawMeshElements()
+//
+//	Draw or record the first indexed triangles of
+//	the mesh.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMeshElements(const GLMesh& mesh, GLsizei count)
+{
+	if (NULL != m_pRecords)
+	{
+		RecordMeshRange(mesh, GL_TRIANGLES, 0, count, true);
+		return;
+	}
+
+	glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)0);
+	RenderStats::Frame().drawCalls++;
+	RenderStats::Frame().triangles += count / 3;
+}
+
+///////////////////////////////////////////////////
+//	RecordMeshRange()
+//
+//	Append a draw record for a range of the mesh.
+//	Fans and strips are turned into triangle lists
+//	the first time a range is recorded, so every
+//	record can be drawn as indexed triangles from
+//	the shared buffers. Ranges reaching past the
+//	stored vertices are clipped to them.
+///////////////////////////////////////////////////
+void ShapeMeshes::RecordMeshRange(const GLMesh& mesh, GLenum mode, GLint first, GLsizei count, bool bIndexed)
+{
+	RangeKey key(mesh.baseVertex, mode, first, count, bIndexed);
+	std::map<RangeKey, SharedRange>::iterator range = m_sharedRanges.find(key);
+	if (range == m_sharedRanges.end())
+	{
+		SharedRange newRange;
+		newRange.firstIndex = (GLuint)m_sharedIndices.size();
+
+		if (bIndexed == true)
+		{
+			GLsizei available = (GLsizei)mesh.indexData.size();
+			m_sharedIndices.insert(m_sharedIndices.end(),
+				mesh.indexData.begin(), mesh.indexData.begin() + std::min(count, available));
+		}
+		else
+		{
+			GLint last = std::min(first + count, mesh.nStoredVertices);
+			if (mode == GL_TRIANGLES)
+			{
+				for (GLint v = first; v + 2 < last; v += 3)
+				{
+					m_sharedIndices.push_back(v);
+					m_sharedIndices.push_back(v + 1);
+					m_sharedIndices.push_back(v + 2);
+				}
+			}
+			else if (mode == GL_TRIANGLE_FAN)
+			{
+				for (GLint v = first + 1; v + 1 < last; v++)
+				{
+					m_sharedIndices.push_back(first);
+					m_sharedIndices.push_back(v);
+					m_sharedIndices.push_back(v + 1);
+				}
+			}
+			else if (mode == GL_TRIANGLE_STRIP)
+			{
+				// every other strip triangle swaps its first two
+				// vertices to keep the winding of the strip
+				for (GLint v = first; v + 2 < last; v++)
+				{
+					bool bOdd = ((v - first) & 1) != 0;
+					m_sharedIndices.push_back(bOdd ? v + 1 : v);
+					m_sharedIndices.push_back(bOdd ? v : v + 1);
+					m_sharedIndices.push_back(v + 2);
+				}
+			}
+		}
+
+		newRange.indexCount = (GLuint)m_sharedIndices.size() - newRange.firstIndex;
+		newRange.bounds = CalculateRangeBounds(mesh.baseVertex, newRange.firstIndex, newRange.indexCount, newRange.extents);
+		range = m_sharedRanges.insert(std::make_pair(key, newRange)).first;
+		m_bSharedIndicesDirty = true;
+	}
+
+	if (range->second.indexCount == 0)
+	{
+		return;
+	}
+
+	DrawRecord record;
+	if (NULL != m_pShaderManager)
+	{
+		record.parameters = m_pShaderManager->getDrawParameters();
+	}
+	else
+	{
+		record.parameters.model = glm::mat4(1.0f);
+		record.parameters.color = glm::vec4(1.0f);
+		record.parameters.surface = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+	}
+	record.firstIndex = range->second.firstIndex;
+	record.indexCount = range->second.indexCount;
+	record.baseVertex = mesh.baseVertex;
+	record.bounds = range->second.bounds;
+	record.extents = range->second.extents;
+	m_pRecords->push_back(record);
+}
+
+///////////////////////////////////////////////////
+//	CalculateRangeBounds()
+//
+//	Calculate a bounding sphere around the vertices
+//	referenced by a range of the shared indices. The
+//	sphere is centered on their bounding box, which
+//	is close enough for culling. The half size of the
+//	box is returned too, for the tighter box tests.
+///////////////////////////////////////////////////
+glm::vec4 ShapeMeshes::CalculateRangeBounds(GLint baseVertex, GLuint firstIndex, GLuint indexCount, glm::vec3& extents)
+{
+	const GLuint floatsPerVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	extents = glm::vec3(0.0f);
+	if (indexCount == 0)
+	{
+		return glm::vec4(0.0f);
+	}
+
+	glm::vec3 minimum(FLT_MAX);
+	glm::vec3 maximum(-FLT_MAX);
+	for (GLuint i = firstIndex; i < firstIndex + indexCount; i++)
+	{
+		const GLfloat* position = &m_sharedVertices[(baseVertex + m_sharedIndices[i]) * floatsPerVertex];
+		glm::vec3 point(position[0], position[1], position[2]);
+		minimum = glm::min(minimum, point);
+		maximum = glm::max(maximum, point);
+	}
+
+	glm::vec3 center = (minimum + maximum) * 0.5f;
+	extents = (maximum - minimum) * 0.5f;
+	float radius = 0.0f;
+	for (GLuint i = firstIndex; i < firstIndex + indexCount; i++)
+	{
+		const GLfloat* position = &m_sharedVertices[(baseVertex + m_sharedIndices[i]) * floatsPerVertex];
+		radius = std::max(radius, glm::length(glm::vec3(position[0], position[1], position[2]) - center));
+	}
+
+	return glm::vec4(center, radius);
+}
+
+///////////////////////////////////////////////////
+//	UpdateSharedBuffers()
+//
+//	Create the shared buffers on first use and send
+//	any vertex or index data added since the last
+//	call to the GPU.
+///////////////////////////////////////////////////
+void ShapeMeshes::UpdateSharedBuffers()
+{
+	if (0 == m_sharedVAO)
+	{
+		m_sharedBuffers[0].Create();
+		m_sharedBuffers[1].Create();
+		m_sharedVAO.Create();
+		glBindVertexArray(m_sharedVAO);
+		SetupSharedVertexArray();
+		glBindVertexArray(0);
+		m_sharedVAO.SetLabel("Shared meshes");
+		m_sharedBuffers[0].SetLabel("Shared mesh vertices");
+		m_sharedBuffers[1].SetLabel("Shared mesh indices");
+	}
+
+	if ((m_bSharedVerticesDirty == true) && (m_sharedVertices.size() > 0))
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_sharedBuffers[0]);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * m_sharedVertices.size(), m_sharedVertices.data(), GL_STATIC_DRAW);
+		m_sharedBuffers[0].SetBytes(sizeof(GLfloat) * m_sharedVertices.size());
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		RenderStats::Frame().bufferUploads++;
+		m_bSharedVerticesDirty = false;
+	}
+
+	if ((m_bSharedIndicesDirty == true) && (m_sharedIndices.size() > 0))
+	{
+		// the element buffer binding belongs to the VAO, so use
+		// the copy binding point to upload the indices
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_sharedBuffers[1]);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(GLuint) * m_sharedIndices.size(), m_sharedIndices.data(), GL_STATIC_DRAW);
+		m_sharedBuffers[1].SetBytes(sizeof(GLuint) * m_sharedIndices.size());
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		RenderStats::Frame().bufferUploads++;
+		m_bSharedIndicesDirty = false;
+	}
+}
+
+///////////////////////////////////////////////////
+//	SetupSharedVertexArray()
+//
+//	Attach the shared vertex and index buffers with
+//	the standard vertex layout to the currently bound
+//	VAO. UpdateSharedBuffers() must have been called
+//	once so that the buffers exist.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetupSharedVertexArray()
+{
+	glBindBuffer(GL_ARRAY_BUFFER, m_sharedBuffers[0]);
+	SetShaderMemoryLayout();
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_sharedBuffers[1]);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+///////////////////////////////////////////////////
+//	ReplayRecords()
+//
+//	Draw recorded triangles with one draw call per
+//	record from the shared buffers, uploading each
+//	record's parameters before its draw.
+///////////////////////////////////////////////////
+void ShapeMeshes::ReplayRecords(const std::vector<DrawRecord>& records)
+{
+	ReplayRecords(records, 0, records.size());
+}
+
+///////////////////////////////////////////////////
+//	ReplayRecords()
+//
+//	Draw a range of the recorded triangles, e.g. only
+//	the opaque records of a depth pre-pass. The draw
+//	parameters set before the replay are restored,
+//	since the objects recorded next may rely on them.
+///////////////////////////////////////////////////
+void ShapeMeshes::ReplayRecords(const std::vector<DrawRecord>& records, size_t first, size_t count)
+{
+	UpdateSharedBuffers();
+
+	ShaderManager::DrawParameters savedParameters;
+	if (NULL != m_pShaderManager)
+	{
+		savedParameters = m_pShaderManager->getDrawParameters();
+	}
+
+	size_t last = std::min(first + count, records.size());
+	glBindVertexArray(m_sharedVAO);
+	RenderStats::Frame().vertexArrayBinds++;
+	for (size_t i = first; i < last; i++)
+	{
+		if (NULL != m_pShaderManager)
+		{
+			m_pShaderManager->setDrawParameters(records[i].parameters);
+			m_pShaderManager->flushDrawParameters();
+		}
+		glDrawElementsBaseVertex(GL_TRIANGLES, records[i].indexCount, GL_UNSIGNED_INT,
+			(void*)(sizeof(GLuint) * records[i].firstIndex), records[i].baseVertex);
+		RenderStats::Frame().drawCalls++;
+		RenderStats::Frame().triangles += records[i].indexCount / 3;
+	}
+	glBindVertexArray(0);
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setDrawParameters(savedParameters);
+	}
+}
+
+///////////////////////////////////////////////////
+//	IsSphereRecord()
+//
+//	Check whether a record draws the whole sphere
+//	mesh - the half sphere covers only part of its
+//	index range.
+///////////////////////////////////////////////////
+bool ShapeMeshes::IsSphereRecord(const DrawRecord& record) const
+{
+	if (m_SphereMesh.indexData.empty() == true)
+	{
+		return false;
+	}
+	GLuint sphereIndexCount = std::min((GLuint)m_SphereMesh.indexData.size(), m_SphereMesh.nIndices);
+	return (record.baseVertex == m_SphereMesh.baseVertex) && (record.indexCount == sphereIndexCount);
 }
 
 //**************************************************************************
@@ -50,6 +475,7 @@ ShapeMeshes::ShapeMeshes()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadBoxMesh()
 {
+	TRACE_ZONE("LoadBoxMesh");
 	// Position and Color data
 	GLfloat verts[] = {
 		//Positions				//Normals
@@ -111,16 +537,22 @@ void ShapeMeshes::LoadBoxMesh()
 	m_BoxMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 	m_BoxMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
 
-	glGenVertexArrays(1, &m_BoxMesh.vao); // we can also generate multiple VAOs or buffers at the same time
+	m_BoxMesh.vao.Create(); // frees the VAO of an earlier load
 	glBindVertexArray(m_BoxMesh.vao);
 
 	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(2, m_BoxMesh.vbos);
+	m_BoxMesh.vbos[0].Create();
+	m_BoxMesh.vbos[1].Create();
 	glBindBuffer(GL_ARRAY_BUFFER, m_BoxMesh.vbos[0]); // Activates the buffer
 	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	m_BoxMesh.vbos[0].SetBytes(sizeof(verts));
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_BoxMesh.vbos[1]); // Activates the buffer
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	m_BoxMesh.vbos[1].SetBytes(sizeof(indices));
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_BoxMesh, "Box", verts, sizeof(verts) / sizeof(verts[0]), indices, sizeof(indices) / sizeof(indices[0]));
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -142,6 +574,7 @@ void ShapeMeshes::LoadBoxMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadConeMesh()
 {
+	TRACE_ZONE("LoadConeMesh");
 	GLfloat verts[] = {
 		// cone bottom			// normals			// texture coords
 		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
@@ -298,13 +731,17 @@ void ShapeMeshes::LoadConeMesh()
 	m_ConeMesh.nIndices = 0;
 
 	// Create VAO
-	glGenVertexArrays(1, &m_ConeMesh.vao); // we can also generate multiple VAOs or buffers at the same time
+	m_ConeMesh.vao.Create(); // frees the VAO of an earlier load
 	glBindVertexArray(m_ConeMesh.vao);
 
 	// Create VBO
-	glGenBuffers(1, m_ConeMesh.vbos);
+	m_ConeMesh.vbos[0].Create();
 	glBindBuffer(GL_ARRAY_BUFFER, m_ConeMesh.vbos[0]); // Activates the buffer
 	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	m_ConeMesh.vbos[0].SetBytes(sizeof(verts));
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_ConeMesh, "Cone", verts, sizeof(verts) / sizeof(verts[0]), NULL, 0);
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -327,6 +764,7 @@ void ShapeMeshes::LoadConeMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadCylinderMesh()
 {
+	TRACE_ZONE("LoadCylinderMesh");
 	GLfloat verts[] = {
 		// cylinder bottom		// normals			// texture coords
 		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
@@ -558,13 +996,17 @@ void ShapeMeshes::LoadCylinderMesh()
 	m_CylinderMesh.nIndices = 0;
 
 	// Create VAO
-	glGenVertexArrays(1, &m_CylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
+	m_CylinderMesh.vao.Create(); // frees the VAO of an earlier load
 	glBindVertexArray(m_CylinderMesh.vao);
 
 	// Create VBO
-	glGenBuffers(1, m_CylinderMesh.vbos);
+	m_CylinderMesh.vbos[0].Create();
 	glBindBuffer(GL_ARRAY_BUFFER, m_CylinderMesh.vbos[0]); // Activates the buffer
 	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	m_CylinderMesh.vbos[0].SetBytes(sizeof(verts));
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_CylinderMesh, "Cylinder", verts, sizeof(verts) / sizeof(verts[0]), NULL, 0);
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -585,6 +1027,7 @@ void ShapeMeshes::LoadCylinderMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPlaneMesh()
 {
+	TRACE_ZONE("LoadPlaneMesh");
 	// Vertex data
 	GLfloat verts[] = {
 		// Vertex Positions		// Normals			// Texture coords	// Index
@@ -605,16 +1048,22 @@ void ShapeMeshes::LoadPlaneMesh()
 	m_PlaneMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
 
 	// Generate the VAO for the mesh
-	glGenVertexArrays(1, &m_PlaneMesh.vao);
+	m_PlaneMesh.vao.Create();
 	glBindVertexArray(m_PlaneMesh.vao);	// activate the VAO
 
 	// Create VBOs for the mesh
-	glGenBuffers(2, m_PlaneMesh.vbos);
+	m_PlaneMesh.vbos[0].Create();
+	m_PlaneMesh.vbos[1].Create();
 	glBindBuffer(GL_ARRAY_BUFFER, m_PlaneMesh.vbos[0]); // Activates the buffer
 	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends data to the GPU
+	m_PlaneMesh.vbos[0].SetBytes(sizeof(verts));
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_PlaneMesh.vbos[1]); // Activates the buffer
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	m_PlaneMesh.vbos[1].SetBytes(sizeof(indices));
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_PlaneMesh, "Plane", verts, sizeof(verts) / sizeof(verts[0]), indices, sizeof(indices) / sizeof(indices[0]));
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -635,6 +1084,7 @@ void ShapeMeshes::LoadPlaneMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPrismMesh()
 {
+	TRACE_ZONE("LoadPrismMesh");
 	// Vertex data
 	GLfloat verts[] = {
 		//Positions				//Normals
@@ -686,13 +1136,17 @@ void ShapeMeshes::LoadPrismMesh()
 
 	m_PrismMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 
-	glGenVertexArrays(1, &m_PrismMesh.vao); // we can also generate multiple VAOs or buffers at the same time
+	m_PrismMesh.vao.Create(); // frees the VAO of an earlier load
 	glBindVertexArray(m_PrismMesh.vao);
 
 	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(1, m_PrismMesh.vbos);
+	m_PrismMesh.vbos[0].Create();
 	glBindBuffer(GL_ARRAY_BUFFER, m_PrismMesh.vbos[0]); // Activates the buffer
 	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	m_PrismMesh.vbos[0].SetBytes(sizeof(verts));
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_PrismMesh, "Prism", verts, sizeof(verts) / sizeof(verts[0]), NULL, 0);
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -713,6 +1167,7 @@ void ShapeMeshes::LoadPrismMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPyramid3Mesh()
 {
+	TRACE_ZONE("LoadPyramid3Mesh");
 	// Vertex data
 	GLfloat verts[] = {
 		// Vertex Positions		// Normals			// Texture coords
@@ -741,12 +1196,16 @@ void ShapeMeshes::LoadPyramid3Mesh()
 	// Calculate total defined vertices
 	m_Pyramid3Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 
-	glGenVertexArrays(1, &m_Pyramid3Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid3Mesh.vbos);					// Creates 1 VBO
+	m_Pyramid3Mesh.vao.Create();				// Creates 1 VAO
+	m_Pyramid3Mesh.vbos[0].Create();					// Creates 1 VBO
 	glBindVertexArray(m_Pyramid3Mesh.vao);					// Activates the VAO
 	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid3Mesh.vbos[0]);	// Activates the VBO
 	// Sends vertex or coordinate data to the GPU
 	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+	m_Pyramid3Mesh.vbos[0].SetBytes(sizeof(verts));
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_Pyramid3Mesh, "Pyramid3", verts, sizeof(verts) / sizeof(verts[0]), NULL, 0);
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -767,6 +1226,7 @@ void ShapeMeshes::LoadPyramid3Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPyramid4Mesh()
 {
+	TRACE_ZONE("LoadPyramid4Mesh");
 	// Vertex data
 	GLfloat verts[] = {
 		// Vertex Positions		// Normals			// Texture coords
@@ -804,12 +1264,16 @@ void ShapeMeshes::LoadPyramid4Mesh()
 	// Calculate total defined vertices
 	m_Pyramid4Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 
-	glGenVertexArrays(1, &m_Pyramid4Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid4Mesh.vbos);					// Creates 1 VBO
+	m_Pyramid4Mesh.vao.Create();				// Creates 1 VAO
+	m_Pyramid4Mesh.vbos[0].Create();					// Creates 1 VBO
 	glBindVertexArray(m_Pyramid4Mesh.vao);					// Activates the VAO
 	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid4Mesh.vbos[0]);	// Activates the VBO
 	// Sends vertex or coordinate data to the GPU
 	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+	m_Pyramid4Mesh.vbos[0].SetBytes(sizeof(verts));
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_Pyramid4Mesh, "Pyramid4", verts, sizeof(verts) / sizeof(verts[0]), NULL, 0);
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -830,6 +1294,7 @@ void ShapeMeshes::LoadPyramid4Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadSphereMesh()
 {
+	TRACE_ZONE("LoadSphereMesh");
 	GLfloat verts[] = {
 		// vertex data					// texture coords			// index
 		// top center point
@@ -1686,16 +2151,22 @@ void ShapeMeshes::LoadSphereMesh()
 	}
 
 	// Create VAO
-	glGenVertexArrays(1, &m_SphereMesh.vao); // we can also generate multiple VAOs or buffers at the same time
+	m_SphereMesh.vao.Create(); // frees the VAO of an earlier load
 	glBindVertexArray(m_SphereMesh.vao);
 
 	// Create VBOs
-	glGenBuffers(2, m_SphereMesh.vbos);
+	m_SphereMesh.vbos[0].Create();
+	m_SphereMesh.vbos[1].Create();
 	glBindBuffer(GL_ARRAY_BUFFER, m_SphereMesh.vbos[0]); // Activates the vertex buffer
 	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	m_SphereMesh.vbos[0].SetBytes(sizeof(GLfloat) * combined_values.size());
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_SphereMesh.vbos[1]); // Activates the index buffer
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	m_SphereMesh.vbos[1].SetBytes(sizeof(indices));
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_SphereMesh, "Sphere", combined_values.data(), combined_values.size(), indices, sizeof(indices) / sizeof(indices[0]));
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -1718,6 +2189,7 @@ void ShapeMeshes::LoadSphereMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadTaperedCylinderMesh()
 {
+	TRACE_ZONE("LoadTaperedCylinderMesh");
 	GLfloat verts[] = {
 		// cylinder bottom		// normals			// texture coords
 		1.0f, 0.0f, 0.0f,		0.0f, -1.0f, 0.0f,	0.5f,1.0f,
@@ -1949,13 +2421,17 @@ void ShapeMeshes::LoadTaperedCylinderMesh()
 	m_TaperedCylinderMesh.nIndices = 0;
 
 	// Create VAO
-	glGenVertexArrays(1, &m_TaperedCylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
+	m_TaperedCylinderMesh.vao.Create(); // frees the VAO of an earlier load
 	glBindVertexArray(m_TaperedCylinderMesh.vao);
 
 	// Create VBO
-	glGenBuffers(1, m_TaperedCylinderMesh.vbos);
+	m_TaperedCylinderMesh.vbos[0].Create();
 	glBindBuffer(GL_ARRAY_BUFFER, m_TaperedCylinderMesh.vbos[0]); // Activates the buffer
 	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	m_TaperedCylinderMesh.vbos[0].SetBytes(sizeof(verts));
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_TaperedCylinderMesh, "Tapered cylinder", verts, sizeof(verts) / sizeof(verts[0]), NULL, 0);
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -1976,6 +2452,7 @@ void ShapeMeshes::LoadTaperedCylinderMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadTorusMesh(float thickness)
 {
+	TRACE_ZONE("LoadTorusMesh");
 	int _mainSegments = 30;
 	int _tubeSegments = 30;
 	float _mainRadius = 1.0f;
@@ -2143,13 +2620,17 @@ void ShapeMeshes::LoadTorusMesh(float thickness)
 	m_TorusMesh.nIndices = 0;
 
 	// Create VAO
-	glGenVertexArrays(1, &m_TorusMesh.vao); // we can also generate multiple VAOs or buffers at the same time
+	m_TorusMesh.vao.Create(); // frees the VAO of an earlier load
 	glBindVertexArray(m_TorusMesh.vao);
 
 	// Create VBOs
-	glGenBuffers(1, m_TorusMesh.vbos);
+	m_TorusMesh.vbos[0].Create();
 	glBindBuffer(GL_ARRAY_BUFFER, m_TorusMesh.vbos[0]); // Activates the buffer
 	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	m_TorusMesh.vbos[0].SetBytes(sizeof(GLfloat) * combined_values.size());
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_TorusMesh, "Torus", combined_values.data(), combined_values.size(), NULL, 0);
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -2170,6 +2651,7 @@ void ShapeMeshes::LoadTorusMesh(float thickness)
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadExtraTorusMesh1(float thickness)
 {
+	TRACE_ZONE("LoadExtraTorusMesh1");
 	int _mainSegments = 30;
 	int _tubeSegments = 30;
 	float _mainRadius = 1.0f;
@@ -2337,13 +2819,17 @@ void ShapeMeshes::LoadExtraTorusMesh1(float thickness)
 	m_ExtraTorusMesh1.nIndices = 0;
 
 	// Create VAO
-	glGenVertexArrays(1, &m_ExtraTorusMesh1.vao); // we can also generate multiple VAOs or buffers at the same time
+	m_ExtraTorusMesh1.vao.Create(); // frees the VAO of an earlier load
 	glBindVertexArray(m_ExtraTorusMesh1.vao);
 
 	// Create VBOs
-	glGenBuffers(1, m_ExtraTorusMesh1.vbos);
+	m_ExtraTorusMesh1.vbos[0].Create();
 	glBindBuffer(GL_ARRAY_BUFFER, m_ExtraTorusMesh1.vbos[0]); // Activates the buffer
 	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	m_ExtraTorusMesh1.vbos[0].SetBytes(sizeof(GLfloat) * combined_values.size());
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_ExtraTorusMesh1, "Extra torus 1", combined_values.data(), combined_values.size(), NULL, 0);
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -2364,6 +2850,7 @@ void ShapeMeshes::LoadExtraTorusMesh1(float thickness)
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadExtraTorusMesh2(float thickness)
 {
+	TRACE_ZONE("LoadExtraTorusMesh2");
 	int _mainSegments = 30;
 	int _tubeSegments = 30;
 	float _mainRadius = 1.0f;
@@ -2531,13 +3018,17 @@ void ShapeMeshes::LoadExtraTorusMesh2(float thickness)
 	m_ExtraTorusMesh2.nIndices = 0;
 
 	// Create VAO
-	glGenVertexArrays(1, &m_ExtraTorusMesh2.vao); // we can also generate multiple VAOs or buffers at the same time
+	m_ExtraTorusMesh2.vao.Create(); // frees the VAO of an earlier load
 	glBindVertexArray(m_ExtraTorusMesh2.vao);
 
 	// Create VBOs
-	glGenBuffers(1, m_ExtraTorusMesh2.vbos);
+	m_ExtraTorusMesh2.vbos[0].Create();
 	glBindBuffer(GL_ARRAY_BUFFER, m_ExtraTorusMesh2.vbos[0]); // Activates the buffer
 	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	m_ExtraTorusMesh2.vbos[0].SetBytes(sizeof(GLfloat) * combined_values.size());
+
+	// keep a copy for the shared buffers used by recorded draws
+	StoreMeshData(m_ExtraTorusMesh2, "Extra torus 2", combined_values.data(), combined_values.size(), NULL, 0);
 
 	if (m_bMemoryLayoutDone == false)
 	{
@@ -2558,11 +3049,11 @@ void ShapeMeshes::LoadExtraTorusMesh2(float thickness)
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawBoxMesh()
 {
-	glBindVertexArray(m_BoxMesh.vao);
+	BeginMeshDraw(m_BoxMesh);
 
-	glDrawElements(GL_TRIANGLES, m_BoxMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+	DrawMeshElements(m_BoxMesh, m_BoxMesh.nIndices);
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2575,31 +3066,31 @@ void ShapeMeshes::DrawBoxMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawBoxMeshSide(BoxSide side)
 {
-	glBindVertexArray(m_BoxMesh.vao);
+	BeginMeshDraw(m_BoxMesh);
 
 	switch (side)
 	{
 	case back:
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+		DrawMeshArrays(m_BoxMesh, GL_TRIANGLE_FAN, 0, 4);
 		break;
 	case bottom:
-		glDrawArrays(GL_TRIANGLE_FAN, 4, 4);
+		DrawMeshArrays(m_BoxMesh, GL_TRIANGLE_FAN, 4, 4);
 		break;
 	case left:
-		glDrawArrays(GL_TRIANGLE_FAN, 8, 4);
+		DrawMeshArrays(m_BoxMesh, GL_TRIANGLE_FAN, 8, 4);
 		break;
 	case right:
-		glDrawArrays(GL_TRIANGLE_FAN, 12, 4);
+		DrawMeshArrays(m_BoxMesh, GL_TRIANGLE_FAN, 12, 4);
 		break;
 	case top:
-		glDrawArrays(GL_TRIANGLE_FAN, 16, 4);
+		DrawMeshArrays(m_BoxMesh, GL_TRIANGLE_FAN, 16, 4);
 		break;
 	case front:
-		glDrawArrays(GL_TRIANGLE_FAN, 20, 4);
+		DrawMeshArrays(m_BoxMesh, GL_TRIANGLE_FAN, 20, 4);
 		break;
 	}
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2610,6 +3101,8 @@ void ShapeMeshes::DrawBoxMeshSide(BoxSide side)
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawBoxMeshLines()
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_BoxMesh.vao);
 
 	glDrawElements(GL_LINE_LOOP, m_BoxMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
@@ -2626,15 +3119,15 @@ void ShapeMeshes::DrawBoxMeshLines()
 void ShapeMeshes::DrawConeMesh(
 	bool bDrawBottom)
 {
-	glBindVertexArray(m_ConeMesh.vao);
+	BeginMeshDraw(m_ConeMesh);
 
 	if (bDrawBottom == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
+		DrawMeshArrays(m_ConeMesh, GL_TRIANGLE_FAN, 0, 36);		//bottom
 	}
-	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
+	DrawMeshArrays(m_ConeMesh, GL_TRIANGLE_STRIP, 36, 108);	//sides
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2646,6 +3139,8 @@ void ShapeMeshes::DrawConeMesh(
 void ShapeMeshes::DrawConeMeshLines(
 	bool bDrawBottom)
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_ConeMesh.vao);
 
 	if (bDrawBottom == true)
@@ -2668,22 +3163,22 @@ void ShapeMeshes::DrawCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_CylinderMesh.vao);
+	BeginMeshDraw(m_CylinderMesh);
 
 	if (bDrawBottom == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
+		DrawMeshArrays(m_CylinderMesh, GL_TRIANGLE_FAN, 0, 36);	//bottom
 	}
 	if (bDrawTop == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 36);	//top
+		DrawMeshArrays(m_CylinderMesh, GL_TRIANGLE_FAN, 36, 36);	//top
 	}
 	if (bDrawSides == true)
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+		DrawMeshArrays(m_CylinderMesh, GL_TRIANGLE_STRIP, 72, 146);	//sides
 	}
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2697,6 +3192,8 @@ void ShapeMeshes::DrawCylinderMeshLines(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_CylinderMesh.vao);
 
 	if (bDrawBottom == true)
@@ -2723,11 +3220,11 @@ void ShapeMeshes::DrawCylinderMeshLines(
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPlaneMesh()
 {
-	glBindVertexArray(m_PlaneMesh.vao);
+	BeginMeshDraw(m_PlaneMesh);
 
-	glDrawElements(GL_TRIANGLES, m_PlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+	DrawMeshElements(m_PlaneMesh, m_PlaneMesh.nIndices);
 	
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2738,6 +3235,8 @@ void ShapeMeshes::DrawPlaneMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPlaneMeshLines()
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_PlaneMesh.vao);
 
 	glDrawElements(GL_LINE_STRIP, m_PlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
@@ -2753,11 +3252,11 @@ void ShapeMeshes::DrawPlaneMeshLines()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPrismMesh()
 {
-	glBindVertexArray(m_PrismMesh.vao);
+	BeginMeshDraw(m_PrismMesh);
 
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_PrismMesh.nVertices);
+	DrawMeshArrays(m_PrismMesh, GL_TRIANGLE_STRIP, 0, m_PrismMesh.nVertices);
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2768,6 +3267,8 @@ void ShapeMeshes::DrawPrismMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPrismMeshLines()
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_PrismMesh.vao);
 
 	glDrawArrays(GL_LINE_STRIP, 0, m_PrismMesh.nVertices);
@@ -2783,11 +3284,11 @@ void ShapeMeshes::DrawPrismMeshLines()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid3Mesh()
 {
-	glBindVertexArray(m_Pyramid3Mesh.vao);
+	BeginMeshDraw(m_Pyramid3Mesh);
 
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid3Mesh.nVertices);
+	DrawMeshArrays(m_Pyramid3Mesh, GL_TRIANGLE_STRIP, 0, m_Pyramid3Mesh.nVertices);
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2798,6 +3299,8 @@ void ShapeMeshes::DrawPyramid3Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid3MeshLines()
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_Pyramid3Mesh.vao);
 
 	glDrawArrays(GL_LINE_STRIP, 0, m_Pyramid3Mesh.nVertices);
@@ -2813,11 +3316,11 @@ void ShapeMeshes::DrawPyramid3MeshLines()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid4Mesh()
 {
-	glBindVertexArray(m_Pyramid4Mesh.vao);
+	BeginMeshDraw(m_Pyramid4Mesh);
 
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid4Mesh.nVertices);
+	DrawMeshArrays(m_Pyramid4Mesh, GL_TRIANGLE_STRIP, 0, m_Pyramid4Mesh.nVertices);
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2828,6 +3331,8 @@ void ShapeMeshes::DrawPyramid4Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid4MeshLines()
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_Pyramid4Mesh.vao);
 
 	glDrawArrays(GL_LINE_STRIP, 0, m_Pyramid4Mesh.nVertices);
@@ -2843,11 +3348,11 @@ void ShapeMeshes::DrawPyramid4MeshLines()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
+	BeginMeshDraw(m_SphereMesh);
 
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+	DrawMeshElements(m_SphereMesh, m_SphereMesh.nIndices);
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2858,6 +3363,8 @@ void ShapeMeshes::DrawSphereMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawSphereMeshLines()
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_SphereMesh.vao);
 
 	glDrawElements(GL_LINE_STRIP, m_SphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
@@ -2873,11 +3380,11 @@ void ShapeMeshes::DrawSphereMeshLines()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
+	BeginMeshDraw(m_SphereMesh);
 
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices/2, GL_UNSIGNED_INT, (void*)0);
+	DrawMeshElements(m_SphereMesh, m_SphereMesh.nIndices/2);
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2888,6 +3395,8 @@ void ShapeMeshes::DrawHalfSphereMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfSphereMeshLines()
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_SphereMesh.vao);
 
 	glDrawElements(GL_LINE_STRIP, m_SphereMesh.nIndices / 2, GL_UNSIGNED_INT, (void*)0);
@@ -2906,22 +3415,22 @@ void ShapeMeshes::DrawTaperedCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
+	BeginMeshDraw(m_TaperedCylinderMesh);
 
 	if (bDrawBottom == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
+		DrawMeshArrays(m_TaperedCylinderMesh, GL_TRIANGLE_FAN, 0, 36);	//bottom
 	}
 	if (bDrawTop == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 72);	//top
+		DrawMeshArrays(m_TaperedCylinderMesh, GL_TRIANGLE_FAN, 36, 72);	//top
 	}
 	if (bDrawSides == true)
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+		DrawMeshArrays(m_TaperedCylinderMesh, GL_TRIANGLE_STRIP, 72, 146);	//sides
 	}
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2935,6 +3444,8 @@ void ShapeMeshes::DrawTaperedCylinderMeshLines(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_TaperedCylinderMesh.vao);
 
 	if (bDrawBottom == true)
@@ -2961,11 +3472,11 @@ void ShapeMeshes::DrawTaperedCylinderMeshLines(
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawTorusMesh()
 {
-	glBindVertexArray(m_TorusMesh.vao);
+	BeginMeshDraw(m_TorusMesh);
 
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices);
+	DrawMeshArrays(m_TorusMesh, GL_TRIANGLES, 0, m_TorusMesh.nVertices);
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -2976,6 +3487,8 @@ void ShapeMeshes::DrawTorusMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawTorusMeshLines()
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_TorusMesh.vao);
 
 	glDrawArrays(GL_LINE_STRIP, 0, m_TorusMesh.nVertices);
@@ -2991,11 +3504,11 @@ void ShapeMeshes::DrawTorusMeshLines()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawExtraTorusMesh1()
 {
-	glBindVertexArray(m_ExtraTorusMesh1.vao);
+	BeginMeshDraw(m_ExtraTorusMesh1);
 
-	glDrawArrays(GL_TRIANGLES, 0, m_ExtraTorusMesh1.nVertices);
+	DrawMeshArrays(m_ExtraTorusMesh1, GL_TRIANGLES, 0, m_ExtraTorusMesh1.nVertices);
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -3006,11 +3519,11 @@ void ShapeMeshes::DrawExtraTorusMesh1()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawExtraTorusMesh2()
 {
-	glBindVertexArray(m_ExtraTorusMesh2.vao);
+	BeginMeshDraw(m_ExtraTorusMesh2);
 
-	glDrawArrays(GL_TRIANGLES, 0, m_ExtraTorusMesh2.nVertices);
+	DrawMeshArrays(m_ExtraTorusMesh2, GL_TRIANGLES, 0, m_ExtraTorusMesh2.nVertices);
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -3021,11 +3534,11 @@ void ShapeMeshes::DrawExtraTorusMesh2()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfTorusMesh()
 {
-	glBindVertexArray(m_TorusMesh.vao);
+	BeginMeshDraw(m_TorusMesh);
 
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices/2);
+	DrawMeshArrays(m_TorusMesh, GL_TRIANGLES, 0, m_TorusMesh.nVertices/2);
 
-	glBindVertexArray(0);
+	EndMeshDraw();
 }
 
 ///////////////////////////////////////////////////
@@ -3036,6 +3549,8 @@ void ShapeMeshes::DrawHalfTorusMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfTorusMeshLines()
 {
+	FlushDrawParameters();
+
 	glBindVertexArray(m_TorusMesh.vao);
 
 	glDrawArrays(GL_LINE_STRIP, 0, m_TorusMesh.nVertices / 2);
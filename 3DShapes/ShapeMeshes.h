@@ -14,6 +14,13 @@
 
 #include <glm/glm.hpp>
 
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "ShaderManager.h"
+#include "GpuResources.h"
+
 /***********************************************************
  *  ShapeMeshes
  *
@@ -26,15 +33,64 @@ public:
 	// constructor
 	ShapeMeshes();
 
+	// set the shader manager that receives the packed
+	// per-draw parameters before each draw call
+	void SetShaderManager(ShaderManager* pShaderManager);
+
+	// one triangle draw captured while recording - the indices
+	// refer to the shared index buffer and the vertices to the
+	// shared vertex buffer, see UpdateSharedBuffers()
+	struct DrawRecord
+	{
+		ShaderManager::DrawParameters parameters;
+		GLuint firstIndex;
+		GLuint indexCount;
+		GLint baseVertex;
+		glm::vec4 bounds;   // object space bounding sphere - xyz center, w radius
+		glm::vec3 extents;  // object space bounding box half size around the center
+	};
+
+	// while recording, the filled Draw*Mesh() methods append their
+	// triangles and the current draw parameters to the passed list
+	// instead of drawing - line drawing is never recorded
+	void BeginRecording(std::vector<DrawRecord>* pRecords);
+	void EndRecording();
+	bool IsRecording() const { return (NULL != m_pRecords); }
+
+	// upload the shared vertex and index buffers if new meshes or
+	// draw ranges were added since the last call
+	void UpdateSharedBuffers();
+	// attach the shared buffers and the vertex layout to the
+	// currently bound vertex array object
+	void SetupSharedVertexArray();
+	// draw recorded triangles one draw call at a time
+	void ReplayRecords(const std::vector<DrawRecord>& records);
+	// draw only the records from first up to first + count
+	void ReplayRecords(const std::vector<DrawRecord>& records, size_t first, size_t count);
+
+	// CPU copies of the shared buffers, for tools that work on the
+	// recorded triangles - SHARED_VERTEX_FLOATS values per vertex:
+	// position, normal and texture coordinates
+	static const int SHARED_VERTEX_FLOATS = 8;
+	const std::vector<GLfloat>& GetSharedVertices() const { return m_sharedVertices; }
+	const std::vector<GLuint>& GetSharedIndices() const { return m_sharedIndices; }
+	// true for the records of a whole sphere mesh, which the impostor
+	// path can draw as ray-cast spheres instead
+	bool IsSphereRecord(const DrawRecord& record) const;
+
 private:
 
-	// stores the GL data relative to a given mesh
+	// stores the GL data relative to a given mesh - the handles free
+	// the vertex array and buffers along with the meshes
 	struct GLMesh
 	{
-		GLuint vao;         // Handle for the vertex array object
-		GLuint vbos[2];     // Handles for the vertex buffer objects
+		GpuVertexArray vao; // Handle for the vertex array object
+		GpuBuffer vbos[2];  // Handles for the vertex buffer objects
 		GLuint nVertices;	// Number of vertices for the mesh
 		GLuint nIndices;    // Number of indices for the mesh
+		GLint baseVertex;   // first vertex of the mesh in the shared vertex buffer
+		GLint nStoredVertices;          // vertices copied into the shared vertex buffer
+		std::vector<GLuint> indexData;  // CPU copy of the index data
 	};
 
 	// the available 3D shapes
@@ -54,6 +110,34 @@ private:
 
 	bool m_bMemoryLayoutDone;
 
+	// optional shader manager for the packed per-draw parameters
+	ShaderManager* m_pShaderManager;
+
+	// list receiving the recorded draws, NULL when not recording
+	std::vector<DrawRecord>* m_pRecords;
+
+	// a range of the shared index buffer generated for one draw
+	struct SharedRange
+	{
+		GLuint firstIndex;
+		GLuint indexCount;
+		glm::vec4 bounds;
+		glm::vec3 extents;
+	};
+	// draw ranges are keyed by base vertex, mode, first, count and
+	// whether the range comes from the mesh index data
+	typedef std::tuple<GLint, GLenum, GLint, GLsizei, bool> RangeKey;
+
+	// every loaded mesh in one vertex buffer, plus triangle list
+	// indices for every draw range recorded so far
+	std::vector<GLfloat> m_sharedVertices;
+	std::vector<GLuint> m_sharedIndices;
+	std::map<RangeKey, SharedRange> m_sharedRanges;
+	GpuVertexArray m_sharedVAO;
+	GpuBuffer m_sharedBuffers[2];
+	bool m_bSharedVerticesDirty;
+	bool m_bSharedIndicesDirty;
+
 public:
         enum BoxSide
 	{
@@ -129,6 +213,9 @@ public:
 	void DrawExtraTorusMesh1();
 	void DrawExtraTorusMesh2();
 
+	// called to calculate the face normal of a triangle
+	// from its corners in counterclockwise order
+	glm::vec3 CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2);
 
 private:
 
@@ -138,9 +225,28 @@ private:
 		glm::vec3 pnt0, glm::vec3 pnt1, glm::vec3 pnt2, glm::vec3 pnt3
 	);
 
-	glm::vec3 CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2);
-
 	// called to set the memory layout 
 	// template for shader data
 	void SetShaderMemoryLayout();
+
+	// called before each draw to upload the
+	// pending per-draw shader parameters
+	void FlushDrawParameters();
+
+	// called at the end of each Load*Mesh() method to keep a CPU
+	// copy of the mesh data for the shared buffers and to label the
+	// mesh objects with the passed name
+	void StoreMeshData(GLMesh& mesh, const char* name, const GLfloat* vertices, size_t floatCount,
+		const GLuint* indices, size_t indexCount);
+
+	// called by the filled Draw*Mesh() methods around their draws -
+	// they draw immediately, or record the draw while recording
+	void BeginMeshDraw(const GLMesh& mesh);
+	void EndMeshDraw();
+	void DrawMeshArrays(const GLMesh& mesh, GLenum mode, GLint first, GLsizei count);
+	void DrawMeshElements(const GLMesh& mesh, GLsizei count);
+	void RecordMeshRange(const GLMesh& mesh, GLenum mode, GLint first, GLsizei count, bool bIndexed);
+	// bounding sphere around the vertices used by a shared index range,
+	// also returns the half size of their bounding box
+	glm::vec4 CalculateRangeBounds(GLint baseVertex, GLuint firstIndex, GLuint indexCount, glm::vec3& extents);
 };
\ No newline at end of file
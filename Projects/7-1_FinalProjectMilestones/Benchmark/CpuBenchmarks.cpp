@@ -0,0 +1,471 @@
+///////////////////////////////////////////////////////////////////////////////
+// cpubenchmarks.cpp
+// =================
+// CPU micro benchmarks of the render path helpers - the transformation
+// helpers of the scene objects, the texture and material lookups, the mesh
+// generators and the collision routines of the 8-2 breakout scene
+//
+// Needs no GL context: the GLEW entry points the mesh generators call are
+// pointed at empty stubs, see GlStubs, so only their CPU work is timed.
+// Every benchmark reports the time and the heap allocations of one call.
+//
+//   CpuBenchmarks [filter]   runs the benchmarks whose name holds the filter
+///////////////////////////////////////////////////////////////////////////////
+
+#include <GL/glew.h>        // GLEW library
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "SceneManager.h"
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+#include "Objects/SceneObject.h"
+#include "Breakout.h"
+#include "GlStubs.h"
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// every benchmark runs batches of growing size until one batch
+	// takes at least this long, and reports that batch
+	const double g_MinimumBatchSeconds = 0.2;
+
+	// the texture tags of the scene, in the order LoadSceneTextures()
+	// creates them
+	const char* const g_TextureTags[] =
+	{
+		"coaster", "table", "table_leg", "carpet", "mat_fabric", "dark_wood",
+		"brown_leather", "black_leather", "red_leather", "pages", "steel",
+		"black_plastic", "raw_cotton", "branch"
+	};
+	const int g_TextureTagCount = (int)(sizeof(g_TextureTags) / sizeof(g_TextureTags[0]));
+
+	// the material tags looked up by the scene objects
+	const char* const g_MaterialTags[] =
+	{
+		"silver", "screen", "wood", "coaster", "book_cover", "book_pages"
+	};
+	const int g_MaterialTagCount = (int)(sizeof(g_MaterialTags) / sizeof(g_MaterialTags[0]));
+
+	// heap allocations made by the whole program so far
+	std::atomic<long long> g_Allocations(0);
+
+	// the benchmarks add their results here so the compiler keeps
+	// the timed calls
+	volatile float g_Sink = 0.0f;
+}
+
+/***********************************************************
+ *  operator new / operator delete
+ *
+ *  Count every heap allocation of the program, so the
+ *  benchmarks can report the allocations of one call.
+ ***********************************************************/
+void* operator new(size_t size)
+{
+	g_Allocations.fetch_add(1, std::memory_order_relaxed);
+	void* pMemory = malloc((size > 0) ? size : 1);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+	return pMemory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+/***********************************************************
+ *  BenchmarkObject
+ *
+ *  A scene object without parts, making the transformation
+ *  helpers of SceneObject callable.
+ ***********************************************************/
+class BenchmarkObject : public SceneObject
+{
+public:
+	BenchmarkObject(ShaderManager* pShaderManager, ShapeMeshes* pMeshes)
+		: SceneObject(pShaderManager, pMeshes)
+	{
+	}
+
+	void Render(glm::vec3, float, float, float, float) override
+	{
+	}
+
+	using SceneObject::SetTransformations;
+	using SceneObject::BuildRotationMatrix;
+	using SceneObject::ScaledOffset;
+};
+
+/***********************************************************
+ *  Measure()
+ *
+ *  Times the passed function in batches of doubling size
+ *  until a batch runs long enough, then prints the time and
+ *  the heap allocations of one call of that batch. The
+ *  function gets the index of the call.
+ ***********************************************************/
+template <typename Function>
+static void Measure(const char* name, const char* filter, Function function)
+{
+	if ((NULL != filter) && (strstr(name, filter) == NULL))
+	{
+		return;
+	}
+
+	// the first call fills the caches and grows the reused vectors
+	function((size_t)0);
+
+	size_t calls = 1;
+	for (;;)
+	{
+		long long allocations = g_Allocations.load(std::memory_order_relaxed);
+		Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < calls; i++)
+		{
+			function(i);
+		}
+		Clock::time_point end = Clock::now();
+		allocations = g_Allocations.load(std::memory_order_relaxed) - allocations;
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		if ((seconds >= g_MinimumBatchSeconds) || (calls >= ((size_t)1 << 40)))
+		{
+			std::printf("%-44s %14.1f ns/op %10.2f allocs/op\n", name,
+				seconds * 1e9 / (double)calls, (double)allocations / (double)calls);
+			return;
+		}
+		calls *= 2;
+	}
+}
+
+/***********************************************************
+ *  BenchmarkSceneObject()
+ *
+ *  The transformation helpers every scene object part uses.
+ ***********************************************************/
+static int BenchmarkSceneObject(const char* filter)
+{
+	int Error = 0;
+
+	ShaderManager shaderManager;
+	ShapeMeshes meshes;
+	BenchmarkObject object(&shaderManager, &meshes);
+
+	Measure("SceneObject::SetTransformations (euler)", filter, [&](size_t i)
+	{
+		float angle = (float)(i & 255);
+		object.SetTransformations(glm::vec3(1.0f, 2.0f, 0.5f), angle, 90.0f - angle, 30.0f, glm::vec3(angle, 0.0f, -2.0f));
+	});
+	g_Sink = g_Sink + shaderManager.getDrawParameters().model[3][0];
+
+	glm::mat4 rotation = object.BuildRotationMatrix(10.0f, 20.0f, 30.0f);
+	Measure("SceneObject::SetTransformations (matrix)", filter, [&](size_t i)
+	{
+		float offset = (float)(i & 255);
+		object.SetTransformations(glm::vec3(1.0f, 2.0f, 0.5f), rotation, glm::vec3(offset, 0.0f, -2.0f));
+	});
+	g_Sink = g_Sink + shaderManager.getDrawParameters().model[3][0];
+
+	glm::mat4 result(0.0f);
+	Measure("SceneObject::BuildRotationMatrix", filter, [&](size_t i)
+	{
+		float angle = (float)(i & 255);
+		result += object.BuildRotationMatrix(angle, 45.0f, -angle);
+	});
+	g_Sink = g_Sink + result[0][0];
+
+	glm::vec3 offsets(0.0f);
+	Measure("SceneObject::ScaledOffset", filter, [&](size_t i)
+	{
+		offsets += object.ScaledOffset(rotation, 1.5f, (float)(i & 15), 0.25f, -1.0f);
+	});
+	g_Sink = g_Sink + offsets.x;
+
+	// a quarter turn around Z takes +X to +Y
+	glm::vec3 turned = object.ScaledOffset(object.BuildRotationMatrix(0.0f, 0.0f, 90.0f), 2.0f, 1.0f, 0.0f, 0.0f);
+	Error += (glm::length(turned - glm::vec3(0.0f, 2.0f, 0.0f)) < 0.0001f) ? 0 : 1;
+
+	return Error;
+}
+
+/***********************************************************
+ *  BenchmarkLookups()
+ *
+ *  The texture slot and material lookups by tag, with tags
+ *  found along the whole table and with a missing tag. The
+ *  texture slots hold the scene tags without textures.
+ ***********************************************************/
+static int BenchmarkLookups(const char* filter)
+{
+	int Error = 0;
+
+	ShaderManager shaderManager;
+	SceneManager scene(&shaderManager);
+
+	SceneManager::TEXTURE_INFO textures[g_TextureTagCount];
+	for (int i = 0; i < g_TextureTagCount; i++)
+	{
+		textures[i].tag = g_TextureTags[i];
+		textures[i].ID = 0;
+	}
+
+	int found = 0;
+	Measure("SceneManager::FindTextureTag (found)", filter, [&](size_t i)
+	{
+		found += SceneManager::FindTextureTag(textures, g_TextureTagCount, g_TextureTags[i % g_TextureTagCount]);
+	});
+	Measure("SceneManager::FindTextureTag (missing)", filter, [&](size_t)
+	{
+		found += SceneManager::FindTextureTag(textures, g_TextureTagCount, "missing");
+	});
+	Measure("SceneManager::FindMaterial (found)", filter, [&](size_t i)
+	{
+		found += scene.FindMaterial(g_MaterialTags[i % g_MaterialTagCount]);
+	});
+	Measure("SceneManager::FindMaterial (missing)", filter, [&](size_t)
+	{
+		found += scene.FindMaterial("missing");
+	});
+	g_Sink = g_Sink + (float)found;
+
+	Error += (SceneManager::FindTextureTag(textures, g_TextureTagCount, "branch") == g_TextureTagCount - 1) ? 0 : 1;
+	Error += (SceneManager::FindTextureTag(textures, g_TextureTagCount, "missing") == -1) ? 0 : 1;
+	Error += (scene.FindMaterial("book_pages") == (int)MAT_BOOK_PAGES) ? 0 : 1;
+	Error += (scene.FindMaterial("missing") == -1) ? 0 : 1;
+
+	return Error;
+}
+
+/***********************************************************
+ *  BenchmarkMeshes()
+ *
+ *  The CPU side of every mesh generator - building the
+ *  vertex and index data and keeping the shared copy - and
+ *  the triangle normal helper. Every generator call loads
+ *  into new meshes, so the shared copy starts out empty;
+ *  the timed call includes creating and freeing them.
+ ***********************************************************/
+static int BenchmarkMeshes(const char* filter)
+{
+	int Error = 0;
+
+	struct MeshGenerator
+	{
+		const char* name;
+		void (ShapeMeshes::*load)();
+	};
+	const MeshGenerator generators[] =
+	{
+		{ "ShapeMeshes::LoadBoxMesh", &ShapeMeshes::LoadBoxMesh },
+		{ "ShapeMeshes::LoadConeMesh", &ShapeMeshes::LoadConeMesh },
+		{ "ShapeMeshes::LoadCylinderMesh", &ShapeMeshes::LoadCylinderMesh },
+		{ "ShapeMeshes::LoadPlaneMesh", &ShapeMeshes::LoadPlaneMesh },
+		{ "ShapeMeshes::LoadPrismMesh", &ShapeMeshes::LoadPrismMesh },
+		{ "ShapeMeshes::LoadPyramid3Mesh", &ShapeMeshes::LoadPyramid3Mesh },
+		{ "ShapeMeshes::LoadPyramid4Mesh", &ShapeMeshes::LoadPyramid4Mesh },
+		{ "ShapeMeshes::LoadSphereMesh", &ShapeMeshes::LoadSphereMesh },
+		{ "ShapeMeshes::LoadTaperedCylinderMesh", &ShapeMeshes::LoadTaperedCylinderMesh },
+	};
+
+	for (size_t i = 0; i < sizeof(generators) / sizeof(generators[0]); i++)
+	{
+		const MeshGenerator& generator = generators[i];
+		Measure(generator.name, filter, [&](size_t)
+		{
+			ShapeMeshes meshes;
+			(meshes.*generator.load)();
+		});
+		ShapeMeshes meshes;
+		(meshes.*generator.load)();
+		Error += (meshes.GetSharedVertices().empty() == false) ? 0 : 1;
+	}
+
+	// the tori take their thickness, so they get their own calls
+	Measure("ShapeMeshes::LoadTorusMesh", filter, [&](size_t)
+	{
+		ShapeMeshes meshes;
+		meshes.LoadTorusMesh();
+	});
+	Measure("ShapeMeshes::LoadExtraTorusMesh1", filter, [&](size_t)
+	{
+		ShapeMeshes meshes;
+		meshes.LoadExtraTorusMesh1();
+	});
+	Measure("ShapeMeshes::LoadExtraTorusMesh2", filter, [&](size_t)
+	{
+		ShapeMeshes meshes;
+		meshes.LoadExtraTorusMesh2();
+	});
+
+	ShapeMeshes meshes;
+	meshes.LoadTorusMesh();
+	Error += (meshes.GetSharedVertices().empty() == false) ? 0 : 1;
+
+	glm::vec3 normals(0.0f);
+	Measure("ShapeMeshes::CalculateTriangleNormal", filter, [&](size_t i)
+	{
+		float lift = (float)(i & 15) * 0.1f;
+		normals += meshes.CalculateTriangleNormal(
+			glm::vec3(0.0f, lift, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+	});
+	g_Sink = g_Sink + normals.y;
+
+	// counter clockwise seen from above points up
+	glm::vec3 normal = meshes.CalculateTriangleNormal(
+		glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+	Error += (glm::length(normal - glm::vec3(0.0f, 1.0f, 0.0f)) < 0.0001f) ? 0 : 1;
+
+	return Error;
+}
+
+/***********************************************************
+ *  BenchmarkCollisions()
+ *
+ *  The collision routines of the 8-2 breakout scene. Every
+ *  call starts from a copy of one of a fixed set of circles,
+ *  so the calls do not drift apart while the batches grow.
+ ***********************************************************/
+static int BenchmarkCollisions(const char* filter)
+{
+	int Error = 0;
+
+	// the circles pick their direction with rand()
+	srand(1);
+	std::vector<Circle> circles;
+	for (int i = 0; i < 256; i++)
+	{
+		float x = (float)(rand() % 2000) / 1000.0f - 1.0f;
+		float y = (float)(rand() % 2000) / 1000.0f - 1.0f;
+		circles.push_back(Circle(x, y, 0.04f, 1.0f, 0.5f, 0.25f));
+	}
+	const size_t circleMask = circles.size() - 1;
+
+	// the bricks of the scene, hard enough to survive every hit
+	std::vector<Brick> bricks = BuildBrickLayout();
+	for (size_t i = 0; i < bricks.size(); i++)
+	{
+		bricks[i].hitPoints = INT_MAX;
+		bricks[i].maxHitPoints = INT_MAX;
+	}
+
+	Paddle paddle;
+	paddle.x = 0.0f;
+	paddle.y = 0.0f;
+	paddle.width = 1.0f;
+
+	int hits = 0;
+	Measure("Paddle::CheckCircleCollision", filter, [&](size_t i)
+	{
+		const Circle& circle = circles[i & circleMask];
+		hits += paddle.CheckCircleCollision(circle.x, circle.y, circle.radius) ? 1 : 0;
+	});
+	g_Sink = g_Sink + (float)hits;
+
+	float velocities = 0.0f;
+	Measure("Circle::CheckCollision (brick layout)", filter, [&](size_t i)
+	{
+		Circle circle = circles[i & circleMask];
+		for (size_t b = 0; b < bricks.size(); b++)
+		{
+			circle.CheckCollision(&bricks[b]);
+		}
+		velocities += circle.vx;
+	});
+	Measure("Circle::CheckPaddleCollision", filter, [&](size_t i)
+	{
+		Circle circle = circles[i & circleMask];
+		circle.CheckPaddleCollision(&paddle);
+		velocities += circle.vx;
+	});
+	Measure("Circle::CheckCircleCollision", filter, [&](size_t i)
+	{
+		Circle circle = circles[i & circleMask];
+		Circle other = circles[(i * 7 + 1) & circleMask];
+		// move the other circle close enough to touch about half the time
+		other.x = circle.x + (float)(i & 7) * 0.015f;
+		other.y = circle.y + 0.01f;
+		circle.CheckCircleCollision(&other);
+		velocities += circle.vx + other.vy;
+	});
+	Measure("Circle::MoveOneStep", filter, [&](size_t i)
+	{
+		Circle circle = circles[i & circleMask];
+		circle.MoveOneStep();
+		velocities += circle.x;
+	});
+	g_Sink = g_Sink + velocities;
+
+	// a circle in the middle of the paddle is caught and sent up
+	Circle falling(0.0f, 0.0f, 0.04f, 1.0f, 1.0f, 1.0f);
+	falling.vy = -0.01f;
+	falling.CheckPaddleCollision(&paddle);
+	Error += (falling.vy > 0.0f) ? 0 : 1;
+
+	// two circles moving head on swap their velocities
+	Circle left(0.0f, 0.0f, 0.04f, 1.0f, 0.0f, 0.0f);
+	Circle right(0.05f, 0.0f, 0.04f, 0.0f, 0.0f, 1.0f);
+	left.vx = 0.01f;
+	left.vy = 0.0f;
+	right.vx = -0.01f;
+	right.vy = 0.0f;
+	left.CheckCircleCollision(&right);
+	Error += ((left.vx < 0.0f) && (right.vx > 0.0f)) ? 0 : 1;
+
+	return Error;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* filter = (argc > 1) ? argv[1] : NULL;
+
+	GlStubs::Install();
+
+	int Error = 0;
+
+	std::printf("%-44s %20s %20s\n", "benchmark", "time", "heap");
+	Error += BenchmarkSceneObject(filter);
+	Error += BenchmarkLookups(filter);
+	Error += BenchmarkMeshes(filter);
+	Error += BenchmarkCollisions(filter);
+
+	if (Error != 0)
+	{
+		std::printf("%d checks failed\n", Error);
+	}
+
+	return Error;
+}
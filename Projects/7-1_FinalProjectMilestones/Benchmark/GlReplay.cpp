@@ -0,0 +1,1224 @@
+///////////////////////////////////////////////////////////////////////////////
+// glreplay.cpp
+// ============
+// plays a GL call capture of the scene back on an offscreen context as fast
+// as it can and reports how long the frames of the capture window take
+//
+// The application and the scene benchmark record the captures with
+// --capture, see GlCapture. The replay runs the recorded calls alone, without
+// the scene code that made them, so the time is the cost of the calls in the
+// driver - and two captures of different render paths compare only that.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <GL/glew.h>        // GLEW library
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GlCaptureFormat.h"
+#include "OffscreenContext.h"
+#include "TimeStatistics.h"
+
+namespace
+{
+	// exit codes - a failed replay returns 1 and bad options return 2
+	const int EXIT_REPLAY_FAILED = 1;
+	const int EXIT_BAD_ARGUMENTS = 2;
+
+	typedef std::chrono::steady_clock Clock;
+	typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+	// the options of a replay
+	struct ReplayOptions
+	{
+		std::string captureFile;
+		int loops = 20;
+		std::string outputFile;
+	};
+
+	// the recorded names of one kind of object and the names the
+	// replay created for them
+	typedef std::unordered_map<GLuint, GLuint> NameMap;
+	// the recorded uniform locations or block indices of each program
+	typedef std::unordered_map<GLuint, std::unordered_map<GLint, GLint>> LocationMap;
+}
+
+/***********************************************************
+ *  CaptureReplay
+ *
+ *  Executes the calls of a capture file. The recorded object
+ *  names are mapped to the names of the objects the replay
+ *  creates - the capture leaves out the glGen calls, so a
+ *  buffer, texture, vertex array or framebuffer is created
+ *  the first time a call refers to it. The uniform locations
+ *  are looked up again as the application did and mapped the
+ *  same way, and the default framebuffer of the application
+ *  is the offscreen one of the replay.
+ ***********************************************************/
+class CaptureReplay
+{
+public:
+	CaptureReplay() : m_position(0), m_bFailed(false), m_currentProgram(0), m_targetFramebuffer(0), m_commands(0)
+	{
+		memset(&m_header, 0, sizeof(m_header));
+	}
+
+	// read the capture and check its header
+	bool Load(const std::string& path);
+	// the framebuffer the frames of the application go to
+	void SetTargetFramebuffer(GLuint framebuffer) { m_targetFramebuffer = framebuffer; }
+	// execute the calls of the next frame - false at the end of the
+	// capture, or when it is cut short
+	bool ExecuteFrame();
+	// free every object the replay created
+	void DeleteObjects();
+
+	const GlCaptureFormat::Header& GetHeader() const { return m_header; }
+	size_t GetPosition() const { return m_position; }
+	void SetPosition(size_t position) { m_position = position; }
+	bool HasFailed() const { return m_bFailed; }
+	// the calls executed so far
+	long long GetCommands() const { return m_commands; }
+
+private:
+	void Execute(GlCaptureFormat::Command command);
+
+	// read an argument of the recorded type
+	template <typename T>
+	T Get()
+	{
+		T value = T();
+		if (m_position + sizeof(T) > m_data.size())
+		{
+			m_bFailed = true;
+			return value;
+		}
+		memcpy(&value, &m_data[m_position], sizeof(T));
+		m_position += sizeof(T);
+		return value;
+	}
+	// a blob stays in the capture - NULL when it is empty
+	const void* GetBlob(unsigned int& length)
+	{
+		length = Get<unsigned int>();
+		if ((0 == length) || (m_position + length > m_data.size()))
+		{
+			m_bFailed = m_bFailed || (0 != length);
+			length = 0;
+			return NULL;
+		}
+		const void* blob = &m_data[m_position];
+		m_position += length;
+		return blob;
+	}
+	const void* GetBlob()
+	{
+		unsigned int length = 0;
+		return GetBlob(length);
+	}
+	// the pixels of a texture upload, from the blob or at the offset
+	// into the unpack buffer
+	const void* GetPixels()
+	{
+		long long offset = Get<long long>();
+		const void* pixels = GetBlob();
+		return (NULL != pixels) ? pixels : (const void*)(intptr_t)offset;
+	}
+	const void* GetOffset()
+	{
+		return (const void*)(intptr_t)Get<long long>();
+	}
+
+	GLuint Buffer(GLuint recorded);
+	GLuint Texture(GLuint recorded);
+	GLuint VertexArray(GLuint recorded);
+	GLuint Framebuffer(GLuint recorded);
+	GLuint Program(GLuint recorded);
+	GLuint Shader(GLuint recorded);
+	GLint Location(GLint recorded);
+	void DeleteNames(NameMap& names, void (GLAPIENTRY* pDelete)(GLsizei, const GLuint*));
+
+	GlCaptureFormat::Header m_header;
+	std::vector<unsigned char> m_data;
+	size_t m_position;
+	bool m_bFailed;
+
+	NameMap m_buffers;
+	NameMap m_textures;
+	NameMap m_vertexArrays;
+	NameMap m_framebuffers;
+	NameMap m_programs;
+	NameMap m_shaders;
+	LocationMap m_locations;
+	LocationMap m_blockIndices;
+	GLuint m_currentProgram;
+	GLuint m_targetFramebuffer;
+	// the buffers mapped by target until they are unmapped
+	std::unordered_map<GLenum, void*> m_mappings;
+	// kept between the calls, so looking up a name does not allocate
+	std::string m_name;
+	long long m_commands;
+};
+
+/***********************************************************
+ *  Load()
+ *
+ *  Reads the whole capture into memory, so the replay never
+ *  waits for the disk.
+ ***********************************************************/
+bool CaptureReplay::Load(const std::string& path)
+{
+	std::ifstream file(path.c_str(), std::ios::binary);
+	if (file.is_open() == false)
+	{
+		std::cout << "Failed to open " << path << std::endl;
+		return false;
+	}
+	file.read((char*)&m_header, sizeof(m_header));
+	if ((file.gcount() != sizeof(m_header)) || (GlCaptureFormat::MAGIC != m_header.magic))
+	{
+		std::cout << path << " is not a GL capture" << std::endl;
+		return false;
+	}
+	if (GlCaptureFormat::VERSION != m_header.version)
+	{
+		std::cout << path << " is a version " << m_header.version << " capture, the replay reads version "
+			<< GlCaptureFormat::VERSION << std::endl;
+		return false;
+	}
+	m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	m_position = 0;
+	return true;
+}
+
+/***********************************************************
+ *  ExecuteFrame()
+ *
+ *  Executes the calls up to the end of the next frame.
+ ***********************************************************/
+bool CaptureReplay::ExecuteFrame()
+{
+	while ((m_position < m_data.size()) && (m_bFailed == false))
+	{
+		GlCaptureFormat::Command command = (GlCaptureFormat::Command)Get<unsigned short>();
+		if (GlCaptureFormat::FRAME_END == command)
+		{
+			return true;
+		}
+		Execute(command);
+	}
+	return false;
+}
+
+/***********************************************************
+ *  DeleteObjects()
+ *
+ *  Frees the objects created for the recorded names.
+ ***********************************************************/
+void CaptureReplay::DeleteObjects()
+{
+	DeleteNames(m_buffers, glDeleteBuffers);
+	DeleteNames(m_textures, glDeleteTextures);
+	DeleteNames(m_vertexArrays, glDeleteVertexArrays);
+	DeleteNames(m_framebuffers, glDeleteFramebuffers);
+	for (const NameMap::value_type& program : m_programs)
+	{
+		glDeleteProgram(program.second);
+	}
+	m_programs.clear();
+	for (const NameMap::value_type& shader : m_shaders)
+	{
+		glDeleteShader(shader.second);
+	}
+	m_shaders.clear();
+}
+
+/***********************************************************
+ *  DeleteNames()
+ *
+ *  Frees the objects of one kind with their delete function.
+ ***********************************************************/
+void CaptureReplay::DeleteNames(NameMap& names, void (GLAPIENTRY* pDelete)(GLsizei, const GLuint*))
+{
+	for (const NameMap::value_type& name : names)
+	{
+		pDelete(1, &name.second);
+	}
+	names.clear();
+}
+
+/***********************************************************
+ *  Buffer(), Texture(), VertexArray(), Framebuffer()
+ *
+ *  The object the replay uses for a recorded name, created
+ *  on first use. The name 0 stays 0, except for the default
+ *  framebuffer.
+ ***********************************************************/
+GLuint CaptureReplay::Buffer(GLuint recorded)
+{
+	if (0 == recorded)
+	{
+		return 0;
+	}
+	NameMap::iterator found = m_buffers.find(recorded);
+	if (found != m_buffers.end())
+	{
+		return found->second;
+	}
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+	m_buffers[recorded] = buffer;
+	return buffer;
+}
+
+GLuint CaptureReplay::Texture(GLuint recorded)
+{
+	if (0 == recorded)
+	{
+		return 0;
+	}
+	NameMap::iterator found = m_textures.find(recorded);
+	if (found != m_textures.end())
+	{
+		return found->second;
+	}
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	m_textures[recorded] = texture;
+	return texture;
+}
+
+GLuint CaptureReplay::VertexArray(GLuint recorded)
+{
+	if (0 == recorded)
+	{
+		return 0;
+	}
+	NameMap::iterator found = m_vertexArrays.find(recorded);
+	if (found != m_vertexArrays.end())
+	{
+		return found->second;
+	}
+	GLuint vertexArray = 0;
+	glGenVertexArrays(1, &vertexArray);
+	m_vertexArrays[recorded] = vertexArray;
+	return vertexArray;
+}
+
+GLuint CaptureReplay::Framebuffer(GLuint recorded)
+{
+	if ((0 == recorded) || (m_header.defaultFramebuffer == recorded))
+	{
+		return m_targetFramebuffer;
+	}
+	NameMap::iterator found = m_framebuffers.find(recorded);
+	if (found != m_framebuffers.end())
+	{
+		return found->second;
+	}
+	GLuint framebuffer = 0;
+	glGenFramebuffers(1, &framebuffer);
+	m_framebuffers[recorded] = framebuffer;
+	return framebuffer;
+}
+
+/***********************************************************
+ *  Program(), Shader()
+ *
+ *  The program or shader created for a recorded one - their
+ *  creation is recorded, so an unknown name has none.
+ ***********************************************************/
+GLuint CaptureReplay::Program(GLuint recorded)
+{
+	NameMap::iterator found = m_programs.find(recorded);
+	return (found != m_programs.end()) ? found->second : 0;
+}
+
+GLuint CaptureReplay::Shader(GLuint recorded)
+{
+	NameMap::iterator found = m_shaders.find(recorded);
+	return (found != m_shaders.end()) ? found->second : 0;
+}
+
+/***********************************************************
+ *  Location()
+ *
+ *  The location of a recorded uniform location in the
+ *  current program - the same one when it was never looked
+ *  up by name, like -1.
+ ***********************************************************/
+GLint CaptureReplay::Location(GLint recorded)
+{
+	LocationMap::iterator program = m_locations.find(m_currentProgram);
+	if (program != m_locations.end())
+	{
+		std::unordered_map<GLint, GLint>::iterator found = program->second.find(recorded);
+		if (found != program->second.end())
+		{
+			return found->second;
+		}
+	}
+	return recorded;
+}
+
+/***********************************************************
+ *  Execute()
+ *
+ *  Reads the arguments of one call and makes it, in the
+ *  order GlCapture wrote them.
+ ***********************************************************/
+void CaptureReplay::Execute(GlCaptureFormat::Command command)
+{
+	m_commands++;
+	switch (command)
+	{
+	// fixed function state
+	case GlCaptureFormat::ENABLE:
+		glEnable(Get<GLenum>());
+		break;
+	case GlCaptureFormat::DISABLE:
+		glDisable(Get<GLenum>());
+		break;
+	case GlCaptureFormat::VIEWPORT:
+	{
+		GLint x = Get<GLint>();
+		GLint y = Get<GLint>();
+		GLsizei width = Get<GLsizei>();
+		GLsizei height = Get<GLsizei>();
+		glViewport(x, y, width, height);
+		break;
+	}
+	case GlCaptureFormat::DEPTH_MASK:
+		glDepthMask(Get<GLboolean>());
+		break;
+	case GlCaptureFormat::DEPTH_FUNC:
+		glDepthFunc(Get<GLenum>());
+		break;
+	case GlCaptureFormat::COLOR_MASK:
+	{
+		GLboolean red = Get<GLboolean>();
+		GLboolean green = Get<GLboolean>();
+		GLboolean blue = Get<GLboolean>();
+		GLboolean alpha = Get<GLboolean>();
+		glColorMask(red, green, blue, alpha);
+		break;
+	}
+	case GlCaptureFormat::BLEND_FUNC:
+	{
+		GLenum source = Get<GLenum>();
+		GLenum destination = Get<GLenum>();
+		glBlendFunc(source, destination);
+		break;
+	}
+	case GlCaptureFormat::BLEND_FUNCI:
+	{
+		GLuint buffer = Get<GLuint>();
+		GLenum source = Get<GLenum>();
+		GLenum destination = Get<GLenum>();
+		glBlendFunci(buffer, source, destination);
+		break;
+	}
+	case GlCaptureFormat::BLEND_FUNC_SEPARATE:
+	{
+		GLenum sourceRGB = Get<GLenum>();
+		GLenum destinationRGB = Get<GLenum>();
+		GLenum sourceAlpha = Get<GLenum>();
+		GLenum destinationAlpha = Get<GLenum>();
+		glBlendFuncSeparate(sourceRGB, destinationRGB, sourceAlpha, destinationAlpha);
+		break;
+	}
+	case GlCaptureFormat::POLYGON_OFFSET:
+	{
+		GLfloat factor = Get<GLfloat>();
+		GLfloat units = Get<GLfloat>();
+		glPolygonOffset(factor, units);
+		break;
+	}
+	case GlCaptureFormat::CLEAR_COLOR:
+	{
+		GLfloat red = Get<GLfloat>();
+		GLfloat green = Get<GLfloat>();
+		GLfloat blue = Get<GLfloat>();
+		GLfloat alpha = Get<GLfloat>();
+		glClearColor(red, green, blue, alpha);
+		break;
+	}
+	case GlCaptureFormat::CLEAR:
+		glClear(Get<GLbitfield>());
+		break;
+	case GlCaptureFormat::CLEAR_BUFFERFV:
+	{
+		GLenum buffer = Get<GLenum>();
+		GLint drawBuffer = Get<GLint>();
+		const GLfloat* value = (const GLfloat*)GetBlob();
+		if (NULL != value)
+		{
+			glClearBufferfv(buffer, drawBuffer, value);
+		}
+		break;
+	}
+	case GlCaptureFormat::PIXEL_STOREI:
+	{
+		GLenum name = Get<GLenum>();
+		GLint value = Get<GLint>();
+		glPixelStorei(name, value);
+		break;
+	}
+
+	// buffers and vertex arrays
+	case GlCaptureFormat::BIND_BUFFER:
+	{
+		GLenum target = Get<GLenum>();
+		glBindBuffer(target, Buffer(Get<GLuint>()));
+		break;
+	}
+	case GlCaptureFormat::BIND_BUFFER_BASE:
+	{
+		GLenum target = Get<GLenum>();
+		GLuint index = Get<GLuint>();
+		glBindBufferBase(target, index, Buffer(Get<GLuint>()));
+		break;
+	}
+	case GlCaptureFormat::BUFFER_DATA:
+	{
+		GLenum target = Get<GLenum>();
+		GLsizeiptr size = (GLsizeiptr)Get<long long>();
+		const void* data = GetBlob();
+		GLenum usage = Get<GLenum>();
+		glBufferData(target, size, data, usage);
+		break;
+	}
+	case GlCaptureFormat::BUFFER_SUB_DATA:
+	{
+		GLenum target = Get<GLenum>();
+		GLintptr offset = (GLintptr)Get<long long>();
+		unsigned int size = 0;
+		const void* data = GetBlob(size);
+		glBufferSubData(target, offset, size, data);
+		break;
+	}
+	case GlCaptureFormat::MAP_BUFFER_RANGE:
+	{
+		GLenum target = Get<GLenum>();
+		GLintptr offset = (GLintptr)Get<long long>();
+		GLsizeiptr length = (GLsizeiptr)Get<long long>();
+		GLbitfield access = Get<GLbitfield>();
+		m_mappings[target] = glMapBufferRange(target, offset, length, access);
+		break;
+	}
+	case GlCaptureFormat::UNMAP_BUFFER:
+	{
+		GLenum target = Get<GLenum>();
+		unsigned int length = 0;
+		const void* written = GetBlob(length);
+		void* pMapped = m_mappings[target];
+		if ((NULL != pMapped) && (NULL != written))
+		{
+			memcpy(pMapped, written, length);
+		}
+		m_mappings.erase(target);
+		glUnmapBuffer(target);
+		break;
+	}
+	case GlCaptureFormat::DELETE_BUFFERS:
+	case GlCaptureFormat::DELETE_VERTEX_ARRAYS:
+	case GlCaptureFormat::DELETE_TEXTURES:
+	case GlCaptureFormat::DELETE_FRAMEBUFFERS:
+	{
+		NameMap& names = (GlCaptureFormat::DELETE_BUFFERS == command) ? m_buffers :
+			(GlCaptureFormat::DELETE_VERTEX_ARRAYS == command) ? m_vertexArrays :
+			(GlCaptureFormat::DELETE_TEXTURES == command) ? m_textures : m_framebuffers;
+		GLsizei count = Get<GLsizei>();
+		for (GLsizei i = 0; i < count; i++)
+		{
+			NameMap::iterator found = names.find(Get<GLuint>());
+			if (found == names.end())
+			{
+				continue;
+			}
+			GLuint name = found->second;
+			names.erase(found);
+			switch (command)
+			{
+			case GlCaptureFormat::DELETE_BUFFERS:
+				glDeleteBuffers(1, &name);
+				break;
+			case GlCaptureFormat::DELETE_VERTEX_ARRAYS:
+				glDeleteVertexArrays(1, &name);
+				break;
+			case GlCaptureFormat::DELETE_TEXTURES:
+				glDeleteTextures(1, &name);
+				break;
+			default:
+				glDeleteFramebuffers(1, &name);
+				break;
+			}
+		}
+		break;
+	}
+	case GlCaptureFormat::BIND_VERTEX_ARRAY:
+		glBindVertexArray(VertexArray(Get<GLuint>()));
+		break;
+	case GlCaptureFormat::ENABLE_VERTEX_ATTRIB_ARRAY:
+		glEnableVertexAttribArray(Get<GLuint>());
+		break;
+	case GlCaptureFormat::VERTEX_ATTRIB_POINTER:
+	{
+		GLuint index = Get<GLuint>();
+		GLint size = Get<GLint>();
+		GLenum type = Get<GLenum>();
+		GLboolean normalized = Get<GLboolean>();
+		GLsizei stride = Get<GLsizei>();
+		glVertexAttribPointer(index, size, type, normalized, stride, GetOffset());
+		break;
+	}
+	case GlCaptureFormat::VERTEX_ATTRIB_I_POINTER:
+	{
+		GLuint index = Get<GLuint>();
+		GLint size = Get<GLint>();
+		GLenum type = Get<GLenum>();
+		GLsizei stride = Get<GLsizei>();
+		glVertexAttribIPointer(index, size, type, stride, GetOffset());
+		break;
+	}
+	case GlCaptureFormat::VERTEX_ATTRIB_DIVISOR:
+	{
+		GLuint index = Get<GLuint>();
+		GLuint divisor = Get<GLuint>();
+		glVertexAttribDivisor(index, divisor);
+		break;
+	}
+
+	// textures
+	case GlCaptureFormat::ACTIVE_TEXTURE:
+		glActiveTexture(Get<GLenum>());
+		break;
+	case GlCaptureFormat::BIND_TEXTURE:
+	{
+		GLenum target = Get<GLenum>();
+		glBindTexture(target, Texture(Get<GLuint>()));
+		break;
+	}
+	case GlCaptureFormat::TEX_PARAMETERI:
+	{
+		GLenum target = Get<GLenum>();
+		GLenum name = Get<GLenum>();
+		GLint value = Get<GLint>();
+		glTexParameteri(target, name, value);
+		break;
+	}
+	case GlCaptureFormat::TEX_STORAGE_2D:
+	{
+		GLenum target = Get<GLenum>();
+		GLsizei levels = Get<GLsizei>();
+		GLenum internalFormat = Get<GLenum>();
+		GLsizei width = Get<GLsizei>();
+		GLsizei height = Get<GLsizei>();
+		// a texture the window created keeps its storage when the window
+		// loops, and immutable storage cannot be specified again
+		GLint bImmutable = GL_FALSE;
+		glGetTexParameteriv(target, GL_TEXTURE_IMMUTABLE_FORMAT, &bImmutable);
+		if (GL_FALSE == bImmutable)
+		{
+			glTexStorage2D(target, levels, internalFormat, width, height);
+		}
+		break;
+	}
+	case GlCaptureFormat::TEX_IMAGE_2D:
+	{
+		GLenum target = Get<GLenum>();
+		GLint level = Get<GLint>();
+		GLint internalFormat = Get<GLint>();
+		GLsizei width = Get<GLsizei>();
+		GLsizei height = Get<GLsizei>();
+		GLint border = Get<GLint>();
+		GLenum format = Get<GLenum>();
+		GLenum type = Get<GLenum>();
+		glTexImage2D(target, level, internalFormat, width, height, border, format, type, GetPixels());
+		break;
+	}
+	case GlCaptureFormat::TEX_SUB_IMAGE_2D:
+	{
+		GLenum target = Get<GLenum>();
+		GLint level = Get<GLint>();
+		GLint x = Get<GLint>();
+		GLint y = Get<GLint>();
+		GLsizei width = Get<GLsizei>();
+		GLsizei height = Get<GLsizei>();
+		GLenum format = Get<GLenum>();
+		GLenum type = Get<GLenum>();
+		glTexSubImage2D(target, level, x, y, width, height, format, type, GetPixels());
+		break;
+	}
+	case GlCaptureFormat::COMPRESSED_TEX_IMAGE_2D:
+	{
+		GLenum target = Get<GLenum>();
+		GLint level = Get<GLint>();
+		GLenum internalFormat = Get<GLenum>();
+		GLsizei width = Get<GLsizei>();
+		GLsizei height = Get<GLsizei>();
+		GLint border = Get<GLint>();
+		GLsizei imageSize = Get<GLsizei>();
+		glCompressedTexImage2D(target, level, internalFormat, width, height, border, imageSize, GetPixels());
+		break;
+	}
+	case GlCaptureFormat::COMPRESSED_TEX_SUB_IMAGE_2D:
+	{
+		GLenum target = Get<GLenum>();
+		GLint level = Get<GLint>();
+		GLint x = Get<GLint>();
+		GLint y = Get<GLint>();
+		GLsizei width = Get<GLsizei>();
+		GLsizei height = Get<GLsizei>();
+		GLenum format = Get<GLenum>();
+		GLsizei imageSize = Get<GLsizei>();
+		glCompressedTexSubImage2D(target, level, x, y, width, height, format, imageSize, GetPixels());
+		break;
+	}
+	case GlCaptureFormat::GENERATE_MIPMAP:
+		glGenerateMipmap(Get<GLenum>());
+		break;
+	case GlCaptureFormat::COPY_TEX_SUB_IMAGE_2D:
+	{
+		GLenum target = Get<GLenum>();
+		GLint level = Get<GLint>();
+		GLint xOffset = Get<GLint>();
+		GLint yOffset = Get<GLint>();
+		GLint x = Get<GLint>();
+		GLint y = Get<GLint>();
+		GLsizei width = Get<GLsizei>();
+		GLsizei height = Get<GLsizei>();
+		glCopyTexSubImage2D(target, level, xOffset, yOffset, x, y, width, height);
+		break;
+	}
+	case GlCaptureFormat::BIND_IMAGE_TEXTURE:
+	{
+		GLuint unit = Get<GLuint>();
+		GLuint texture = Texture(Get<GLuint>());
+		GLint level = Get<GLint>();
+		GLboolean layered = Get<GLboolean>();
+		GLint layer = Get<GLint>();
+		GLenum access = Get<GLenum>();
+		GLenum format = Get<GLenum>();
+		glBindImageTexture(unit, texture, level, layered, layer, access, format);
+		break;
+	}
+
+	// framebuffers
+	case GlCaptureFormat::BIND_FRAMEBUFFER:
+	{
+		GLenum target = Get<GLenum>();
+		glBindFramebuffer(target, Framebuffer(Get<GLuint>()));
+		break;
+	}
+	case GlCaptureFormat::FRAMEBUFFER_TEXTURE_2D:
+	{
+		GLenum target = Get<GLenum>();
+		GLenum attachment = Get<GLenum>();
+		GLenum textureTarget = Get<GLenum>();
+		GLuint texture = Texture(Get<GLuint>());
+		GLint level = Get<GLint>();
+		glFramebufferTexture2D(target, attachment, textureTarget, texture, level);
+		break;
+	}
+	case GlCaptureFormat::DRAW_BUFFERS:
+	{
+		GLenum buffers[16];
+		GLsizei count = Get<GLsizei>();
+		for (GLsizei i = 0; i < count; i++)
+		{
+			GLenum buffer = Get<GLenum>();
+			if (i < 16)
+			{
+				buffers[i] = buffer;
+			}
+		}
+		glDrawBuffers(std::min(count, 16), buffers);
+		break;
+	}
+	case GlCaptureFormat::DRAW_BUFFER:
+		glDrawBuffer(Get<GLenum>());
+		break;
+	case GlCaptureFormat::READ_BUFFER:
+		glReadBuffer(Get<GLenum>());
+		break;
+	case GlCaptureFormat::BLIT_FRAMEBUFFER:
+	{
+		GLint values[8];
+		for (int i = 0; i < 8; i++)
+		{
+			values[i] = Get<GLint>();
+		}
+		GLbitfield mask = Get<GLbitfield>();
+		GLenum filter = Get<GLenum>();
+		glBlitFramebuffer(values[0], values[1], values[2], values[3],
+			values[4], values[5], values[6], values[7], mask, filter);
+		break;
+	}
+
+	// shaders and programs
+	case GlCaptureFormat::CREATE_SHADER:
+	{
+		GLenum type = Get<GLenum>();
+		GLuint recorded = Get<GLuint>();
+		m_shaders[recorded] = glCreateShader(type);
+		break;
+	}
+	case GlCaptureFormat::SHADER_SOURCE:
+	{
+		GLuint shader = Shader(Get<GLuint>());
+		GLsizei count = Get<GLsizei>();
+		std::vector<const GLchar*> strings;
+		std::vector<GLint> lengths;
+		for (GLsizei i = 0; i < count; i++)
+		{
+			unsigned int length = 0;
+			const GLchar* source = (const GLchar*)GetBlob(length);
+			strings.push_back((NULL != source) ? source : "");
+			lengths.push_back((GLint)length);
+		}
+		glShaderSource(shader, count, strings.data(), lengths.data());
+		break;
+	}
+	case GlCaptureFormat::COMPILE_SHADER:
+		glCompileShader(Shader(Get<GLuint>()));
+		break;
+	case GlCaptureFormat::DELETE_SHADER:
+	{
+		GLuint recorded = Get<GLuint>();
+		glDeleteShader(Shader(recorded));
+		m_shaders.erase(recorded);
+		break;
+	}
+	case GlCaptureFormat::CREATE_PROGRAM:
+		m_programs[Get<GLuint>()] = glCreateProgram();
+		break;
+	case GlCaptureFormat::ATTACH_SHADER:
+	case GlCaptureFormat::DETACH_SHADER:
+	{
+		GLuint program = Program(Get<GLuint>());
+		GLuint shader = Shader(Get<GLuint>());
+		if (GlCaptureFormat::ATTACH_SHADER == command)
+		{
+			glAttachShader(program, shader);
+		}
+		else
+		{
+			glDetachShader(program, shader);
+		}
+		break;
+	}
+	case GlCaptureFormat::LINK_PROGRAM:
+		glLinkProgram(Program(Get<GLuint>()));
+		break;
+	case GlCaptureFormat::DELETE_PROGRAM:
+	{
+		GLuint recorded = Get<GLuint>();
+		glDeleteProgram(Program(recorded));
+		m_programs.erase(recorded);
+		m_locations.erase(recorded);
+		m_blockIndices.erase(recorded);
+		break;
+	}
+	case GlCaptureFormat::USE_PROGRAM:
+		m_currentProgram = Get<GLuint>();
+		glUseProgram(Program(m_currentProgram));
+		break;
+	case GlCaptureFormat::GET_UNIFORM_LOCATION:
+	case GlCaptureFormat::GET_UNIFORM_BLOCK_INDEX:
+	{
+		GLuint recorded = Get<GLuint>();
+		unsigned int length = 0;
+		const char* name = (const char*)GetBlob(length);
+		m_name.assign((NULL != name) ? name : "", length);
+		if (GlCaptureFormat::GET_UNIFORM_LOCATION == command)
+		{
+			GLint location = Get<GLint>();
+			m_locations[recorded][location] = glGetUniformLocation(Program(recorded), m_name.c_str());
+		}
+		else
+		{
+			GLint index = (GLint)Get<GLuint>();
+			m_blockIndices[recorded][index] = (GLint)glGetUniformBlockIndex(Program(recorded), m_name.c_str());
+		}
+		break;
+	}
+	case GlCaptureFormat::UNIFORM_BLOCK_BINDING:
+	{
+		GLuint recorded = Get<GLuint>();
+		GLint index = (GLint)Get<GLuint>();
+		GLuint binding = Get<GLuint>();
+		std::unordered_map<GLint, GLint>& indices = m_blockIndices[recorded];
+		std::unordered_map<GLint, GLint>::iterator found = indices.find(index);
+		glUniformBlockBinding(Program(recorded), (GLuint)((found != indices.end()) ? found->second : index), binding);
+		break;
+	}
+	case GlCaptureFormat::UNIFORM_1I:
+	{
+		GLint location = Location(Get<GLint>());
+		glUniform1i(location, Get<GLint>());
+		break;
+	}
+	case GlCaptureFormat::UNIFORM_1UI:
+	{
+		GLint location = Location(Get<GLint>());
+		glUniform1ui(location, Get<GLuint>());
+		break;
+	}
+	case GlCaptureFormat::UNIFORM_1F:
+	{
+		GLint location = Location(Get<GLint>());
+		glUniform1f(location, Get<GLfloat>());
+		break;
+	}
+	case GlCaptureFormat::UNIFORM_2I:
+	{
+		GLint location = Location(Get<GLint>());
+		GLint x = Get<GLint>();
+		GLint y = Get<GLint>();
+		glUniform2i(location, x, y);
+		break;
+	}
+	case GlCaptureFormat::UNIFORM_2F:
+	{
+		GLint location = Location(Get<GLint>());
+		GLfloat x = Get<GLfloat>();
+		GLfloat y = Get<GLfloat>();
+		glUniform2f(location, x, y);
+		break;
+	}
+	case GlCaptureFormat::UNIFORM_3I:
+	{
+		GLint location = Location(Get<GLint>());
+		GLint x = Get<GLint>();
+		GLint y = Get<GLint>();
+		GLint z = Get<GLint>();
+		glUniform3i(location, x, y, z);
+		break;
+	}
+	case GlCaptureFormat::UNIFORM_3F:
+	{
+		GLint location = Location(Get<GLint>());
+		GLfloat x = Get<GLfloat>();
+		GLfloat y = Get<GLfloat>();
+		GLfloat z = Get<GLfloat>();
+		glUniform3f(location, x, y, z);
+		break;
+	}
+	case GlCaptureFormat::UNIFORM_4F:
+	{
+		GLint location = Location(Get<GLint>());
+		GLfloat x = Get<GLfloat>();
+		GLfloat y = Get<GLfloat>();
+		GLfloat z = Get<GLfloat>();
+		GLfloat w = Get<GLfloat>();
+		glUniform4f(location, x, y, z, w);
+		break;
+	}
+	case GlCaptureFormat::UNIFORM_FV:
+	{
+		int components = Get<int>();
+		GLint location = Location(Get<GLint>());
+		GLsizei count = Get<GLsizei>();
+		const GLfloat* values = (const GLfloat*)GetBlob();
+		if (NULL == values)
+		{
+			break;
+		}
+		if (2 == components)
+		{
+			glUniform2fv(location, count, values);
+		}
+		else if (3 == components)
+		{
+			glUniform3fv(location, count, values);
+		}
+		else
+		{
+			glUniform4fv(location, count, values);
+		}
+		break;
+	}
+	case GlCaptureFormat::UNIFORM_MATRIX_FV:
+	{
+		int components = Get<int>();
+		GLint location = Location(Get<GLint>());
+		GLsizei count = Get<GLsizei>();
+		GLboolean transpose = Get<GLboolean>();
+		const GLfloat* values = (const GLfloat*)GetBlob();
+		if (NULL == values)
+		{
+			break;
+		}
+		if (2 == components)
+		{
+			glUniformMatrix2fv(location, count, transpose, values);
+		}
+		else if (3 == components)
+		{
+			glUniformMatrix3fv(location, count, transpose, values);
+		}
+		else
+		{
+			glUniformMatrix4fv(location, count, transpose, values);
+		}
+		break;
+	}
+
+	// draws and dispatches
+	case GlCaptureFormat::DRAW_ARRAYS:
+	{
+		GLenum mode = Get<GLenum>();
+		GLint first = Get<GLint>();
+		GLsizei count = Get<GLsizei>();
+		glDrawArrays(mode, first, count);
+		break;
+	}
+	case GlCaptureFormat::DRAW_ARRAYS_INSTANCED:
+	{
+		GLenum mode = Get<GLenum>();
+		GLint first = Get<GLint>();
+		GLsizei count = Get<GLsizei>();
+		GLsizei instanceCount = Get<GLsizei>();
+		glDrawArraysInstanced(mode, first, count, instanceCount);
+		break;
+	}
+	case GlCaptureFormat::DRAW_ELEMENTS:
+	{
+		GLenum mode = Get<GLenum>();
+		GLsizei count = Get<GLsizei>();
+		GLenum type = Get<GLenum>();
+		glDrawElements(mode, count, type, GetOffset());
+		break;
+	}
+	case GlCaptureFormat::DRAW_ELEMENTS_BASE_VERTEX:
+	{
+		GLenum mode = Get<GLenum>();
+		GLsizei count = Get<GLsizei>();
+		GLenum type = Get<GLenum>();
+		void* indices = (void*)GetOffset();
+		GLint baseVertex = Get<GLint>();
+		glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+		break;
+	}
+	case GlCaptureFormat::MULTI_DRAW_ELEMENTS_INDIRECT:
+	{
+		GLenum mode = Get<GLenum>();
+		GLenum type = Get<GLenum>();
+		const void* indirect = GetOffset();
+		GLsizei drawCount = Get<GLsizei>();
+		GLsizei stride = Get<GLsizei>();
+		glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+		break;
+	}
+	case GlCaptureFormat::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT:
+	{
+		GLenum mode = Get<GLenum>();
+		GLenum type = Get<GLenum>();
+		const void* indirect = GetOffset();
+		GLintptr drawCount = (GLintptr)Get<long long>();
+		GLsizei maxDrawCount = Get<GLsizei>();
+		GLsizei stride = Get<GLsizei>();
+		// recorded from the core or the ARB function, whichever the
+		// application had - the replay uses whichever it has
+		if (NULL != glMultiDrawElementsIndirectCount)
+		{
+			glMultiDrawElementsIndirectCount(mode, type, indirect, drawCount, maxDrawCount, stride);
+		}
+		else if (NULL != glMultiDrawElementsIndirectCountARB)
+		{
+			glMultiDrawElementsIndirectCountARB(mode, type, indirect, drawCount, maxDrawCount, stride);
+		}
+		break;
+	}
+	case GlCaptureFormat::DISPATCH_COMPUTE:
+	{
+		GLuint groupsX = Get<GLuint>();
+		GLuint groupsY = Get<GLuint>();
+		GLuint groupsZ = Get<GLuint>();
+		glDispatchCompute(groupsX, groupsY, groupsZ);
+		break;
+	}
+	case GlCaptureFormat::MEMORY_BARRIER:
+		glMemoryBarrier(Get<GLbitfield>());
+		break;
+
+	default:
+		// the arguments of an unknown call cannot be skipped
+		std::cout << "Unknown call " << command << " in the capture" << std::endl;
+		m_bFailed = true;
+		break;
+	}
+}
+
+/***********************************************************
+ *  PrintUsage()
+ *
+ *  Lists the replay options.
+ ***********************************************************/
+static void PrintUsage()
+{
+	std::cout << "Usage: GlReplay [options] CAPTURE\n";
+	std::cout << "  --loops N      times the capture window is replayed (default 20)\n";
+	std::cout << "  --output FILE  write the report to FILE as well\n";
+	std::cout << "Record a capture with --capture FILE in the application or SceneBenchmark." << std::endl;
+}
+
+/***********************************************************
+ *  ParseOptions()
+ *
+ *  Reads the replay options - false for unknown options or
+ *  a missing capture.
+ ***********************************************************/
+static bool ParseOptions(int argc, char* argv[], ReplayOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		bool bHasValue = (i + 1 < argc);
+
+		if ((strcmp(argument, "--loops") == 0) && (bHasValue == true))
+		{
+			options.loops = std::max(1, atoi(argv[++i]));
+		}
+		else if ((strcmp(argument, "--output") == 0) && (bHasValue == true))
+		{
+			options.outputFile = argv[++i];
+		}
+		else if ((argument[0] != '-') && (options.captureFile.empty() == true))
+		{
+			options.captureFile = argument;
+		}
+		else
+		{
+			std::cout << "Unknown option " << argument << std::endl;
+			return false;
+		}
+	}
+	return (options.captureFile.empty() == false);
+}
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  Replays the startup and the frames before the capture
+ *  window once, the window once more to create what it
+ *  creates, and then times the window for every loop. The
+ *  submit time of a frame is the time its calls take to
+ *  return, the loop time waits for the GPU with glFinish.
+ *  Returns 0 when the capture replayed without a GL error.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	ReplayOptions options;
+	if (ParseOptions(argc, argv, options) == false)
+	{
+		PrintUsage();
+		return EXIT_BAD_ARGUMENTS;
+	}
+
+	CaptureReplay replay;
+	if (replay.Load(options.captureFile) == false)
+	{
+		return EXIT_REPLAY_FAILED;
+	}
+	const GlCaptureFormat::Header& header = replay.GetHeader();
+
+	OffscreenTarget target;
+	if (OffscreenContext::Create(target, header.width, header.height, false) == false)
+	{
+		OffscreenContext::Destroy(target);
+		return EXIT_REPLAY_FAILED;
+	}
+	replay.SetTargetFramebuffer(target.framebuffer);
+
+	// the state the window starts with
+	bool bSucceeded = true;
+	Clock::time_point setupStart = Clock::now();
+	for (int frame = 0; (frame < header.firstFrame) && (bSucceeded == true); frame++)
+	{
+		bSucceeded = replay.ExecuteFrame();
+	}
+	size_t windowStart = replay.GetPosition();
+	long long windowCommands = replay.GetCommands();
+	int windowFrames = 0;
+	while ((bSucceeded == true) && (replay.ExecuteFrame() == true))
+	{
+		windowFrames++;
+	}
+	windowCommands = replay.GetCommands() - windowCommands;
+	glFinish();
+	double setupTime = Milliseconds(Clock::now() - setupStart).count();
+	if ((bSucceeded == false) || (replay.HasFailed() == true) || (0 == windowFrames))
+	{
+		std::cout << options.captureFile << " ends before the frames of its capture window" << std::endl;
+		replay.DeleteObjects();
+		OffscreenContext::Destroy(target);
+		return EXIT_REPLAY_FAILED;
+	}
+
+	std::vector<double> submitTimes;
+	std::vector<double> frameTimes;
+	for (int loop = 0; loop < options.loops; loop++)
+	{
+		replay.SetPosition(windowStart);
+		Clock::time_point loopStart = Clock::now();
+		Clock::time_point frameStart = loopStart;
+		for (int frame = 0; frame < windowFrames; frame++)
+		{
+			replay.ExecuteFrame();
+			Clock::time_point submitted = Clock::now();
+			submitTimes.push_back(Milliseconds(submitted - frameStart).count());
+			frameStart = submitted;
+		}
+		glFinish();
+		frameTimes.push_back(Milliseconds(Clock::now() - loopStart).count() / windowFrames);
+	}
+
+	GLenum glError = glGetError();
+	bSucceeded = (GL_NO_ERROR == glError) && (replay.HasFailed() == false);
+
+	std::ostringstream json;
+	json << "{\n";
+	json << "  \"capture\": \"" << options.captureFile << "\",\n";
+	json << "  \"renderer\": \"" << glGetString(GL_RENDERER) << "\",\n";
+	json << "  \"width\": " << header.width << ",\n";
+	json << "  \"height\": " << header.height << ",\n";
+	json << "  \"setup_frames\": " << header.firstFrame << ",\n";
+	json << "  \"setup_ms\": " << setupTime << ",\n";
+	json << "  \"frames\": " << windowFrames << ",\n";
+	json << "  \"loops\": " << options.loops << ",\n";
+	json << "  \"calls_per_frame\": " << (double)windowCommands / windowFrames << ",\n";
+	json << "  \"submit_ms\": ";
+	TimeStatistics::Write(json, submitTimes);
+	json << ",\n  \"frame_ms\": ";
+	TimeStatistics::Write(json, frameTimes);
+	json << ",\n  \"gl_error\": " << glError << "\n";
+	json << "}\n";
+	std::cout << json.str();
+	if (options.outputFile.empty() == false)
+	{
+		std::ofstream report(options.outputFile.c_str());
+		report << json.str();
+		report.close();
+		if (report.fail() == true)
+		{
+			std::cout << "Failed to write " << options.outputFile << std::endl;
+			bSucceeded = false;
+		}
+	}
+
+	replay.DeleteObjects();
+	OffscreenContext::Destroy(target);
+
+	return (bSucceeded == true) ? EXIT_SUCCESS : EXIT_REPLAY_FAILED;
+}
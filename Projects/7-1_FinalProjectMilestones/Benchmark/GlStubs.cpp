@@ -0,0 +1,59 @@
+#include "GlStubs.h"
+
+#include <GL/glew.h>        // GLEW library
+
+namespace
+{
+	// the next name handed out by the stubs
+	GLuint g_NextName = 1;
+}
+
+static void GLAPIENTRY StubGenNames(GLsizei count, GLuint* pNames)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		pNames[i] = g_NextName++;
+	}
+}
+
+static void GLAPIENTRY StubDeleteNames(GLsizei, const GLuint*)
+{
+}
+
+static void GLAPIENTRY StubBindVertexArray(GLuint)
+{
+}
+
+static void GLAPIENTRY StubBindBuffer(GLenum, GLuint)
+{
+}
+
+static void GLAPIENTRY StubBufferData(GLenum, GLsizeiptr, const void*, GLenum)
+{
+}
+
+static void GLAPIENTRY StubVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*)
+{
+}
+
+static void GLAPIENTRY StubEnableVertexAttribArray(GLuint)
+{
+}
+
+/***********************************************************
+ *  Install()
+ *
+ *  Replaces the GLEW function pointers the generators call.
+ ***********************************************************/
+void GlStubs::Install()
+{
+	__glewGenVertexArrays = StubGenNames;
+	__glewDeleteVertexArrays = StubDeleteNames;
+	__glewBindVertexArray = StubBindVertexArray;
+	__glewGenBuffers = StubGenNames;
+	__glewDeleteBuffers = StubDeleteNames;
+	__glewBindBuffer = StubBindBuffer;
+	__glewBufferData = StubBufferData;
+	__glewVertexAttribPointer = StubVertexAttribPointer;
+	__glewEnableVertexAttribArray = StubEnableVertexAttribArray;
+}
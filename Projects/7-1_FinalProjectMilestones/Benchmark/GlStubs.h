@@ -0,0 +1,15 @@
+#pragma once
+
+/***********************************************************
+ *  GlStubs
+ *
+ *  Stand-ins for the GL calls of the mesh generators, so the
+ *  tools without a context can build the meshes - names are
+ *  handed out in order and everything else does nothing.
+ *  Only the calls of the Load*Mesh() methods are replaced.
+ ***********************************************************/
+namespace GlStubs
+{
+	// point the GLEW entry points at the stubs
+	void Install();
+}
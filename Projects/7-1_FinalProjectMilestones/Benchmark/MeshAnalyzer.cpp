@@ -0,0 +1,610 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshanalyzer.cpp
+// ================
+// reports the quality of the ShapeMeshes primitives and of OBJ meshes - the
+// vertices and indices, duplicate vertices, degenerate triangles, the hit
+// rate of a post-transform vertex cache and the overdraw from fixed views
+//
+// Needs no GL context: the primitives are built with the GL calls stubbed
+// out, see GlStubs, and recorded into the triangle lists the indirect path
+// draws from the shared buffers, so the fans and strips of the immediate
+// path are analyzed as the triangles they turn into.
+//
+//   MeshAnalyzer [--output FILE] [mesh.obj ...]
+///////////////////////////////////////////////////////////////////////////////
+
+#include <GL/glew.h>        // GLEW library
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "ShapeMeshes.h"
+#include "GlStubs.h"
+
+namespace
+{
+	// exit codes - a mesh that failed to load returns 1 and bad options return 2
+	const int EXIT_ANALYSIS_FAILED = 1;
+	const int EXIT_BAD_ARGUMENTS = 2;
+
+	// the floats of a vertex in the shared layout - position, normal and
+	// texture coordinates - and the bytes of a vertex and of an index
+	const int g_VertexFloats = ShapeMeshes::SHARED_VERTEX_FLOATS;
+	const int g_VertexBytes = g_VertexFloats * (int)sizeof(GLfloat);
+	const int g_IndexBytes = (int)sizeof(GLuint);
+
+	// the entries of the simulated FIFO vertex caches
+	const int g_CacheSizes[] = { 16, 32 };
+	const int g_CacheCount = (int)(sizeof(g_CacheSizes) / sizeof(g_CacheSizes[0]));
+
+	// the overdraw is rasterized at this size from every view
+	const int g_OverdrawResolution = 128;
+
+	// a triangle is degenerate when it repeats a vertex or when twice its
+	// area is below this share of the squared bounding radius
+	const float g_DegenerateArea = 1.0e-7f;
+
+	// the triangles of one mesh - the indices refer to the vertices
+	struct MeshData
+	{
+		std::string name;
+		std::vector<GLfloat> vertices;
+		std::vector<GLuint> indices;
+	};
+
+	// the measurements of one mesh
+	struct MeshReport
+	{
+		std::string name;
+		int vertices;
+		// stored vertices no triangle uses
+		int unusedVertices;
+		// stored vertices equal to an earlier one in every float
+		int duplicateVertices;
+		int indices;
+		int triangles;
+		int degenerateTriangles;
+		// cache misses per triangle and per used vertex
+		double acmr[g_CacheCount];
+		double atvr[g_CacheCount];
+		// shaded fragments per covered pixel, averaged over the views
+		double overdraw;
+		long long bytes;
+	};
+
+	// one primitive of ShapeMeshes, its generator and the draw recorded
+	struct Primitive
+	{
+		const char* name;
+		void (*load)(ShapeMeshes& meshes);
+		void (*draw)(ShapeMeshes& meshes);
+	};
+
+	// every primitive the scenes draw - the half sphere and half torus
+	// draw a part of the whole mesh
+	const Primitive g_Primitives[] =
+	{
+		{ "box", [](ShapeMeshes& m) { m.LoadBoxMesh(); }, [](ShapeMeshes& m) { m.DrawBoxMesh(); } },
+		{ "cone", [](ShapeMeshes& m) { m.LoadConeMesh(); }, [](ShapeMeshes& m) { m.DrawConeMesh(); } },
+		{ "cylinder", [](ShapeMeshes& m) { m.LoadCylinderMesh(); }, [](ShapeMeshes& m) { m.DrawCylinderMesh(); } },
+		{ "plane", [](ShapeMeshes& m) { m.LoadPlaneMesh(); }, [](ShapeMeshes& m) { m.DrawPlaneMesh(); } },
+		{ "prism", [](ShapeMeshes& m) { m.LoadPrismMesh(); }, [](ShapeMeshes& m) { m.DrawPrismMesh(); } },
+		{ "pyramid3", [](ShapeMeshes& m) { m.LoadPyramid3Mesh(); }, [](ShapeMeshes& m) { m.DrawPyramid3Mesh(); } },
+		{ "pyramid4", [](ShapeMeshes& m) { m.LoadPyramid4Mesh(); }, [](ShapeMeshes& m) { m.DrawPyramid4Mesh(); } },
+		{ "sphere", [](ShapeMeshes& m) { m.LoadSphereMesh(); }, [](ShapeMeshes& m) { m.DrawSphereMesh(); } },
+		{ "half_sphere", [](ShapeMeshes& m) { m.LoadSphereMesh(); }, [](ShapeMeshes& m) { m.DrawHalfSphereMesh(); } },
+		{ "tapered_cylinder", [](ShapeMeshes& m) { m.LoadTaperedCylinderMesh(); },
+			[](ShapeMeshes& m) { m.DrawTaperedCylinderMesh(); } },
+		{ "torus", [](ShapeMeshes& m) { m.LoadTorusMesh(); }, [](ShapeMeshes& m) { m.DrawTorusMesh(); } },
+		{ "half_torus", [](ShapeMeshes& m) { m.LoadTorusMesh(); }, [](ShapeMeshes& m) { m.DrawHalfTorusMesh(); } },
+		{ "extra_torus1", [](ShapeMeshes& m) { m.LoadExtraTorusMesh1(); }, [](ShapeMeshes& m) { m.DrawExtraTorusMesh1(); } },
+		{ "extra_torus2", [](ShapeMeshes& m) { m.LoadExtraTorusMesh2(); }, [](ShapeMeshes& m) { m.DrawExtraTorusMesh2(); } }
+	};
+	const int g_PrimitiveCount = (int)(sizeof(g_Primitives) / sizeof(g_Primitives[0]));
+}
+
+/***********************************************************
+ *  PrintUsage()
+ *
+ *  Lists the analyzer options.
+ ***********************************************************/
+static void PrintUsage()
+{
+	std::cout << "Usage: MeshAnalyzer [--output FILE] [mesh.obj ...]\n";
+	std::cout << "  --output FILE  also write the report as JSON to FILE\n";
+	std::cout << "Every ShapeMeshes primitive is analyzed, followed by the OBJ meshes passed." << std::endl;
+}
+
+/***********************************************************
+ *  BuildPrimitive()
+ *
+ *  Generates one primitive into its own meshes object and
+ *  records its draw, so the shared buffers hold only its
+ *  vertices and the triangles of the draw.
+ ***********************************************************/
+static MeshData BuildPrimitive(const Primitive& primitive)
+{
+	ShapeMeshes meshes;
+	primitive.load(meshes);
+	std::vector<ShapeMeshes::DrawRecord> records;
+	meshes.BeginRecording(&records);
+	primitive.draw(meshes);
+	meshes.EndRecording();
+
+	MeshData mesh;
+	mesh.name = primitive.name;
+	mesh.vertices = meshes.GetSharedVertices();
+	const std::vector<GLuint>& sharedIndices = meshes.GetSharedIndices();
+	for (const ShapeMeshes::DrawRecord& record : records)
+	{
+		for (GLuint i = record.firstIndex; i < record.firstIndex + record.indexCount; i++)
+		{
+			mesh.indices.push_back(record.baseVertex + sharedIndices[i]);
+		}
+	}
+	return mesh;
+}
+
+/***********************************************************
+ *  LoadObjMesh()
+ *
+ *  Reads the triangles of a Wavefront OBJ file into the
+ *  shared vertex layout. Every distinct position, texture
+ *  coordinate and normal triple of the faces becomes one
+ *  vertex, polygons are split into fans and everything but
+ *  the v, vt, vn and f lines is skipped.
+ ***********************************************************/
+static bool LoadObjMesh(const char* filename, MeshData& mesh)
+{
+	std::ifstream file(filename);
+	if (file.is_open() == false)
+	{
+		std::cout << "Failed to open " << filename << std::endl;
+		return false;
+	}
+
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	std::map<std::tuple<int, int, int>, GLuint> vertexIndices;
+	mesh.name = filename;
+
+	// the array index of a 1 based or negative OBJ index, -1 when
+	// it is missing or out of range
+	auto Resolve = [](int index, size_t count) {
+		int resolved = (index < 0) ? (int)count + index : index - 1;
+		return ((resolved >= 0) && (resolved < (int)count)) ? resolved : -1;
+		};
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		std::istringstream stream(line);
+		std::string type;
+		stream >> type;
+		if (type == "v")
+		{
+			glm::vec3 position(0.0f);
+			stream >> position.x >> position.y >> position.z;
+			positions.push_back(position);
+		}
+		else if (type == "vt")
+		{
+			glm::vec2 uv(0.0f);
+			stream >> uv.x >> uv.y;
+			uvs.push_back(uv);
+		}
+		else if (type == "vn")
+		{
+			glm::vec3 normal(0.0f);
+			stream >> normal.x >> normal.y >> normal.z;
+			normals.push_back(normal);
+		}
+		else if (type == "f")
+		{
+			std::vector<GLuint> face;
+			std::string corner;
+			while (stream >> corner)
+			{
+				// v, v/vt, v//vn or v/vt/vn
+				int position = 0;
+				int uv = 0;
+				int normal = 0;
+				if ((sscanf(corner.c_str(), "%d/%d/%d", &position, &uv, &normal) != 3) &&
+					(sscanf(corner.c_str(), "%d//%d", &position, &normal) != 2) &&
+					(sscanf(corner.c_str(), "%d/%d", &position, &uv) != 2) &&
+					(sscanf(corner.c_str(), "%d", &position) != 1))
+				{
+					position = 0;
+				}
+				std::tuple<int, int, int> key(Resolve(position, positions.size()),
+					Resolve(uv, uvs.size()), Resolve(normal, normals.size()));
+				if (std::get<0>(key) < 0)
+				{
+					std::cout << filename << "(" << lineNumber << "): bad vertex " << corner << std::endl;
+					return false;
+				}
+
+				std::map<std::tuple<int, int, int>, GLuint>::iterator found = vertexIndices.find(key);
+				if (found == vertexIndices.end())
+				{
+					glm::vec3 p = positions[std::get<0>(key)];
+					glm::vec2 t = (std::get<1>(key) >= 0) ? uvs[std::get<1>(key)] : glm::vec2(0.0f);
+					glm::vec3 n = (std::get<2>(key) >= 0) ? normals[std::get<2>(key)] : glm::vec3(0.0f);
+					GLfloat vertex[g_VertexFloats] = { p.x, p.y, p.z, n.x, n.y, n.z, t.x, t.y };
+					mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + g_VertexFloats);
+					found = vertexIndices.insert(std::make_pair(key, (GLuint)vertexIndices.size())).first;
+				}
+				face.push_back(found->second);
+			}
+
+			for (size_t i = 2; i < face.size(); i++)
+			{
+				mesh.indices.push_back(face[0]);
+				mesh.indices.push_back(face[i - 1]);
+				mesh.indices.push_back(face[i]);
+			}
+		}
+	}
+
+	if (mesh.indices.empty() == true)
+	{
+		std::cout << filename << " has no faces" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/***********************************************************
+ *  GetPosition()
+ *
+ *  The position of a vertex of the mesh.
+ ***********************************************************/
+static glm::vec3 GetPosition(const MeshData& mesh, GLuint vertex)
+{
+	const GLfloat* values = &mesh.vertices[(size_t)vertex * g_VertexFloats];
+	return glm::vec3(values[0], values[1], values[2]);
+}
+
+/***********************************************************
+ *  SimulateFifoCache()
+ *
+ *  The misses of a FIFO post-transform cache of the passed
+ *  entries over the indices - a hit does not move the
+ *  vertex, like the caches of most hardware.
+ ***********************************************************/
+static int SimulateFifoCache(const std::vector<GLuint>& indices, int cacheSize)
+{
+	std::vector<GLuint> cache((size_t)cacheSize, 0xFFFFFFFFu);
+	size_t next = 0;
+	int misses = 0;
+	for (GLuint index : indices)
+	{
+		if (std::find(cache.begin(), cache.end(), index) == cache.end())
+		{
+			cache[next] = index;
+			next = (next + 1) % cache.size();
+			misses++;
+		}
+	}
+	return misses;
+}
+
+/***********************************************************
+ *  MeasureOverdraw()
+ *
+ *  Rasterizes the triangles in their index order from the
+ *  6 axis and 8 corner directions, orthographically around
+ *  the bounding sphere and without face culling like the
+ *  scenes draw them. The overdraw of a view is the
+ *  fragments that pass the depth test per covered pixel -
+ *  1.0 when every pixel is shaded once, more when the
+ *  order draws far triangles before near ones. Views that
+ *  see a flat mesh edge on cover nothing and are left out
+ *  of the average.
+ ***********************************************************/
+static double MeasureOverdraw(const MeshData& mesh, const glm::vec3& center, float radius)
+{
+	const int size = g_OverdrawResolution;
+	std::vector<glm::vec3> directions;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		glm::vec3 direction(0.0f);
+		direction[axis] = 1.0f;
+		directions.push_back(direction);
+		directions.push_back(-direction);
+	}
+	for (int corner = 0; corner < 8; corner++)
+	{
+		directions.push_back(glm::normalize(glm::vec3((corner & 1) ? 1.0f : -1.0f,
+			(corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f)));
+	}
+
+	double totalOverdraw = 0.0;
+	int coveringViews = 0;
+	std::vector<float> depths((size_t)size * size);
+	for (const glm::vec3& direction : directions)
+	{
+		// screen axes across the view direction
+		glm::vec3 reference = (std::fabs(direction.y) < 0.9f) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+		glm::vec3 right = glm::normalize(glm::cross(direction, reference));
+		glm::vec3 up = glm::cross(right, direction);
+		float scale = size / (2.0f * std::max(radius, FLT_MIN));
+
+		std::fill(depths.begin(), depths.end(), FLT_MAX);
+		long long fragments = 0;
+		for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+		{
+			// pixel coordinates and the depth along the view direction
+			glm::vec3 corners[3];
+			for (int c = 0; c < 3; c++)
+			{
+				glm::vec3 offset = GetPosition(mesh, mesh.indices[t + c]) - center;
+				corners[c] = glm::vec3(glm::dot(offset, right) * scale + size * 0.5f,
+					glm::dot(offset, up) * scale + size * 0.5f, glm::dot(offset, direction));
+			}
+			float area = (corners[1].x - corners[0].x) * (corners[2].y - corners[0].y) -
+				(corners[2].x - corners[0].x) * (corners[1].y - corners[0].y);
+			if (std::fabs(area) < 1.0e-12f)
+			{
+				continue;
+			}
+
+			int minX = std::max(0, (int)std::floor(std::min(corners[0].x, std::min(corners[1].x, corners[2].x))));
+			int maxX = std::min(size - 1, (int)std::ceil(std::max(corners[0].x, std::max(corners[1].x, corners[2].x))));
+			int minY = std::max(0, (int)std::floor(std::min(corners[0].y, std::min(corners[1].y, corners[2].y))));
+			int maxY = std::min(size - 1, (int)std::ceil(std::max(corners[0].y, std::max(corners[1].y, corners[2].y))));
+			for (int y = minY; y <= maxY; y++)
+			{
+				for (int x = minX; x <= maxX; x++)
+				{
+					// barycentric weights of the pixel center, positive inside
+					// for either winding
+					float px = x + 0.5f;
+					float py = y + 0.5f;
+					float w0 = ((corners[2].x - corners[1].x) * (py - corners[1].y) -
+						(corners[2].y - corners[1].y) * (px - corners[1].x)) / area;
+					float w1 = ((corners[0].x - corners[2].x) * (py - corners[2].y) -
+						(corners[0].y - corners[2].y) * (px - corners[2].x)) / area;
+					float w2 = 1.0f - w0 - w1;
+					if ((w0 <= 0.0f) || (w1 <= 0.0f) || (w2 <= 0.0f))
+					{
+						continue;
+					}
+					float depth = w0 * corners[0].z + w1 * corners[1].z + w2 * corners[2].z;
+					float& stored = depths[(size_t)y * size + x];
+					if (depth < stored)
+					{
+						stored = depth;
+						fragments++;
+					}
+				}
+			}
+		}
+
+		long long covered = std::count_if(depths.begin(), depths.end(), [](float depth) { return depth < FLT_MAX; });
+		if (covered > 0)
+		{
+			totalOverdraw += (double)fragments / (double)covered;
+			coveringViews++;
+		}
+	}
+	return (coveringViews > 0) ? totalOverdraw / coveringViews : 0.0;
+}
+
+/***********************************************************
+ *  AnalyzeMesh()
+ *
+ *  Measures the vertices, triangles, vertex cache and
+ *  overdraw of one mesh.
+ ***********************************************************/
+static MeshReport AnalyzeMesh(const MeshData& mesh)
+{
+	MeshReport report;
+	report.name = mesh.name;
+	report.vertices = (int)(mesh.vertices.size() / g_VertexFloats);
+	report.indices = (int)mesh.indices.size();
+	report.triangles = report.indices / 3;
+	report.bytes = (long long)report.vertices * g_VertexBytes + (long long)report.indices * g_IndexBytes;
+
+	// the vertices no triangle uses, and the ones repeating another
+	std::vector<bool> used((size_t)report.vertices, false);
+	for (GLuint index : mesh.indices)
+	{
+		used[index] = true;
+	}
+	int usedVertices = (int)std::count(used.begin(), used.end(), true);
+	report.unusedVertices = report.vertices - usedVertices;
+
+	std::map<std::array<GLfloat, g_VertexFloats>, int> distinct;
+	for (int v = 0; v < report.vertices; v++)
+	{
+		std::array<GLfloat, g_VertexFloats> values;
+		std::copy(&mesh.vertices[(size_t)v * g_VertexFloats], &mesh.vertices[(size_t)(v + 1) * g_VertexFloats], values.begin());
+		distinct.insert(std::make_pair(values, v));
+	}
+	report.duplicateVertices = report.vertices - (int)distinct.size();
+
+	// the bounding sphere the degenerate test and the views use
+	glm::vec3 minimum(FLT_MAX);
+	glm::vec3 maximum(-FLT_MAX);
+	for (int v = 0; v < report.vertices; v++)
+	{
+		if (used[v] == true)
+		{
+			minimum = glm::min(minimum, GetPosition(mesh, v));
+			maximum = glm::max(maximum, GetPosition(mesh, v));
+		}
+	}
+	glm::vec3 center = (usedVertices > 0) ? (minimum + maximum) * 0.5f : glm::vec3(0.0f);
+	float radius = 0.0f;
+	for (int v = 0; v < report.vertices; v++)
+	{
+		if (used[v] == true)
+		{
+			radius = std::max(radius, glm::length(GetPosition(mesh, v) - center));
+		}
+	}
+
+	report.degenerateTriangles = 0;
+	for (int t = 0; t < report.triangles; t++)
+	{
+		GLuint a = mesh.indices[t * 3];
+		GLuint b = mesh.indices[t * 3 + 1];
+		GLuint c = mesh.indices[t * 3 + 2];
+		glm::vec3 p0 = GetPosition(mesh, a);
+		float doubleArea = glm::length(glm::cross(GetPosition(mesh, b) - p0, GetPosition(mesh, c) - p0));
+		if ((a == b) || (b == c) || (a == c) || (doubleArea <= g_DegenerateArea * radius * radius))
+		{
+			report.degenerateTriangles++;
+		}
+	}
+
+	for (int i = 0; i < g_CacheCount; i++)
+	{
+		int misses = SimulateFifoCache(mesh.indices, g_CacheSizes[i]);
+		report.acmr[i] = (report.triangles > 0) ? (double)misses / report.triangles : 0.0;
+		report.atvr[i] = (usedVertices > 0) ? (double)misses / usedVertices : 0.0;
+	}
+
+	report.overdraw = MeasureOverdraw(mesh, center, radius);
+	return report;
+}
+
+/***********************************************************
+ *  PrintReports()
+ *
+ *  Prints the measurements of every mesh as a table.
+ ***********************************************************/
+static void PrintReports(const std::vector<MeshReport>& reports)
+{
+	std::printf("%-20s %8s %7s %7s %8s %8s %7s %7s %7s %7s %7s %8s %10s %8s\n", "mesh", "vertices", "unused",
+		"dupes", "indices", "tris", "degen", "ACMR16", "ACMR32", "ATVR16", "ATVR32", "overdraw", "bytes", "B/vertex");
+	for (const MeshReport& report : reports)
+	{
+		std::printf("%-20s %8d %7d %7d %8d %8d %7d %7.3f %7.3f %7.3f %7.3f %8.3f %10lld %8.1f\n",
+			report.name.c_str(), report.vertices, report.unusedVertices, report.duplicateVertices, report.indices,
+			report.triangles, report.degenerateTriangles, report.acmr[0], report.acmr[1], report.atvr[0], report.atvr[1],
+			report.overdraw, report.bytes, (report.vertices > 0) ? (double)report.bytes / report.vertices : 0.0);
+	}
+	std::printf("%d bytes per vertex and %d per index, ACMR and ATVR of FIFO caches of %d and %d entries\n",
+		g_VertexBytes, g_IndexBytes, g_CacheSizes[0], g_CacheSizes[1]);
+}
+
+/***********************************************************
+ *  WriteJsonReport()
+ *
+ *  Writes the measurements of every mesh as JSON, for
+ *  comparing the generators between changes.
+ ***********************************************************/
+static void WriteJsonReport(std::ostream& json, const std::vector<MeshReport>& reports)
+{
+	json << "{\n";
+	json << "  \"vertex_bytes\": " << g_VertexBytes << ",\n";
+	json << "  \"index_bytes\": " << g_IndexBytes << ",\n";
+	json << "  \"overdraw_resolution\": " << g_OverdrawResolution << ",\n";
+	json << "  \"meshes\": [\n";
+	for (size_t i = 0; i < reports.size(); i++)
+	{
+		const MeshReport& report = reports[i];
+		json << "    { \"name\": \"" << report.name << "\""
+			<< ", \"vertices\": " << report.vertices
+			<< ", \"unused_vertices\": " << report.unusedVertices
+			<< ", \"duplicate_vertices\": " << report.duplicateVertices
+			<< ", \"indices\": " << report.indices
+			<< ", \"triangles\": " << report.triangles
+			<< ", \"degenerate_triangles\": " << report.degenerateTriangles;
+		for (int c = 0; c < g_CacheCount; c++)
+		{
+			json << ", \"acmr" << g_CacheSizes[c] << "\": " << report.acmr[c]
+				<< ", \"atvr" << g_CacheSizes[c] << "\": " << report.atvr[c];
+		}
+		json << ", \"overdraw\": " << report.overdraw
+			<< ", \"bytes\": " << report.bytes << " }" << ((i + 1 < reports.size()) ? "," : "") << "\n";
+	}
+	json << "  ]\n";
+	json << "}\n";
+}
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  Analyzes every primitive and the OBJ files passed and
+ *  prints the table. Returns 0 when every mesh loaded and
+ *  the JSON report could be written.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	std::string outputFile;
+	std::vector<const char*> objFiles;
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--output") == 0) && (i + 1 < argc))
+		{
+			outputFile = argv[++i];
+		}
+		else if (argv[i][0] == '-')
+		{
+			std::cout << "Unknown option " << argv[i] << std::endl;
+			PrintUsage();
+			return EXIT_BAD_ARGUMENTS;
+		}
+		else
+		{
+			objFiles.push_back(argv[i]);
+		}
+	}
+
+	GlStubs::Install();
+
+	bool bSucceeded = true;
+	std::vector<MeshReport> reports;
+	for (int i = 0; i < g_PrimitiveCount; i++)
+	{
+		reports.push_back(AnalyzeMesh(BuildPrimitive(g_Primitives[i])));
+	}
+	for (const char* objFile : objFiles)
+	{
+		MeshData mesh;
+		if (LoadObjMesh(objFile, mesh) == true)
+		{
+			reports.push_back(AnalyzeMesh(mesh));
+		}
+		else
+		{
+			bSucceeded = false;
+		}
+	}
+
+	PrintReports(reports);
+
+	if (outputFile.empty() == false)
+	{
+		std::ofstream json(outputFile.c_str());
+		WriteJsonReport(json, reports);
+		json.close();
+		if (json.fail() == true)
+		{
+			std::cout << "Failed to write " << outputFile << std::endl;
+			bSucceeded = false;
+		}
+	}
+
+	return (bSucceeded == true) ? EXIT_SUCCESS : EXIT_ANALYSIS_FAILED;
+}
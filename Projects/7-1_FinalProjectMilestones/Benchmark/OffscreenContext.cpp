@@ -0,0 +1,125 @@
+#include "OffscreenContext.h"
+
+#include <iostream>
+
+namespace
+{
+	// the context versions tried from the newest down - the scene
+	// needs 3.3 and runs the indirect paths from 4.3
+	const int g_ContextVersions[][2] = { { 4, 6 }, { 4, 5 }, { 4, 3 }, { 3, 3 } };
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  Creates a core profile context without any surface on the
+ *  surfaceless platform of Mesa, or the default display when
+ *  that is missing, and a framebuffer to render into. There
+ *  is no swap chain, so nothing waits for a vertical sync.
+ *  With bDebugContext it is a debug context.
+ ***********************************************************/
+bool OffscreenContext::Create(OffscreenTarget& target, int width, int height, bool bDebugContext)
+{
+	PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (NULL != eglGetPlatformDisplayEXT)
+	{
+		target.display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+	if (EGL_NO_DISPLAY == target.display)
+	{
+		target.display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+	if ((EGL_NO_DISPLAY == target.display) || (eglInitialize(target.display, NULL, NULL) == EGL_FALSE))
+	{
+		std::cout << "Failed to initialize an EGL display" << std::endl;
+		return false;
+	}
+	if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE)
+	{
+		std::cout << "The EGL display does not support OpenGL" << std::endl;
+		return false;
+	}
+
+	for (const int* version : g_ContextVersions)
+	{
+		const EGLint attributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, version[0],
+			EGL_CONTEXT_MINOR_VERSION, version[1],
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			// without a debug context the list ends here
+			(bDebugContext == true) ? EGL_CONTEXT_OPENGL_DEBUG : EGL_NONE, EGL_TRUE,
+			EGL_NONE };
+		target.context = eglCreateContext(target.display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+		if (EGL_NO_CONTEXT != target.context)
+		{
+			break;
+		}
+	}
+	if ((EGL_NO_CONTEXT == target.context) ||
+		(eglMakeCurrent(target.display, EGL_NO_SURFACE, EGL_NO_SURFACE, target.context) == EGL_FALSE))
+	{
+		std::cout << "Failed to create a surfaceless OpenGL 3.3 context" << std::endl;
+		return false;
+	}
+
+	// GLEW built for GLX reports the missing X display, but it has
+	// loaded the OpenGL functions from the current context by then
+	glewExperimental = GL_TRUE;
+	GLenum glewResult = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+	if (GLEW_ERROR_NO_GLX_DISPLAY == glewResult)
+	{
+		glewResult = GLEW_OK;
+	}
+#endif
+	if (GLEW_OK != glewResult)
+	{
+		std::cout << "Failed to initialize GLEW: " << glewGetErrorString(glewResult) << std::endl;
+		return false;
+	}
+	// GLEW can leave an error behind from probing the context
+	glGetError();
+
+	glGenFramebuffers(1, &target.framebuffer);
+	glGenRenderbuffers(2, target.renderbuffers);
+	glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, target.renderbuffers[0]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.renderbuffers[0]);
+	glBindRenderbuffer(GL_RENDERBUFFER, target.renderbuffers[1]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target.renderbuffers[1]);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "The offscreen framebuffer is incomplete" << std::endl;
+		return false;
+	}
+
+	std::cout << "Renderer: " << glGetString(GL_RENDERER) << ", OpenGL " << glGetString(GL_VERSION) << std::endl;
+	return true;
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  Frees the framebuffer and releases the context.
+ ***********************************************************/
+void OffscreenContext::Destroy(OffscreenTarget& target)
+{
+	if (EGL_NO_CONTEXT != target.context)
+	{
+		if (0 != target.framebuffer)
+		{
+			glDeleteFramebuffers(1, &target.framebuffer);
+			glDeleteRenderbuffers(2, target.renderbuffers);
+		}
+		eglMakeCurrent(target.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(target.display, target.context);
+	}
+	if (EGL_NO_DISPLAY != target.display)
+	{
+		eglTerminate(target.display);
+	}
+}
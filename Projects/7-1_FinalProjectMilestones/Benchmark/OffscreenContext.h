@@ -0,0 +1,30 @@
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+#include <EGL/egl.h>        // EGL context without a window
+#include <EGL/eglext.h>
+
+// the offscreen context and framebuffer
+struct OffscreenTarget
+{
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLContext context = EGL_NO_CONTEXT;
+	GLuint framebuffer = 0;
+	GLuint renderbuffers[2] = { 0, 0 };
+};
+
+/***********************************************************
+ *  OffscreenContext
+ *
+ *  The EGL context without a window the benchmark and the
+ *  GL replay render in, with an RGBA8 and depth stencil
+ *  framebuffer standing in for the window.
+ ***********************************************************/
+namespace OffscreenContext
+{
+	// create the context, load the GL functions and create the
+	// framebuffer - the target is left bound
+	bool Create(OffscreenTarget& target, int width, int height, bool bDebugContext);
+	// free whatever Create() got to
+	void Destroy(OffscreenTarget& target);
+}
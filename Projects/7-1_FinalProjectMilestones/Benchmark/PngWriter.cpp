@@ -0,0 +1,151 @@
+#include "PngWriter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+namespace
+{
+	// the largest block of a stored deflate stream
+	const size_t MAX_STORED_BLOCK = 65535;
+
+	/***********************************************************
+	 *  Crc32()
+	 *
+	 *  Continues the CRC-32 of the PNG chunks over the passed
+	 *  bytes.
+	 ***********************************************************/
+	uint32_t Crc32(uint32_t crc, const unsigned char* pData, size_t size)
+	{
+		static uint32_t table[256];
+		static bool bTableReady = false;
+		if (bTableReady == false)
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t value = i;
+				for (int bit = 0; bit < 8; bit++)
+				{
+					value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+				}
+				table[i] = value;
+			}
+			bTableReady = true;
+		}
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+		{
+			crc = table[(crc ^ pData[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+
+	/***********************************************************
+	 *  AppendBigEndian()
+	 *
+	 *  PNG stores its integers most significant byte first.
+	 ***********************************************************/
+	void AppendBigEndian(std::vector<unsigned char>& data, uint32_t value)
+	{
+		data.push_back((unsigned char)(value >> 24));
+		data.push_back((unsigned char)(value >> 16));
+		data.push_back((unsigned char)(value >> 8));
+		data.push_back((unsigned char)value);
+	}
+
+	/***********************************************************
+	 *  AppendChunk()
+	 *
+	 *  Adds a chunk with its length, type and CRC.
+	 ***********************************************************/
+	void AppendChunk(std::vector<unsigned char>& file, const char* type, const std::vector<unsigned char>& data)
+	{
+		AppendBigEndian(file, (uint32_t)data.size());
+		size_t typeStart = file.size();
+		file.insert(file.end(), type, type + 4);
+		file.insert(file.end(), data.begin(), data.end());
+		AppendBigEndian(file, Crc32(0, &file[typeStart], file.size() - typeStart));
+	}
+}
+
+/***********************************************************
+ *  WriteRGB()
+ *
+ *  Builds the IHDR, IDAT and IEND chunks in memory and
+ *  writes them in one go. Every row uses the None filter.
+ ***********************************************************/
+bool PngWriter::WriteRGB(const std::string& filename, int width, int height,
+	const std::vector<unsigned char>& pixels)
+{
+	size_t rowSize = (size_t)width * 3;
+	if ((width <= 0) || (height <= 0) || (pixels.size() < rowSize * height))
+	{
+		std::cout << "Cannot write " << filename << ": the image is empty" << std::endl;
+		return false;
+	}
+
+	// the filtered rows, top down, each starting with its filter type
+	std::vector<unsigned char> rows;
+	rows.reserve((rowSize + 1) * height);
+	for (int y = height - 1; y >= 0; y--)
+	{
+		rows.push_back(0);
+		rows.insert(rows.end(), pixels.begin() + rowSize * y, pixels.begin() + rowSize * (y + 1));
+	}
+
+	// zlib stream of stored blocks, followed by the Adler-32 of the rows
+	std::vector<unsigned char> compressed;
+	compressed.reserve(rows.size() + rows.size() / MAX_STORED_BLOCK * 5 + 16);
+	compressed.push_back(0x78);
+	compressed.push_back(0x01);
+	for (size_t offset = 0; (offset < rows.size()) || (offset == 0); offset += MAX_STORED_BLOCK)
+	{
+		size_t blockSize = std::min(MAX_STORED_BLOCK, rows.size() - offset);
+		bool bFinal = (offset + blockSize == rows.size());
+		compressed.push_back(bFinal ? 1 : 0);
+		compressed.push_back((unsigned char)(blockSize & 0xFF));
+		compressed.push_back((unsigned char)(blockSize >> 8));
+		compressed.push_back((unsigned char)(~blockSize & 0xFF));
+		compressed.push_back((unsigned char)((~blockSize >> 8) & 0xFF));
+		compressed.insert(compressed.end(), rows.begin() + offset, rows.begin() + offset + blockSize);
+	}
+	uint32_t a = 1;
+	uint32_t b = 0;
+	for (size_t i = 0; i < rows.size(); i++)
+	{
+		a = (a + rows[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	AppendBigEndian(compressed, (b << 16) | a);
+
+	std::vector<unsigned char> header;
+	AppendBigEndian(header, (uint32_t)width);
+	AppendBigEndian(header, (uint32_t)height);
+	header.push_back(8);    // bit depth
+	header.push_back(2);    // RGB color
+	header.push_back(0);    // deflate compression
+	header.push_back(0);    // adaptive filtering
+	header.push_back(0);    // no interlace
+
+	static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	std::vector<unsigned char> file(signature, signature + 8);
+	AppendChunk(file, "IHDR", header);
+	AppendChunk(file, "IDAT", compressed);
+	AppendChunk(file, "IEND", std::vector<unsigned char>());
+
+	FILE* pFile = fopen(filename.c_str(), "wb");
+	if (NULL == pFile)
+	{
+		std::cout << "Cannot open " << filename << " for writing" << std::endl;
+		return false;
+	}
+	bool bWritten = (fwrite(file.data(), 1, file.size(), pFile) == file.size());
+	bWritten = (fclose(pFile) == 0) && bWritten;
+	if (bWritten == false)
+	{
+		std::cout << "Failed to write " << filename << std::endl;
+	}
+	return bWritten;
+}
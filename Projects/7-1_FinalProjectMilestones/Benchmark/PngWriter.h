@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  PngWriter
+ *
+ *  Writes 8 bit RGB images as PNG files without any image
+ *  library. The image data is stored uncompressed inside the
+ *  deflate stream, so the files are larger than they need to
+ *  be, but every viewer and diff tool reads them.
+ ***********************************************************/
+namespace PngWriter
+{
+	// write width * height RGB pixels - the rows are expected
+	// bottom up, as glReadPixels() returns them
+	bool WriteRGB(const std::string& filename, int width, int height,
+		const std::vector<unsigned char>& pixels);
+}
@@ -0,0 +1,594 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebenchmark.cpp
+// ==================
+// headless benchmark of the 7-1 scene - renders every preset view of the
+// view manager, or a recorded camera path, into an offscreen framebuffer
+// and reports the frame times
+//
+// Runs without a window on an EGL surfaceless context, so it works on
+// Mesa llvmpipe in CI. Run it from the project folder, where the shaders
+// and textures folders are.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <GL/glew.h>        // GLEW library
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "SceneManager.h"
+#include "ShaderManager.h"
+#include "GpuResources.h"
+#include "DebugOutput.h"
+#include "GlCapture.h"
+#include "RenderStats.h"
+#include "TraceZones.h"
+#include "CameraPresets.h"
+#include "CameraPath.h"
+#include "camera.h"
+#include "PngWriter.h"
+#include "OffscreenContext.h"
+#include "TimeStatistics.h"
+
+namespace
+{
+	// exit codes - a failed run returns 1 and bad options return 2
+	const int EXIT_BENCHMARK_FAILED = 1;
+	const int EXIT_BAD_ARGUMENTS = 2;
+
+	// the textures decode on worker threads - give up waiting for
+	// them after this long
+	const double g_TextureTimeoutSeconds = 60.0;
+	// the lightmap bakes on worker threads too, and takes longer
+	const double g_BakeTimeoutSeconds = 300.0;
+
+	typedef std::chrono::steady_clock Clock;
+	typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+	// the options of a benchmark run
+	struct BenchmarkOptions
+	{
+		int frames = 120;
+		int warmupFrames = 10;
+		int width = 1000;
+		int height = 800;
+		std::string outputFolder = "benchmark";
+		RenderSettings renderSettings;
+	};
+
+	// the measurements of one preset view, or of the camera path
+	struct ViewResult
+	{
+		std::string name;
+		// one of them is set
+		const CameraPreset* pPreset;
+		const CameraPath* pPath;
+		std::vector<double> cpuTimes;
+		std::vector<double> frameTimes;
+		std::vector<double> gpuTimes;
+		// the GL calls of the last timed frame
+		RenderStats renderStats;
+		// the draws hidden by occlusion culling as of the last timed
+		// frame - read back a frame or two late, -1 without it
+		int occludedDraws = -1;
+		std::string imageFile;
+	};
+}
+
+/***********************************************************
+ *  PrintUsage()
+ *
+ *  Lists the benchmark options.
+ ***********************************************************/
+static void PrintUsage()
+{
+	std::cout << "Usage: SceneBenchmark [options] [render options]\n";
+	std::cout << "  --frames N    timed frames per view (default 120)\n";
+	std::cout << "  --warmup N    untimed frames before each view (default 10)\n";
+	std::cout << "  --width N     framebuffer width (default 1000)\n";
+	std::cout << "  --height N    framebuffer height (default 800)\n";
+	std::cout << "  --output DIR  folder for the report and the view images (default benchmark)\n";
+	std::cout << "The render options are the ones of the application, like --indirect or --shadows.\n";
+	std::cout << "With --play-camera FILE the frames of the camera path are timed instead of the views.\n";
+	std::cout << "Run it from the project folder so the shaders and textures are found." << std::endl;
+}
+
+/***********************************************************
+ *  ParseOptions()
+ *
+ *  Reads the benchmark options and passes everything else to
+ *  the render settings - false for unknown options.
+ ***********************************************************/
+static bool ParseOptions(int argc, char* argv[], BenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const char* argument = argv[i];
+		bool bHasValue = (i + 1 < argc);
+
+		if ((strcmp(argument, "--frames") == 0) && (bHasValue == true))
+		{
+			options.frames = std::max(1, atoi(argv[++i]));
+		}
+		else if ((strcmp(argument, "--warmup") == 0) && (bHasValue == true))
+		{
+			options.warmupFrames = std::max(0, atoi(argv[++i]));
+		}
+		else if ((strcmp(argument, "--width") == 0) && (bHasValue == true))
+		{
+			options.width = std::max(1, atoi(argv[++i]));
+		}
+		else if ((strcmp(argument, "--height") == 0) && (bHasValue == true))
+		{
+			options.height = std::max(1, atoi(argv[++i]));
+		}
+		else if ((strcmp(argument, "--output") == 0) && (bHasValue == true))
+		{
+			options.outputFolder = argv[++i];
+		}
+		else if (options.renderSettings.ParseArgument(argc, argv, i) == false)
+		{
+			std::cout << "Unknown option " << argument << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/***********************************************************
+ *  RenderFrame()
+ *
+ *  Renders one frame of the scene from the preset view or
+ *  the passed frame of the camera path, like the render
+ *  loop of the application does with the view manager.
+ ***********************************************************/
+static void RenderFrame(SceneManager* pSceneManager, ShaderManager* pShaderManager,
+	const ViewResult& result, int frame, const OffscreenTarget& target, int width, int height)
+{
+	glm::vec3 position;
+	glm::mat4 view;
+	glm::mat4 projection;
+	if (NULL != result.pPreset)
+	{
+		const CameraPreset& preset = *result.pPreset;
+		position = preset.position;
+		view = glm::lookAt(preset.position, preset.position + preset.front, preset.up);
+		projection = BuildSceneProjection(preset.bOrthographic, CAMERA_PRESET_ZOOM, (float)width / (float)height);
+	}
+	else
+	{
+		CameraPath::Key key = result.pPath->GetFrameKey(frame);
+		Camera camera;
+		CameraPath::ApplyKey(key, camera);
+		position = camera.Position;
+		view = camera.GetViewMatrix();
+		projection = BuildSceneProjection(key.bOrthographic, camera.Zoom, (float)width / (float)height);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+	glViewport(0, 0, width, height);
+	glEnable(GL_DEPTH_TEST);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	pShaderManager->use();
+	pShaderManager->setMat4Value("view", view);
+	pShaderManager->setMat4Value("projection", projection);
+	pShaderManager->setVec3Value("viewPosition", position);
+	pSceneManager->SetViewParameters(view, projection, position);
+
+	pSceneManager->RenderScene();
+	GlCapture::EndFrame();
+}
+
+/***********************************************************
+ *  ReadQueryTime()
+ *
+ *  The milliseconds between the timestamps of a query pair -
+ *  waits for the results.
+ ***********************************************************/
+static double ReadQueryTime(const GLuint queries[2])
+{
+	GLuint64 start = 0;
+	GLuint64 end = 0;
+	glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &start);
+	glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &end);
+	return (double)(end - start) / 1.0e6;
+}
+
+/***********************************************************
+ *  BenchmarkView()
+ *
+ *  Renders the warmup and the timed frames of one view - the
+ *  warmup frames of the camera path repeat its first frame,
+ *  and every frame of the path is timed once. The
+ *  GPU time of each frame is the difference of timestamps
+ *  around it - elapsed time queries cannot nest, and the
+ *  shadow maps time their own update with one. The
+ *  timestamps are read back one frame later from the other
+ *  of two query pairs, so reading them never waits for the
+ *  frame in flight.
+ ***********************************************************/
+static void BenchmarkView(SceneManager* pSceneManager, ShaderManager* pShaderManager,
+	const OffscreenTarget& target, const BenchmarkOptions& options, ViewResult& result)
+{
+	TRACE_ZONE_DETAIL("BenchmarkView", result.name.c_str());
+	for (int i = 0; i < options.warmupFrames; i++)
+	{
+		RenderFrame(pSceneManager, pShaderManager, result, 0, target, options.width, options.height);
+	}
+	glFinish();
+
+	bool bTimerQueries = (GLEW_VERSION_3_3 != 0) || (GLEW_ARB_timer_query != 0);
+	// the start and end timestamps of the even and odd frames
+	GLuint queries[2][2] = { { 0, 0 }, { 0, 0 } };
+	if (bTimerQueries == true)
+	{
+		glGenQueries(4, &queries[0][0]);
+	}
+
+	int frames = (NULL != result.pPath) ? result.pPath->GetFrameCount() : options.frames;
+	Clock::time_point frameStart = Clock::now();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		if (bTimerQueries == true)
+		{
+			glQueryCounter(queries[frame % 2][0], GL_TIMESTAMP);
+		}
+		RenderFrame(pSceneManager, pShaderManager, result, frame, target, options.width, options.height);
+		if (bTimerQueries == true)
+		{
+			glQueryCounter(queries[frame % 2][1], GL_TIMESTAMP);
+		}
+		Clock::time_point submitted = Clock::now();
+		result.cpuTimes.push_back(Milliseconds(submitted - frameStart).count());
+		result.renderStats = pSceneManager->GetFrameStats();
+		result.occludedDraws = pSceneManager->GetOccludedDrawCount();
+
+		if ((bTimerQueries == true) && (frame > 0))
+		{
+			result.gpuTimes.push_back(ReadQueryTime(queries[(frame - 1) % 2]));
+		}
+
+		// the last frame is only done once the GPU is
+		if (frame == frames - 1)
+		{
+			glFinish();
+		}
+		Clock::time_point frameEnd = Clock::now();
+		result.frameTimes.push_back(Milliseconds(frameEnd - frameStart).count());
+		frameStart = frameEnd;
+	}
+
+	if (bTimerQueries == true)
+	{
+		result.gpuTimes.push_back(ReadQueryTime(queries[(frames - 1) % 2]));
+		glDeleteQueries(4, &queries[0][0]);
+	}
+}
+
+/***********************************************************
+ *  SaveViewImage()
+ *
+ *  Reads the last frame of the view back and writes it as a
+ *  PNG next to the report, for the image comparisons.
+ ***********************************************************/
+static bool SaveViewImage(const OffscreenTarget& target, const BenchmarkOptions& options, ViewResult& result)
+{
+	std::vector<unsigned char> pixels((size_t)options.width * options.height * 3);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, target.framebuffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, options.width, options.height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+	result.imageFile = result.name + ".png";
+	return PngWriter::WriteRGB(options.outputFolder + "/" + result.imageFile,
+		options.width, options.height, pixels);
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  Writes the results of every view as JSON - the camera
+ *  path is NULL when the preset views were rendered.
+ ***********************************************************/
+static void WriteReport(std::ostream& json, const BenchmarkOptions& options, const CameraPath* pCameraPath,
+	const std::vector<ViewResult>& results, const DebugOutput* pDebugOutput, GLenum glError)
+{
+	const RenderSettings& settings = options.renderSettings;
+	json << "{\n";
+	json << "  \"renderer\": \"" << glGetString(GL_RENDERER) << "\",\n";
+	json << "  \"version\": \"" << glGetString(GL_VERSION) << "\",\n";
+	json << "  \"width\": " << options.width << ",\n";
+	json << "  \"height\": " << options.height << ",\n";
+	json << "  \"frames\": " << options.frames << ",\n";
+	json << "  \"warmup\": " << options.warmupFrames << ",\n";
+	if (NULL != pCameraPath)
+	{
+		json << "  \"camera_path\": { \"file\": \"" << settings.cameraPlaybackFile
+			<< "\", \"keys\": " << pCameraPath->GetKeyCount()
+			<< ", \"seconds\": " << pCameraPath->GetDuration()
+			<< ", \"frames\": " << pCameraPath->GetFrameCount()
+			<< ", \"frame_rate\": " << CameraPath::FRAME_RATE << " },\n";
+	}
+	json << "  \"settings\": { "
+		<< "\"indirect\": " << (settings.bIndirectDraw ? "true" : "false")
+		<< ", \"cull\": " << (settings.bFrustumCulling ? "true" : "false")
+		<< ", \"occlusion\": " << (settings.bOcclusionCulling ? "true" : "false")
+		<< ", \"prepass\": " << (settings.bDepthPrepass ? "true" : "false")
+		<< ", \"lightlists\": " << (settings.bLightLists ? "true" : "false")
+		<< ", \"clustered\": " << (settings.bClusteredLighting ? "true" : "false")
+		<< ", \"deferred\": " << (settings.bDeferredShading ? "true" : "false")
+		<< ", \"shadows\": " << (settings.bShadows ? "true" : "false")
+		<< ", \"baked\": " << (settings.bBakedLighting ? "true" : "false")
+		<< ", \"oit\": " << (settings.bOrderIndependentTransparency ? "true" : "false")
+		<< ", \"impostors\": " << (settings.bSphereImpostors ? "true" : "false")
+		<< ", \"gpu_timers\": " << (settings.bGpuTimers ? "true" : "false")
+		<< ", \"stats_overlay\": " << (settings.bStatsOverlay ? "true" : "false")
+		<< ", \"copies\": " << settings.sceneCopies
+		<< ", \"lights\": " << settings.extraLightCount
+		<< ", \"spheres\": " << settings.extraSphereCount << " },\n";
+	json << "  \"views\": [\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const ViewResult& result = results[i];
+		json << "    {\n";
+		json << "      \"name\": \"" << result.name << "\",\n";
+		if (NULL != result.pPreset)
+		{
+			json << "      \"key\": " << (result.pPreset - g_CameraPresets) + 1 << ",\n";
+		}
+		json << "      \"image\": \"" << result.imageFile << "\",\n";
+		const RenderStats& stats = result.renderStats;
+		json << "      \"draw_calls\": " << stats.drawCalls << ",\n";
+		json << "      \"occluded_draws\": ";
+		if (result.occludedDraws >= 0)
+		{
+			json << result.occludedDraws << ",\n";
+		}
+		else
+		{
+			json << "null,\n";
+		}
+		json << "      \"render_stats\": { \"triangles\": " << stats.triangles
+			<< ", \"vertex_array_binds\": " << stats.vertexArrayBinds
+			<< ", \"program_binds\": " << stats.programBinds
+			<< ", \"texture_binds\": " << stats.textureBinds
+			<< ", \"uniform_calls\": " << stats.uniformCalls
+			<< ", \"buffer_uploads\": " << stats.bufferUploads << " },\n";
+		json << "      \"cpu_ms\": ";
+		TimeStatistics::Write(json, result.cpuTimes);
+		json << ",\n      \"frame_ms\": ";
+		TimeStatistics::Write(json, result.frameTimes);
+		json << ",\n      \"gpu_ms\": ";
+		TimeStatistics::Write(json, result.gpuTimes);
+		json << "\n    }" << ((i + 1 < results.size()) ? "," : "") << "\n";
+	}
+	json << "  ],\n";
+	// the video memory of the scene after the last view
+	json << "  \"gpu_memory\": {";
+	for (int i = 0; i < GpuResources::CATEGORY_COUNT; i++)
+	{
+		GpuResources::Category category = (GpuResources::Category)i;
+		const GpuResources::Usage& usage = GpuResources::GetUsage(category);
+		json << ((i > 0) ? "," : "") << " \"" << GpuResources::GetCategoryName(category) << "\": { \"objects\": "
+			<< usage.liveObjects << ", \"bytes\": " << usage.liveBytes << ", \"peak_bytes\": " << usage.peakBytes << " }";
+	}
+	json << " },\n";
+	if (NULL != pDebugOutput)
+	{
+		json << "  \"debug_messages\": ";
+		pDebugOutput->WriteJsonReport(json);
+		json << ",\n";
+	}
+	json << "  \"gl_error\": " << glError << "\n";
+	json << "}\n";
+}
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  Prepares the scene once, waits for its textures and then
+ *  benchmarks each preset view in the order of the number
+ *  keys, or the camera path of --play-camera. Returns 0
+ *  when every view rendered without a GL error and the
+ *  report and images were written.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options;
+	if (ParseOptions(argc, argv, options) == false)
+	{
+		PrintUsage();
+		return EXIT_BAD_ARGUMENTS;
+	}
+	// the recorded path replaces the preset views
+	CameraPath cameraPath;
+	const CameraPath* pCameraPath = NULL;
+	if (options.renderSettings.cameraPlaybackFile.empty() == false)
+	{
+		if (cameraPath.Load(options.renderSettings.cameraPlaybackFile.c_str()) == false)
+		{
+			return EXIT_BENCHMARK_FAILED;
+		}
+		pCameraPath = &cameraPath;
+	}
+	mkdir(options.outputFolder.c_str(), 0755);
+	TraceZones::SetThreadName("Main");
+	TraceZones::SetEnabled(options.renderSettings.bTrace);
+
+	OffscreenTarget target;
+	if (OffscreenContext::Create(target, options.width, options.height, options.renderSettings.bDebugOutput) == false)
+	{
+		OffscreenContext::Destroy(target);
+		return EXIT_BENCHMARK_FAILED;
+	}
+
+	// the driver messages are written to the report with --gl-debug
+	DebugOutput* pDebugOutput = NULL;
+	if (options.renderSettings.bDebugOutput == true)
+	{
+		pDebugOutput = new DebugOutput();
+		if (pDebugOutput->Install() == false)
+		{
+			delete pDebugOutput;
+			pDebugOutput = NULL;
+		}
+	}
+
+	// the GL calls for GlReplay with --capture - the frames of the
+	// window count the warmup frames of every view
+	const std::string& captureFile = options.renderSettings.captureFile;
+	if ((captureFile.empty() == false) &&
+		(GlCapture::Start(captureFile.c_str(), options.width, options.height, target.framebuffer,
+			options.renderSettings.captureFirstFrame, options.renderSettings.captureFrameCount) == false))
+	{
+		std::cout << "Failed to open " << captureFile << std::endl;
+		delete pDebugOutput;
+		OffscreenContext::Destroy(target);
+		return EXIT_BENCHMARK_FAILED;
+	}
+
+	ShaderManager* pShaderManager = new ShaderManager();
+	GpuProgram sceneProgram;
+	sceneProgram.Adopt(pShaderManager->LoadShaders("shaders/vertexShader.glsl", "shaders/fragmentShader.glsl"));
+	if (0 == sceneProgram)
+	{
+		std::cout << "Failed to load the scene shaders - run the benchmark from the project folder" << std::endl;
+		delete pShaderManager;
+		delete pDebugOutput;
+		OffscreenContext::Destroy(target);
+		return EXIT_BENCHMARK_FAILED;
+	}
+	pShaderManager->use();
+
+	SceneManager* pSceneManager = new SceneManager(pShaderManager);
+	*pSceneManager->GetRenderSettings() = options.renderSettings;
+	pSceneManager->PrepareScene();
+
+	// the images would show the placeholder textures otherwise
+	Clock::time_point waitStart = Clock::now();
+	while (pSceneManager->AreTexturesResident() == false)
+	{
+		TRACE_ZONE("WaitForTextures");
+		if (std::chrono::duration<double>(Clock::now() - waitStart).count() > g_TextureTimeoutSeconds)
+		{
+			std::cout << "Timed out waiting for the scene textures" << std::endl;
+			break;
+		}
+		pSceneManager->UpdateTextureUploads();
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	bool bSucceeded = pSceneManager->AreTexturesResident();
+
+	// the images would show the lit path while the lightmap bakes - the
+	// frames that start and collect the bake are outside the capture
+	// window count, and the bake only starts with the textures resident
+	if ((options.renderSettings.bBakedLighting == true) && (bSucceeded == true))
+	{
+		waitStart = Clock::now();
+		glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+		glViewport(0, 0, options.width, options.height);
+		pSceneManager->RenderScene();
+		while (pSceneManager->IsLightingBaked() == false)
+		{
+			TRACE_ZONE("WaitForBake");
+			if (std::chrono::duration<double>(Clock::now() - waitStart).count() > g_BakeTimeoutSeconds)
+			{
+				std::cout << "Timed out waiting for the lightmap bake" << std::endl;
+				bSucceeded = false;
+				break;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			pSceneManager->RenderScene();
+		}
+	}
+	GLenum glError = glGetError();
+	std::vector<ViewResult> results;
+	int viewCount = (NULL != pCameraPath) ? 1 : CAMERA_PRESET_COUNT;
+	for (int i = 0; (i < viewCount) && (GL_NO_ERROR == glError); i++)
+	{
+		ViewResult result;
+		result.pPreset = (NULL != pCameraPath) ? NULL : &g_CameraPresets[i];
+		result.pPath = pCameraPath;
+		result.name = (NULL != pCameraPath) ? "camera_path" : result.pPreset->name;
+		BenchmarkView(pSceneManager, pShaderManager, target, options, result);
+		bSucceeded = SaveViewImage(target, options, result) && bSucceeded;
+		results.push_back(result);
+
+		glError = glGetError();
+		if (GL_NO_ERROR != glError)
+		{
+			std::cout << "GL error 0x" << std::hex << glError << std::dec
+				<< " in view " << result.name << std::endl;
+		}
+	}
+	bSucceeded = (GL_NO_ERROR == glError) && bSucceeded;
+
+	// a window past the last frame keeps the frames rendered
+	if (captureFile.empty() == false)
+	{
+		if (GlCapture::IsRecording() == true)
+		{
+			std::cout << "The capture window ends after the last frame, " << GlCapture::GetFrame()
+				<< " frames were captured" << std::endl;
+		}
+		if (GlCapture::Stop() == false)
+		{
+			std::cout << "Failed to write " << captureFile << std::endl;
+			bSucceeded = false;
+		}
+	}
+
+	std::ostringstream json;
+	WriteReport(json, options, pCameraPath, results, pDebugOutput, glError);
+	std::cout << json.str();
+	std::string reportFile = options.outputFolder + "/benchmark.json";
+	std::ofstream report(reportFile.c_str());
+	report << json.str();
+	report.close();
+	if (report.fail() == true)
+	{
+		std::cout << "Failed to write " << reportFile << std::endl;
+		bSucceeded = false;
+	}
+	if (options.renderSettings.bTrace == true)
+	{
+		std::string traceFile = options.outputFolder + "/trace.json";
+		if (TraceZones::WriteChromeTrace(traceFile) == false)
+		{
+			std::cout << "Failed to write " << traceFile << std::endl;
+			bSucceeded = false;
+		}
+	}
+
+	delete pSceneManager;
+	delete pShaderManager;
+	sceneProgram.Reset();
+	if (GpuResources::GetLiveObjects() > 0)
+	{
+		std::cout << GpuResources::GetLiveObjects() << " OpenGL objects were not freed" << std::endl;
+		GpuResources::WriteReport(std::cout);
+		bSucceeded = false;
+	}
+	if (NULL != pDebugOutput)
+	{
+		pDebugOutput->PrintReport(std::cout);
+		delete pDebugOutput;
+	}
+	OffscreenContext::Destroy(target);
+
+	return (bSucceeded == true) ? EXIT_SUCCESS : EXIT_BENCHMARK_FAILED;
+}
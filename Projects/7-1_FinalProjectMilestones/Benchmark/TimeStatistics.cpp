@@ -0,0 +1,38 @@
+#include "TimeStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+/***********************************************************
+ *  Write()
+ *
+ *  Writes the minimum, average, percentiles and maximum of
+ *  the times as a JSON object, or null without times.
+ ***********************************************************/
+void TimeStatistics::Write(std::ostream& json, std::vector<double> times)
+{
+	if (times.empty() == true)
+	{
+		json << "null";
+		return;
+	}
+
+	std::sort(times.begin(), times.end());
+	double total = 0.0;
+	for (double time : times)
+	{
+		total += time;
+	}
+	// nearest rank percentiles
+	auto Percentile = [&times](double percent) {
+		size_t rank = (size_t)std::ceil(percent / 100.0 * times.size());
+		return times[std::min(times.size(), std::max((size_t)1, rank)) - 1];
+		};
+
+	json << "{ \"min\": " << times.front()
+		<< ", \"avg\": " << total / times.size()
+		<< ", \"p50\": " << Percentile(50.0)
+		<< ", \"p90\": " << Percentile(90.0)
+		<< ", \"p99\": " << Percentile(99.0)
+		<< ", \"max\": " << times.back() << " }";
+}
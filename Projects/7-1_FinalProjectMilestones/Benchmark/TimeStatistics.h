@@ -0,0 +1,18 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+/***********************************************************
+ *  TimeStatistics
+ *
+ *  The summary of the frame times the scene benchmark and the
+ *  replay write to their JSON reports, so both report the
+ *  same statistics the same way.
+ ***********************************************************/
+namespace TimeStatistics
+{
+	// write the minimum, average, nearest rank percentiles and
+	// maximum of the times as a JSON object, or null without times
+	void Write(std::ostream& json, std::vector<double> times);
+}
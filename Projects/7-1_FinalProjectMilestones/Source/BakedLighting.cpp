@@ -0,0 +1,405 @@
+#include "BakedLighting.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+namespace
+{
+	const char* g_BakedVertexShader = "shaders/bakedVertexShader.glsl";
+	const char* g_BakedFragmentShader = "shaders/bakedFragmentShader.glsl";
+
+	// true when a draw covers the same triangles at the same place
+	// with the same look, so its baked copy can stand in for it
+	bool IsSameDraw(const ShapeMeshes::DrawRecord& a, const ShapeMeshes::DrawRecord& b)
+	{
+		return (a.firstIndex == b.firstIndex) && (a.indexCount == b.indexCount) &&
+			(a.baseVertex == b.baseVertex) && (a.parameters.model == b.parameters.model) &&
+			(a.parameters.color == b.parameters.color) && (a.parameters.surface == b.parameters.surface);
+	}
+
+	bool IsSameDrawList(const std::vector<ShapeMeshes::DrawRecord>& a, const std::vector<ShapeMeshes::DrawRecord>& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if (IsSameDraw(a[i], b[i]) == false)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+/***********************************************************
+ *  BakedLighting()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BakedLighting::BakedLighting()
+{
+	m_pShaderManager = NULL;
+	m_pBaker = new LightmapBaker();
+	m_directionalLight.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_directionalLight.ambient = glm::vec3(0.0f);
+	m_directionalLight.diffuse = glm::vec3(0.0f);
+	m_lightVersion = 0;
+	m_bBaking = false;
+	m_bakingLightVersion = -1;
+	m_bakedLightVersion = -1;
+	m_bakedVertexCount = 0;
+}
+
+/***********************************************************
+ *  ~BakedLighting()
+ *
+ *  The destructor waits for a running bake - the program,
+ *  the lightmap and the baked triangles are freed by their
+ *  handles.
+ ***********************************************************/
+BakedLighting::~BakedLighting()
+{
+	delete m_pBaker;
+	m_pBaker = NULL;
+
+	if (NULL != m_pShaderManager)
+	{
+		delete m_pShaderManager;
+		m_pShaderManager = NULL;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Loads the baked program and points its lightmap sampler
+ *  at the lightmap texture unit.
+ ***********************************************************/
+bool BakedLighting::Initialize()
+{
+	m_pShaderManager = new ShaderManager();
+	m_program.Adopt(m_pShaderManager->LoadShaders(g_BakedVertexShader, g_BakedFragmentShader));
+	if (0 == m_program)
+	{
+		return false;
+	}
+	m_program.SetLabel("Baked lighting");
+	m_pShaderManager->use();
+	m_pShaderManager->setSampler2DValue("lightmap", LIGHTMAP_TEXTURE_UNIT);
+
+	return true;
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  Stores the lights for the next bake. The uploaded bake
+ *  keeps being drawn until it is replaced.
+ ***********************************************************/
+void BakedLighting::SetLights(const LightmapBaker::DirectionalLight& directionalLight,
+	const std::vector<LightSource>& lights)
+{
+	m_directionalLight = directionalLight;
+	m_lights = lights;
+	m_lightVersion++;
+}
+
+/***********************************************************
+ *  IsBakedRecord()
+ *
+ *  Blended draws show what is behind them and dynamic draws
+ *  move, so neither can use a bake.
+ ***********************************************************/
+bool BakedLighting::IsBakedRecord(const ShapeMeshes::DrawRecord& record)
+{
+	return (record.parameters.color.a >= 1.0f) &&
+		(((int)record.parameters.surface.w & ShaderManager::DRAW_FLAG_DYNAMIC) == 0);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  Collects a finished bake, starts a new one when the
+ *  static draws or the lights changed, and takes the baked
+ *  draws out of the frame while the bake is current. Only
+ *  the first copy of the scene is baked.
+ ***********************************************************/
+bool BakedLighting::Update(const ShapeMeshes* pMeshes, std::vector<ShapeMeshes::DrawRecord>& records,
+	size_t sceneDrawCount, const MaterialLibrary* pMaterials, bool bCanStart)
+{
+	if (NULL == m_pShaderManager)
+	{
+		return false;
+	}
+
+	m_frameDraws.clear();
+	for (size_t i = 0; (i < sceneDrawCount) && (i < records.size()); i++)
+	{
+		if (IsBakedRecord(records[i]) == true)
+		{
+			m_frameDraws.push_back(records[i]);
+		}
+	}
+
+	if ((m_bBaking == true) && (m_pBaker->IsFinished() == true))
+	{
+		UploadBake();
+	}
+
+	bool bCurrent = (m_bakedLightVersion == m_lightVersion) && IsSameDrawList(m_frameDraws, m_bakedDraws);
+	if ((bCurrent == false) && (m_bBaking == false) && (bCanStart == true) && !m_frameDraws.empty())
+	{
+		StartBake(pMeshes, pMaterials);
+	}
+	if ((bCurrent == false) || m_bakedDraws.empty())
+	{
+		return false;
+	}
+
+	// the baked draws are drawn by Draw() instead
+	std::vector<ShapeMeshes::DrawRecord>::iterator sceneEnd =
+		records.begin() + std::min(sceneDrawCount, records.size());
+	std::vector<ShapeMeshes::DrawRecord>::iterator bakedEnd =
+		std::stable_partition(records.begin(), sceneEnd,
+			[](const ShapeMeshes::DrawRecord& record) { return (IsBakedRecord(record) == false); });
+	records.erase(bakedEnd, sceneEnd);
+
+	return true;
+}
+
+/***********************************************************
+ *  StartBake()
+ *
+ *  Copies the triangles of the frame's static draws out of
+ *  the shared buffers into world space, with the normals
+ *  turned by the inverse transpose of the model matrix, and
+ *  starts the baker on them. The colors the surfaces bounce
+ *  are their texture averages or their object colors.
+ ***********************************************************/
+void BakedLighting::StartBake(const ShapeMeshes* pMeshes, const MaterialLibrary* pMaterials)
+{
+	const std::vector<GLfloat>& vertices = pMeshes->GetSharedVertices();
+	const std::vector<GLuint>& indices = pMeshes->GetSharedIndices();
+	const int stride = ShapeMeshes::SHARED_VERTEX_FLOATS;
+
+	std::vector<LightmapBaker::Surface> surfaces(m_frameDraws.size());
+	m_bakingVertices.clear();
+	for (size_t i = 0; i < m_frameDraws.size(); i++)
+	{
+		const ShapeMeshes::DrawRecord& record = m_frameDraws[i];
+		const glm::mat4& model = record.parameters.model;
+		glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+
+		LightmapBaker::Surface& surface = surfaces[i];
+		for (GLuint j = record.firstIndex; j < record.firstIndex + record.indexCount; j++)
+		{
+			const GLfloat* vertex = &vertices[(record.baseVertex + indices[j]) * stride];
+			glm::vec3 normal = normalMatrix * glm::vec3(vertex[3], vertex[4], vertex[5]);
+
+			BakedVertex bakedVertex;
+			bakedVertex.position = glm::vec3(model * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f));
+			bakedVertex.uv = glm::vec2(vertex[6], vertex[7]);
+			bakedVertex.lightmapUV = glm::vec2(0.0f);
+			m_bakingVertices.push_back(bakedVertex);
+
+			surface.positions.push_back(bakedVertex.position);
+			surface.normals.push_back((glm::length(normal) > 0.0f) ? glm::normalize(normal) : normal);
+		}
+
+		int flags = (int)record.parameters.surface.w;
+		glm::vec3 baseColor = glm::vec3(record.parameters.color);
+		if ((flags & ShaderManager::DRAW_FLAG_USE_TEXTURE) != 0)
+		{
+			baseColor = GetTextureAverage(flags >> ShaderManager::DRAW_FLAG_TEXTURE_SHIFT);
+		}
+		int materialIndex = (int)record.parameters.surface.z;
+		surface.diffuseColor = glm::vec3(1.0f);
+		if ((materialIndex >= 0) && (materialIndex < pMaterials->GetMaterialCount()))
+		{
+			surface.diffuseColor = pMaterials->GetMaterial(materialIndex).diffuseColor;
+		}
+		surface.albedo = baseColor * surface.diffuseColor;
+	}
+
+	if (m_pBaker->Start(surfaces, m_directionalLight, m_lights) == true)
+	{
+		m_bBaking = true;
+		m_bakingDraws = m_frameDraws;
+		m_bakingLightVersion = m_lightVersion;
+		std::cout << "INFO: Baking the lighting of " << m_bakingDraws.size() << " static draws on "
+			<< m_pBaker->GetThreadCount() << " threads" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  UploadBake()
+ *
+ *  Uploads the lightmap of the finished bake as a half
+ *  float texture and the baked triangles with their
+ *  lightmap coordinates into the vertex buffer.
+ ***********************************************************/
+void BakedLighting::UploadBake()
+{
+	m_bBaking = false;
+
+	const std::vector<glm::vec3>& lightmap = m_pBaker->GetLightmap();
+	const std::vector<glm::vec2>& lightmapUVs = m_pBaker->GetLightmapUVs();
+	if ((lightmapUVs.size() != m_bakingVertices.size()) ||
+		(lightmap.size() != (size_t)(LightmapBaker::LIGHTMAP_SIZE * LightmapBaker::LIGHTMAP_SIZE)))
+	{
+		std::cout << "Lightmap bake failed, the static draws stay lit per fragment" << std::endl;
+		return;
+	}
+	for (size_t i = 0; i < m_bakingVertices.size(); i++)
+	{
+		m_bakingVertices[i].lightmapUV = lightmapUVs[i];
+	}
+
+	if (0 == m_lightmap)
+	{
+		m_lightmap.Create();
+		glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+		glBindTexture(GL_TEXTURE_2D, m_lightmap);
+		m_lightmap.SetLabel("Lightmap");
+	}
+	glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_lightmap);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, LightmapBaker::LIGHTMAP_SIZE, LightmapBaker::LIGHTMAP_SIZE, 0,
+		GL_RGB, GL_FLOAT, lightmap.data());
+	m_lightmap.SetBytes(GpuResources::TextureBytes(GL_RGB16F, LightmapBaker::LIGHTMAP_SIZE, LightmapBaker::LIGHTMAP_SIZE));
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glActiveTexture(GL_TEXTURE0);
+
+	if (0 == m_vertexArray)
+	{
+		m_vertexArray.Create();
+		m_vertexBuffer.Create();
+		glBindVertexArray(m_vertexArray);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+		m_vertexArray.SetLabel("Baked draws");
+		m_vertexBuffer.SetLabel("Baked draw vertices");
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, position));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, uv));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, lightmapUV));
+		glEnableVertexAttribArray(3);
+		glBindVertexArray(0);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(BakedVertex) * m_bakingVertices.size(), m_bakingVertices.data(), GL_STATIC_DRAW);
+	m_vertexBuffer.SetBytes(sizeof(BakedVertex) * m_bakingVertices.size());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_bakedDraws = m_bakingDraws;
+	m_bakedLightVersion = m_bakingLightVersion;
+	m_bakedFirstVertices.resize(m_bakedDraws.size());
+	m_bakedVertexCounts.resize(m_bakedDraws.size());
+	GLint firstVertex = 0;
+	for (size_t i = 0; i < m_bakedDraws.size(); i++)
+	{
+		m_bakedFirstVertices[i] = firstVertex;
+		m_bakedVertexCounts[i] = (GLsizei)m_bakedDraws[i].indexCount;
+		firstVertex += (GLint)m_bakedDraws[i].indexCount;
+	}
+	m_bakedVertexCount = firstVertex;
+	std::vector<BakedVertex>().swap(m_bakingVertices);
+
+	std::cout << "INFO: Baked the lighting of " << m_pBaker->GetTriangleCount() << " triangles in "
+		<< m_pBaker->GetBakeSeconds() << " s on " << m_pBaker->GetThreadCount() << " threads, "
+		<< m_pBaker->GetRayCount() << " rays" << std::endl;
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  Draws every baked draw from the world space copy of its
+ *  triangles, with its recorded parameters for the color
+ *  and the texture.
+ ***********************************************************/
+void BakedLighting::Draw(const glm::mat4& view, const glm::mat4& projection)
+{
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("view", view);
+	m_pShaderManager->setMat4Value("projection", projection);
+
+	glActiveTexture(GL_TEXTURE0 + LIGHTMAP_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_lightmap);
+	glActiveTexture(GL_TEXTURE0);
+
+	RenderStats& stats = RenderStats::Frame();
+	stats.textureBinds++;
+	glBindVertexArray(m_vertexArray);
+	stats.vertexArrayBinds++;
+	for (size_t i = 0; i < m_bakedDraws.size(); i++)
+	{
+		m_pShaderManager->setDrawParameters(m_bakedDraws[i].parameters);
+		m_pShaderManager->flushDrawParameters();
+		glDrawArrays(GL_TRIANGLES, m_bakedFirstVertices[i], m_bakedVertexCounts[i]);
+		stats.drawCalls++;
+		stats.triangles += m_bakedVertexCounts[i] / 3;
+	}
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  GetTextureAverage()
+ *
+ *  Reads the smallest mip level of the texture bound to a
+ *  slot back from the GPU and averages it. Every texture is
+ *  only read once.
+ ***********************************************************/
+glm::vec3 BakedLighting::GetTextureAverage(int slot)
+{
+	glActiveTexture(GL_TEXTURE0 + slot);
+	GLint texture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+
+	std::map<GLuint, glm::vec3>::iterator cached = m_textureAverages.find((GLuint)texture);
+	if (cached != m_textureAverages.end())
+	{
+		glActiveTexture(GL_TEXTURE0);
+		return cached->second;
+	}
+
+	GLint width = 0;
+	GLint height = 0;
+	GLint maxLevel = 0;
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+	glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+	int level = 0;
+	while ((level < maxLevel) && (((width >> (level + 1)) > 0) || ((height >> (level + 1)) > 0)))
+	{
+		level++;
+	}
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+
+	glm::vec3 average(1.0f);
+	if ((width > 0) && (height > 0))
+	{
+		std::vector<glm::vec4> pixels(width * height);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glGetTexImage(GL_TEXTURE_2D, level, GL_RGBA, GL_FLOAT, pixels.data());
+
+		glm::vec3 sum(0.0f);
+		for (size_t i = 0; i < pixels.size(); i++)
+		{
+			sum += glm::vec3(pixels[i]);
+		}
+		average = sum / (float)pixels.size();
+	}
+	glActiveTexture(GL_TEXTURE0);
+
+	m_textureAverages[(GLuint)texture] = average;
+	return average;
+}
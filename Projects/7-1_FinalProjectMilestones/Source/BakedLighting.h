@@ -0,0 +1,108 @@
+#pragma once
+
+#include "LightmapBaker.h"
+#include "MaterialLibrary.h"
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+#include "GpuResources.h"
+
+#include <map>
+#include <vector>
+
+/***********************************************************
+ *  BakedLighting
+ *
+ *  Draws the static opaque draws with lighting baked into a
+ *  lightmap instead of the per-fragment Phong loop. The
+ *  first frame that asks for it hands their triangles to a
+ *  LightmapBaker, and the frames keep the lit path until the
+ *  bake is done. Then the lightmap and a copy of the baked
+ *  triangles in world space are uploaded, and as long as
+ *  the static draws and the lights stay the same, they are
+ *  taken out of the frame and drawn with a shader that only
+ *  multiplies the base color by the lightmap.
+ ***********************************************************/
+class BakedLighting
+{
+public:
+	// texture unit of the lightmap in the baked program - above the
+	// shadow maps
+	static const GLuint LIGHTMAP_TEXTURE_UNIT = 22;
+
+	// constructor
+	BakedLighting();
+	// destructor - waits for a running bake and frees the program,
+	// the lightmap and the baked triangles
+	~BakedLighting();
+
+	// load the baked program
+	bool Initialize();
+
+	// set the lights to bake - a finished bake with other lights is
+	// baked again
+	void SetLights(const LightmapBaker::DirectionalLight& directionalLight, const std::vector<LightSource>& lights);
+
+	// collect a finished bake and start a new one when the static draws
+	// among the first sceneDrawCount records no longer match the baked
+	// ones - only when bCanStart is set, as the surface colors are read
+	// from the bound textures. Returns true when the bake is current,
+	// after taking the baked draws out of the records.
+	bool Update(const ShapeMeshes* pMeshes, std::vector<ShapeMeshes::DrawRecord>& records,
+		size_t sceneDrawCount, const MaterialLibrary* pMaterials, bool bCanStart);
+
+	// draw the baked draws - leaves the baked program in use
+	void Draw(const glm::mat4& view, const glm::mat4& projection);
+
+	// state of the bake, for the statistics report
+	bool IsBaking() const { return m_bBaking; }
+	int GetBakedDrawCount() const { return (int)m_bakedDraws.size(); }
+	int GetBakedTriangleCount() const { return m_bakedVertexCount / 3; }
+
+private:
+	// vertex of the baked triangles - world space position, texture
+	// and lightmap coordinates
+	struct BakedVertex
+	{
+		glm::vec3 position;
+		glm::vec2 uv;
+		glm::vec2 lightmapUV;
+	};
+
+	// true for the draws that are baked - opaque and not dynamic
+	static bool IsBakedRecord(const ShapeMeshes::DrawRecord& record);
+	// copy the triangles of the draws to world space and start baking
+	void StartBake(const ShapeMeshes* pMeshes, const MaterialLibrary* pMaterials);
+	// upload the lightmap and the triangles of the finished bake
+	void UploadBake();
+	// the average color of the texture bound to a slot, from its
+	// smallest mip level
+	glm::vec3 GetTextureAverage(int slot);
+
+	ShaderManager* m_pShaderManager;
+	GpuProgram m_program;
+	LightmapBaker* m_pBaker;
+	LightmapBaker::DirectionalLight m_directionalLight;
+	std::vector<LightSource> m_lights;
+	// bumped on every light change, to tell a bake with old lights
+	int m_lightVersion;
+
+	// the bakeable draws of the frame, the draws of the running bake
+	// and its triangles, and the draws of the uploaded bake
+	std::vector<ShapeMeshes::DrawRecord> m_frameDraws;
+	bool m_bBaking;
+	int m_bakingLightVersion;
+	std::vector<ShapeMeshes::DrawRecord> m_bakingDraws;
+	std::vector<BakedVertex> m_bakingVertices;
+	std::vector<ShapeMeshes::DrawRecord> m_bakedDraws;
+	int m_bakedLightVersion;
+	// first vertex of every baked draw in the vertex buffer
+	std::vector<GLint> m_bakedFirstVertices;
+	std::vector<GLsizei> m_bakedVertexCounts;
+	int m_bakedVertexCount;
+
+	GpuTexture m_lightmap;
+	GpuVertexArray m_vertexArray;
+	GpuBuffer m_vertexBuffer;
+	// average texture colors by texture name
+	std::map<GLuint, glm::vec3> m_textureAverages;
+};
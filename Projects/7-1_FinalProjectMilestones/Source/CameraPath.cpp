@@ -0,0 +1,199 @@
+#include "CameraPath.h"
+
+#include <GL/glew.h>
+#include "camera.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace
+{
+	// the first line of a path file, the readers skip lines starting with #
+	const char* const g_FileHeader = "# camera path: time x y z yaw pitch zoom orthographic";
+}
+
+/***********************************************************
+ *  AddKey()
+ *
+ *  Appends the camera of the next frame - a key that is
+ *  not later than the last one is dropped.
+ ***********************************************************/
+void CameraPath::AddKey(const Key& key)
+{
+	if ((m_keys.empty() == true) || (key.time > m_keys.back().time))
+	{
+		m_keys.push_back(key);
+	}
+}
+
+/***********************************************************
+ *  CaptureKey()
+ *
+ *  The key of where the camera is and how it projects.
+ ***********************************************************/
+CameraPath::Key CameraPath::CaptureKey(const Camera& camera, bool bOrthographic, float time)
+{
+	Key key;
+	key.time = time;
+	key.position = camera.Position;
+	key.yaw = camera.Yaw;
+	key.pitch = camera.Pitch;
+	key.zoom = camera.Zoom;
+	key.bOrthographic = bOrthographic;
+	return key;
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  Reads the keys of a path file, replacing the ones held.
+ *  The times have to increase from line to line.
+ ***********************************************************/
+bool CameraPath::Load(const char* filename)
+{
+	std::ifstream file(filename);
+	if (file.is_open() == false)
+	{
+		std::cout << "Failed to open camera path " << filename << std::endl;
+		return false;
+	}
+
+	m_keys.clear();
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		if ((line.empty() == true) || (line[0] == '#'))
+		{
+			continue;
+		}
+
+		Key key;
+		int orthographic = 0;
+		if (sscanf(line.c_str(), "%f %f %f %f %f %f %f %d", &key.time, &key.position.x, &key.position.y,
+			&key.position.z, &key.yaw, &key.pitch, &key.zoom, &orthographic) != 8)
+		{
+			std::cout << filename << "(" << lineNumber << "): expected 8 values" << std::endl;
+			m_keys.clear();
+			return false;
+		}
+		if ((m_keys.empty() == false) && (key.time <= m_keys.back().time))
+		{
+			std::cout << filename << "(" << lineNumber << "): the time does not increase" << std::endl;
+			m_keys.clear();
+			return false;
+		}
+		key.bOrthographic = (orthographic != 0);
+		m_keys.push_back(key);
+	}
+
+	if (m_keys.empty() == true)
+	{
+		std::cout << "The camera path " << filename << " has no keys" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/***********************************************************
+ *  Save()
+ *
+ *  Writes the keys, with enough digits that loading them
+ *  gives back the same floats.
+ ***********************************************************/
+bool CameraPath::Save(const char* filename) const
+{
+	if (m_keys.empty() == true)
+	{
+		std::cout << "No camera keys to write to " << filename << std::endl;
+		return false;
+	}
+
+	std::ofstream file(filename);
+	file << g_FileHeader << "\n";
+	char line[256];
+	for (const Key& key : m_keys)
+	{
+		snprintf(line, sizeof(line), "%.9g %.9g %.9g %.9g %.9g %.9g %.9g %d\n", key.time, key.position.x,
+			key.position.y, key.position.z, key.yaw, key.pitch, key.zoom, (key.bOrthographic == true) ? 1 : 0);
+		file << line;
+	}
+	file.close();
+	if (file.fail() == true)
+	{
+		std::cout << "Failed to write camera path " << filename << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/***********************************************************
+ *  GetFrameCount()
+ *
+ *  The frames of FRAME_RATE it takes to reach the last key.
+ ***********************************************************/
+int CameraPath::GetFrameCount() const
+{
+	if (m_keys.empty() == true)
+	{
+		return 0;
+	}
+	float duration = m_keys.back().time - m_keys.front().time;
+	return (int)std::ceil(duration * FRAME_RATE) + 1;
+}
+
+/***********************************************************
+ *  GetFrameKey()
+ *
+ *  The camera of a frame of the playback, interpolated
+ *  linearly between the keys around its time. The
+ *  projection switches with the earlier key, and frames
+ *  past either end hold the camera of the end key.
+ ***********************************************************/
+CameraPath::Key CameraPath::GetFrameKey(int frame) const
+{
+	float time = m_keys.front().time + (float)frame / FRAME_RATE;
+	std::vector<Key>::const_iterator next = std::upper_bound(m_keys.begin(), m_keys.end(), time,
+		[](float value, const Key& key) { return value < key.time; });
+	if (next == m_keys.begin())
+	{
+		return m_keys.front();
+	}
+	if (next == m_keys.end())
+	{
+		return m_keys.back();
+	}
+
+	const Key& previous = *(next - 1);
+	float blend = (time - previous.time) / (next->time - previous.time);
+	Key key = previous;
+	key.time = time;
+	key.position = glm::mix(previous.position, next->position, blend);
+	key.yaw = glm::mix(previous.yaw, next->yaw, blend);
+	key.pitch = glm::mix(previous.pitch, next->pitch, blend);
+	key.zoom = glm::mix(previous.zoom, next->zoom, blend);
+	return key;
+}
+
+/***********************************************************
+ *  ApplyKey()
+ *
+ *  Moves and turns the camera to the key - the front, right
+ *  and up vectors are rebuilt from the yaw and pitch, like
+ *  free look does, so a straight down preset view plays
+ *  back at the pitch limit of free look.
+ ***********************************************************/
+void CameraPath::ApplyKey(const Key& key, Camera& camera)
+{
+	camera.Position = key.position;
+	camera.Yaw = key.yaw;
+	camera.Pitch = key.pitch;
+	camera.Zoom = key.zoom;
+	// a zero offset only limits the pitch and rebuilds the vectors
+	camera.ProcessMouseMovement(0.0f, 0.0f);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class Camera;
+
+/***********************************************************
+ *  CameraPath
+ *
+ *  The camera of a recorded fly-through - one key per
+ *  rendered frame, stamped with the seconds since the
+ *  recording started. Played back at the fixed FRAME_RATE
+ *  instead of the frame times of the recording, so the same
+ *  path renders the same frames on every build and machine,
+ *  with the camera interpolated between the keys. The file
+ *  is text, a line per key of the time, the position, the
+ *  yaw, pitch and zoom in degrees and 1 for orthographic.
+ ***********************************************************/
+class CameraPath
+{
+public:
+	// frames per second of the playback
+	static const int FRAME_RATE = 60;
+
+	// the camera of one frame
+	struct Key
+	{
+		float time;
+		glm::vec3 position;
+		float yaw;
+		float pitch;
+		float zoom;
+		bool bOrthographic;
+	};
+
+	// add the camera of the next frame - keys not later than the last are dropped
+	void AddKey(const Key& key);
+	// the key of the camera at the passed time
+	static Key CaptureKey(const Camera& camera, bool bOrthographic, float time);
+
+	// read or write the file - false when it cannot be, or when the
+	// file holds no keys
+	bool Load(const char* filename);
+	bool Save(const char* filename) const;
+
+	// the frames of the playback, the last one at or past the last key
+	int GetFrameCount() const;
+	// the camera of a frame of the playback
+	Key GetFrameKey(int frame) const;
+	// point the camera like the key, keeping its speed
+	static void ApplyKey(const Key& key, Camera& camera);
+
+	size_t GetKeyCount() const { return m_keys.size(); }
+	float GetDuration() const { return (m_keys.empty() == true) ? 0.0f : m_keys.back().time; }
+
+private:
+	std::vector<Key> m_keys;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+/***********************************************************
+ *  CameraPreset
+ *
+ *  One of the preset views of the number keys 1 to 9. The
+ *  view manager snaps the camera to them, and the headless
+ *  benchmark renders every one of them, so both use this
+ *  table and the projection below.
+ ***********************************************************/
+struct CameraPreset
+{
+	const char* name;
+	bool bOrthographic;
+	glm::vec3 position;
+	glm::vec3 front;
+	glm::vec3 up;
+};
+
+// the presets in the order of the number keys
+static const int CAMERA_PRESET_COUNT = 9;
+static const CameraPreset g_CameraPresets[CAMERA_PRESET_COUNT] = {
+	// 1 - orthographic front view, looking straight down the -Z axis
+	{ "ortho_front", true, glm::vec3(0.0f, 7.0f, 10.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+	// 2 - orthographic left side view, looking in the +X direction
+	{ "ortho_left", true, glm::vec3(-10.0f, 7.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+	// 3 - orthographic back view, looking in the +Z direction
+	{ "ortho_back", true, glm::vec3(0.0f, 7.0f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+	// 4 - orthographic right side view, looking in the -X direction
+	{ "ortho_right", true, glm::vec3(10.0f, 7.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+	// 5 - orthographic top view, looking straight down the -Y axis
+	{ "ortho_top", true, glm::vec3(0.0f, 15.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f) },
+	// 6 - perspective view from the front at a slight downward angle
+	{ "front", false, glm::vec3(0.0f, 8.5f, 8.0f), glm::vec3(0.0f, -1.0f, -2.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+	// 7 - perspective view from the front-left diagonal
+	{ "front_left", false, glm::vec3(-6.0f, 8.5f, 6.0f), glm::vec3(0.6f, -0.6f, -0.6f), glm::vec3(0.0f, 1.0f, 0.0f) },
+	// 8 - perspective view from the front-right diagonal
+	{ "front_right", false, glm::vec3(6.0f, 8.5f, 6.0f), glm::vec3(-0.6f, -0.6f, -0.6f), glm::vec3(0.0f, 1.0f, 0.0f) },
+	// 9 - perspective view from behind the scene
+	{ "back", false, glm::vec3(0.0f, 8.5f, -8.0f), glm::vec3(0.0f, -0.5f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f) }
+};
+
+// field of view in degrees the perspective presets reset the zoom to
+static const float CAMERA_PRESET_ZOOM = 80.0f;
+
+/***********************************************************
+ *  BuildSceneProjection()
+ *
+ *  The projection of the scene views - the orthographic
+ *  views cover a fixed square around the table.
+ ***********************************************************/
+inline glm::mat4 BuildSceneProjection(bool bOrthographic, float zoom, float aspectRatio)
+{
+	if (bOrthographic == true)
+	{
+		return glm::ortho(-15.0f, 15.0f, -15.0f, 15.0f, 0.1f, 100.0f);
+	}
+	return glm::perspective(glm::radians(zoom), aspectRatio, 0.1f, 100.0f);
+}
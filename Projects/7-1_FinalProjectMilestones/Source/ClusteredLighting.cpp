@@ -0,0 +1,340 @@
+#include "ClusteredLighting.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// the view space position of a normalized device coordinate
+	glm::vec3 UnprojectPoint(const glm::mat4& inverseProjection, float x, float y, float z)
+	{
+		glm::vec4 point = inverseProjection * glm::vec4(x, y, z, 1.0f);
+		return glm::vec3(point) / point.w;
+	}
+
+	// the point of the line through a and b at the passed view depth
+	glm::vec3 PointAtDepth(const glm::vec3& a, const glm::vec3& b, float depth)
+	{
+		float t = (-depth - a.z) / (b.z - a.z);
+		return a + ((b - a) * t);
+	}
+}
+
+/***********************************************************
+ *  ClusteredLighting()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ClusteredLighting::ClusteredLighting()
+{
+	m_viewportWidth = 0;
+	m_viewportHeight = 0;
+	m_nearDepth = 0.0f;
+	m_farDepth = 0.0f;
+	m_boundsProjection = glm::mat4(0.0f);
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  The cluster lists are read from shader storage buffers,
+ *  which are core from OpenGL 4.3.
+ ***********************************************************/
+bool ClusteredLighting::IsSupported()
+{
+	return (GLEW_VERSION_4_3 != 0) || (GLEW_ARB_shader_storage_buffer_object != 0);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Creates the light, cluster and light index buffers.
+ ***********************************************************/
+bool ClusteredLighting::Initialize()
+{
+	if (IsSupported() == false)
+	{
+		std::cout << "Clustered lighting needs shader storage buffers" << std::endl;
+		return false;
+	}
+
+	m_lightBuffer.Create();
+	m_clusterBuffer.Create();
+	m_lightIndexBuffer.Create();
+
+	// the buffers are bound once so they exist and can be labeled
+	GpuBuffer* pBuffers[3] = { &m_lightBuffer, &m_clusterBuffer, &m_lightIndexBuffer };
+	const char* const labels[3] = { "Cluster lights", "Clusters", "Cluster light indices" };
+	for (int i = 0; i < 3; i++)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, *pBuffers[i]);
+		pBuffers[i]->SetLabel(labels[i]);
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	return true;
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  Packs the scene lights into the light buffer. Lights
+ *  without a falloff get a radius of 0 and are added to
+ *  every cluster.
+ ***********************************************************/
+void ClusteredLighting::SetLights(const std::vector<LightSource>& lights)
+{
+	m_lights = lights;
+	m_lightRadii.resize(lights.size());
+
+	// the buffer always holds one entry, so it can be bound
+	std::vector<GPULight> gpuLights(std::max((size_t)1, lights.size()));
+	for (size_t i = 0; i < lights.size(); i++)
+	{
+		m_lightRadii[i] = GetLightRadius(lights[i]);
+		gpuLights[i] = PackLight(lights[i], m_lightRadii[i]);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_lightBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GPULight) * gpuLights.size(), gpuLights.data(), GL_STATIC_DRAW);
+	m_lightBuffer.SetBytes(sizeof(GPULight) * gpuLights.size());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UpdateClusterBounds()
+ *
+ *  Splits the viewport into tiles and the depth range of the
+ *  projection into exponential slices, so the slices stay
+ *  about as deep as they are wide. The view space box of
+ *  every cluster is kept for the light tests.
+ ***********************************************************/
+void ClusteredLighting::UpdateClusterBounds(const glm::mat4& projection, int width, int height)
+{
+	if ((width == m_viewportWidth) && (height == m_viewportHeight) && (projection == m_boundsProjection))
+	{
+		return;
+	}
+
+	m_viewportWidth = width;
+	m_viewportHeight = height;
+	m_boundsProjection = projection;
+
+	glm::mat4 inverseProjection = glm::inverse(projection);
+	m_nearDepth = -UnprojectPoint(inverseProjection, 0.0f, 0.0f, -1.0f).z;
+	m_farDepth = -UnprojectPoint(inverseProjection, 0.0f, 0.0f, 1.0f).z;
+
+	m_clusterBounds.resize(CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_DEPTH_SLICES);
+	for (int slice = 0; slice < CLUSTER_DEPTH_SLICES; slice++)
+	{
+		float sliceNear = m_nearDepth * std::pow(m_farDepth / m_nearDepth, (float)slice / CLUSTER_DEPTH_SLICES);
+		float sliceFar = m_nearDepth * std::pow(m_farDepth / m_nearDepth, (float)(slice + 1) / CLUSTER_DEPTH_SLICES);
+
+		for (int y = 0; y < CLUSTER_TILES_Y; y++)
+		{
+			float bottom = -1.0f + (2.0f * y) / CLUSTER_TILES_Y;
+			float top = -1.0f + (2.0f * (y + 1)) / CLUSTER_TILES_Y;
+
+			for (int x = 0; x < CLUSTER_TILES_X; x++)
+			{
+				float left = -1.0f + (2.0f * x) / CLUSTER_TILES_X;
+				float right = -1.0f + (2.0f * (x + 1)) / CLUSTER_TILES_X;
+				const float cornersX[4] = { left, right, left, right };
+				const float cornersY[4] = { bottom, bottom, top, top };
+
+				ClusterBounds& bounds = m_clusterBounds[(slice * CLUSTER_TILES_Y + y) * CLUSTER_TILES_X + x];
+				bounds.minimum = glm::vec3(1.0e30f);
+				bounds.maximum = glm::vec3(-1.0e30f);
+				for (int corner = 0; corner < 4; corner++)
+				{
+					// the corner ray from the near to the far plane, cut at
+					// the depths of the slice
+					glm::vec3 nearPoint = UnprojectPoint(inverseProjection, cornersX[corner], cornersY[corner], -1.0f);
+					glm::vec3 farPoint = UnprojectPoint(inverseProjection, cornersX[corner], cornersY[corner], 1.0f);
+					glm::vec3 a = PointAtDepth(nearPoint, farPoint, sliceNear);
+					glm::vec3 b = PointAtDepth(nearPoint, farPoint, sliceFar);
+					bounds.minimum = glm::min(bounds.minimum, glm::min(a, b));
+					bounds.maximum = glm::max(bounds.maximum, glm::max(a, b));
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GetDepthSlice()
+ *
+ *  The exponential depth slice of a view space distance,
+ *  the same mapping the fragment shader uses.
+ ***********************************************************/
+int ClusteredLighting::GetDepthSlice(float depth) const
+{
+	if (depth <= m_nearDepth)
+	{
+		return 0;
+	}
+	int slice = (int)(std::log(depth / m_nearDepth) / std::log(m_farDepth / m_nearDepth) * CLUSTER_DEPTH_SLICES);
+	return std::min(std::max(slice, 0), CLUSTER_DEPTH_SLICES - 1);
+}
+
+/***********************************************************
+ *  AssignLights()
+ *
+ *  Tests the range sphere of every light against the boxes
+ *  of the clusters it can reach, then sorts the hits into
+ *  one index list per cluster. Only the slices the sphere
+ *  spans and the tiles its projected box covers are tested.
+ ***********************************************************/
+void ClusteredLighting::AssignLights(const glm::mat4& view, const glm::mat4& projection)
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	UpdateClusterBounds(projection, std::max(1, (int)viewport[2]), std::max(1, (int)viewport[3]));
+
+	int clusterCount = CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_DEPTH_SLICES;
+	m_clusterCounts.assign(clusterCount, 0);
+	m_assignments.clear();
+
+	for (size_t light = 0; light < m_lights.size(); light++)
+	{
+		float radius = m_lightRadii[light];
+		if (radius <= 0.0f)
+		{
+			// no falloff - the light reaches every cluster
+			for (int cluster = 0; cluster < clusterCount; cluster++)
+			{
+				m_assignments.push_back(glm::uvec2(cluster, light));
+				m_clusterCounts[cluster]++;
+			}
+			continue;
+		}
+
+		glm::vec3 center = glm::vec3(view * glm::vec4(m_lights[light].position, 1.0f));
+		float depth = -center.z;
+		if (((depth + radius) < m_nearDepth) || ((depth - radius) > m_farDepth))
+		{
+			continue;
+		}
+		int firstSlice = GetDepthSlice(depth - radius);
+		int lastSlice = GetDepthSlice(depth + radius);
+
+		// the tiles under the projected box of the sphere - every tile
+		// when the sphere reaches behind the near plane
+		int firstX = 0;
+		int lastX = CLUSTER_TILES_X - 1;
+		int firstY = 0;
+		int lastY = CLUSTER_TILES_Y - 1;
+		if ((depth - radius) > m_nearDepth)
+		{
+			glm::vec2 ndcMinimum(1.0e30f);
+			glm::vec2 ndcMaximum(-1.0e30f);
+			for (int corner = 0; corner < 8; corner++)
+			{
+				glm::vec3 offset(
+					(corner & 1) ? radius : -radius,
+					(corner & 2) ? radius : -radius,
+					(corner & 4) ? radius : -radius);
+				glm::vec4 clip = projection * glm::vec4(center + offset, 1.0f);
+				glm::vec2 ndc = glm::vec2(clip) / clip.w;
+				ndcMinimum = glm::min(ndcMinimum, ndc);
+				ndcMaximum = glm::max(ndcMaximum, ndc);
+			}
+			firstX = std::max(0, (int)std::floor((ndcMinimum.x * 0.5f + 0.5f) * CLUSTER_TILES_X));
+			lastX = std::min(CLUSTER_TILES_X - 1, (int)std::floor((ndcMaximum.x * 0.5f + 0.5f) * CLUSTER_TILES_X));
+			firstY = std::max(0, (int)std::floor((ndcMinimum.y * 0.5f + 0.5f) * CLUSTER_TILES_Y));
+			lastY = std::min(CLUSTER_TILES_Y - 1, (int)std::floor((ndcMaximum.y * 0.5f + 0.5f) * CLUSTER_TILES_Y));
+		}
+
+		for (int slice = firstSlice; slice <= lastSlice; slice++)
+		{
+			for (int y = firstY; y <= lastY; y++)
+			{
+				for (int x = firstX; x <= lastX; x++)
+				{
+					int cluster = (slice * CLUSTER_TILES_Y + y) * CLUSTER_TILES_X + x;
+					const ClusterBounds& bounds = m_clusterBounds[cluster];
+					glm::vec3 closest = glm::clamp(center, bounds.minimum, bounds.maximum);
+					glm::vec3 toCenter = center - closest;
+					if (glm::dot(toCenter, toCenter) <= (radius * radius))
+					{
+						m_assignments.push_back(glm::uvec2(cluster, light));
+						m_clusterCounts[cluster]++;
+					}
+				}
+			}
+		}
+	}
+
+	// counting sort of the hits - the lights of a cluster stay in scene
+	// order, so their contributions add up in the same order as on the
+	// forward path
+	m_clusterRanges.resize(clusterCount);
+	GLuint offset = 0;
+	for (int cluster = 0; cluster < clusterCount; cluster++)
+	{
+		m_clusterRanges[cluster] = glm::uvec2(offset, 0);
+		offset += m_clusterCounts[cluster];
+	}
+	m_lightIndices.resize(std::max((GLuint)1, offset));
+	for (size_t i = 0; i < m_assignments.size(); i++)
+	{
+		glm::uvec2& range = m_clusterRanges[m_assignments[i].x];
+		m_lightIndices[range.x + range.y] = m_assignments[i].y;
+		range.y++;
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_clusterBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::uvec2) * m_clusterRanges.size(),
+		m_clusterRanges.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_lightIndexBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * m_lightIndices.size(),
+		m_lightIndices.data(), GL_STREAM_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	m_clusterBuffer.SetBytes(sizeof(glm::uvec2) * m_clusterRanges.size());
+	m_lightIndexBuffer.SetBytes(sizeof(GLuint) * m_lightIndices.size());
+	RenderStats::Frame().bufferUploads += 2;
+}
+
+/***********************************************************
+ *  ApplyClusters()
+ *
+ *  Sets the grid uniforms the fragment shader uses to find
+ *  its cluster, and binds the light and cluster buffers.
+ ***********************************************************/
+void ClusteredLighting::ApplyClusters(ShaderManager* pShaderManager, const glm::mat4& view) const
+{
+	GLuint programID = pShaderManager->m_programID;
+	glUniform3i(glGetUniformLocation(programID, "clusterGrid"),
+		CLUSTER_TILES_X, CLUSTER_TILES_Y, CLUSTER_DEPTH_SLICES);
+	RenderStats::Frame().uniformCalls++;
+	// the pixel size of a tile
+	pShaderManager->setVec2Value("clusterTileSize",
+		(float)m_viewportWidth / CLUSTER_TILES_X, (float)m_viewportHeight / CLUSTER_TILES_Y);
+
+	// slice = log(depth) * scale + bias
+	float logDepthRange = std::log(m_farDepth / m_nearDepth);
+	pShaderManager->setVec2Value("clusterDepth",
+		CLUSTER_DEPTH_SLICES / logDepthRange,
+		-CLUSTER_DEPTH_SLICES * std::log(m_nearDepth) / logDepthRange);
+	// the camera looks down the view space -Z axis
+	pShaderManager->setVec3Value("clusterViewForward", -view[0][2], -view[1][2], -view[2][2]);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_BLOCK_BINDING, m_lightBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_BLOCK_BINDING, m_clusterBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_INDEX_BINDING, m_lightIndexBuffer);
+}
+
+/***********************************************************
+ *  GetAverageClusterLights()
+ *
+ *  The average length of the cluster light lists.
+ ***********************************************************/
+float ClusteredLighting::GetAverageClusterLights() const
+{
+	if (m_clusterRanges.empty())
+	{
+		return 0.0f;
+	}
+	return (float)m_assignments.size() / m_clusterRanges.size();
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "LightSource.h"
+#include "ShaderManager.h"
+#include "GpuResources.h"
+
+#include <vector>
+
+/***********************************************************
+ *  ClusteredLighting
+ *
+ *  Clustered forward shading for scenes with many lights.
+ *  The view frustum is split into a grid of screen tiles
+ *  and exponential depth slices. Every frame the lights are
+ *  assigned on the CPU to the clusters their range overlaps,
+ *  and the fragment shader only loops over the lights of
+ *  its own cluster. The lights, the cluster list ranges and
+ *  the light index list live in shader storage buffers.
+ ***********************************************************/
+class ClusteredLighting
+{
+public:
+	// shader storage bindings of the light, cluster and index buffers -
+	// must match lighting.glsl
+	static const GLuint LIGHT_BLOCK_BINDING = 6;
+	static const GLuint CLUSTER_BLOCK_BINDING = 7;
+	static const GLuint LIGHT_INDEX_BINDING = 8;
+	// screen tiles across and down the viewport and the number of
+	// depth slices - a fixed grid, so the lists are as tight at any
+	// window size
+	static const int CLUSTER_TILES_X = 16;
+	static const int CLUSTER_TILES_Y = 9;
+	static const int CLUSTER_DEPTH_SLICES = 24;
+
+	// constructor - the buffers are freed by their handles
+	ClusteredLighting();
+
+	// true when the context has shader storage buffers
+	static bool IsSupported();
+
+	// create the buffers
+	bool Initialize();
+
+	// upload the scene lights - the radius of every light is taken
+	// from its attenuation
+	void SetLights(const std::vector<LightSource>& lights);
+
+	// assign the lights to the clusters of the current viewport and
+	// camera, then upload the cluster lists
+	void AssignLights(const glm::mat4& view, const glm::mat4& projection);
+
+	// set the cluster grid uniforms and bind the buffers for a program
+	// that includes lighting.glsl, which must be in use
+	void ApplyClusters(ShaderManager* pShaderManager, const glm::mat4& view) const;
+
+	// the number of lights and the average lights per cluster of the
+	// last assignment, for the statistics report
+	int GetLightCount() const { return (int)m_lights.size(); }
+	float GetAverageClusterLights() const;
+
+private:
+	// view space bounds of one cluster
+	struct ClusterBounds
+	{
+		glm::vec3 minimum;
+		glm::vec3 maximum;
+	};
+
+	// rebuild the cluster bounds when the projection or viewport changed
+	void UpdateClusterBounds(const glm::mat4& projection, int width, int height);
+	// the depth slice of a positive view space distance
+	int GetDepthSlice(float depth) const;
+
+	GpuBuffer m_lightBuffer;
+	GpuBuffer m_clusterBuffer;
+	GpuBuffer m_lightIndexBuffer;
+	std::vector<LightSource> m_lights;
+	std::vector<float> m_lightRadii;
+	// viewport and depth range of the cluster bounds
+	int m_viewportWidth;
+	int m_viewportHeight;
+	float m_nearDepth;
+	float m_farDepth;
+	glm::mat4 m_boundsProjection;
+	std::vector<ClusterBounds> m_clusterBounds;
+	// per cluster offset and count into the light index list
+	std::vector<glm::uvec2> m_clusterRanges;
+	std::vector<GLuint> m_lightIndices;
+	// cluster and light of every hit, and the hits per cluster
+	std::vector<glm::uvec2> m_assignments;
+	std::vector<GLuint> m_clusterCounts;
+};
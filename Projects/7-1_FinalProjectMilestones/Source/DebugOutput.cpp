@@ -0,0 +1,285 @@
+#include "DebugOutput.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+	// set while an installed debug output wants the debug groups
+	bool g_bGroupsEnabled = false;
+
+	// the most frequent messages listed by the reports
+	const size_t g_ReportedMessages = 10;
+
+	const char* GetSeverityName(GLenum severity)
+	{
+		switch (severity)
+		{
+		case GL_DEBUG_SEVERITY_HIGH:
+			return "high";
+		case GL_DEBUG_SEVERITY_MEDIUM:
+			return "medium";
+		case GL_DEBUG_SEVERITY_LOW:
+			return "low";
+		default:
+			return "notification";
+		}
+	}
+
+	// JSON string characters - driver messages may hold quotes
+	void WriteEscaped(std::ostream& output, const std::string& text)
+	{
+		for (char character : text)
+		{
+			if ((character == '"') || (character == '\\'))
+			{
+				output << '\\' << character;
+			}
+			else if ((unsigned char)character >= 0x20)
+			{
+				output << character;
+			}
+		}
+	}
+
+	// the indices of the messages, the most frequent first
+	std::vector<size_t> SortByCount(const std::vector<DebugOutput::Message>& messages)
+	{
+		std::vector<size_t> order(messages.size());
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&messages](size_t a, size_t b)
+			{
+				return messages[a].count > messages[b].count;
+			});
+		return order;
+	}
+}
+
+/***********************************************************
+ *  DebugOutput()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DebugOutput::DebugOutput()
+{
+	m_bInstalled = false;
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		m_counts[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~DebugOutput()
+ *
+ *  The destructor removes the callback, so the driver never
+ *  calls into a deleted object.
+ ***********************************************************/
+DebugOutput::~DebugOutput()
+{
+	if (m_bInstalled == true)
+	{
+		glDebugMessageCallback(NULL, NULL);
+		glDisable(GL_DEBUG_OUTPUT);
+		g_bGroupsEnabled = false;
+		m_bInstalled = false;
+	}
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  The debug output is core in 4.3 and KHR_debug brings it
+ *  to older contexts, but not to the 3.3 ones of macOS.
+ ***********************************************************/
+bool DebugOutput::IsSupported()
+{
+	return (GLEW_VERSION_4_3 != 0) || (GLEW_KHR_debug != 0);
+}
+
+/***********************************************************
+ *  AreGroupsEnabled()
+ *
+ *  True while an installed debug output wants the groups.
+ ***********************************************************/
+bool DebugOutput::AreGroupsEnabled()
+{
+	return g_bGroupsEnabled;
+}
+
+/***********************************************************
+ *  Install()
+ *
+ *  Registers the callback and turns the debug groups on.
+ *  The push and pop messages of the groups are filtered out,
+ *  as they would only echo the application's own groups.
+ *  Drivers report the most on a debug context, so a normal
+ *  context is mentioned in the console.
+ ***********************************************************/
+bool DebugOutput::Install()
+{
+	if (IsSupported() == false)
+	{
+		std::cout << "The debug output is not supported by this OpenGL context" << std::endl;
+		return false;
+	}
+
+	GLint contextFlags = 0;
+	glGetIntegerv(GL_CONTEXT_FLAGS, &contextFlags);
+	if ((contextFlags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0)
+	{
+		std::cout << "INFO: not a debug context, the driver may report fewer messages" << std::endl;
+	}
+
+	glEnable(GL_DEBUG_OUTPUT);
+	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	glDebugMessageCallback(OnMessage, this);
+	glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_PUSH_GROUP, GL_DONT_CARE, 0, NULL, GL_FALSE);
+	glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_POP_GROUP, GL_DONT_CARE, 0, NULL, GL_FALSE);
+	m_bInstalled = true;
+	g_bGroupsEnabled = true;
+
+	return true;
+}
+
+/***********************************************************
+ *  GetCategoryName()
+ *
+ *  The name of a category in the reports.
+ ***********************************************************/
+const char* DebugOutput::GetCategoryName(Category category)
+{
+	static const char* const names[CATEGORY_COUNT] = {
+		"error", "performance", "deprecated", "undefined", "portability", "other" };
+	return names[category];
+}
+
+/***********************************************************
+ *  OnMessage()
+ *
+ *  The callback registered with the driver.
+ ***********************************************************/
+void GLAPIENTRY DebugOutput::OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
+	GLsizei /*length*/, const GLchar* message, const void* userParam)
+{
+	DebugOutput* pOutput = (DebugOutput*)userParam;
+	if (NULL != pOutput)
+	{
+		pOutput->AddMessage(source, type, id, severity, message);
+	}
+}
+
+/***********************************************************
+ *  AddMessage()
+ *
+ *  Counts the message under its category and prints it the
+ *  first time it arrives. The notifications, which some
+ *  drivers send for every buffer they place, are counted
+ *  without printing them.
+ ***********************************************************/
+void DebugOutput::AddMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const GLchar* message)
+{
+	Category category = OTHER;
+	switch (type)
+	{
+	case GL_DEBUG_TYPE_ERROR:
+		category = ERRORS;
+		break;
+	case GL_DEBUG_TYPE_PERFORMANCE:
+		category = PERFORMANCE;
+		break;
+	case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+		category = DEPRECATED;
+		break;
+	case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+		category = UNDEFINED_BEHAVIOR;
+		break;
+	case GL_DEBUG_TYPE_PORTABILITY:
+		category = PORTABILITY;
+		break;
+	default:
+		break;
+	}
+	m_counts[category]++;
+
+	// some drivers give every message the same id, so the text
+	// tells the messages apart as well
+	for (Message& known : m_messages)
+	{
+		if ((known.id == id) && (known.category == category) && (strcmp(known.text.c_str(), message) == 0))
+		{
+			known.count++;
+			return;
+		}
+	}
+
+	Message added;
+	added.category = category;
+	added.source = source;
+	added.severity = severity;
+	added.id = id;
+	added.text = message;
+	added.count = 1;
+	m_messages.push_back(added);
+
+	if (severity != GL_DEBUG_SEVERITY_NOTIFICATION)
+	{
+		std::cout << "GL " << GetCategoryName(category) << " (" << GetSeverityName(severity) << "): "
+			<< message << std::endl;
+	}
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  Prints the count of every category and the messages that
+ *  arrived most often.
+ ***********************************************************/
+void DebugOutput::PrintReport(std::ostream& output) const
+{
+	output << "GL debug messages:";
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		output << " " << GetCategoryName((Category)i) << " " << m_counts[i];
+	}
+	output << "\n";
+
+	std::vector<size_t> order = SortByCount(m_messages);
+	for (size_t i = 0; (i < order.size()) && (i < g_ReportedMessages); i++)
+	{
+		const Message& message = m_messages[order[i]];
+		output << "  " << message.count << "x " << GetCategoryName(message.category) << " ("
+			<< GetSeverityName(message.severity) << "): " << message.text << "\n";
+	}
+}
+
+/***********************************************************
+ *  WriteJsonReport()
+ *
+ *  Writes the counts and the most frequent messages as a
+ *  JSON object.
+ ***********************************************************/
+void DebugOutput::WriteJsonReport(std::ostream& output) const
+{
+	output << "{";
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		output << ((i > 0) ? ", " : " ") << "\"" << GetCategoryName((Category)i) << "\": " << m_counts[i];
+	}
+	output << ", \"messages\": [";
+	std::vector<size_t> order = SortByCount(m_messages);
+	for (size_t i = 0; (i < order.size()) && (i < g_ReportedMessages); i++)
+	{
+		const Message& message = m_messages[order[i]];
+		output << ((i > 0) ? ", " : " ") << "{ \"type\": \"" << GetCategoryName(message.category)
+			<< "\", \"severity\": \"" << GetSeverityName(message.severity) << "\", \"count\": " << message.count
+			<< ", \"text\": \"";
+		WriteEscaped(output, message.text);
+		output << "\" }";
+	}
+	output << " ] }";
+}
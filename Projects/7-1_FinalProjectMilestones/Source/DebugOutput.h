@@ -0,0 +1,113 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  DebugOutput
+ *
+ *  Receives the messages of the driver through the KHR_debug
+ *  callback and keeps a count of them by type - errors, the
+ *  performance warnings like shader recompiles, buffer
+ *  migrations and implicit syncs, and the rest. Every
+ *  distinct message is printed the first time it arrives
+ *  and counted after that, so a warning raised every frame
+ *  does not flood the console. While it is installed the
+ *  debug groups below are pushed, so the messages and the
+ *  frame debuggers show which part of the frame issued a
+ *  call. The output is synchronous, so the callback runs on
+ *  the thread of the call that raised the message.
+ ***********************************************************/
+class DebugOutput
+{
+public:
+	// the message types the counts are kept by
+	enum Category
+	{
+		ERRORS,
+		PERFORMANCE,
+		DEPRECATED,
+		UNDEFINED_BEHAVIOR,
+		PORTABILITY,
+		OTHER,
+		CATEGORY_COUNT
+	};
+
+	// one distinct message and how often it arrived
+	struct Message
+	{
+		Category category;
+		GLenum source;
+		GLenum severity;
+		GLuint id;
+		std::string text;
+		int count;
+	};
+
+	// constructor
+	DebugOutput();
+	// destructor - removes the callback when installed
+	~DebugOutput();
+
+	// true when the context has the debug output
+	static bool IsSupported();
+	// true while an installed debug output wants debug groups
+	static bool AreGroupsEnabled();
+
+	// register the callback - false when the context has no debug output
+	bool Install();
+
+	static const char* GetCategoryName(Category category);
+	int GetCount(Category category) const { return m_counts[category]; }
+	const std::vector<Message>& GetMessages() const { return m_messages; }
+
+	// print the counts and the most frequent messages, or write them as JSON
+	void PrintReport(std::ostream& output) const;
+	void WriteJsonReport(std::ostream& output) const;
+
+private:
+	static void GLAPIENTRY OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
+		GLsizei length, const GLchar* message, const void* userParam);
+	void AddMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const GLchar* message);
+
+	bool m_bInstalled;
+	int m_counts[CATEGORY_COUNT];
+	// the distinct messages in the order they first arrived
+	std::vector<Message> m_messages;
+};
+
+/***********************************************************
+ *  DebugGroup
+ *
+ *  Marks the GL calls of a C++ scope as a named group for
+ *  the debug output and frame debuggers like RenderDoc -
+ *  does nothing unless a DebugOutput is installed. The
+ *  name has to stay valid until the scope ends.
+ ***********************************************************/
+class DebugGroup
+{
+public:
+	DebugGroup(const char* name) : m_bPushed(DebugOutput::AreGroupsEnabled())
+	{
+		if (m_bPushed == true)
+		{
+			glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+		}
+	}
+	~DebugGroup()
+	{
+		if (m_bPushed == true)
+		{
+			glPopDebugGroup();
+		}
+	}
+
+private:
+	bool m_bPushed;
+
+	DebugGroup(const DebugGroup&);
+	DebugGroup& operator=(const DebugGroup&);
+};
@@ -0,0 +1,234 @@
+#include "DeferredRenderer.h"
+#include "RenderStats.h"
+
+#include <iostream>
+
+namespace
+{
+	const char* g_IndirectVertexShader = "shaders/indirectVertexShader.glsl";
+	const char* g_GBufferFragmentShader = "shaders/gbufferFragmentShader.glsl";
+	const char* g_DeferredVertexShader = "shaders/deferredVertexShader.glsl";
+	const char* g_DeferredFragmentShader = "shaders/deferredFragmentShader.glsl";
+}
+
+/***********************************************************
+ *  DeferredRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DeferredRenderer::DeferredRenderer()
+{
+	m_pGeometryShader = NULL;
+	m_pLightingShader = NULL;
+	m_framebuffer = 0;
+	m_width = 0;
+	m_height = 0;
+	m_previousFramebuffer = 0;
+	m_bBlendEnabled = false;
+	for (int i = 0; i < 4; i++)
+	{
+		m_previousViewport[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~DeferredRenderer()
+ *
+ *  The destructor frees the framebuffer - the G-buffer and
+ *  the programs are freed by their handles.
+ ***********************************************************/
+DeferredRenderer::~DeferredRenderer()
+{
+	if (NULL != m_pGeometryShader)
+	{
+		delete m_pGeometryShader;
+		m_pGeometryShader = NULL;
+	}
+	if (NULL != m_pLightingShader)
+	{
+		delete m_pLightingShader;
+		m_pLightingShader = NULL;
+	}
+	if (0 != m_framebuffer)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Loads the G-buffer program, which shares the vertex
+ *  shader of the indirect path, and the lighting program,
+ *  and points their samplers at the texture units. The
+ *  G-buffer textures are created by the first geometry pass,
+ *  once the viewport size is known.
+ ***********************************************************/
+bool DeferredRenderer::Initialize(int textureSlots)
+{
+	m_pGeometryShader = new ShaderManager();
+	m_geometryProgram.Adopt(m_pGeometryShader->LoadShaders(g_IndirectVertexShader, g_GBufferFragmentShader));
+	if (0 == m_geometryProgram)
+	{
+		return false;
+	}
+	m_geometryProgram.SetLabel("G-buffer");
+	m_pGeometryShader->use();
+	for (int i = 0; i < textureSlots; i++)
+	{
+		m_pGeometryShader->setSampler2DValue("sceneTextures[" + std::to_string(i) + "]", i);
+	}
+
+	m_pLightingShader = new ShaderManager();
+	m_lightingProgram.Adopt(m_pLightingShader->LoadShaders(g_DeferredVertexShader, g_DeferredFragmentShader));
+	if (0 == m_lightingProgram)
+	{
+		return false;
+	}
+	m_lightingProgram.SetLabel("Deferred lighting");
+	m_pLightingShader->use();
+	m_pLightingShader->setSampler2DValue("gBufferAlbedo", ALBEDO_TEXTURE_UNIT);
+	m_pLightingShader->setSampler2DValue("gBufferNormal", NORMAL_TEXTURE_UNIT);
+	m_pLightingShader->setSampler2DValue("gBufferDepth", DEPTH_TEXTURE_UNIT);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	m_emptyVertexArray.Create();
+	glBindVertexArray(m_emptyVertexArray);
+	m_emptyVertexArray.SetLabel("Deferred lighting");
+	glBindVertexArray(0);
+
+	return true;
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  Creates the G-buffer textures at the viewport size. The
+ *  normals keep 16 bit floats, so the material index fits
+ *  exactly into their fourth channel.
+ ***********************************************************/
+void DeferredRenderer::Resize(int width, int height)
+{
+	if ((width == m_width) && (height == m_height))
+	{
+		return;
+	}
+
+	m_width = width;
+	m_height = height;
+
+	const GLenum formats[3] = { GL_RGBA8, GL_RGBA16F, GL_DEPTH_COMPONENT32F };
+	GpuTexture* pTextures[3] = { &m_albedoTexture, &m_normalTexture, &m_depthTexture };
+	// created on a G-buffer unit, so the scene textures stay bound -
+	// creating a texture frees the one of the previous size
+	const char* const labels[3] = { "G-buffer albedo", "G-buffer normal", "G-buffer depth" };
+	glActiveTexture(GL_TEXTURE0 + ALBEDO_TEXTURE_UNIT);
+	for (int i = 0; i < 3; i++)
+	{
+		pTextures[i]->Create();
+		glBindTexture(GL_TEXTURE_2D, *pTextures[i]);
+		pTextures[i]->SetLabel(labels[i]);
+		glTexStorage2D(GL_TEXTURE_2D, 1, formats[i], width, height);
+		pTextures[i]->SetBytes(GpuResources::TextureBytes(formats[i], width, height));
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_albedoTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normalTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+	const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "G-buffer framebuffer is incomplete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, m_previousFramebuffer);
+}
+
+/***********************************************************
+ *  BeginGeometryPass()
+ *
+ *  Remembers the current framebuffer and viewport, binds
+ *  the G-buffer at the same size and clears it. Blending is
+ *  turned off, the G-buffer only holds opaque draws.
+ ***********************************************************/
+void DeferredRenderer::BeginGeometryPass(const glm::mat4& view, const glm::mat4& projection)
+{
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+
+	Resize(m_previousViewport[2], m_previousViewport[3]);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, m_width, m_height);
+	// cleared per attachment, so the clear color of the scene is kept
+	const GLfloat clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const GLfloat clearDepth = 1.0f;
+	glDepthMask(GL_TRUE);
+	glClearBufferfv(GL_COLOR, 0, clearColor);
+	glClearBufferfv(GL_COLOR, 1, clearColor);
+	glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+	m_bBlendEnabled = (glIsEnabled(GL_BLEND) == GL_TRUE);
+	glDisable(GL_BLEND);
+
+	m_pGeometryShader->use();
+	m_pGeometryShader->setMat4Value("view", view);
+	m_pGeometryShader->setMat4Value("projection", projection);
+}
+
+/***********************************************************
+ *  EndGeometryPass()
+ *
+ *  Switches back to the framebuffer, viewport and blending
+ *  of the scene.
+ ***********************************************************/
+void DeferredRenderer::EndGeometryPass()
+{
+	if (m_bBlendEnabled == true)
+	{
+		glEnable(GL_BLEND);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, m_previousFramebuffer);
+	glViewport(m_previousViewport[0], m_previousViewport[1], m_previousViewport[2], m_previousViewport[3]);
+}
+
+/***********************************************************
+ *  LightScene()
+ *
+ *  Draws one screen covering triangle with the lighting
+ *  program. Every covered pixel is lit once and writes its
+ *  G-buffer depth, the empty pixels are discarded so the
+ *  clear color stays.
+ ***********************************************************/
+void DeferredRenderer::LightScene(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position)
+{
+	m_pLightingShader->use();
+	m_pLightingShader->setMat4Value("inverseViewProjection", glm::inverse(projection * view));
+	m_pLightingShader->setVec3Value("viewPosition", position);
+
+	glActiveTexture(GL_TEXTURE0 + ALBEDO_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_albedoTexture);
+	glActiveTexture(GL_TEXTURE0 + NORMAL_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_normalTexture);
+	glActiveTexture(GL_TEXTURE0 + DEPTH_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	// the depth test has to stay on for the depth to be written
+	glDepthFunc(GL_ALWAYS);
+	glBindVertexArray(m_emptyVertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	glDepthFunc(GL_LESS);
+
+	RenderStats& stats = RenderStats::Frame();
+	stats.textureBinds += 3;
+	stats.vertexArrayBinds++;
+	stats.drawCalls++;
+	stats.triangles++;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "ShaderManager.h"
+#include "GpuResources.h"
+
+/***********************************************************
+ *  DeferredRenderer
+ *
+ *  The G-buffer and the screen space lighting pass of the
+ *  deferred path. The opaque draws only write their base
+ *  color, normal, material index and depth, and the lights
+ *  are evaluated afterwards once per covered pixel, so the
+ *  lighting cost follows the screen size instead of the
+ *  overdraw. The lighting pass reads the cluster light lists,
+ *  which limit every light to the screen tiles and depth
+ *  slices it reaches. The draws themselves are issued by the
+ *  IndirectRenderer with the G-buffer program.
+ ***********************************************************/
+class DeferredRenderer
+{
+public:
+	// texture units of the G-buffer in the lighting pass - above the
+	// scene texture slots and the depth pyramid
+	static const GLuint ALBEDO_TEXTURE_UNIT = 17;
+	static const GLuint NORMAL_TEXTURE_UNIT = 18;
+	static const GLuint DEPTH_TEXTURE_UNIT = 19;
+
+	// constructor
+	DeferredRenderer();
+	// destructor - frees the framebuffer, the handles free the G-buffer
+	// and the programs
+	~DeferredRenderer();
+
+	// load the G-buffer and lighting programs
+	bool Initialize(int textureSlots);
+
+	// the program that writes the G-buffer, drawn with the indirect
+	// vertex array
+	ShaderManager* GetGeometryShader() { return m_pGeometryShader; }
+	// the program of the lighting pass, used to set the light uniforms
+	ShaderManager* GetLightingShader() { return m_pLightingShader; }
+
+	// bind and clear the G-buffer, sized to the current viewport
+	void BeginGeometryPass(const glm::mat4& view, const glm::mat4& projection);
+	// switch back to the framebuffer of the scene
+	void EndGeometryPass();
+
+	// light every covered pixel of the G-buffer into the scene
+	// framebuffer and copy the depth, so the translucent draws are
+	// depth tested against the opaque ones - leaves the lighting
+	// program active
+	void LightScene(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position);
+
+private:
+	// recreate the G-buffer textures when the viewport size changes
+	void Resize(int width, int height);
+
+	ShaderManager* m_pGeometryShader;
+	ShaderManager* m_pLightingShader;
+	GpuProgram m_geometryProgram;
+	GpuProgram m_lightingProgram;
+	GLuint m_framebuffer;
+	GpuTexture m_albedoTexture;
+	GpuTexture m_normalTexture;
+	GpuTexture m_depthTexture;
+	// the lighting pass draws without vertex buffers
+	GpuVertexArray m_emptyVertexArray;
+	int m_width;
+	int m_height;
+	GLint m_previousFramebuffer;
+	GLint m_previousViewport[4];
+	bool m_bBlendEnabled;
+};
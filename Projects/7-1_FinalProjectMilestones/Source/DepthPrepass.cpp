@@ -0,0 +1,152 @@
+#include "DepthPrepass.h"
+
+namespace
+{
+	const char* g_PrepassVertexShader = "shaders/prepassVertexShader.glsl";
+	const char* g_DepthFragmentShader = "shaders/depthFragmentShader.glsl";
+
+	// sample queries of the depth and the shading pass
+	const int DEPTH_PASS_QUERY = 0;
+	const int SHADING_PASS_QUERY = 1;
+}
+
+/***********************************************************
+ *  DepthPrepass()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DepthPrepass::DepthPrepass()
+{
+	m_pShaderManager = NULL;
+	m_queries[DEPTH_PASS_QUERY] = 0;
+	m_queries[SHADING_PASS_QUERY] = 0;
+	m_bDepthPassMeasured = false;
+	m_bShadingPassMeasured = false;
+}
+
+/***********************************************************
+ *  ~DepthPrepass()
+ *
+ *  The destructor frees the queries - the depth program is
+ *  freed by its handle.
+ ***********************************************************/
+DepthPrepass::~DepthPrepass()
+{
+	if (NULL != m_pShaderManager)
+	{
+		delete m_pShaderManager;
+		m_pShaderManager = NULL;
+	}
+	if (0 != m_queries[DEPTH_PASS_QUERY])
+	{
+		glDeleteQueries(2, m_queries);
+		m_queries[DEPTH_PASS_QUERY] = 0;
+		m_queries[SHADING_PASS_QUERY] = 0;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Loads the depth only program used by the immediate path
+ *  and creates the sample queries.
+ ***********************************************************/
+bool DepthPrepass::Initialize()
+{
+	m_pShaderManager = new ShaderManager();
+	m_program.Adopt(m_pShaderManager->LoadShaders(g_PrepassVertexShader, g_DepthFragmentShader));
+	if (0 == m_program)
+	{
+		return false;
+	}
+	m_program.SetLabel("Depth pre-pass");
+
+	glGenQueries(2, m_queries);
+
+	return true;
+}
+
+/***********************************************************
+ *  BeginDepthPass()
+ *
+ *  Turns color writes off for the depth only draws. The
+ *  samples that pass the depth test here are the ones the
+ *  lit pass would shade without the pre-pass.
+ ***********************************************************/
+void DepthPrepass::BeginDepthPass()
+{
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_TRUE);
+	glDepthFunc(GL_LESS);
+	glBeginQuery(GL_SAMPLES_PASSED, m_queries[DEPTH_PASS_QUERY]);
+}
+
+/***********************************************************
+ *  EndDepthPass()
+ *
+ *  Turns color writes back on.
+ ***********************************************************/
+void DepthPrepass::EndDepthPass()
+{
+	glEndQuery(GL_SAMPLES_PASSED);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	m_bDepthPassMeasured = true;
+}
+
+/***********************************************************
+ *  BeginShadingPass()
+ *
+ *  After the depth pass only the fragments at the stored
+ *  depth pass an equal test, and the depth is already in
+ *  place so it is not written again.
+ ***********************************************************/
+void DepthPrepass::BeginShadingPass(bool bAfterDepthPass)
+{
+	if (bAfterDepthPass == true)
+	{
+		glDepthFunc(GL_EQUAL);
+		glDepthMask(GL_FALSE);
+	}
+	else
+	{
+		m_bDepthPassMeasured = false;
+	}
+	glBeginQuery(GL_SAMPLES_PASSED, m_queries[SHADING_PASS_QUERY]);
+}
+
+/***********************************************************
+ *  EndShadingPass()
+ *
+ *  Restores the default depth state for the draws that
+ *  follow, like the translucent ones.
+ ***********************************************************/
+void DepthPrepass::EndShadingPass()
+{
+	glEndQuery(GL_SAMPLES_PASSED);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	m_bShadingPassMeasured = true;
+}
+
+/***********************************************************
+ *  ReadSampleCounts()
+ *
+ *  Reads the sample counts of the last frame. The depth
+ *  samples are 0 when the last frame had no depth pass.
+ ***********************************************************/
+bool DepthPrepass::ReadSampleCounts(GLuint& depthSamples, GLuint& shadedSamples)
+{
+	if (m_bShadingPassMeasured == false)
+	{
+		return false;
+	}
+
+	depthSamples = 0;
+	if (m_bDepthPassMeasured == true)
+	{
+		glGetQueryObjectuiv(m_queries[DEPTH_PASS_QUERY], GL_QUERY_RESULT, &depthSamples);
+	}
+	glGetQueryObjectuiv(m_queries[SHADING_PASS_QUERY], GL_QUERY_RESULT, &shadedSamples);
+
+	return true;
+}
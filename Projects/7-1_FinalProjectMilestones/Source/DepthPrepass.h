@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ShaderManager.h"
+#include "GpuResources.h"
+
+/***********************************************************
+ *  DepthPrepass
+ *
+ *  Sets up the passes of the depth pre-pass mode and
+ *  measures the overdraw it saves. The opaque draws are
+ *  first drawn depth only, then shaded with an equal depth
+ *  test and depth writes off, so every visible pixel runs
+ *  the lighting exactly once. The renderers do the drawing,
+ *  this class only switches the depth and color state
+ *  around it and counts the samples of each pass.
+ ***********************************************************/
+class DepthPrepass
+{
+public:
+	// constructor
+	DepthPrepass();
+	// destructor - frees the queries, the handle frees the program
+	~DepthPrepass();
+
+	// load the depth only program of the immediate path
+	bool Initialize();
+
+	// the shader manager of the immediate depth program
+	ShaderManager* GetShaderManager() { return m_pShaderManager; }
+
+	// depth writes only, no color
+	void BeginDepthPass();
+	void EndDepthPass();
+	// shade the opaque draws - with the pre-pass only the pixels
+	// whose depth equals the pre-pass depth are shaded
+	void BeginShadingPass(bool bAfterDepthPass);
+	void EndShadingPass();
+
+	// the samples written by the last depth pass and shaded by the
+	// last shading pass - waits for the GPU, so only call it for
+	// the occasional statistics report
+	bool ReadSampleCounts(GLuint& depthSamples, GLuint& shadedSamples);
+
+private:
+	ShaderManager* m_pShaderManager;
+	GpuProgram m_program;
+	GLuint m_queries[2];
+	bool m_bDepthPassMeasured;
+	bool m_bShadingPassMeasured;
+};
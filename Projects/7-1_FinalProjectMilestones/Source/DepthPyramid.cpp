@@ -0,0 +1,227 @@
+#include "DepthPyramid.h"
+#include "ShaderManager.h"
+#include "RenderStats.h"
+
+#include <iostream>
+
+namespace
+{
+	const char* g_DepthPyramidComputeShader = "shaders/depthPyramidComputeShader.glsl";
+
+	// work group size of the reduction compute shader
+	const int PYRAMID_GROUP_SIZE = 8;
+
+	// largest power of two that is not above the passed value
+	int FloorPowerOfTwo(int value)
+	{
+		int result = 1;
+		while ((result * 2) <= value)
+		{
+			result *= 2;
+		}
+		return result;
+	}
+}
+
+/***********************************************************
+ *  DepthPyramid()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DepthPyramid::DepthPyramid()
+{
+	m_framebuffer = 0;
+	m_depthWidth = 0;
+	m_depthHeight = 0;
+	m_pyramidWidth = 0;
+	m_pyramidHeight = 0;
+	m_levelCount = 0;
+	m_previousFramebuffer = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_previousViewport[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~DepthPyramid()
+ *
+ *  The destructor frees the framebuffer - the textures and
+ *  the reduction program are freed by their handles.
+ ***********************************************************/
+DepthPyramid::~DepthPyramid()
+{
+	if (0 != m_framebuffer)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Loads the reduction compute shader and creates the
+ *  occluder framebuffer. The textures are created by the
+ *  first occluder pass, once the viewport size is known.
+ ***********************************************************/
+bool DepthPyramid::Initialize()
+{
+	ShaderManager pyramidShader;
+	m_program.Adopt(pyramidShader.LoadComputeShader(g_DepthPyramidComputeShader));
+	if (0 == m_program)
+	{
+		return false;
+	}
+	m_program.SetLabel("Depth pyramid reduction");
+
+	glUseProgram(m_program);
+	glUniform1i(glGetUniformLocation(m_program, "sourceDepth"), PYRAMID_TEXTURE_UNIT);
+
+	glGenFramebuffers(1, &m_framebuffer);
+
+	return true;
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  Creates the occluder depth texture at the viewport size
+ *  and the pyramid at the next lower power of two, so every
+ *  level halves the one before it.
+ ***********************************************************/
+void DepthPyramid::Resize(int width, int height)
+{
+	if ((width == m_depthWidth) && (height == m_depthHeight))
+	{
+		return;
+	}
+
+	m_depthWidth = width;
+	m_depthHeight = height;
+	m_pyramidWidth = FloorPowerOfTwo(width);
+	m_pyramidHeight = FloorPowerOfTwo(height);
+	m_levelCount = 1;
+	while ((m_pyramidWidth >> m_levelCount) > 0 || (m_pyramidHeight >> m_levelCount) > 0)
+	{
+		m_levelCount++;
+	}
+
+	// creating the textures frees the ones of the previous size
+	glActiveTexture(GL_TEXTURE0 + PYRAMID_TEXTURE_UNIT);
+
+	m_depthTexture.Create();
+	glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+	m_depthTexture.SetLabel("Occluder depth");
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+	m_depthTexture.SetBytes(GpuResources::TextureBytes(GL_DEPTH_COMPONENT32F, width, height));
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	m_pyramidTexture.Create();
+	glBindTexture(GL_TEXTURE_2D, m_pyramidTexture);
+	m_pyramidTexture.SetLabel("Depth pyramid");
+	glTexStorage2D(GL_TEXTURE_2D, m_levelCount, GL_R32F, m_pyramidWidth, m_pyramidHeight);
+	m_pyramidTexture.SetBytes(GpuResources::TextureBytes(GL_R32F, m_pyramidWidth, m_pyramidHeight, m_levelCount));
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Occluder depth framebuffer is incomplete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, m_previousFramebuffer);
+}
+
+/***********************************************************
+ *  BeginOccluderPass()
+ *
+ *  Remembers the current framebuffer and viewport, then
+ *  binds the occluder depth target at the same size.
+ ***********************************************************/
+void DepthPyramid::BeginOccluderPass()
+{
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+
+	Resize(m_previousViewport[2], m_previousViewport[3]);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, m_depthWidth, m_depthHeight);
+	glDepthMask(GL_TRUE);
+	glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+/***********************************************************
+ *  EndOccluderPass()
+ *
+ *  Switches back to the framebuffer and viewport of the
+ *  scene and builds the pyramid from the occluder depth.
+ ***********************************************************/
+void DepthPyramid::EndOccluderPass()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_previousFramebuffer);
+	glViewport(m_previousViewport[0], m_previousViewport[1], m_previousViewport[2], m_previousViewport[3]);
+
+	BuildLevels();
+}
+
+/***********************************************************
+ *  BuildLevels()
+ *
+ *  Level 0 is reduced from the occluder depth texture, then
+ *  every further level from the level before it. A barrier
+ *  between the dispatches makes each level visible to the
+ *  next one, and the last barrier to the culling pass.
+ ***********************************************************/
+void DepthPyramid::BuildLevels()
+{
+	glUseProgram(m_program);
+	GLint sourceSizeLocation = glGetUniformLocation(m_program, "sourceSize");
+	GLint destinationSizeLocation = glGetUniformLocation(m_program, "destinationSize");
+	GLint readDepthLocation = glGetUniformLocation(m_program, "bReadDepth");
+
+	glActiveTexture(GL_TEXTURE0 + PYRAMID_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+	RenderStats::Frame().programBinds++;
+	RenderStats::Frame().textureBinds += 2;
+
+	int sourceWidth = m_depthWidth;
+	int sourceHeight = m_depthHeight;
+	for (int level = 0; level < m_levelCount; level++)
+	{
+		int width = (m_pyramidWidth >> level) > 0 ? (m_pyramidWidth >> level) : 1;
+		int height = (m_pyramidHeight >> level) > 0 ? (m_pyramidHeight >> level) : 1;
+
+		if (level > 0)
+		{
+			glBindImageTexture(0, m_pyramidTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		}
+		glBindImageTexture(1, m_pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glUniform2i(sourceSizeLocation, sourceWidth, sourceHeight);
+		glUniform2i(destinationSizeLocation, width, height);
+		glUniform1i(readDepthLocation, (level == 0) ? 1 : 0);
+		RenderStats::Frame().uniformCalls += 3;
+
+		glDispatchCompute(
+			(width + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE,
+			(height + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		sourceWidth = width;
+		sourceHeight = height;
+	}
+
+	// leave the pyramid bound for the culling pass
+	glBindTexture(GL_TEXTURE_2D, m_pyramidTexture);
+	glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GpuResources.h"
+
+/***********************************************************
+ *  DepthPyramid
+ *
+ *  A hierarchical depth buffer for occlusion culling. The
+ *  occluders of the frame are drawn depth only into the
+ *  pyramid's own depth texture, which is then reduced into
+ *  a mip chain where every texel keeps the farthest depth of
+ *  the area it covers. A draw whose nearest depth is behind
+ *  that value is fully hidden by the occluders.
+ ***********************************************************/
+class DepthPyramid
+{
+public:
+	// texture unit the pyramid is sampled from - above the scene's
+	// texture slots so the bound scene textures are left alone
+	static const GLuint PYRAMID_TEXTURE_UNIT = 16;
+
+	// constructor
+	DepthPyramid();
+	// destructor - frees the framebuffer, the handles free the textures
+	// and the program
+	~DepthPyramid();
+
+	// load the reduction compute shader
+	bool Initialize();
+
+	// bind the occluder depth target, sized to the current viewport,
+	// and clear it - the occluders are drawn next
+	void BeginOccluderPass();
+	// restore the previous framebuffer and viewport, then reduce the
+	// occluder depth into the pyramid levels
+	void EndOccluderPass();
+
+	// the R32F pyramid texture with all its levels
+	GLuint GetTexture() const { return m_pyramidTexture; }
+
+private:
+	// recreate the textures when the viewport size changes
+	void Resize(int width, int height);
+	// run the reduction compute shader once per pyramid level
+	void BuildLevels();
+
+	GpuProgram m_program;
+	GLuint m_framebuffer;
+	GpuTexture m_depthTexture;
+	GpuTexture m_pyramidTexture;
+	int m_depthWidth;
+	int m_depthHeight;
+	int m_pyramidWidth;
+	int m_pyramidHeight;
+	int m_levelCount;
+	GLint m_previousFramebuffer;
+	GLint m_previousViewport[4];
+};
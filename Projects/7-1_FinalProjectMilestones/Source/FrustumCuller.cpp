@@ -0,0 +1,98 @@
+#include "FrustumCuller.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  ExtractPlanes()
+ *
+ *  Reads the frustum planes straight out of the rows of the
+ *  combined matrix (left, right, bottom, top, near, far).
+ ***********************************************************/
+void FrustumCuller::ExtractPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+{
+	// glm matrices are column major, so gather the rows first
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+	{
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row],
+			viewProjection[2][row], viewProjection[3][row]);
+	}
+
+	planes[0] = rows[3] + rows[0];
+	planes[1] = rows[3] - rows[0];
+	planes[2] = rows[3] + rows[1];
+	planes[3] = rows[3] - rows[1];
+	planes[4] = rows[3] + rows[2];
+	planes[5] = rows[3] - rows[2];
+
+	for (int i = 0; i < 6; i++)
+	{
+		planes[i] /= glm::length(glm::vec3(planes[i]));
+	}
+}
+
+/***********************************************************
+ *  TransformSphere()
+ *
+ *  Moves a bounding sphere by the model matrix. Non uniform
+ *  scales make the sphere an ellipsoid, so the largest axis
+ *  scale is used to keep it conservative.
+ ***********************************************************/
+glm::vec4 FrustumCuller::TransformSphere(const glm::vec4& bounds, const glm::mat4& model)
+{
+	glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(bounds), 1.0f));
+	float scale = std::max(glm::length(glm::vec3(model[0])),
+		std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+	return glm::vec4(center, bounds.w * scale);
+}
+
+/***********************************************************
+ *  IsSphereVisible()
+ *
+ *  A sphere is culled once it lies fully behind any one of
+ *  the planes.
+ ***********************************************************/
+bool FrustumCuller::IsSphereVisible(const glm::vec4 planes[6], const glm::vec4& sphere)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		if (glm::dot(glm::vec3(planes[i]), glm::vec3(sphere)) + planes[i].w < -sphere.w)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/***********************************************************
+ *  CullRecords()
+ *
+ *  Compacts the visible draws to the front of the list in
+ *  their original order, so blending is not affected.
+ ***********************************************************/
+int FrustumCuller::CullRecords(std::vector<ShapeMeshes::DrawRecord>& records, const glm::mat4& viewProjection)
+{
+	glm::vec4 planes[6];
+	ExtractPlanes(viewProjection, planes);
+
+	size_t visible = 0;
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		glm::vec4 sphere = TransformSphere(records[i].bounds, records[i].parameters.model);
+		if (IsSphereVisible(planes, sphere))
+		{
+			if (visible != i)
+			{
+				records[visible] = records[i];
+			}
+			visible++;
+		}
+	}
+
+	int culled = (int)(records.size() - visible);
+	records.resize(visible);
+
+	return culled;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ShapeMeshes.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  FrustumCuller
+ *
+ *  Tests the bounding spheres of recorded draws against the
+ *  view frustum on the CPU. This is the fallback used when
+ *  the scene is drawn on the immediate path, or when the
+ *  context has no compute shaders to cull on the GPU. The
+ *  plane and sphere math matches cullComputeShader.glsl.
+ ***********************************************************/
+class FrustumCuller
+{
+public:
+	// extract the six normalized frustum planes of a combined
+	// projection * view matrix - a point is inside a plane when
+	// dot(plane.xyz, point) + plane.w >= 0
+	static void ExtractPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]);
+
+	// move an object space bounding sphere into world space,
+	// growing the radius by the largest scale of the model matrix
+	static glm::vec4 TransformSphere(const glm::vec4& bounds, const glm::mat4& model);
+
+	// true when any part of the world space sphere is inside the planes
+	static bool IsSphereVisible(const glm::vec4 planes[6], const glm::vec4& sphere);
+
+	// remove the draws outside the frustum, keeping the order of the
+	// remaining draws - returns the number of culled draws
+	static int CullRecords(std::vector<ShapeMeshes::DrawRecord>& records, const glm::mat4& viewProjection);
+};
@@ -0,0 +1,338 @@
+#include "GpuTimers.h"
+
+#include <algorithm>
+#include <cstring>
+
+/***********************************************************
+ *  GpuTimers()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GpuTimers::GpuTimers()
+{
+	for (int i = 0; i < FRAME_LATENCY; i++)
+	{
+		m_frames[i].usedQueries = 0;
+	}
+	m_currentFrame = 0;
+	m_bFrameOpen = false;
+	m_droppedFrames = 0;
+}
+
+/***********************************************************
+ *  ~GpuTimers()
+ *
+ *  The destructor frees the queries of every frame.
+ ***********************************************************/
+GpuTimers::~GpuTimers()
+{
+	for (int i = 0; i < FRAME_LATENCY; i++)
+	{
+		if (m_frames[i].queryPool.empty() == false)
+		{
+			glDeleteQueries((GLsizei)m_frames[i].queryPool.size(), m_frames[i].queryPool.data());
+		}
+	}
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  Timestamp queries are core in 3.3.
+ ***********************************************************/
+bool GpuTimers::IsSupported()
+{
+	return (GLEW_VERSION_3_3 != 0) || (GLEW_ARB_timer_query != 0);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  Moves on to the oldest frame of the ring and adds its
+ *  times to the histories before its queries are reused.
+ ***********************************************************/
+void GpuTimers::BeginFrame()
+{
+	if (m_bFrameOpen == true)
+	{
+		EndFrame();
+	}
+
+	m_currentFrame = (m_currentFrame + 1) % FRAME_LATENCY;
+	FrameQueries& frame = m_frames[m_currentFrame];
+	ReadFrame(frame);
+	frame.usedQueries = 0;
+	frame.scopes.clear();
+	m_openScopes.clear();
+	m_bFrameOpen = true;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  Closes any scope left open, so the frame can be read.
+ ***********************************************************/
+void GpuTimers::EndFrame()
+{
+	while (m_openScopes.empty() == false)
+	{
+		EndScope();
+	}
+	m_bFrameOpen = false;
+}
+
+/***********************************************************
+ *  BeginScope()
+ *
+ *  Writes the start timestamp of a scope. Scopes outside of
+ *  a frame are ignored.
+ ***********************************************************/
+void GpuTimers::BeginScope(const char* name)
+{
+	if (m_bFrameOpen == false)
+	{
+		return;
+	}
+
+	FrameQueries& frame = m_frames[m_currentFrame];
+	ScopeQuery scope;
+	scope.scope = FindScope(name);
+	scope.startQuery = NextQuery(frame);
+	scope.endQuery = NextQuery(frame);
+	glQueryCounter(scope.startQuery, GL_TIMESTAMP);
+
+	m_openScopes.push_back(frame.scopes.size());
+	frame.scopes.push_back(scope);
+}
+
+/***********************************************************
+ *  EndScope()
+ *
+ *  Writes the end timestamp of the innermost open scope.
+ ***********************************************************/
+void GpuTimers::EndScope()
+{
+	if (m_openScopes.empty() == true)
+	{
+		return;
+	}
+
+	FrameQueries& frame = m_frames[m_currentFrame];
+	glQueryCounter(frame.scopes[m_openScopes.back()].endQuery, GL_TIMESTAMP);
+	m_openScopes.pop_back();
+}
+
+/***********************************************************
+ *  FindScope()
+ *
+ *  The scopes are few, so a linear search is enough. A new
+ *  scope takes the depth it is first seen at.
+ ***********************************************************/
+int GpuTimers::FindScope(const char* name)
+{
+	for (size_t i = 0; i < m_histories.size(); i++)
+	{
+		if (strcmp(m_histories[i].name.c_str(), name) == 0)
+		{
+			return (int)i;
+		}
+	}
+
+	ScopeHistory history;
+	history.name = name;
+	history.depth = (int)m_openScopes.size();
+	history.milliseconds.reserve(ROLLING_FRAMES);
+	history.nextSample = 0;
+	history.lastMilliseconds = 0.0;
+	m_histories.push_back(history);
+	return (int)m_histories.size() - 1;
+}
+
+/***********************************************************
+ *  NextQuery()
+ *
+ *  The pools only grow, up to the most scopes of a frame.
+ ***********************************************************/
+GLuint GpuTimers::NextQuery(FrameQueries& frame)
+{
+	if (frame.usedQueries == frame.queryPool.size())
+	{
+		GLuint query = 0;
+		glGenQueries(1, &query);
+		frame.queryPool.push_back(query);
+	}
+	return frame.queryPool[frame.usedQueries++];
+}
+
+/***********************************************************
+ *  ReadFrame()
+ *
+ *  Adds the times of a frame submitted FRAME_LATENCY frames
+ *  ago. The timestamps are written in order, so when the
+ *  last one is available every one is. A scope timed more
+ *  than once in the frame adds up to one sample.
+ ***********************************************************/
+void GpuTimers::ReadFrame(FrameQueries& frame)
+{
+	if (frame.scopes.empty() == true)
+	{
+		return;
+	}
+
+	GLuint available = 0;
+	glGetQueryObjectuiv(frame.queryPool[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available == 0)
+	{
+		// waiting here would stall the frame, so the times are lost
+		m_droppedFrames++;
+		return;
+	}
+
+	std::vector<double> frameTimes(m_histories.size(), -1.0);
+	for (size_t i = 0; i < frame.scopes.size(); i++)
+	{
+		GLuint64 start = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(frame.scopes[i].startQuery, GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(frame.scopes[i].endQuery, GL_QUERY_RESULT, &end);
+		double& time = frameTimes[frame.scopes[i].scope];
+		time = std::max(time, 0.0) + (end - start) / 1.0e6;
+	}
+
+	for (size_t i = 0; i < m_histories.size(); i++)
+	{
+		if (frameTimes[i] < 0.0)
+		{
+			continue;
+		}
+		ScopeHistory& history = m_histories[i];
+		if (history.milliseconds.size() < ROLLING_FRAMES)
+		{
+			history.milliseconds.push_back(frameTimes[i]);
+		}
+		else
+		{
+			history.milliseconds[history.nextSample] = frameTimes[i];
+		}
+		history.nextSample = (history.nextSample + 1) % ROLLING_FRAMES;
+		history.lastMilliseconds = frameTimes[i];
+	}
+}
+
+/***********************************************************
+ *  BuildStats()
+ *
+ *  Sums up the rolling window of a scope.
+ ***********************************************************/
+GpuTimers::ScopeStats GpuTimers::BuildStats(const ScopeHistory& history) const
+{
+	ScopeStats stats;
+	stats.name = history.name;
+	stats.depth = history.depth;
+	stats.samples = (int)history.milliseconds.size();
+	stats.lastMilliseconds = history.lastMilliseconds;
+	stats.averageMilliseconds = 0.0;
+	stats.minMilliseconds = 0.0;
+	stats.maxMilliseconds = 0.0;
+	if (stats.samples == 0)
+	{
+		return stats;
+	}
+
+	stats.minMilliseconds = history.milliseconds[0];
+	stats.maxMilliseconds = history.milliseconds[0];
+	double total = 0.0;
+	for (double time : history.milliseconds)
+	{
+		total += time;
+		stats.minMilliseconds = std::min(stats.minMilliseconds, time);
+		stats.maxMilliseconds = std::max(stats.maxMilliseconds, time);
+	}
+	stats.averageMilliseconds = total / stats.samples;
+	return stats;
+}
+
+/***********************************************************
+ *  GetStats()
+ *
+ *  The statistics of every scope seen so far.
+ ***********************************************************/
+std::vector<GpuTimers::ScopeStats> GpuTimers::GetStats() const
+{
+	std::vector<ScopeStats> stats;
+	stats.reserve(m_histories.size());
+	for (size_t i = 0; i < m_histories.size(); i++)
+	{
+		stats.push_back(BuildStats(m_histories[i]));
+	}
+	return stats;
+}
+
+/***********************************************************
+ *  FindStats()
+ *
+ *  The statistics of the named scope.
+ ***********************************************************/
+bool GpuTimers::FindStats(const std::string& name, ScopeStats& stats) const
+{
+	for (size_t i = 0; i < m_histories.size(); i++)
+	{
+		if (m_histories[i].name == name)
+		{
+			stats = BuildStats(m_histories[i]);
+			return true;
+		}
+	}
+	return false;
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  One line per scope, indented by its nesting depth.
+ ***********************************************************/
+void GpuTimers::PrintReport(std::ostream& output) const
+{
+	output << "INFO: GPU times over the last " << ROLLING_FRAMES << " frames (avg / min / max ms)";
+	if (m_droppedFrames > 0)
+	{
+		output << ", " << m_droppedFrames << " frames not ready in time";
+	}
+	output << "\n";
+
+	std::vector<ScopeStats> stats = GetStats();
+	for (size_t i = 0; i < stats.size(); i++)
+	{
+		output << "  " << std::string(stats[i].depth * 2, ' ') << stats[i].name << ": "
+			<< stats[i].averageMilliseconds << " / " << stats[i].minMilliseconds << " / "
+			<< stats[i].maxMilliseconds << "\n";
+	}
+	output.flush();
+}
+
+/***********************************************************
+ *  WriteJsonReport()
+ *
+ *  The same statistics as one JSON object.
+ ***********************************************************/
+void GpuTimers::WriteJsonReport(std::ostream& output) const
+{
+	std::vector<ScopeStats> stats = GetStats();
+	output << "{\n";
+	output << "  \"rolling_frames\": " << ROLLING_FRAMES << ",\n";
+	output << "  \"dropped_frames\": " << m_droppedFrames << ",\n";
+	output << "  \"scopes\": [\n";
+	for (size_t i = 0; i < stats.size(); i++)
+	{
+		output << "    { \"name\": \"" << stats[i].name << "\""
+			<< ", \"depth\": " << stats[i].depth
+			<< ", \"samples\": " << stats[i].samples
+			<< ", \"last_ms\": " << stats[i].lastMilliseconds
+			<< ", \"avg_ms\": " << stats[i].averageMilliseconds
+			<< ", \"min_ms\": " << stats[i].minMilliseconds
+			<< ", \"max_ms\": " << stats[i].maxMilliseconds << " }"
+			<< ((i + 1 < stats.size()) ? "," : "") << "\n";
+	}
+	output << "  ]\n";
+	output << "}\n";
+}
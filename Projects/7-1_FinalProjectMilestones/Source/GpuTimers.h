@@ -0,0 +1,142 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  GpuTimers
+ *
+ *  Measures the GPU time of named scopes of the frame, like
+ *  the render passes and the scene objects. Each scope is a
+ *  pair of timestamp queries, so the scopes can nest, and
+ *  the queries of a frame are read back FRAME_LATENCY frames
+ *  later, when the GPU has long finished them, so reading
+ *  never stalls the frame. Every scope keeps the times of
+ *  its last ROLLING_FRAMES frames for the statistics.
+ ***********************************************************/
+class GpuTimers
+{
+public:
+	// frames in flight before the queries of a frame are read
+	static const int FRAME_LATENCY = 3;
+	// frames the rolling statistics cover
+	static const int ROLLING_FRAMES = 120;
+
+	// the rolling statistics of one scope
+	struct ScopeStats
+	{
+		std::string name;
+		// nesting depth of the scope when it was first seen
+		int depth;
+		int samples;
+		double lastMilliseconds;
+		double averageMilliseconds;
+		double minMilliseconds;
+		double maxMilliseconds;
+	};
+
+	// constructor
+	GpuTimers();
+	// destructor - frees the queries
+	~GpuTimers();
+
+	// true when the context has timestamp queries
+	static bool IsSupported();
+
+	// start a frame - reads back the oldest frame in flight
+	void BeginFrame();
+	void EndFrame();
+
+	// time the GPU work between the calls under the passed name - the
+	// names of a frame should be string literals or outlive the frame
+	void BeginScope(const char* name);
+	void EndScope();
+
+	// the statistics of every scope in the order they were first seen
+	std::vector<ScopeStats> GetStats() const;
+	// the statistics of one scope - false when it was never timed
+	bool FindStats(const std::string& name, ScopeStats& stats) const;
+
+	// print the statistics as an indented list, or write them as JSON
+	void PrintReport(std::ostream& output) const;
+	void WriteJsonReport(std::ostream& output) const;
+
+private:
+	// one timed scope of a frame and its two timestamp queries
+	struct ScopeQuery
+	{
+		int scope;
+		GLuint startQuery;
+		GLuint endQuery;
+	};
+
+	// the queries of one frame in flight
+	struct FrameQueries
+	{
+		std::vector<GLuint> queryPool;
+		size_t usedQueries;
+		std::vector<ScopeQuery> scopes;
+	};
+
+	// the times of one scope over the last ROLLING_FRAMES frames
+	struct ScopeHistory
+	{
+		std::string name;
+		int depth;
+		std::vector<double> milliseconds;
+		size_t nextSample;
+		double lastMilliseconds;
+	};
+
+	// the history index of a scope name, added on first use
+	int FindScope(const char* name);
+	// the next free query of the frame, growing the pool as needed
+	GLuint NextQuery(FrameQueries& frame);
+	// add the times of a finished frame to the histories
+	void ReadFrame(FrameQueries& frame);
+	ScopeStats BuildStats(const ScopeHistory& history) const;
+
+	FrameQueries m_frames[FRAME_LATENCY];
+	int m_currentFrame;
+	bool m_bFrameOpen;
+	// the scopes begun and not yet ended in the current frame
+	std::vector<size_t> m_openScopes;
+	std::vector<ScopeHistory> m_histories;
+	// frames whose results were not ready after FRAME_LATENCY frames
+	int m_droppedFrames;
+};
+
+/***********************************************************
+ *  GpuTimerScope
+ *
+ *  Times the GPU work of a C++ scope - does nothing when the
+ *  timers are NULL, so the callers can pass NULL while the
+ *  timers are off.
+ ***********************************************************/
+class GpuTimerScope
+{
+public:
+	GpuTimerScope(GpuTimers* pTimers, const char* name) : m_pTimers(pTimers)
+	{
+		if (NULL != m_pTimers)
+		{
+			m_pTimers->BeginScope(name);
+		}
+	}
+	~GpuTimerScope()
+	{
+		if (NULL != m_pTimers)
+		{
+			m_pTimers->EndScope();
+		}
+	}
+
+private:
+	GpuTimers* m_pTimers;
+
+	GpuTimerScope(const GpuTimerScope&);
+	GpuTimerScope& operator=(const GpuTimerScope&);
+};
@@ -0,0 +1,644 @@
+#include "IndirectRenderer.h"
+#include "FrustumCuller.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+	const char* g_IndirectVertexShader = "shaders/indirectVertexShader.glsl";
+	const char* g_IndirectFragmentShader = "shaders/indirectFragmentShader.glsl";
+	const char* g_CullComputeShader = "shaders/cullComputeShader.glsl";
+	const char* g_DepthVertexShader = "shaders/depthVertexShader.glsl";
+	const char* g_DepthFragmentShader = "shaders/depthFragmentShader.glsl";
+}
+
+/***********************************************************
+ *  IndirectRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+IndirectRenderer::IndirectRenderer()
+{
+	m_pShaderManager = NULL;
+	m_pMeshes = NULL;
+	m_pDepthPyramid = NULL;
+	m_bDrawCountSupported = false;
+	for (int i = 0; i <= SEGMENT_COUNT; i++)
+	{
+		m_segmentStarts[i] = 0;
+	}
+	m_bCulledDraws = false;
+	m_drawCapacity = 0;
+	for (int i = 0; i < SEGMENT_COUNT; i++)
+	{
+		m_segmentTriangles[i] = 0;
+	}
+	for (int i = 0; i < COUNT_READBACK_LATENCY; i++)
+	{
+		m_countReadbacks[i].fence = NULL;
+	}
+	m_nextCountReadback = 0;
+	m_visibleDrawCount = -1;
+	m_occludedDrawCount = -1;
+}
+
+/***********************************************************
+ *  ~IndirectRenderer()
+ *
+ *  The destructor frees the depth pyramid - the programs,
+ *  buffers and the vertex array are freed by their handles.
+ ***********************************************************/
+IndirectRenderer::~IndirectRenderer()
+{
+	if (NULL != m_pShaderManager)
+	{
+		delete m_pShaderManager;
+		m_pShaderManager = NULL;
+	}
+	if (NULL != m_pDepthPyramid)
+	{
+		delete m_pDepthPyramid;
+		m_pDepthPyramid = NULL;
+	}
+	for (int i = 0; i < COUNT_READBACK_LATENCY; i++)
+	{
+		if (NULL != m_countReadbacks[i].fence)
+		{
+			glDeleteSync(m_countReadbacks[i].fence);
+			m_countReadbacks[i].fence = NULL;
+		}
+	}
+	m_pMeshes = NULL;
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  The indirect path needs multi-draw indirect and shader
+ *  storage buffers, which are core from OpenGL 4.3. The
+ *  3.3 contexts created on macOS always use the immediate
+ *  path.
+ ***********************************************************/
+bool IndirectRenderer::IsSupported()
+{
+	return (GLEW_VERSION_4_3 != 0) ||
+		((GLEW_ARB_multi_draw_indirect != 0) &&
+		 (GLEW_ARB_shader_storage_buffer_object != 0) &&
+		 (GLEW_ARB_base_instance != 0));
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Loads the indirect shader program and creates a vertex
+ *  array over the shared mesh buffers. Besides the standard
+ *  vertex layout the vertex array has an instanced draw
+ *  index attribute - with a divisor of 1 each command reads
+ *  its value at baseInstance, which is set to the index of
+ *  the draw. This gives the vertex shader its draw index
+ *  without needing gl_DrawID or gl_BaseInstance.
+ ***********************************************************/
+bool IndirectRenderer::Initialize(ShapeMeshes* pMeshes, int textureSlots)
+{
+	if (IsSupported() == false)
+	{
+		std::cout << "Multi-draw indirect is not supported by this OpenGL context" << std::endl;
+		return false;
+	}
+
+	m_pMeshes = pMeshes;
+	m_pShaderManager = new ShaderManager();
+	m_program.Adopt(m_pShaderManager->LoadShaders(g_IndirectVertexShader, g_IndirectFragmentShader));
+	if (0 == m_program)
+	{
+		return false;
+	}
+	m_program.SetLabel("Indirect scene");
+
+	// each texture slot sampler reads the texture unit of its slot
+	m_pShaderManager->use();
+	for (int i = 0; i < textureSlots; i++)
+	{
+		m_pShaderManager->setSampler2DValue("sceneTextures[" + std::to_string(i) + "]", i);
+	}
+
+	m_pMeshes->UpdateSharedBuffers();
+
+	m_commandBuffer.Create();
+	m_drawParameterBuffer.Create();
+	m_drawIndexBuffer.Create();
+
+	m_vertexArray.Create();
+	glBindVertexArray(m_vertexArray);
+	m_vertexArray.SetLabel("Indirect draws");
+	m_pMeshes->SetupSharedVertexArray();
+	glBindBuffer(GL_ARRAY_BUFFER, m_drawIndexBuffer);
+	glVertexAttribIPointer(DRAW_INDEX_ATTRIBUTE, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+	glVertexAttribDivisor(DRAW_INDEX_ATTRIBUTE, 1);
+	glEnableVertexAttribArray(DRAW_INDEX_ATTRIBUTE);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// compute shaders are core in 4.3, but the indirect path may also
+	// run on the extensions alone - culling then falls back to the CPU
+	if ((GLEW_VERSION_4_3 != 0) || (GLEW_ARB_compute_shader != 0))
+	{
+		ShaderManager cullShader;
+		m_cullProgram.Adopt(cullShader.LoadComputeShader(g_CullComputeShader));
+		m_cullProgram.SetLabel("Draw culling");
+	}
+	if (0 != m_cullProgram)
+	{
+		m_cullInputBuffer.Create();
+		m_drawCountBuffer.Create();
+		// the visible and the occluded draw counts of each segment
+		GLuint counts[SEGMENT_COUNT * 2] = { 0 };
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawCountBuffer);
+		m_drawCountBuffer.SetLabel("Draw counts");
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(counts), counts, GL_DYNAMIC_COPY);
+		m_drawCountBuffer.SetBytes(sizeof(counts));
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		// the copies of the counts the statistics read back
+		for (int i = 0; i < COUNT_READBACK_LATENCY; i++)
+		{
+			m_countReadbacks[i].buffer.Create();
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_countReadbacks[i].buffer);
+			m_countReadbacks[i].buffer.SetLabel("Draw count readback");
+			glBufferData(GL_COPY_WRITE_BUFFER, sizeof(counts), NULL, GL_STREAM_READ);
+			m_countReadbacks[i].buffer.SetBytes(sizeof(counts));
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		// occlusion culling draws the occluders depth only with the
+		// same vertex array, then tests against their depth pyramid
+		ShaderManager depthShader;
+		m_depthProgram.Adopt(depthShader.LoadShaders(g_DepthVertexShader, g_DepthFragmentShader));
+		m_depthProgram.SetLabel("Occluder depth");
+		m_pDepthPyramid = new DepthPyramid();
+		if ((0 == m_depthProgram) || (m_pDepthPyramid->Initialize() == false))
+		{
+			delete m_pDepthPyramid;
+			m_pDepthPyramid = NULL;
+		}
+		else
+		{
+			m_occluderCommandBuffer.Create();
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_occluderCommandBuffer);
+			m_occluderCommandBuffer.SetLabel("Occluder commands");
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+			glUseProgram(m_cullProgram);
+			glUniform1i(glGetUniformLocation(m_cullProgram, "depthPyramid"), DepthPyramid::PYRAMID_TEXTURE_UNIT);
+		}
+	}
+	// with a draw count the GPU skips the culled commands entirely,
+	// otherwise the zeroed tail of the command buffer is drawn
+	m_bDrawCountSupported = (GLEW_VERSION_4_6 != 0) || (GLEW_ARB_indirect_parameters != 0);
+
+	return true;
+}
+
+/***********************************************************
+ *  ReserveDraws()
+ *
+ *  Grows the command, parameter and draw index buffers. The
+ *  draw index buffer simply counts up from 0, so it only has
+ *  to be written when it grows.
+ ***********************************************************/
+void IndirectRenderer::ReserveDraws(size_t drawCount)
+{
+	if (drawCount <= m_drawCapacity)
+	{
+		return;
+	}
+
+	size_t capacity = (m_drawCapacity > 0) ? m_drawCapacity : 256;
+	while (capacity < drawCount)
+	{
+		capacity *= 2;
+	}
+
+	std::vector<GLuint> drawIndices(capacity);
+	for (size_t i = 0; i < capacity; i++)
+	{
+		drawIndices[i] = (GLuint)i;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, m_drawIndexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLuint) * capacity, drawIndices.data(), GL_STATIC_DRAW);
+	m_drawIndexBuffer.SetBytes(sizeof(GLuint) * capacity);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * capacity, NULL, GL_DYNAMIC_DRAW);
+	m_commandBuffer.SetBytes(sizeof(DrawElementsIndirectCommand) * capacity);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawParameterBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(ShaderManager::DrawParameters) * capacity, NULL, GL_DYNAMIC_DRAW);
+	m_drawParameterBuffer.SetBytes(sizeof(ShaderManager::DrawParameters) * capacity);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	if (0 != m_cullInputBuffer)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_cullInputBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(CullInput) * capacity, NULL, GL_DYNAMIC_DRAW);
+		m_cullInputBuffer.SetBytes(sizeof(CullInput) * capacity);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	// the buffers only exist once bound, so they are labeled when
+	// they are first sized
+	if (0 == m_drawCapacity)
+	{
+		m_drawIndexBuffer.SetLabel("Draw indices");
+		m_commandBuffer.SetLabel("Draw commands");
+		m_drawParameterBuffer.SetLabel("Draw parameters");
+		m_cullInputBuffer.SetLabel("Cull inputs");
+	}
+
+	m_drawCapacity = capacity;
+}
+
+/***********************************************************
+ *  SetCamera()
+ *
+ *  Sets the camera uniforms of the lit indirect program and
+ *  of the depth only program used for the occluders and the
+ *  depth pre-pass.
+ ***********************************************************/
+void IndirectRenderer::SetCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position)
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("view", view);
+	m_pShaderManager->setMat4Value("projection", projection);
+	m_pShaderManager->setVec3Value("viewPosition", position);
+
+	if (0 != m_depthProgram)
+	{
+		glUseProgram(m_depthProgram);
+		glUniformMatrix4fv(glGetUniformLocation(m_depthProgram, "view"), 1, GL_FALSE, &view[0][0]);
+		glUniformMatrix4fv(glGetUniformLocation(m_depthProgram, "projection"), 1, GL_FALSE, &projection[0][0]);
+	}
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  Writes one parameter entry per record and draws all of
+ *  them with a single call.
+ ***********************************************************/
+void IndirectRenderer::Submit(const std::vector<ShapeMeshes::DrawRecord>& records,
+	const glm::mat4* pCullViewProjection, bool bOcclusionCulling)
+{
+	PrepareDraws(records, pCullViewProjection, bOcclusionCulling, records.size());
+	DrawOpaque();
+}
+
+/***********************************************************
+ *  PrepareDraws()
+ *
+ *  Writes one parameter entry per record and the indirect
+ *  commands of both segments. Without culling the commands
+ *  are written on the CPU. With culling the compute shader
+ *  writes the commands of the visible draws instead.
+ ***********************************************************/
+void IndirectRenderer::PrepareDraws(const std::vector<ShapeMeshes::DrawRecord>& records,
+	const glm::mat4* pCullViewProjection, bool bOcclusionCulling, size_t opaqueDrawCount)
+{
+	m_segmentStarts[OPAQUE_SEGMENT] = 0;
+	m_segmentStarts[TRANSLUCENT_SEGMENT] = std::min(opaqueDrawCount, records.size());
+	m_segmentStarts[SEGMENT_COUNT] = records.size();
+	m_bCulledDraws = false;
+	for (int segment = 0; segment < SEGMENT_COUNT; segment++)
+	{
+		m_segmentTriangles[segment] = 0;
+		for (size_t i = m_segmentStarts[segment]; i < m_segmentStarts[segment + 1]; i++)
+		{
+			m_segmentTriangles[segment] += records[i].indexCount / 3;
+		}
+	}
+
+	if (records.empty() || (NULL == m_pShaderManager))
+	{
+		return;
+	}
+
+	bool bCull = (NULL != pCullViewProjection) && (0 != m_cullProgram);
+
+	m_pMeshes->UpdateSharedBuffers();
+	ReserveDraws(records.size());
+
+	m_drawParameters.resize(records.size());
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		m_drawParameters[i] = records[i].parameters;
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawParameterBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+		sizeof(ShaderManager::DrawParameters) * m_drawParameters.size(), m_drawParameters.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	RenderStats::Frame().bufferUploads++;
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_BLOCK_BINDING, m_drawParameterBuffer);
+
+	if (bCull == true)
+	{
+		m_cullInputs.resize(records.size());
+		for (size_t i = 0; i < records.size(); i++)
+		{
+			m_cullInputs[i].bounds = records[i].bounds;
+			m_cullInputs[i].extents = glm::vec4(records[i].extents, 0.0f);
+			m_cullInputs[i].count = records[i].indexCount;
+			m_cullInputs[i].firstIndex = records[i].firstIndex;
+			m_cullInputs[i].baseVertex = records[i].baseVertex;
+			m_cullInputs[i].padding = 0;
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_cullInputBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(CullInput) * m_cullInputs.size(), m_cullInputs.data());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		RenderStats::Frame().bufferUploads++;
+
+		bool bOcclusion = (bOcclusionCulling == true) && (NULL != m_pDepthPyramid) &&
+			RenderOccluders(records);
+		CullDraws(*pCullViewProjection, bOcclusion);
+		QueueCountReadback();
+		m_bCulledDraws = true;
+	}
+	else
+	{
+		m_commands.resize(records.size());
+		for (size_t i = 0; i < records.size(); i++)
+		{
+			m_commands[i].count = records[i].indexCount;
+			m_commands[i].instanceCount = 1;
+			m_commands[i].firstIndex = records[i].firstIndex;
+			m_commands[i].baseVertex = records[i].baseVertex;
+			m_commands[i].baseInstance = (GLuint)i;
+		}
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0,
+			sizeof(DrawElementsIndirectCommand) * m_commands.size(), m_commands.data());
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		RenderStats::Frame().bufferUploads++;
+	}
+}
+
+/***********************************************************
+ *  DrawOpaqueDepth()
+ *
+ *  Draws the prepared opaque segment with the depth only
+ *  program for the depth pre-pass.
+ ***********************************************************/
+void IndirectRenderer::DrawOpaqueDepth()
+{
+	DrawSegment(OPAQUE_SEGMENT, m_depthProgram);
+}
+
+/***********************************************************
+ *  DrawOpaque()
+ *
+ *  Draws the prepared opaque segment with the lit program.
+ ***********************************************************/
+void IndirectRenderer::DrawOpaque()
+{
+	DrawSegment(OPAQUE_SEGMENT, (NULL != m_pShaderManager) ? m_pShaderManager->m_programID : 0);
+}
+
+/***********************************************************
+ *  DrawTranslucent()
+ *
+ *  Draws the prepared translucent segment with the lit
+ *  program.
+ ***********************************************************/
+void IndirectRenderer::DrawTranslucent()
+{
+	DrawSegment(TRANSLUCENT_SEGMENT, (NULL != m_pShaderManager) ? m_pShaderManager->m_programID : 0);
+}
+
+/***********************************************************
+ *  DrawOpaqueWith()
+ *
+ *  Draws the prepared opaque segment with the passed program.
+ ***********************************************************/
+void IndirectRenderer::DrawOpaqueWith(GLuint programID)
+{
+	DrawSegment(OPAQUE_SEGMENT, programID);
+}
+
+/***********************************************************
+ *  DrawSegment()
+ *
+ *  Draws the commands of one segment with a single call.
+ *  The culled commands of a segment are compacted to its
+ *  start, so with a draw count only the visible ones are
+ *  drawn, and without it the zeroed rest draws nothing.
+ ***********************************************************/
+void IndirectRenderer::DrawSegment(int segment, GLuint programID)
+{
+	GLsizei drawCount = (GLsizei)(m_segmentStarts[segment + 1] - m_segmentStarts[segment]);
+	if ((drawCount == 0) || (0 == programID))
+	{
+		return;
+	}
+
+	const void* pCommands = (const void*)(sizeof(DrawElementsIndirectCommand) * m_segmentStarts[segment]);
+	GLintptr countOffset = sizeof(GLuint) * segment;
+
+	glUseProgram(programID);
+	glBindVertexArray(m_vertexArray);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	if ((m_bCulledDraws == true) && (m_bDrawCountSupported == true))
+	{
+		glBindBuffer(GL_PARAMETER_BUFFER_ARB, m_drawCountBuffer);
+		if (GLEW_VERSION_4_6 != 0)
+		{
+			glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, pCommands, countOffset, drawCount, 0);
+		}
+		else
+		{
+			glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, pCommands, countOffset, drawCount, 0);
+		}
+		glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+	}
+	else
+	{
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, pCommands, drawCount, 0);
+	}
+	// the culled triangles are only known on the GPU, so this counts
+	// every triangle submitted
+	RenderStats& stats = RenderStats::Frame();
+	stats.programBinds++;
+	stats.vertexArrayBinds++;
+	stats.drawCalls++;
+	stats.triangles += m_segmentTriangles[segment];
+	glBindVertexArray(0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+/***********************************************************
+ *  RenderOccluders()
+ *
+ *  Draws the records flagged as occluders depth only into
+ *  the depth pyramid, which is then built from their depth.
+ *  The occluders are drawn in this frame before the culling
+ *  pass, so moving the camera never culls by stale depth.
+ ***********************************************************/
+bool IndirectRenderer::RenderOccluders(const std::vector<ShapeMeshes::DrawRecord>& records)
+{
+	m_occluderCommands.clear();
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		if (((int)records[i].parameters.surface.w & ShaderManager::DRAW_FLAG_OCCLUDER) == 0)
+		{
+			continue;
+		}
+
+		DrawElementsIndirectCommand command;
+		command.count = records[i].indexCount;
+		command.instanceCount = 1;
+		command.firstIndex = records[i].firstIndex;
+		command.baseVertex = records[i].baseVertex;
+		command.baseInstance = (GLuint)i;
+		m_occluderCommands.push_back(command);
+	}
+	if (m_occluderCommands.empty())
+	{
+		return false;
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_occluderCommandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * m_occluderCommands.size(),
+		m_occluderCommands.data(), GL_STREAM_DRAW);
+	m_occluderCommandBuffer.SetBytes(sizeof(DrawElementsIndirectCommand) * m_occluderCommands.size());
+	RenderStats::Frame().bufferUploads++;
+
+	m_pDepthPyramid->BeginOccluderPass();
+	glUseProgram(m_depthProgram);
+	glBindVertexArray(m_vertexArray);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)m_occluderCommands.size(), 0);
+	RenderStats& stats = RenderStats::Frame();
+	stats.programBinds++;
+	stats.vertexArrayBinds++;
+	stats.drawCalls++;
+	for (size_t i = 0; i < m_occluderCommands.size(); i++)
+	{
+		stats.triangles += m_occluderCommands[i].count / 3;
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	m_pDepthPyramid->EndOccluderPass();
+
+	return true;
+}
+
+/***********************************************************
+ *  CullDraws()
+ *
+ *  Runs the culling compute shader over every draw, once
+ *  per segment. One work group handles a whole segment so
+ *  its visible draws can be compacted in order - see
+ *  cullComputeShader.glsl.
+ ***********************************************************/
+void IndirectRenderer::CullDraws(const glm::mat4& viewProjection, bool bOcclusionCulling)
+{
+	glm::vec4 planes[6];
+	FrustumCuller::ExtractPlanes(viewProjection, planes);
+
+	glUseProgram(m_cullProgram);
+	glUniform4fv(glGetUniformLocation(m_cullProgram, "frustumPlanes"), 6, &planes[0][0]);
+	glUniform1i(glGetUniformLocation(m_cullProgram, "bOcclusionCulling"), (bOcclusionCulling == true) ? 1 : 0);
+	glUniformMatrix4fv(glGetUniformLocation(m_cullProgram, "viewProjection"), 1, GL_FALSE, &viewProjection[0][0]);
+	RenderStats::Frame().programBinds++;
+	RenderStats::Frame().uniformCalls += 3;
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_INPUT_BINDING, m_cullInputBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BLOCK_BINDING, m_commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COUNT_BINDING, m_drawCountBuffer);
+	for (int segment = 0; segment < SEGMENT_COUNT; segment++)
+	{
+		if (m_segmentStarts[segment] == m_segmentStarts[segment + 1])
+		{
+			continue;
+		}
+		glUniform1ui(glGetUniformLocation(m_cullProgram, "segment"), (GLuint)segment);
+		glUniform1ui(glGetUniformLocation(m_cullProgram, "segmentStart"), (GLuint)m_segmentStarts[segment]);
+		glUniform1ui(glGetUniformLocation(m_cullProgram, "segmentEnd"), (GLuint)m_segmentStarts[segment + 1]);
+		glDispatchCompute(1, 1, 1);
+		RenderStats::Frame().uniformCalls += 3;
+	}
+
+	// the commands and the count are read by the draw call next,
+	// and the count is copied for the statistics
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+/***********************************************************
+ *  QueueCountReadback()
+ *
+ *  Reads the copies of the draw counts whose fence is
+ *  signaled, oldest first, so the counts never go back in
+ *  time and reading them never waits for the GPU. A copy
+ *  still not done when its slot comes around again is
+ *  dropped. Then the counts of the pass just run are copied
+ *  into that slot, behind a fence of their own.
+ ***********************************************************/
+void IndirectRenderer::QueueCountReadback()
+{
+	for (int i = 0; i < COUNT_READBACK_LATENCY; i++)
+	{
+		CountReadback& readback = m_countReadbacks[(m_nextCountReadback + i) % COUNT_READBACK_LATENCY];
+		if (NULL == readback.fence)
+		{
+			continue;
+		}
+		GLenum status = glClientWaitSync(readback.fence, 0, 0);
+		if ((GL_ALREADY_SIGNALED != status) && (GL_CONDITION_SATISFIED != status))
+		{
+			// the later copies are not done either
+			break;
+		}
+		glDeleteSync(readback.fence);
+		readback.fence = NULL;
+
+		// the visible counts of all segments, then the occluded counts
+		GLuint counts[SEGMENT_COUNT * 2] = { 0 };
+		glBindBuffer(GL_COPY_READ_BUFFER, readback.buffer);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(counts), counts);
+		m_visibleDrawCount = 0;
+		m_occludedDrawCount = 0;
+		for (int segment = 0; segment < SEGMENT_COUNT; segment++)
+		{
+			if (readback.bSegmentCulled[segment] == true)
+			{
+				m_visibleDrawCount += (int)counts[segment];
+				m_occludedDrawCount += (int)counts[SEGMENT_COUNT + segment];
+			}
+		}
+	}
+
+	CountReadback& readback = m_countReadbacks[m_nextCountReadback];
+	if (NULL != readback.fence)
+	{
+		glDeleteSync(readback.fence);
+	}
+	// the segments skipped by the pass keep the counts of an older one
+	for (int segment = 0; segment < SEGMENT_COUNT; segment++)
+	{
+		readback.bSegmentCulled[segment] = (m_segmentStarts[segment] != m_segmentStarts[segment + 1]);
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, m_drawCountBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(GLuint) * SEGMENT_COUNT * 2);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_nextCountReadback = (m_nextCountReadback + 1) % COUNT_READBACK_LATENCY;
+}
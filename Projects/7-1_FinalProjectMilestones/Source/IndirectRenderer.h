@@ -0,0 +1,168 @@
+#pragma once
+
+#include "DepthPyramid.h"
+#include "GpuResources.h"
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+
+#include <vector>
+
+/***********************************************************
+ *  IndirectRenderer
+ *
+ *  Draws a list of recorded mesh draws with a single
+ *  glMultiDrawElementsIndirect call. The per-draw parameters
+ *  of every record are stored in a shader storage buffer and
+ *  each indirect command's baseInstance selects its entry,
+ *  so the whole list needs no state changes between draws.
+ *  The records are drawn in order, so blending behaves the
+ *  same as on the immediate path. For the depth pre-pass the
+ *  records are split into an opaque and a translucent
+ *  segment that are drawn separately.
+ ***********************************************************/
+class IndirectRenderer
+{
+public:
+	// shader storage binding of the per-draw parameter buffer
+	static const GLuint DRAW_BLOCK_BINDING = 2;
+	// vertex attribute holding the draw index of each draw
+	static const GLuint DRAW_INDEX_ATTRIBUTE = 3;
+	// shader storage bindings used by the culling compute shader
+	static const GLuint CULL_INPUT_BINDING = 3;
+	static const GLuint COMMAND_BLOCK_BINDING = 4;
+	static const GLuint DRAW_COUNT_BINDING = 5;
+	// the culling passes a copy of their draw counts may take to
+	// reach the CPU before it is dropped
+	static const int COUNT_READBACK_LATENCY = 3;
+
+	// constructor
+	IndirectRenderer();
+	// destructor - frees the depth pyramid, the handles free the
+	// programs and buffers
+	~IndirectRenderer();
+
+	// true when the context can run the indirect path
+	static bool IsSupported();
+	// true when the draws can be frustum culled by a compute shader
+	bool IsComputeCullingSupported() const { return (0 != m_cullProgram); }
+	// true when the culling pass can also test the depth pyramid
+	bool IsOcclusionCullingSupported() const { return (NULL != m_pDepthPyramid); }
+
+	// load the indirect shaders and create the buffers - the meshes
+	// provide the shared vertex and index buffers that are drawn from
+	bool Initialize(ShapeMeshes* pMeshes, int textureSlots);
+
+	// the shader manager of the indirect program, used to set the
+	// lights uniforms
+	ShaderManager* GetShaderManager() { return m_pShaderManager; }
+	// set the camera of the indirect and the depth only programs
+	void SetCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position);
+
+	// draw every record with one indirect call - leaves the indirect
+	// program active. With a view projection matrix the records are
+	// first frustum culled by the compute shader, and with occlusion
+	// culling also tested against the depth of the occluder draws.
+	void Submit(const std::vector<ShapeMeshes::DrawRecord>& records,
+		const glm::mat4* pCullViewProjection = NULL, bool bOcclusionCulling = false);
+
+	// upload the records and write their commands like Submit(), but
+	// without drawing them. The first opaqueDrawCount records are the
+	// opaque segment and the rest the translucent segment.
+	void PrepareDraws(const std::vector<ShapeMeshes::DrawRecord>& records,
+		const glm::mat4* pCullViewProjection, bool bOcclusionCulling, size_t opaqueDrawCount);
+	// draw the prepared opaque segment depth only
+	void DrawOpaqueDepth();
+	// draw the prepared opaque or translucent segment with the lit
+	// program - leaves the indirect program active
+	void DrawOpaque();
+	void DrawTranslucent();
+	// draw the prepared opaque segment with another program that uses
+	// the indirect vertex shader, like the deferred G-buffer program
+	void DrawOpaqueWith(GLuint programID);
+
+	// the number of draws that survived a recent GPU culling pass and
+	// the number hidden by occluders - the counts are copied and read
+	// back once the GPU is done with them, so they trail the frame by a
+	// pass or two and are -1 until the first copy arrives
+	int GetVisibleDrawCount() const { return m_visibleDrawCount; }
+	int GetOccludedDrawCount() const { return m_occludedDrawCount; }
+
+private:
+	// the layout of one indirect command, defined by OpenGL
+	struct DrawElementsIndirectCommand
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	// per-draw input of the culling compute shader, std430 layout
+	struct CullInput
+	{
+		glm::vec4 bounds;
+		glm::vec4 extents;
+		GLuint count;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint padding;
+	};
+
+	// grow the buffers to hold at least the passed number of draws
+	void ReserveDraws(size_t drawCount);
+	// the opaque and the translucent draw segments
+	static const int OPAQUE_SEGMENT = 0;
+	static const int TRANSLUCENT_SEGMENT = 1;
+	static const int SEGMENT_COUNT = 2;
+
+	// draw the depth of the occluder records into the depth pyramid -
+	// false when the records have no occluders
+	bool RenderOccluders(const std::vector<ShapeMeshes::DrawRecord>& records);
+	// write the visible draw commands of each segment with the compute shader
+	void CullDraws(const glm::mat4& viewProjection, bool bOcclusionCulling);
+	// draw the commands of one segment with the passed program
+	void DrawSegment(int segment, GLuint programID);
+	// read the draw count copies the GPU is done with, then copy the
+	// counts of the culling pass just run
+	void QueueCountReadback();
+
+	// a copy of the draw counts of one culling pass and the fence
+	// that tells when it can be read without waiting
+	struct CountReadback
+	{
+		GpuBuffer buffer;
+		GLsync fence;
+		bool bSegmentCulled[SEGMENT_COUNT];
+	};
+
+	ShaderManager* m_pShaderManager;
+	GpuProgram m_program;
+	ShapeMeshes* m_pMeshes;
+	GpuVertexArray m_vertexArray;
+	GpuBuffer m_commandBuffer;
+	GpuBuffer m_drawParameterBuffer;
+	GpuBuffer m_drawIndexBuffer;
+	GpuBuffer m_cullInputBuffer;
+	GpuBuffer m_drawCountBuffer;
+	GpuProgram m_cullProgram;
+	GpuProgram m_depthProgram;
+	GpuBuffer m_occluderCommandBuffer;
+	DepthPyramid* m_pDepthPyramid;
+	bool m_bDrawCountSupported;
+	// the segments of the prepared draws and whether they were culled
+	size_t m_segmentStarts[SEGMENT_COUNT + 1];
+	bool m_bCulledDraws;
+	size_t m_drawCapacity;
+	// the triangles submitted by each segment, for the frame statistics
+	long long m_segmentTriangles[SEGMENT_COUNT];
+	std::vector<DrawElementsIndirectCommand> m_commands;
+	std::vector<ShaderManager::DrawParameters> m_drawParameters;
+	std::vector<CullInput> m_cullInputs;
+	std::vector<DrawElementsIndirectCommand> m_occluderCommands;
+	// the ring of draw count copies and the counts last read back
+	CountReadback m_countReadbacks[COUNT_READBACK_LATENCY];
+	int m_nextCountReadback;
+	int m_visibleDrawCount;
+	int m_occludedDrawCount;
+};
@@ -0,0 +1,217 @@
+#include "LightLists.h"
+#include "FrustumCuller.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <iostream>
+
+/***********************************************************
+ *  LightLists()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightLists::LightLists()
+{
+	m_drawCount = 0;
+	m_listedLights = 0;
+	m_overflowDraws = 0;
+}
+
+/***********************************************************
+ *  CreateLightBuffer()
+ *
+ *  Creates the uniform buffer of the light table at its
+ *  full std140 size and attaches it to the shader program's
+ *  LightTableBlock. The lights are filled in by SetLights().
+ ***********************************************************/
+bool LightLists::CreateLightBuffer(GLuint programID)
+{
+	if (0 == m_lightBuffer)
+	{
+		m_lightBuffer.Create();
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, m_lightBuffer);
+	m_lightBuffer.SetLabel("Light table");
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(GPULight) * MAX_LIGHTS, NULL, GL_STATIC_DRAW);
+	m_lightBuffer.SetBytes(sizeof(GPULight) * MAX_LIGHTS);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_TABLE_BINDING, m_lightBuffer);
+
+	return BindLightTable(programID);
+}
+
+/***********************************************************
+ *  BindLightTable()
+ *
+ *  Attaches the LightTableBlock of a shader program to the
+ *  light table binding point.
+ ***********************************************************/
+bool LightLists::BindLightTable(GLuint programID)
+{
+	GLuint blockIndex = glGetUniformBlockIndex(programID, "LightTableBlock");
+	if (GL_INVALID_INDEX == blockIndex)
+	{
+		std::cout << "Shader program has no LightTableBlock uniform block" << std::endl;
+		return false;
+	}
+	glUniformBlockBinding(programID, blockIndex, LIGHT_TABLE_BINDING);
+
+	return true;
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  Packs the scene lights into the light table. Lights
+ *  without a falloff get a radius of 0 and are added to
+ *  every draw.
+ ***********************************************************/
+void LightLists::SetLights(const std::vector<LightSource>& lights)
+{
+	size_t lightCount = std::min(lights.size(), (size_t)MAX_LIGHTS);
+	if (lightCount < lights.size())
+	{
+		std::cout << "Light table is full, " << (lights.size() - lightCount)
+			<< " lights are left out of the light lists" << std::endl;
+	}
+
+	m_lights.assign(lights.begin(), lights.begin() + lightCount);
+	m_lightRadii.resize(lightCount);
+	m_lightIntensities.resize(lightCount);
+
+	std::vector<GPULight> gpuLights(lightCount);
+	for (size_t i = 0; i < lightCount; i++)
+	{
+		const LightSource& light = m_lights[i];
+		m_lightRadii[i] = GetLightRadius(light);
+		gpuLights[i] = PackLight(light, m_lightRadii[i]);
+
+		glm::vec3 brightest = glm::max(light.ambient, glm::max(light.diffuse, light.specular));
+		m_lightIntensities[i] = std::max(brightest.r, std::max(brightest.g, brightest.b));
+	}
+
+	if ((0 != m_lightBuffer) && (lightCount > 0))
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_lightBuffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(GPULight) * lightCount, gpuLights.data());
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		RenderStats::Frame().bufferUploads++;
+	}
+}
+
+/***********************************************************
+ *  GetBoxDistance()
+ *
+ *  Measures along each axis of the model matrix how far the
+ *  point is outside the bounding box of the record. The
+ *  objects only use rotations and scales, so the axes stay
+ *  perpendicular.
+ ***********************************************************/
+float LightLists::GetBoxDistance(const ShapeMeshes::DrawRecord& record, const glm::vec3& point)
+{
+	const glm::mat4& model = record.parameters.model;
+	glm::vec3 offset = point - glm::vec3(model * glm::vec4(glm::vec3(record.bounds), 1.0f));
+
+	float distanceSquared = 0.0f;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		glm::vec3 direction = glm::vec3(model[axis]);
+		float scale = glm::length(direction);
+		if (scale <= 0.0f)
+		{
+			continue;
+		}
+		float outside = std::abs(glm::dot(offset, direction) / scale) - (record.extents[axis] * scale);
+		if (outside > 0.0f)
+		{
+			distanceSquared += outside * outside;
+		}
+	}
+
+	return std::sqrt(distanceSquared);
+}
+
+/***********************************************************
+ *  AssignLights()
+ *
+ *  Tests every light against the bounding sphere of every
+ *  record, then against its box. The lights still in range
+ *  are ranked by their attenuated brightness at the nearest
+ *  point of the box, and the brightest ones are packed into
+ *  the record in light order, so the shader sums them up in
+ *  the same order as the forward uniforms.
+ ***********************************************************/
+void LightLists::AssignLights(std::vector<ShapeMeshes::DrawRecord>& records)
+{
+	m_drawCount = (int)records.size();
+	m_listedLights = 0;
+	m_overflowDraws = 0;
+
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		ShapeMeshes::DrawRecord& record = records[i];
+		glm::vec4 sphere = FrustumCuller::TransformSphere(record.bounds, record.parameters.model);
+
+		m_candidates.clear();
+		for (size_t j = 0; j < m_lights.size(); j++)
+		{
+			const LightSource& light = m_lights[j];
+			float radius = m_lightRadii[j];
+			float distance = 0.0f;
+			if (radius > 0.0f)
+			{
+				if (glm::length(light.position - glm::vec3(sphere)) > radius + sphere.w)
+				{
+					continue;
+				}
+				distance = GetBoxDistance(record, light.position);
+				if (distance > radius)
+				{
+					continue;
+				}
+			}
+
+			Candidate candidate;
+			candidate.brightness = m_lightIntensities[j] /
+				(light.constant + (light.linear * distance) + (light.quadratic * distance * distance));
+			candidate.lightIndex = (int)j;
+			m_candidates.push_back(candidate);
+		}
+
+		if ((int)m_candidates.size() > MAX_DRAW_LIGHTS)
+		{
+			std::partial_sort(m_candidates.begin(), m_candidates.begin() + MAX_DRAW_LIGHTS, m_candidates.end(),
+				[](const Candidate& a, const Candidate& b) { return a.brightness > b.brightness; });
+			m_candidates.resize(MAX_DRAW_LIGHTS);
+			std::sort(m_candidates.begin(), m_candidates.end(),
+				[](const Candidate& a, const Candidate& b) { return a.lightIndex < b.lightIndex; });
+			m_overflowDraws++;
+		}
+
+		// index + 1 in the low byte of a component for the even entries
+		// and in the high byte for the odd ones, 0 ends the list
+		glm::vec4 packedLights(0.0f);
+		for (size_t j = 0; j < m_candidates.size(); j++)
+		{
+			float shift = ((j & 1) == 0) ? 1.0f : 256.0f;
+			packedLights[(int)(j / 2)] += (float)(m_candidates[j].lightIndex + 1) * shift;
+		}
+		record.parameters.lights = packedLights;
+		m_listedLights += (int)m_candidates.size();
+	}
+}
+
+/***********************************************************
+ *  GetAverageDrawLights()
+ *
+ *  The average length of the light lists of the last
+ *  assignment.
+ ***********************************************************/
+float LightLists::GetAverageDrawLights() const
+{
+	if (m_drawCount == 0)
+	{
+		return 0.0f;
+	}
+	return (float)m_listedLights / m_drawCount;
+}
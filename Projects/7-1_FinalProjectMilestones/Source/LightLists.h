@@ -0,0 +1,76 @@
+#pragma once
+
+#include "GpuResources.h"
+#include "LightSource.h"
+#include "ShapeMeshes.h"
+
+#include <vector>
+
+/***********************************************************
+ *  LightLists
+ *
+ *  Per-draw light lists for the forward path. Every scene
+ *  light is mirrored into a uniform buffer table, and every
+ *  frame each recorded draw gets the indices of the lights
+ *  whose range reaches its bounds, packed into the lights
+ *  value of its draw parameters. The fragment shader then
+ *  only loops over that short list instead of every light.
+ ***********************************************************/
+class LightLists
+{
+public:
+	// the uniform buffer binding point of the light table - the
+	// material table uses binding 0
+	static const GLuint LIGHT_TABLE_BINDING = 1;
+	// must match MAX_SCENE_LIGHTS in lighting.glsl
+	static const int MAX_LIGHTS = 128;
+	// two indices per component of the lights value
+	static const int MAX_DRAW_LIGHTS = 8;
+
+	// constructor - the light table is freed by its handle
+	LightLists();
+
+	// create the light table and connect the shader program's
+	// light table block to it
+	bool CreateLightBuffer(GLuint programID);
+	// connect another shader program's light table block to the buffer
+	bool BindLightTable(GLuint programID);
+
+	// upload the scene lights - only the first MAX_LIGHTS fit into
+	// the table, and the radius of every light is taken from its
+	// attenuation
+	void SetLights(const std::vector<LightSource>& lights);
+
+	// fill the light list of every record with the lights reaching
+	// its bounds - the brightest ones when more than MAX_DRAW_LIGHTS do
+	void AssignLights(std::vector<ShapeMeshes::DrawRecord>& records);
+
+	// the lights in the table, the average list length and the
+	// draws that had more lights in range than fit into their list,
+	// for the statistics report
+	int GetLightCount() const { return (int)m_lights.size(); }
+	float GetAverageDrawLights() const;
+	int GetOverflowDraws() const { return m_overflowDraws; }
+
+private:
+	// a light in range of a draw and its estimated brightness there
+	struct Candidate
+	{
+		float brightness;
+		int lightIndex;
+	};
+
+	// the distance from a point to the oriented box of a record
+	static float GetBoxDistance(const ShapeMeshes::DrawRecord& record, const glm::vec3& point);
+
+	GpuBuffer m_lightBuffer;
+	std::vector<LightSource> m_lights;
+	std::vector<float> m_lightRadii;
+	// brightest channel of every light, to rank the candidates
+	std::vector<float> m_lightIntensities;
+	std::vector<Candidate> m_candidates;
+	// totals of the last assignment
+	int m_drawCount;
+	int m_listedLights;
+	int m_overflowDraws;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+/***********************************************************
+ *  LightSource
+ *
+ *  One point or spot light of the scene. The forward
+ *  shaders get the first lights as uniforms, the light lists
+ *  and the clustered path get all of them in a buffer.
+ ***********************************************************/
+struct LightSource
+{
+	glm::vec3 position = glm::vec3(0.0f);
+	// spot lights only
+	glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f);
+	float cutOff = 1.0f;
+	float outerCutOff = 1.0f;
+
+	glm::vec3 ambient = glm::vec3(0.0f);
+	glm::vec3 diffuse = glm::vec3(0.0f);
+	glm::vec3 specular = glm::vec3(0.0f);
+
+	// attenuation terms - a point light with no linear or quadratic
+	// term lights everything at full strength
+	float constant = 1.0f;
+	float linear = 0.0f;
+	float quadratic = 0.0f;
+
+	bool bSpot = false;
+};
+
+/***********************************************************
+ *  GetLightRadius()
+ *
+ *  The distance at which the attenuated light falls below
+ *  one step of an 8 bit color channel, so it can be ignored
+ *  past it. Returns 0 for lights without a falloff, which
+ *  reach the whole scene.
+ ***********************************************************/
+inline float GetLightRadius(const LightSource& light)
+{
+	if ((light.linear <= 0.0f) && (light.quadratic <= 0.0f))
+	{
+		return 0.0f;
+	}
+
+	// brightest channel of any light term over the attenuation
+	// has to drop below 1/256
+	glm::vec3 brightest = glm::max(light.ambient, glm::max(light.diffuse, light.specular));
+	float intensity = std::max(brightest.r, std::max(brightest.g, brightest.b));
+	float target = (256.0f * intensity) - light.constant;
+	if (target <= 0.0f)
+	{
+		return 0.0001f;
+	}
+
+	// solve quadratic * d^2 + linear * d - target = 0
+	if (light.quadratic <= 0.0f)
+	{
+		return target / light.linear;
+	}
+	return (-light.linear + std::sqrt((light.linear * light.linear) + (4.0f * light.quadratic * target))) /
+		(2.0f * light.quadratic);
+}
+
+/***********************************************************
+ *  GPULight
+ *
+ *  One light as the shaders read it from the light table or
+ *  the light buffer - six vec4 values, so the std140 and
+ *  std430 layouts match. Must match LightData in
+ *  lighting.glsl.
+ ***********************************************************/
+struct GPULight
+{
+	glm::vec4 positionRadius;      // xyz position, w radius, 0 for unbounded
+	glm::vec4 directionType;       // xyz spot direction, w 1 for spot lights
+	glm::vec4 ambientConstant;     // rgb ambient, w constant attenuation
+	glm::vec4 diffuseLinear;       // rgb diffuse, w linear attenuation
+	glm::vec4 specularQuadratic;   // rgb specular, w quadratic attenuation
+	glm::vec4 cone;                // x cutoff, y outer cutoff
+};
+
+/***********************************************************
+ *  PackLight()
+ *
+ *  Packs a light and its radius for the shaders.
+ ***********************************************************/
+inline GPULight PackLight(const LightSource& light, float radius)
+{
+	GPULight gpuLight;
+	gpuLight.positionRadius = glm::vec4(light.position, radius);
+	gpuLight.directionType = glm::vec4(light.direction, light.bSpot ? 1.0f : 0.0f);
+	gpuLight.ambientConstant = glm::vec4(light.ambient, light.constant);
+	gpuLight.diffuseLinear = glm::vec4(light.diffuse, light.linear);
+	gpuLight.specularQuadratic = glm::vec4(light.specular, light.quadratic);
+	gpuLight.cone = glm::vec4(light.cutOff, light.outerCutOff, 0.0f, 0.0f);
+	return gpuLight;
+}
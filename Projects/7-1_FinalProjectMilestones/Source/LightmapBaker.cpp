@@ -0,0 +1,707 @@
+#include "LightmapBaker.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+	// texels around every chart, filled from the nearest point of its
+	// triangle so bilinear filtering at the edges never reads black
+	const int CHART_PADDING = 1;
+	// share of the lightmap the first packing attempt fills, and how
+	// much the texel density drops after every failed attempt
+	const float TARGET_COVERAGE = 0.8f;
+	const float DENSITY_STEP = 0.9f;
+	const int MAX_PACKING_ATTEMPTS = 64;
+	// triangles per leaf of the hierarchy
+	const int MAX_LEAF_TRIANGLES = 4;
+	// ray origins move this share of the scene size off the surface
+	const float RAY_OFFSET_SCALE = 0.00005f;
+	const float PI = 3.14159265f;
+
+	// xorshift generator - every texel has its own seed, so a bake
+	// gives the same result on any number of threads
+	struct Random
+	{
+		unsigned int state;
+
+		float Next()
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return (float)(state >> 8) * (1.0f / 16777216.0f);
+		}
+	};
+
+	// barycentric weights of the point of the triangle abc closest to
+	// p, see Ericson, Real-Time Collision Detection 5.1.5
+	glm::vec3 GetClosestPointWeights(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c)
+	{
+		glm::vec2 ab = b - a;
+		glm::vec2 ac = c - a;
+		glm::vec2 ap = p - a;
+		float d1 = glm::dot(ab, ap);
+		float d2 = glm::dot(ac, ap);
+		if ((d1 <= 0.0f) && (d2 <= 0.0f))
+		{
+			return glm::vec3(1.0f, 0.0f, 0.0f);
+		}
+
+		glm::vec2 bp = p - b;
+		float d3 = glm::dot(ab, bp);
+		float d4 = glm::dot(ac, bp);
+		if ((d3 >= 0.0f) && (d4 <= d3))
+		{
+			return glm::vec3(0.0f, 1.0f, 0.0f);
+		}
+
+		float vc = (d1 * d4) - (d3 * d2);
+		if ((vc <= 0.0f) && (d1 >= 0.0f) && (d3 <= 0.0f))
+		{
+			float v = d1 / (d1 - d3);
+			return glm::vec3(1.0f - v, v, 0.0f);
+		}
+
+		glm::vec2 cp = p - c;
+		float d5 = glm::dot(ab, cp);
+		float d6 = glm::dot(ac, cp);
+		if ((d6 >= 0.0f) && (d5 <= d6))
+		{
+			return glm::vec3(0.0f, 0.0f, 1.0f);
+		}
+
+		float vb = (d5 * d2) - (d1 * d6);
+		if ((vb <= 0.0f) && (d2 >= 0.0f) && (d6 <= 0.0f))
+		{
+			float w = d2 / (d2 - d6);
+			return glm::vec3(1.0f - w, 0.0f, w);
+		}
+
+		float va = (d3 * d6) - (d5 * d4);
+		if ((va <= 0.0f) && ((d4 - d3) >= 0.0f) && ((d5 - d6) >= 0.0f))
+		{
+			float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			return glm::vec3(0.0f, 1.0f - w, w);
+		}
+
+		float sum = va + vb + vc;
+		if (sum <= 0.0f)
+		{
+			return glm::vec3(1.0f, 0.0f, 0.0f);
+		}
+		float v = vb / sum;
+		float w = vc / sum;
+		return glm::vec3(1.0f - v - w, v, w);
+	}
+
+	// slab test of a ray against a box, true when it enters the box
+	// before maxDistance
+	bool IntersectBox(const glm::vec3& origin, const glm::vec3& inverseDirection,
+		const glm::vec3& minimum, const glm::vec3& maximum, float maxDistance)
+	{
+		glm::vec3 t1 = (minimum - origin) * inverseDirection;
+		glm::vec3 t2 = (maximum - origin) * inverseDirection;
+		glm::vec3 entries = glm::min(t1, t2);
+		glm::vec3 exits = glm::max(t1, t2);
+		float enter = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.0f));
+		float leave = std::min(std::min(exits.x, exits.y), exits.z);
+		return (enter <= leave) && (enter < maxDistance);
+	}
+}
+
+/***********************************************************
+ *  LightmapBaker()
+ *
+ *  The constructor for the class. When threadCount is 0
+ *  every hardware thread bakes - the render thread only
+ *  needs a little time while the scene is baking.
+ ***********************************************************/
+LightmapBaker::LightmapBaker(int threadCount)
+{
+	if (threadCount <= 0)
+	{
+		threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+	}
+	m_threadCount = threadCount;
+	m_bRunning = false;
+	m_bFinished = false;
+	m_nextRow = 0;
+	m_rayCount = 0;
+	m_bakeSeconds = 0.0;
+	m_directionalLight.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_directionalLight.ambient = glm::vec3(0.0f);
+	m_directionalLight.diffuse = glm::vec3(0.0f);
+	m_rayOffset = 0.001f;
+}
+
+/***********************************************************
+ *  ~LightmapBaker()
+ *
+ *  The destructor waits for a running bake to finish.
+ ***********************************************************/
+LightmapBaker::~LightmapBaker()
+{
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  Copies the surfaces and lights and starts the baking
+ *  thread. The results of an earlier bake stay readable
+ *  until this is called again.
+ ***********************************************************/
+bool LightmapBaker::Start(const std::vector<Surface>& surfaces, const DirectionalLight& directionalLight,
+	const std::vector<LightSource>& lights)
+{
+	if (m_bRunning == true)
+	{
+		return false;
+	}
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	m_surfaces = surfaces;
+	m_directionalLight = directionalLight;
+	m_lights = lights;
+	m_lightRadii.resize(m_lights.size());
+	for (size_t i = 0; i < m_lights.size(); i++)
+	{
+		m_lightRadii[i] = GetLightRadius(m_lights[i]);
+	}
+
+	m_bFinished = false;
+	m_bRunning = true;
+	m_thread = std::thread(&LightmapBaker::Bake, this);
+
+	return true;
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  The baking thread. Flattens every triangle into a chart,
+ *  packs the charts at the highest texel density that fits,
+ *  builds the hierarchy, finds the point of the scene under
+ *  every texel and lights them in two passes - the direct
+ *  light first, as the bounce reads it where its rays land.
+ ***********************************************************/
+void LightmapBaker::Bake()
+{
+	std::chrono::steady_clock::time_point bakeStart = std::chrono::steady_clock::now();
+	m_rayCount = 0;
+
+	m_triangles.clear();
+	m_chartCoordinates.clear();
+	m_chartSizes.clear();
+	glm::vec3 sceneMinimum(FLT_MAX);
+	glm::vec3 sceneMaximum(-FLT_MAX);
+	float chartArea = 0.0f;
+	for (size_t i = 0; i < m_surfaces.size(); i++)
+	{
+		const Surface& surface = m_surfaces[i];
+		for (size_t first = 0; first + 2 < surface.positions.size(); first += 3)
+		{
+			Triangle triangle;
+			triangle.surface = (int)i;
+			for (int j = 0; j < 3; j++)
+			{
+				triangle.positions[j] = surface.positions[first + j];
+				triangle.normals[j] = surface.normals[first + j];
+				sceneMinimum = glm::min(sceneMinimum, triangle.positions[j]);
+				sceneMaximum = glm::max(sceneMaximum, triangle.positions[j]);
+			}
+
+			// the longest edge lies on the x axis of the chart, so the
+			// chart bounds are only twice the size of the triangle
+			int longest = 0;
+			float longestLength = -1.0f;
+			for (int j = 0; j < 3; j++)
+			{
+				float length = glm::length(triangle.positions[(j + 1) % 3] - triangle.positions[j]);
+				if (length > longestLength)
+				{
+					longest = j;
+					longestLength = length;
+				}
+			}
+			glm::vec3 a = triangle.positions[longest];
+			glm::vec3 b = triangle.positions[(longest + 1) % 3];
+			glm::vec3 c = triangle.positions[(longest + 2) % 3];
+			glm::vec3 normal = glm::cross(b - a, c - a);
+
+			glm::vec2 coordinates[3] = { glm::vec2(0.0f), glm::vec2(0.0f), glm::vec2(0.0f) };
+			if ((longestLength > 0.0f) && (glm::length(normal) > 0.0f))
+			{
+				glm::vec3 axisX = (b - a) / longestLength;
+				glm::vec3 axisY = glm::normalize(glm::cross(glm::normalize(normal), axisX));
+				coordinates[(longest + 1) % 3] = glm::vec2(longestLength, 0.0f);
+				coordinates[(longest + 2) % 3] = glm::vec2(glm::dot(c - a, axisX), glm::dot(c - a, axisY));
+			}
+			glm::vec2 minimum = glm::min(coordinates[0], glm::min(coordinates[1], coordinates[2]));
+			glm::vec2 maximum = glm::max(coordinates[0], glm::max(coordinates[1], coordinates[2]));
+			for (int j = 0; j < 3; j++)
+			{
+				m_chartCoordinates.push_back(coordinates[j] - minimum);
+			}
+			m_chartSizes.push_back(maximum - minimum);
+			chartArea += (maximum.x - minimum.x) * (maximum.y - minimum.y);
+
+			m_triangles.push_back(triangle);
+		}
+	}
+	m_rayOffset = std::max(RAY_OFFSET_SCALE * glm::length(sceneMaximum - sceneMinimum), 0.0001f);
+
+	// shrink the texel density until every chart fits
+	float texelsPerUnit = std::sqrt(TARGET_COVERAGE * LIGHTMAP_SIZE * LIGHTMAP_SIZE / std::max(chartArea, 0.0001f));
+	bool bPacked = false;
+	for (int attempt = 0; (attempt < MAX_PACKING_ATTEMPTS) && (bPacked == false); attempt++)
+	{
+		bPacked = PackCharts(texelsPerUnit);
+		if (bPacked == false)
+		{
+			texelsPerUnit *= DENSITY_STEP;
+		}
+	}
+	if (bPacked == false)
+	{
+		std::cout << "Lightmap charts of " << m_triangles.size() << " triangles do not fit into the lightmap" << std::endl;
+		m_triangles.clear();
+	}
+
+	m_nodes.clear();
+	if (!m_triangles.empty())
+	{
+		m_nodes.resize(1);
+		BuildNode(0, 0, (int)m_triangles.size());
+	}
+
+	// every texel of a chart shows the nearest point of its triangle -
+	// the charts never overlap, so every texel has one owner
+	const int texelCount = LIGHTMAP_SIZE * LIGHTMAP_SIZE;
+	m_texelTriangles.assign(texelCount, -1);
+	m_texelPositions.assign(texelCount, glm::vec3(0.0f));
+	m_texelNormals.assign(texelCount, glm::vec3(0.0f));
+	m_texelAmbient.assign(texelCount, glm::vec3(0.0f));
+	m_texelDirect.assign(texelCount, glm::vec3(0.0f));
+	m_lightmap.assign(texelCount, glm::vec3(0.0f));
+	for (size_t i = 0; i < m_triangles.size(); i++)
+	{
+		const Triangle& triangle = m_triangles[i];
+		glm::vec3 faceNormal = glm::cross(triangle.positions[1] - triangle.positions[0],
+			triangle.positions[2] - triangle.positions[0]);
+		for (int y = triangle.chartRect.y; y < triangle.chartRect.y + triangle.chartRect.w; y++)
+		{
+			for (int x = triangle.chartRect.x; x < triangle.chartRect.x + triangle.chartRect.z; x++)
+			{
+				glm::vec3 weights = GetClosestPointWeights(glm::vec2(x + 0.5f, y + 0.5f),
+					triangle.chartTexels[0], triangle.chartTexels[1], triangle.chartTexels[2]);
+				glm::vec3 normal = (weights.x * triangle.normals[0]) + (weights.y * triangle.normals[1]) +
+					(weights.z * triangle.normals[2]);
+				if (glm::length(normal) <= 0.0f)
+				{
+					normal = faceNormal;
+				}
+
+				int texel = (y * LIGHTMAP_SIZE) + x;
+				m_texelTriangles[texel] = (int)i;
+				m_texelPositions[texel] = (weights.x * triangle.positions[0]) + (weights.y * triangle.positions[1]) +
+					(weights.z * triangle.positions[2]);
+				m_texelNormals[texel] = (glm::length(normal) > 0.0f) ? glm::normalize(normal) : glm::vec3(0.0f, 1.0f, 0.0f);
+			}
+		}
+	}
+
+	RunPass(&LightmapBaker::BakeDirectRow);
+	RunPass(&LightmapBaker::BakeBounceRow);
+
+	// only the lightmap and its coordinates are kept
+	std::vector<int>().swap(m_texelTriangles);
+	std::vector<glm::vec3>().swap(m_texelPositions);
+	std::vector<glm::vec3>().swap(m_texelNormals);
+	std::vector<glm::vec3>().swap(m_texelAmbient);
+	std::vector<glm::vec3>().swap(m_texelDirect);
+
+	m_bakeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - bakeStart).count();
+	m_bFinished = true;
+	m_bRunning = false;
+}
+
+/***********************************************************
+ *  PackCharts()
+ *
+ *  Sizes every chart at the texel density and packs them in
+ *  rows, tallest first. Stores the chart rectangle and the
+ *  lightmap coordinates of every triangle when they fit.
+ ***********************************************************/
+bool LightmapBaker::PackCharts(float texelsPerUnit)
+{
+	size_t triangleCount = m_triangles.size();
+	std::vector<glm::ivec2> sizes(triangleCount);
+	std::vector<int> order(triangleCount);
+	for (size_t i = 0; i < triangleCount; i++)
+	{
+		sizes[i].x = std::max(1, (int)std::ceil(m_chartSizes[i].x * texelsPerUnit)) + (2 * CHART_PADDING);
+		sizes[i].y = std::max(1, (int)std::ceil(m_chartSizes[i].y * texelsPerUnit)) + (2 * CHART_PADDING);
+		order[i] = (int)i;
+	}
+	std::sort(order.begin(), order.end(),
+		[&sizes](int a, int b) { return sizes[a].y > sizes[b].y; });
+
+	std::vector<glm::ivec2> corners(triangleCount);
+	int x = 0;
+	int y = 0;
+	int rowHeight = 0;
+	for (size_t i = 0; i < triangleCount; i++)
+	{
+		const glm::ivec2& size = sizes[order[i]];
+		if (x + size.x > LIGHTMAP_SIZE)
+		{
+			x = 0;
+			y += rowHeight;
+			rowHeight = 0;
+		}
+		if ((size.x > LIGHTMAP_SIZE) || (y + size.y > LIGHTMAP_SIZE))
+		{
+			return false;
+		}
+		corners[order[i]] = glm::ivec2(x, y);
+		x += size.x;
+		rowHeight = std::max(rowHeight, size.y);
+	}
+
+	m_lightmapUVs.resize(triangleCount * 3);
+	for (size_t i = 0; i < triangleCount; i++)
+	{
+		Triangle& triangle = m_triangles[i];
+		triangle.chartRect = glm::ivec4(corners[i], sizes[i]);
+		for (int j = 0; j < 3; j++)
+		{
+			triangle.chartTexels[j] = glm::vec2(corners[i] + CHART_PADDING) +
+				(m_chartCoordinates[(i * 3) + j] * texelsPerUnit);
+			m_lightmapUVs[(i * 3) + j] = triangle.chartTexels[j] / (float)LIGHTMAP_SIZE;
+		}
+	}
+
+	return true;
+}
+
+/***********************************************************
+ *  BuildNode()
+ *
+ *  Bounds the triangles of a node and splits them at the
+ *  median of their centers along the longest axis, until
+ *  only a few are left per leaf.
+ ***********************************************************/
+void LightmapBaker::BuildNode(int node, int first, int count)
+{
+	glm::vec3 minimum(FLT_MAX);
+	glm::vec3 maximum(-FLT_MAX);
+	glm::vec3 centerMinimum(FLT_MAX);
+	glm::vec3 centerMaximum(-FLT_MAX);
+	for (int i = first; i < first + count; i++)
+	{
+		const Triangle& triangle = m_triangles[i];
+		glm::vec3 center = (triangle.positions[0] + triangle.positions[1] + triangle.positions[2]) / 3.0f;
+		for (int j = 0; j < 3; j++)
+		{
+			minimum = glm::min(minimum, triangle.positions[j]);
+			maximum = glm::max(maximum, triangle.positions[j]);
+		}
+		centerMinimum = glm::min(centerMinimum, center);
+		centerMaximum = glm::max(centerMaximum, center);
+	}
+	m_nodes[node].minimum = minimum;
+	m_nodes[node].maximum = maximum;
+	m_nodes[node].first = first;
+	m_nodes[node].count = count;
+
+	glm::vec3 spread = centerMaximum - centerMinimum;
+	int axis = 0;
+	if (spread.y > spread[axis])
+	{
+		axis = 1;
+	}
+	if (spread.z > spread[axis])
+	{
+		axis = 2;
+	}
+	if ((count <= MAX_LEAF_TRIANGLES) || (spread[axis] <= 0.0f))
+	{
+		return;
+	}
+
+	int middle = first + (count / 2);
+	std::nth_element(m_triangles.begin() + first, m_triangles.begin() + middle, m_triangles.begin() + first + count,
+		[axis](const Triangle& a, const Triangle& b)
+		{
+			return (a.positions[0][axis] + a.positions[1][axis] + a.positions[2][axis]) <
+				(b.positions[0][axis] + b.positions[1][axis] + b.positions[2][axis]);
+		});
+
+	// the children are stored next to each other
+	int left = (int)m_nodes.size();
+	m_nodes.resize(m_nodes.size() + 2);
+	m_nodes[node].first = left;
+	m_nodes[node].count = 0;
+	BuildNode(left, first, middle - first);
+	BuildNode(left + 1, middle, first + count - middle);
+}
+
+/***********************************************************
+ *  Trace()
+ *
+ *  Walks the hierarchy front to back with a small stack and
+ *  tests the triangles of every leaf the ray reaches, with
+ *  the Moller-Trumbore test. Triangles are hit from both
+ *  sides, so the thin floor covers block light too.
+ ***********************************************************/
+bool LightmapBaker::Trace(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+	bool bAnyHit, Hit& hit) const
+{
+	if (m_nodes.empty())
+	{
+		return false;
+	}
+
+	glm::vec3 inverseDirection = 1.0f / direction;
+	hit.triangle = -1;
+	hit.distance = maxDistance;
+
+	int stack[64];
+	int depth = 0;
+	stack[depth++] = 0;
+	while (depth > 0)
+	{
+		const BVHNode& node = m_nodes[stack[--depth]];
+		if (IntersectBox(origin, inverseDirection, node.minimum, node.maximum, hit.distance) == false)
+		{
+			continue;
+		}
+		if (node.count == 0)
+		{
+			if (depth + 2 <= 64)
+			{
+				stack[depth++] = node.first;
+				stack[depth++] = node.first + 1;
+			}
+			continue;
+		}
+
+		for (int i = node.first; i < node.first + node.count; i++)
+		{
+			const Triangle& triangle = m_triangles[i];
+			glm::vec3 edge1 = triangle.positions[1] - triangle.positions[0];
+			glm::vec3 edge2 = triangle.positions[2] - triangle.positions[0];
+			glm::vec3 p = glm::cross(direction, edge2);
+			float determinant = glm::dot(edge1, p);
+			if (std::abs(determinant) < 1e-12f)
+			{
+				continue;
+			}
+			float inverseDeterminant = 1.0f / determinant;
+			glm::vec3 t = origin - triangle.positions[0];
+			float u = glm::dot(t, p) * inverseDeterminant;
+			if ((u < 0.0f) || (u > 1.0f))
+			{
+				continue;
+			}
+			glm::vec3 q = glm::cross(t, edge1);
+			float v = glm::dot(direction, q) * inverseDeterminant;
+			if ((v < 0.0f) || (u + v > 1.0f))
+			{
+				continue;
+			}
+			float distance = glm::dot(edge2, q) * inverseDeterminant;
+			if ((distance > 0.0f) && (distance < hit.distance))
+			{
+				hit.triangle = i;
+				hit.distance = distance;
+				hit.u = u;
+				hit.v = v;
+				if (bAnyHit == true)
+				{
+					return true;
+				}
+			}
+		}
+	}
+
+	return (hit.triangle >= 0);
+}
+
+/***********************************************************
+ *  RunPass()
+ *
+ *  Hands the lightmap rows out to the baking thread and
+ *  m_threadCount - 1 helpers, and returns once every row
+ *  is done.
+ ***********************************************************/
+void LightmapBaker::RunPass(void (LightmapBaker::*pass)(int row, long long& rays))
+{
+	m_nextRow = 0;
+	auto work = [this, pass]()
+	{
+		long long rays = 0;
+		int row = 0;
+		while ((row = m_nextRow++) < LIGHTMAP_SIZE)
+		{
+			(this->*pass)(row, rays);
+		}
+		m_rayCount += rays;
+	};
+
+	std::vector<std::thread> helpers;
+	for (int i = 1; i < m_threadCount; i++)
+	{
+		helpers.push_back(std::thread(work));
+	}
+	work();
+	for (size_t i = 0; i < helpers.size(); i++)
+	{
+		helpers[i].join();
+	}
+}
+
+/***********************************************************
+ *  BakeDirectRow()
+ *
+ *  Lights one row of texels like the diffuse terms of the
+ *  lit shaders, with a shadow ray towards every light that
+ *  faces the texel. The specular terms depend on the view,
+ *  so they are left out.
+ ***********************************************************/
+void LightmapBaker::BakeDirectRow(int row, long long& rays)
+{
+	Hit hit;
+	for (int x = 0; x < LIGHTMAP_SIZE; x++)
+	{
+		int texel = (row * LIGHTMAP_SIZE) + x;
+		if (m_texelTriangles[texel] < 0)
+		{
+			continue;
+		}
+		const glm::vec3& position = m_texelPositions[texel];
+		const glm::vec3& normal = m_texelNormals[texel];
+		glm::vec3 origin = position + (normal * m_rayOffset);
+
+		glm::vec3 ambient = m_directionalLight.ambient;
+		glm::vec3 direct(0.0f);
+
+		glm::vec3 lightDirection = glm::normalize(-m_directionalLight.direction);
+		float diffuse = glm::dot(normal, lightDirection);
+		if (diffuse > 0.0f)
+		{
+			rays++;
+			if (Trace(origin, lightDirection, FLT_MAX, true, hit) == false)
+			{
+				direct += m_directionalLight.diffuse * diffuse;
+			}
+		}
+
+		for (size_t i = 0; i < m_lights.size(); i++)
+		{
+			const LightSource& light = m_lights[i];
+			glm::vec3 offset = light.position - position;
+			float distance = glm::length(offset);
+			if ((distance <= 0.0f) || ((m_lightRadii[i] > 0.0f) && (distance > m_lightRadii[i])))
+			{
+				continue;
+			}
+			lightDirection = offset / distance;
+
+			float attenuation = 1.0f / (light.constant + (light.linear * distance) +
+				(light.quadratic * distance * distance));
+			if (light.bSpot == true)
+			{
+				float theta = glm::dot(lightDirection, glm::normalize(-light.direction));
+				float epsilon = light.cutOff - light.outerCutOff;
+				float intensity = (epsilon > 0.0f) ? ((theta - light.outerCutOff) / epsilon) :
+					((theta >= light.cutOff) ? 1.0f : 0.0f);
+				attenuation *= glm::clamp(intensity, 0.0f, 1.0f);
+			}
+			if (attenuation <= 0.0f)
+			{
+				continue;
+			}
+
+			ambient += light.ambient * attenuation;
+			diffuse = glm::dot(normal, lightDirection);
+			if (diffuse > 0.0f)
+			{
+				rays++;
+				if (Trace(origin, lightDirection, distance - m_rayOffset, true, hit) == false)
+				{
+					direct += light.diffuse * diffuse * attenuation;
+				}
+			}
+		}
+
+		m_texelAmbient[texel] = ambient;
+		m_texelDirect[texel] = direct;
+	}
+}
+
+/***********************************************************
+ *  BakeBounceRow()
+ *
+ *  Adds the first bounce to one row of texels. Cosine
+ *  weighted rays pick up the direct light of the texel they
+ *  land on, tinted by the surface there, so the average of
+ *  the samples is the bounced light. Writes the final
+ *  lightmap texels.
+ ***********************************************************/
+void LightmapBaker::BakeBounceRow(int row, long long& rays)
+{
+	Hit hit;
+	for (int x = 0; x < LIGHTMAP_SIZE; x++)
+	{
+		int texel = (row * LIGHTMAP_SIZE) + x;
+		int triangle = m_texelTriangles[texel];
+		if (triangle < 0)
+		{
+			continue;
+		}
+		const glm::vec3& normal = m_texelNormals[texel];
+		glm::vec3 origin = m_texelPositions[texel] + (normal * m_rayOffset);
+		glm::vec3 tangent = glm::normalize(glm::cross((std::abs(normal.x) > 0.9f) ?
+			glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f), normal));
+		glm::vec3 bitangent = glm::cross(normal, tangent);
+
+		Random random;
+		random.state = ((unsigned int)texel * 2654435761u) | 1u;
+		glm::vec3 bounce(0.0f);
+		for (int i = 0; i < BOUNCE_SAMPLES; i++)
+		{
+			float angle = 2.0f * PI * random.Next();
+			float radiusSquared = random.Next();
+			float radius = std::sqrt(radiusSquared);
+			glm::vec3 direction = (tangent * (radius * std::cos(angle))) + (bitangent * (radius * std::sin(angle))) +
+				(normal * std::sqrt(std::max(0.0f, 1.0f - radiusSquared)));
+
+			rays++;
+			if (Trace(origin, direction, FLT_MAX, false, hit) == true)
+			{
+				const Triangle& hitTriangle = m_triangles[hit.triangle];
+				glm::vec2 hitTexel = (hitTriangle.chartTexels[0] * (1.0f - hit.u - hit.v)) +
+					(hitTriangle.chartTexels[1] * hit.u) + (hitTriangle.chartTexels[2] * hit.v);
+				int hitX = glm::clamp((int)hitTexel.x, 0, LIGHTMAP_SIZE - 1);
+				int hitY = glm::clamp((int)hitTexel.y, 0, LIGHTMAP_SIZE - 1);
+				bounce += m_surfaces[hitTriangle.surface].albedo * m_texelDirect[(hitY * LIGHTMAP_SIZE) + hitX];
+			}
+		}
+		bounce /= (float)BOUNCE_SAMPLES;
+
+		m_lightmap[texel] = m_texelAmbient[texel] +
+			(m_surfaces[m_triangles[triangle].surface].diffuseColor * (m_texelDirect[texel] + bounce));
+	}
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "LightSource.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  LightmapBaker
+ *
+ *  Bakes the diffuse lighting of static triangles into a
+ *  lightmap on the CPU. Every triangle gets its own chart in
+ *  the lightmap, then worker threads light every texel with
+ *  shadow rays towards each light, and add one bounce by
+ *  tracing cosine weighted rays into the scene. Both passes
+ *  trace against a bounding volume hierarchy of the baked
+ *  triangles. The baking runs off the main thread and uses
+ *  no GL calls - the caller uploads the results once
+ *  IsFinished() returns true.
+ ***********************************************************/
+class LightmapBaker
+{
+public:
+	// width and height of the lightmap in texels
+	static const int LIGHTMAP_SIZE = 512;
+	// rays traced per texel for the indirect bounce
+	static const int BOUNCE_SAMPLES = 32;
+
+	// one static draw to bake, with its triangles in world space
+	struct Surface
+	{
+		// three entries per triangle
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> normals;
+		// material diffuse color, which scales the incoming light
+		glm::vec3 diffuseColor;
+		// average base color times the diffuse color - the share of the
+		// light the surface passes on to the bounce
+		glm::vec3 albedo;
+	};
+
+	// the directional light of the scene
+	struct DirectionalLight
+	{
+		glm::vec3 direction;
+		glm::vec3 ambient;
+		glm::vec3 diffuse;
+	};
+
+	// constructor - threadCount of 0 uses every hardware thread
+	LightmapBaker(int threadCount = 0);
+	// destructor - waits for a running bake
+	~LightmapBaker();
+
+	// copy the surfaces and lights and start baking them on the
+	// worker threads - returns false while a bake is still running
+	bool Start(const std::vector<Surface>& surfaces, const DirectionalLight& directionalLight,
+		const std::vector<LightSource>& lights);
+	// true once the last started bake has finished
+	bool IsFinished() const { return m_bFinished; }
+	bool IsRunning() const { return m_bRunning; }
+
+	// the results of the finished bake - the linear RGB lightmap, row
+	// by row from the bottom, and the lightmap coordinates of every
+	// vertex in the order of the surface positions
+	const std::vector<glm::vec3>& GetLightmap() const { return m_lightmap; }
+	const std::vector<glm::vec2>& GetLightmapUVs() const { return m_lightmapUVs; }
+
+	// statistics of the finished bake
+	int GetTriangleCount() const { return (int)m_triangles.size(); }
+	int GetThreadCount() const { return m_threadCount; }
+	long long GetRayCount() const { return m_rayCount; }
+	double GetBakeSeconds() const { return m_bakeSeconds; }
+
+private:
+	// a baked triangle in world space and its lightmap chart
+	struct Triangle
+	{
+		glm::vec3 positions[3];
+		glm::vec3 normals[3];
+		// the vertices in lightmap texels and the texel rectangle of the
+		// chart - x, y, width, height - including the padding
+		glm::vec2 chartTexels[3];
+		glm::ivec4 chartRect;
+		int surface;
+	};
+
+	// a node of the bounding volume hierarchy - leaves hold count
+	// triangles from first, inner nodes have count 0 and their
+	// children at first and first + 1
+	struct BVHNode
+	{
+		glm::vec3 minimum;
+		glm::vec3 maximum;
+		int first;
+		int count;
+	};
+
+	// the closest hit of a ray
+	struct Hit
+	{
+		int triangle;
+		float distance;
+		float u;
+		float v;
+	};
+
+	// the baking thread - lays out the charts, builds the hierarchy
+	// and runs both lighting passes
+	void Bake();
+	// lay out one chart per triangle at the passed texel density,
+	// false when they do not fit into the lightmap
+	bool PackCharts(float texelsPerUnit);
+	// fill a node of the hierarchy over count triangles from first,
+	// reordering them, and build its children
+	void BuildNode(int node, int first, int count);
+	// find the closest hit up to maxDistance - with bAnyHit the first
+	// hit found is enough, for shadow rays
+	bool Trace(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+		bool bAnyHit, Hit& hit) const;
+	// run a pass over every lightmap row on all threads
+	void RunPass(void (LightmapBaker::*pass)(int row, long long& rays));
+	// light one row of texels directly, then add the bounce
+	void BakeDirectRow(int row, long long& rays);
+	void BakeBounceRow(int row, long long& rays);
+
+	int m_threadCount;
+	std::thread m_thread;
+	std::atomic<bool> m_bRunning;
+	std::atomic<bool> m_bFinished;
+	// next row to hand out to a worker of the running pass
+	std::atomic<int> m_nextRow;
+	std::atomic<long long> m_rayCount;
+	double m_bakeSeconds;
+
+	// copies of the inputs
+	std::vector<Surface> m_surfaces;
+	DirectionalLight m_directionalLight;
+	std::vector<LightSource> m_lights;
+	std::vector<float> m_lightRadii;
+
+	std::vector<Triangle> m_triangles;
+	// every triangle flattened into its own plane, in world units with
+	// the lower left corner of its bounds at the origin, and its size
+	std::vector<glm::vec2> m_chartCoordinates;
+	std::vector<glm::vec2> m_chartSizes;
+	std::vector<BVHNode> m_nodes;
+	// offset of a ray origin from its surface
+	float m_rayOffset;
+
+	// per texel - the covering triangle or -1, the world position and
+	// normal at the texel center, the ambient light and the direct
+	// diffuse light before the material
+	std::vector<int> m_texelTriangles;
+	std::vector<glm::vec3> m_texelPositions;
+	std::vector<glm::vec3> m_texelNormals;
+	std::vector<glm::vec3> m_texelAmbient;
+	std::vector<glm::vec3> m_texelDirect;
+
+	std::vector<glm::vec3> m_lightmap;
+	std::vector<glm::vec2> m_lightmapUVs;
+};
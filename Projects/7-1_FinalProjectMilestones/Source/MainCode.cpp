@@ -22,6 +22,10 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "GpuResources.h"
+#include "DebugOutput.h"
+#include "GlCapture.h"
+#include "TraceZones.h"
 
 // Namespace for declaring global variables
 namespace
@@ -32,17 +36,22 @@ namespace
 	// Main GLFW window
 	GLFWwindow* g_Window = nullptr;
 
+	// the timeline written on exit when started with --trace
+	const char* const g_TraceFile = "trace.json";
+
 	// scene manager object for managing the 3D scene prepare and render
 	SceneManager* g_SceneManager = nullptr;
 	// shader manager object for dynamic interaction with the shader code
 	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// the driver message log when started with --gl-debug
+	DebugOutput* g_DebugOutput = nullptr;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
-bool InitializeGLFW();
+bool InitializeGLFW(bool bDebugContext);
 bool InitializeGLEW();
 
 
@@ -54,8 +63,18 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// the trace has to be on before the startup it should cover, so the
+	// options are read once here for it and again into the scene below
+	RenderSettings startupSettings;
+	for (int i = 1; i < argc; i++)
+	{
+		startupSettings.ParseArgument(argc, argv, i);
+	}
+	TraceZones::SetThreadName("Main");
+	TraceZones::SetEnabled(startupSettings.bTrace);
+
 	// if GLFW fails initialization, then terminate the application
-	if (InitializeGLFW() == false)
+	if (InitializeGLFW(startupSettings.bDebugOutput) == false)
 	{
 		return(EXIT_FAILURE);
 	}
@@ -75,14 +94,49 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
+	// log the driver messages from the first GL call of the scene on
+	if (startupSettings.bDebugOutput == true)
+	{
+		g_DebugOutput = new DebugOutput();
+		g_DebugOutput->Install();
+	}
+
+	// record the GL calls for GlReplay with --capture, from the shaders
+	// loaded below through the capture window
+	bool bCapturing = false;
+	if (startupSettings.captureFile.empty() == false)
+	{
+		int width = 0;
+		int height = 0;
+		glfwGetFramebufferSize(g_Window, &width, &height);
+		bCapturing = GlCapture::Start(startupSettings.captureFile.c_str(), width, height, 0,
+			startupSettings.captureFirstFrame, startupSettings.captureFrameCount);
+		if (bCapturing == false)
+		{
+			std::cout << "Failed to open " << startupSettings.captureFile << std::endl;
+		}
+	}
+
+	// load the shader code from the external GLSL files - the handle
+	// frees the program before the window closes
+	GpuProgram sceneProgram;
+	sceneProgram.Adopt(g_ShaderManager->LoadShaders(
 		"shaders/vertexShader.glsl",
-		"shaders/fragmentShader.glsl");
+		"shaders/fragmentShader.glsl"));
 	g_ShaderManager->use();
 
 	// try to create a new scene manager object and prepare the 3D scene
 	g_SceneManager = new SceneManager(g_ShaderManager);
+
+	// command line options for benchmarking the draw paths, see
+	// RenderSettings::ParseArgument()
+	RenderSettings* pRenderSettings = g_SceneManager->GetRenderSettings();
+	for (int i = 1; i < argc; i++)
+	{
+		pRenderSettings->ParseArgument(argc, argv, i);
+	}
+	g_ViewManager->SetRenderSettings(pRenderSettings);
+
 	g_SceneManager->PrepareScene();
 
 	// display all the camera controls
@@ -104,12 +158,48 @@ int main(int argc, char* argv[])
 	std::cout << "  9          - Perspective back view\n";
 	std::cout << "  P          - Cycle perspective views\n";
 	std::cout << "  O          - Cycle orthographic views\n";
+	std::cout << "  F1         - Toggle render statistics overlay\n";
+	std::cout << "  F2         - Switch immediate/indirect draw path\n";
+	std::cout << "  F3         - Toggle frustum culling\n";
+	std::cout << "  F4         - Toggle occlusion culling\n";
+	std::cout << "  F5         - Toggle depth pre-pass\n";
+	std::cout << "  F6         - Toggle clustered lighting\n";
+	std::cout << "  F7         - Toggle deferred shading\n";
+	std::cout << "  F8         - Toggle per-draw light lists\n";
+	std::cout << "  F9         - Toggle shadows\n";
+	std::cout << "  F10        - Toggle baked lighting\n";
+	std::cout << "  F11        - Toggle order-independent transparency\n";
+	std::cout << "  F12        - Toggle sphere impostors\n";
+	std::cout << "  T          - Toggle GPU pass and object timers\n";
 	std::cout << "  ESC        - Exit\n" << std::endl;
 
+	// the camera fly-throughs - --play-camera drives the camera from a
+	// recorded path and closes the window after its last frame, so the
+	// frame times of builds can be compared on the same frames
+	const std::string& cameraPlaybackFile = pRenderSettings->cameraPlaybackFile;
+	const std::string& cameraRecordFile = pRenderSettings->cameraRecordFile;
+	bool bPlayingCamera = false;
+	if (cameraPlaybackFile.empty() == false)
+	{
+		bPlayingCamera = g_ViewManager->StartCameraPlayback(cameraPlaybackFile.c_str());
+		if (bPlayingCamera == false)
+		{
+			glfwSetWindowShouldClose(g_Window, true);
+		}
+	}
+	if (cameraRecordFile.empty() == false)
+	{
+		g_ViewManager->StartCameraRecording();
+	}
+	double playbackStartTime = glfwGetTime();
+
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
 	while (!glfwWindowShouldClose(g_Window))
 	{
+		// the whole frame, including the wait for the buffer swap
+		TRACE_ZONE("Frame");
+
 		// Enable z-depth
 		glEnable(GL_DEPTH_TEST);
 
@@ -119,16 +209,63 @@ int main(int argc, char* argv[])
 
 		// convert from 3D object space to 2D view
 		g_ViewManager->PrepareSceneView();
+		g_SceneManager->SetViewParameters(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetCameraPosition());
 
 		// refresh the 3D scene
 		g_SceneManager->RenderScene();
 
+		// the capture closes its file after the last frame of its window
+		GlCapture::EndFrame();
+		if ((bCapturing == true) && (GlCapture::IsRecording() == false))
+		{
+			std::cout << "INFO: GL calls captured to " << startupSettings.captureFile << std::endl;
+			bCapturing = false;
+		}
 
 		// Flips the the back buffer with the front buffer every frame.
 		glfwSwapBuffers(g_Window);
 
 		// query the latest GLFW events
 		glfwPollEvents();
+
+		if ((bPlayingCamera == true) && (g_ViewManager->IsCameraPlaybackFinished() == true))
+		{
+			int frames = g_ViewManager->GetCameraPlaybackFrame();
+			double seconds = glfwGetTime() - playbackStartTime;
+			std::cout << "INFO: camera path played, " << frames << " frames in " << seconds << " s, "
+				<< seconds * 1000.0 / frames << " ms per frame" << std::endl;
+			glfwSetWindowShouldClose(g_Window, true);
+			bPlayingCamera = false;
+		}
+	}
+
+	if ((cameraRecordFile.empty() == false) &&
+		(g_ViewManager->SaveCameraRecording(cameraRecordFile.c_str()) == true))
+	{
+		std::cout << "INFO: camera path written to " << cameraRecordFile << std::endl;
+	}
+
+	if (startupSettings.bTrace == true)
+	{
+		if (TraceZones::WriteChromeTrace(g_TraceFile) == true)
+		{
+			std::cout << "INFO: timing zones written to " << g_TraceFile << std::endl;
+		}
+		else
+		{
+			std::cout << "Failed to write " << g_TraceFile << std::endl;
+		}
+	}
+
+	// a window closed early keeps the frames captured so far
+	if (bCapturing == true)
+	{
+		GlCapture::Stop();
+		std::cout << "WARNING: closed after " << GlCapture::GetFrame() << " frames, before the end of the capture window"
+			<< std::endl;
 	}
 
 	// clear the allocated manager objects from memory
@@ -137,6 +274,22 @@ int main(int argc, char* argv[])
 		delete g_SceneManager;
 		g_SceneManager = NULL;
 	}
+	sceneProgram.Reset();
+
+	if (NULL != g_DebugOutput)
+	{
+		g_DebugOutput->PrintReport(std::cout);
+		delete g_DebugOutput;
+		g_DebugOutput = NULL;
+	}
+
+	// every OpenGL object is freed by now, anything still alive leaked
+	GpuResources::WriteReport(std::cout);
+	if (GpuResources::GetLiveObjects() > 0)
+	{
+		std::cout << "WARNING: " << GpuResources::GetLiveObjects() << " OpenGL objects were not freed" << std::endl;
+	}
+
 	if (NULL != g_ViewManager)
 	{
 		delete g_ViewManager;
@@ -156,9 +309,13 @@ int main(int argc, char* argv[])
  *	InitializeGLFW()
  * 
  *  This function is used to initialize the GLFW library.   
+ *  With bDebugContext the window gets a debug context, on
+ *  which the driver reports the most messages.
  ***********************************************************/
-bool InitializeGLFW()
+bool InitializeGLFW(bool bDebugContext)
 {
+	TRACE_ZONE("InitializeGLFW");
+
 	// GLFW: initialize and configure library
 	// --------------------------------------
 	glfwInit();
@@ -174,6 +331,7 @@ bool InitializeGLFW()
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 #endif
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, (bDebugContext == true) ? GL_TRUE : GL_FALSE);
 	// GLFW: end -------------------------------
 
 	return(true);
@@ -186,6 +344,8 @@ bool InitializeGLFW()
  ***********************************************************/
 bool InitializeGLEW()
 {
+	TRACE_ZONE("InitializeGLEW");
+
 	// GLEW: initialize
 	// -----------------------------------------
 	GLenum GLEWInitResult = GLEW_OK;
@@ -0,0 +1,145 @@
+#include "MaterialLibrary.h"
+
+#include <iostream>
+
+namespace
+{
+	// the built in material values, listed in MaterialID order
+	struct BuiltinMaterial
+	{
+		const char* tag;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+	};
+
+	const BuiltinMaterial g_BuiltinMaterials[MAT_BUILTIN_COUNT] =
+	{
+		{ "silver",           glm::vec3(0.76f, 0.76f, 0.76f),   glm::vec3(0.4f,  0.4f,  0.4f),     32.0f },
+		{ "screen",           glm::vec3(0.02f, 0.02f, 0.02f),   glm::vec3(1.0f,  1.0f,  1.0f),    512.0f },
+		{ "deck_outline",     glm::vec3(0.15f, 0.15f, 0.15f),   glm::vec3(0.05f, 0.05f, 0.05f),    4.0f },
+		{ "dark_key",         glm::vec3(0.2f,  0.2f,  0.2f),    glm::vec3(0.1f,  0.1f,  0.1f),     8.0f },
+		{ "centerpiece_base", glm::vec3(0.15f, 0.15f, 0.18f),   glm::vec3(1.0f,  1.0f,  1.0f),    32.0f },
+		{ "crystal_body",     glm::vec3(1.0f,  1.0f,  1.0f),    glm::vec3(0.9f,  0.9f,  0.9f),   156.0f },
+		{ "crystal_inner",    glm::vec3(0.5f,  0.8f,  0.05f),   glm::vec3(0.9f,  0.9f,  0.9f),   256.0f },
+		{ "wood",             glm::vec3(0.35f, 0.22f, 0.1f),    glm::vec3(0.1f,  0.08f, 0.05f),   16.0f },
+		{ "teal",             glm::vec3(0.4f,  0.55f, 0.5f),    glm::vec3(0.05f, 0.05f, 0.05f),    4.0f },
+		{ "brown",            glm::vec3(0.545f,0.271f,0.075f),  glm::vec3(0.545f,0.271f,0.075f),   4.0f },
+		{ "coaster",          glm::vec3(0.7f,  0.65f, 0.6f),    glm::vec3(0.02f, 0.02f, 0.02f),    2.0f },
+		{ "book_cover",       glm::vec3(0.3f,  0.25f, 0.2f),    glm::vec3(0.05f, 0.05f, 0.05f),    4.0f },
+		{ "book_pages",       glm::vec3(0.95f, 0.92f, 0.85f),   glm::vec3(0.05f, 0.05f, 0.05f),    4.0f },
+	};
+}
+
+/***********************************************************
+ *  MaterialLibrary()
+ *
+ *  The constructor adds the built in materials so their
+ *  table index matches their MaterialID.
+ ***********************************************************/
+MaterialLibrary::MaterialLibrary()
+{
+	for (int i = 0; i < MAT_BUILTIN_COUNT; i++)
+	{
+		AddMaterial(
+			g_BuiltinMaterials[i].tag,
+			g_BuiltinMaterials[i].diffuseColor,
+			g_BuiltinMaterials[i].specularColor,
+			g_BuiltinMaterials[i].shininess);
+	}
+}
+
+/***********************************************************
+ *  AddMaterial()
+ *
+ *  Adds a material to the end of the table. Materials added
+ *  after CreateMaterialBuffer() only reach the shader once
+ *  the buffer is created again.
+ ***********************************************************/
+int MaterialLibrary::AddMaterial(std::string tag, glm::vec3 diffuseColor, glm::vec3 specularColor, float shininess)
+{
+	if ((int)m_materials.size() >= MAX_MATERIALS)
+	{
+		std::cout << "No free material slot for material:" << tag << std::endl;
+		return(-1);
+	}
+
+	Material material;
+	material.tag = tag;
+	material.diffuseColor = diffuseColor;
+	material.specularColor = specularColor;
+	material.shininess = shininess;
+	m_materials.push_back(material);
+
+	return((int)m_materials.size() - 1);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  Returns the table index of the material with the passed
+ *  tag. Only meant for setup code - draws should keep the
+ *  index instead of looking it up every frame.
+ ***********************************************************/
+int MaterialLibrary::FindMaterial(std::string tag) const
+{
+	for (int index = 0; index < (int)m_materials.size(); index++)
+	{
+		if (m_materials[index].tag.compare(tag) == 0)
+		{
+			return(index);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  CreateMaterialBuffer()
+ *
+ *  Packs the material table into std140 layout, uploads it
+ *  into a uniform buffer and attaches the buffer to the
+ *  shader program's MaterialBlock.
+ ***********************************************************/
+bool MaterialLibrary::CreateMaterialBuffer(GLuint programID)
+{
+	std::vector<GPUMaterial> gpuMaterials(MAX_MATERIALS);
+	for (size_t i = 0; i < m_materials.size(); i++)
+	{
+		gpuMaterials[i].diffuseColor = glm::vec4(m_materials[i].diffuseColor, 1.0f);
+		gpuMaterials[i].specularShininess = glm::vec4(m_materials[i].specularColor, m_materials[i].shininess);
+	}
+
+	if (0 == m_materialBuffer)
+	{
+		m_materialBuffer.Create();
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, m_materialBuffer);
+	m_materialBuffer.SetLabel("Material table");
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(GPUMaterial) * gpuMaterials.size(), &gpuMaterials[0], GL_STATIC_DRAW);
+	m_materialBuffer.SetBytes(sizeof(GPUMaterial) * gpuMaterials.size());
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_BLOCK_BINDING, m_materialBuffer);
+
+	return BindMaterialBlock(programID);
+}
+
+/***********************************************************
+ *  BindMaterialBlock()
+ *
+ *  Attaches the MaterialBlock of a shader program to the
+ *  material buffer binding point, so further programs can
+ *  share the buffer created by CreateMaterialBuffer().
+ ***********************************************************/
+bool MaterialLibrary::BindMaterialBlock(GLuint programID)
+{
+	GLuint blockIndex = glGetUniformBlockIndex(programID, "MaterialBlock");
+	if (GL_INVALID_INDEX == blockIndex)
+	{
+		std::cout << "Shader program has no MaterialBlock uniform block" << std::endl;
+		return false;
+	}
+	glUniformBlockBinding(programID, blockIndex, MATERIAL_BLOCK_BINDING);
+
+	return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "GpuResources.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  MaterialID
+ *
+ *  Indices of the shared materials in the material table.
+ *  Objects pass one of these to SetShaderMaterial(), which
+ *  only has to upload the index - the material values stay
+ *  on the GPU in the material buffer.
+ ***********************************************************/
+enum MaterialID
+{
+	MAT_SILVER = 0,
+	MAT_SCREEN,
+	MAT_DECK_OUTLINE,
+	MAT_DARK_KEY,
+	MAT_CENTERPIECE_BASE,
+	MAT_CRYSTAL_BODY,
+	MAT_CRYSTAL_INNER,
+	MAT_WOOD,
+	MAT_TEAL,
+	MAT_BROWN,
+	MAT_COASTER,
+	MAT_BOOK_COVER,
+	MAT_BOOK_PAGES,
+	// number of built in materials - materials added at runtime follow
+	MAT_BUILTIN_COUNT
+};
+
+/***********************************************************
+ *  MaterialLibrary
+ *
+ *  Holds every material used in the scene in one table and
+ *  mirrors it into a uniform buffer. The fragment shader
+ *  reads the material for a draw from that buffer using the
+ *  materialIndex uniform, so switching materials costs one
+ *  integer uniform instead of three separate values.
+ ***********************************************************/
+class MaterialLibrary
+{
+public:
+	// the uniform buffer binding point used for the material table
+	static const GLuint MATERIAL_BLOCK_BINDING = 0;
+	// must match MAX_MATERIALS in the fragment shader
+	static const int MAX_MATERIALS = 64;
+
+	struct Material
+	{
+		std::string tag;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+	};
+
+	// constructor - fills the table with the built in materials, the
+	// material buffer is freed by its handle
+	MaterialLibrary();
+
+	// add a material to the table, returns its index or -1 when full
+	int AddMaterial(std::string tag, glm::vec3 diffuseColor, glm::vec3 specularColor, float shininess);
+	// find a material index by tag, returns -1 when not found
+	int FindMaterial(std::string tag) const;
+	// number of materials in the table
+	int GetMaterialCount() const { return (int)m_materials.size(); }
+	// the material at a table index, which must be below the count
+	const Material& GetMaterial(int index) const { return m_materials[index]; }
+
+	// upload the table into the uniform buffer and connect the
+	// shader program's material block to it
+	bool CreateMaterialBuffer(GLuint programID);
+	// connect another shader program's material block to the buffer
+	bool BindMaterialBlock(GLuint programID);
+
+private:
+	// std140 layout of one material in the uniform buffer
+	struct GPUMaterial
+	{
+		glm::vec4 diffuseColor;         // rgb - diffuse color
+		glm::vec4 specularShininess;    // rgb - specular color, a - shininess
+	};
+
+	std::vector<Material> m_materials;
+	GpuBuffer m_materialBuffer;
+};
@@ -21,10 +21,11 @@ void Book::Render(glm::vec3 position, float scale, float xRotation, float yRotat
     glm::mat4 rotation = BuildRotationMatrix(xRotation, yRotation, zRotation);
 
     // --- front cover --- uses passed in cover texture slot
+    // both covers are occluders for the pages sandwiched between them
     SetShaderMaterial(MAT_BOOK_COVER);
-    m_pShaderManager->setIntValue("bUseTexture", true);
-    m_pShaderManager->setSampler2DValue("objectTexture", m_coverTextureSlot);
-    m_pShaderManager->setVec2Value("UVscale", m_uvScale);
+    m_pShaderManager->setDrawOccluder(true);
+    m_pShaderManager->setDrawTexture(m_coverTextureSlot);
+    m_pShaderManager->setDrawUVScale(m_uvScale);
 
     // offset 0.25 up to sit on top of the pages
     glm::vec3 frontCoverOffset = ScaledOffset(rotation, scale, 0.0f, 0.25f, 0.0f);
@@ -38,12 +39,13 @@ void Book::Render(glm::vec3 position, float scale, float xRotation, float yRotat
     SetTransformations(glm::vec3(2.0f * scale, 0.05f * scale, 3.0f * scale),
         xRotation, yRotation, zRotation, position + backCoverOffset);
     m_basicMeshes->DrawBoxMesh();
+    m_pShaderManager->setDrawOccluder(false);
 
     // --- pages --- slightly smaller than covers, own material and texture
     SetShaderMaterial(MAT_BOOK_PAGES);
-    m_pShaderManager->setSampler2DValue("objectTexture", m_pageTextureSlot);
-    m_pShaderManager->setVec2Value("UVscale", glm::vec2(0.3f, 0.8f));
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.95f, 0.92f, 0.85f, 1.0f));
+    m_pShaderManager->setDrawTexture(m_pageTextureSlot);
+    m_pShaderManager->setDrawUVScale(glm::vec2(0.3f, 0.8f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.95f, 0.92f, 0.85f, 1.0f));
 
     // no offset, centered between the two covers
     SetTransformations(glm::vec3(1.9f * scale, 0.45f * scale, 2.9f * scale),
@@ -52,8 +54,8 @@ void Book::Render(glm::vec3 position, float scale, float xRotation, float yRotat
 
     // --- spine --- thin box on the left side connecting covers, same material as cover
     SetShaderMaterial(MAT_BOOK_COVER);
-    m_pShaderManager->setSampler2DValue("objectTexture", m_coverTextureSlot);
-    m_pShaderManager->setVec2Value("UVscale", glm::vec2(0.5f, 1.0f));
+    m_pShaderManager->setDrawTexture(m_coverTextureSlot);
+    m_pShaderManager->setDrawUVScale(glm::vec2(0.5f, 1.0f));
 
     // offset -1.0 on X to sit on the left edge
     glm::vec3 spineOffset = ScaledOffset(rotation, scale, -1.0f, 0.0f, 0.0f);
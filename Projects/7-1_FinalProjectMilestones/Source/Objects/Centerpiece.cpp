@@ -23,11 +23,11 @@ Centerpiece::Centerpiece(ShaderManager* shaderManager, ShapeMeshes* meshes, int
 void Centerpiece::Render(glm::vec3 position, float scale, float xRotation, float yRotation, float zRotation) {
     glm::mat4 rotation = BuildRotationMatrix(xRotation, yRotation, zRotation);
 
-    m_pShaderManager->setIntValue("bUseTexture", false);
+    m_pShaderManager->setDrawTexture(-1);
 
     // --- flat base --- thin dark cylinder the prism rests on
     SetShaderMaterial(MAT_CENTERPIECE_BASE);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.15f, 0.15f, 0.18f, 1.0f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.15f, 0.15f, 0.18f, 1.0f));
 
     // no offset, base sits at position
     SetTransformations(glm::vec3(0.35f * scale, 0.04f * scale, 0.35f * scale),
@@ -36,7 +36,7 @@ void Centerpiece::Render(glm::vec3 position, float scale, float xRotation, float
 
     // --- prism body --- crystal glass triangular prism standing upright
     SetShaderMaterial(MAT_CRYSTAL_BODY);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.4f, 0.55f, 0.6f, 0.3f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.4f, 0.55f, 0.6f, 0.3f));
 
     // offset up so it sits on top of the base
     glm::vec3 prismOffset = ScaledOffset(rotation, scale, 0.0f, 0.75f, 0.08f);
@@ -46,7 +46,7 @@ void Centerpiece::Render(glm::vec3 position, float scale, float xRotation, float
 
     // --- inner highlight --- slightly smaller prism inside main body
     SetShaderMaterial(MAT_CRYSTAL_INNER);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.5f, 0.7f, 0.75f, 0.5f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.5f, 0.7f, 0.75f, 0.5f));
 
     // same offset as prism body, slightly smaller scale
     SetTransformations(glm::vec3(0.36f * scale, 1.36f * scale, 0.36f * scale),
@@ -61,7 +61,6 @@ void Centerpiece::Render(glm::vec3 position, float scale, float xRotation, float
     float BRANCH_Y_HEIGHT = 1.40f;
     float STEM_LENGTH = 0.6f;
     float STEM_TIP_Y = BRANCH_Y_HEIGHT + STEM_LENGTH;
-    m_pShaderManager->setIntValue("bUseTexture", true);
 
     // --- center main stem --- straight up
     RenderBranch(position, scale, rotation, 0.0f, 0.0f, 0.0f, BRANCH_Y_HEIGHT, 0.0f, STEM_LENGTH);
@@ -109,8 +108,8 @@ void Centerpiece::RenderBranch(glm::vec3 position, float scale, glm::mat4 rotati
 {
 
     SetShaderMaterial(MAT_WOOD);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.12f, 0.08f, 0.05f, 1.0f));
-    m_pShaderManager->setSampler2DValue("objectTexture", m_branchTexture);
+    m_pShaderManager->setDrawColor(glm::vec4(0.12f, 0.08f, 0.05f, 1.0f));
+    m_pShaderManager->setDrawTexture(m_branchTexture);
     glm::mat4 yaw = glm::rotate(glm::radians(yRotation), glm::vec3(0.0f, 1.0f, 0.0f));
     glm::mat4 tilt = glm::rotate(glm::radians(xRotation), glm::vec3(1.0f, 0.0f, 0.0f));
     glm::mat4 branchRotation = rotation * yaw * tilt;
@@ -118,7 +117,7 @@ void Centerpiece::RenderBranch(glm::vec3 position, float scale, glm::mat4 rotati
     glm::vec3 branchOffset = ScaledOffset(rotation, scale, xPosition, yPosition, zPosition);
     SetTransformations(glm::vec3(0.03f * scale, yScale * scale, 0.03f * scale),
         branchRotation, position + branchOffset);
-    m_pShaderManager->setVec2Value("UVscale", glm::vec2(3.0f, 1.0f));
+    m_pShaderManager->setDrawUVScale(glm::vec2(3.0f, 1.0f));
     m_basicMeshes->DrawCylinderMesh(true, true, true);
 }
 
@@ -142,20 +141,20 @@ void Centerpiece::RenderBranchWithBerry(glm::vec3 position, float scale, glm::ma
 
     // --- branch cylinder ---
     SetShaderMaterial(MAT_WOOD);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.12f, 0.08f, 0.05f, 1.0f));
-    m_pShaderManager->setSampler2DValue("objectTexture", m_branchTexture);
+    m_pShaderManager->setDrawColor(glm::vec4(0.12f, 0.08f, 0.05f, 1.0f));
+    m_pShaderManager->setDrawTexture(m_branchTexture);
     SetTransformations(glm::vec3(0.03f * scale, yScale * scale, 0.03f * scale),
         branchRotation, position + branchOffset);
-    m_pShaderManager->setVec2Value("UVscale", glm::vec2(3.0f, 1.0f));
+    m_pShaderManager->setDrawUVScale(glm::vec2(3.0f, 1.0f));
     m_basicMeshes->DrawCylinderMesh(true, true, true);
 
     // --- berry at tip --- offset along the branch direction by yScale
     glm::vec3 tipOffset = glm::vec3(branchRotation * glm::vec4(0.0f, yScale * scale, 0.0f, 0.0f));
     SetShaderMaterial(MAT_CRYSTAL_BODY);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.92f, 0.90f, 0.88f, 1.0f));
-    m_pShaderManager->setSampler2DValue("objectTexture", m_cottonTexture);
+    m_pShaderManager->setDrawColor(glm::vec4(0.92f, 0.90f, 0.88f, 1.0f));
+    m_pShaderManager->setDrawTexture(m_cottonTexture);
     SetTransformations(glm::vec3(0.07f * scale, 0.07f * scale, 0.07f * scale),
         rotation, position + branchOffset + tipOffset);
-    m_pShaderManager->setVec2Value("UVscale", glm::vec2(1.0f, 1.0f));
+    m_pShaderManager->setDrawUVScale(glm::vec2(1.0f, 1.0f));
     m_basicMeshes->DrawSphereMesh();
 }
@@ -23,21 +23,20 @@ void Coaster::Render(glm::vec3 position, float scale, float xRotation, float yRo
     // build rotation matrix for transforming offsets and the handle
 	glm::mat4 rotation = BuildRotationMatrix(xRotation, yRotation, zRotation);
 
-    m_pShaderManager->setIntValue("bUseTexture", true);
-    m_pShaderManager->setSampler2DValue("objectTexture", m_coasterTexture);
+    m_pShaderManager->setDrawTexture(m_coasterTexture);
     SetShaderMaterial(MAT_COASTER);
 
     // --- flat base sides --- tiled UV to avoid stretching on the thin sides, no offset
     // tile UV 8x horizontally and compress vertically on the cylinder sides
     // this prevents the wood grain from stretching around the curved rim
     // and instead repeats it naturally like real wood grain would appear
-    m_pShaderManager->setVec2Value("UVscale", glm::vec2(8.0f, 0.1f));
+    m_pShaderManager->setDrawUVScale(glm::vec2(8.0f, 0.1f));
     SetTransformations(glm::vec3(0.7f * scale, 0.1f * scale, 0.7f * scale),
         xRotation, yRotation, zRotation, position);
     m_basicMeshes->DrawCylinderMesh(false, false, true);
 
     // --- flat base top and bottom --- normal UV for flat faces, no offset
-    m_pShaderManager->setVec2Value("UVscale", glm::vec2(1.0f, 1.0f));
+    m_pShaderManager->setDrawUVScale(glm::vec2(1.0f, 1.0f));
     SetTransformations(glm::vec3(0.7f * scale, 0.1f * scale, 0.7f * scale),
         xRotation, yRotation, zRotation, position);
     m_basicMeshes->DrawCylinderMesh(true, true, false);
@@ -45,7 +44,7 @@ void Coaster::Render(glm::vec3 position, float scale, float xRotation, float yRo
     // --- raised ring --- torus sitting on the edge of the base
     // base rotation 90 on X orients the torus flat
     // mug rotation matrix applied on top to follow object rotation
-    m_pShaderManager->setVec2Value("UVscale", glm::vec2(3.0f, 0.7f));
+    m_pShaderManager->setDrawUVScale(glm::vec2(3.0f, 0.7f));
     glm::mat4 ringBaseRot = glm::rotate(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
     glm::mat4 ringRotation = rotation * ringBaseRot;
 
@@ -22,13 +22,14 @@ Laptop::Laptop(ShaderManager* shaderManager, ShapeMeshes* meshes, int laptopFram
 void Laptop::Render(glm::vec3 position, float scale, float xRotation, float yRotation, float zRotation) {
     glm::mat4 rotation = BuildRotationMatrix(xRotation, yRotation, zRotation);
 
-    // enable textures for the aluminum body panels
-    m_pShaderManager->setIntValue("bUseTexture", true);
-    m_pShaderManager->setSampler2DValue("objectTexture", m_laptopFrameTexture);
+    // enable textures for the aluminum body panels - the deck and the
+    // open screen are occluders for the keys and parts behind them
+    m_pShaderManager->setDrawTexture(m_laptopFrameTexture);
+    m_pShaderManager->setDrawOccluder(true);
 
     // --- base / keyboard deck --- flat silver box, no offset
     SetShaderMaterial(MAT_SILVER);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.76f, 0.76f, 0.76f, 1.0f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.76f, 0.76f, 0.76f, 1.0f));
 
     SetTransformations(glm::vec3(3.0f * scale, 0.1f * scale, 2.0f * scale),
         xRotation, yRotation, zRotation, position);
@@ -36,7 +37,7 @@ void Laptop::Render(glm::vec3 position, float scale, float xRotation, float yRot
 
     // --- screen panel --- slightly thinner box, hinged open at the back
     // offset 1.0 back on Z and 1.0 up, tilted open on X
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.76f, 0.76f, 0.76f, 1.0f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.76f, 0.76f, 0.76f, 1.0f));
     glm::mat4 screenBaseRot = glm::rotate(glm::radians(-100.0f), glm::vec3(1.0f, 0.0f, 0.0f));
     glm::mat4 screenRotation = rotation * screenBaseRot;
     glm::vec3 screenOffset = ScaledOffset(rotation, scale, 0.0f, 0.79f, -1.08f);
@@ -44,13 +45,14 @@ void Laptop::Render(glm::vec3 position, float scale, float xRotation, float yRot
     SetTransformations(glm::vec3(3.0f * scale, 0.08f * scale, 1.5f * scale),
         screenRotation, position + screenOffset);
     m_basicMeshes->DrawBoxMesh();
+    m_pShaderManager->setDrawOccluder(false);
 
     // disable textures for remaining parts
-    m_pShaderManager->setIntValue("bUseTexture", false);
+    m_pShaderManager->setDrawTexture(-1);
 
     // --- screen outline --- near-black border around the screen panel, sides only
     SetShaderMaterial(MAT_SCREEN);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.05f, 0.05f, 0.05f, 1.0f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.05f, 0.05f, 0.05f, 1.0f));
 
     glm::vec3 screenOutlineOffset = ScaledOffset(rotation, scale, 0.0f, 0.8f, -1.05f);
     SetTransformations(glm::vec3(2.9f * scale, 0.03f * scale, 1.44f * scale),
@@ -69,7 +71,7 @@ void Laptop::Render(glm::vec3 position, float scale, float xRotation, float yRot
 
     // --- keyboard area --- dark outline on top of the base, sides only
     SetShaderMaterial(MAT_DECK_OUTLINE);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.15f, 0.15f, 0.15f, 1.0f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.15f, 0.15f, 0.15f, 1.0f));
 
     glm::vec3 keyboardOffset = ScaledOffset(rotation, scale, 0.0f, 0.06f, -0.275f);
     SetTransformations(glm::vec3(2.6f * scale, 0.01f * scale, 1.05f * scale),
@@ -109,10 +111,9 @@ void Laptop::RenderKeyboard(glm::vec3 position, float scale, float xRotation, fl
     glm::mat4 rotation = BuildRotationMatrix(xRotation, yRotation, zRotation);
 
     // enable textures and apply key material for all keys
-    m_pShaderManager->setIntValue("bUseTexture", true);
-    m_pShaderManager->setSampler2DValue("objectTexture", m_keyTexture);
+    m_pShaderManager->setDrawTexture(m_keyTexture);
     SetShaderMaterial(MAT_DARK_KEY);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.2f, 0.2f, 0.2f, 1.0f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.2f, 0.2f, 0.2f, 1.0f));
 
     float keyH = 0.062f;        // Y offset above deck
     float sqW = 0.155f;         // square key X
@@ -274,5 +275,5 @@ void Laptop::RenderKeyboard(glm::vec3 position, float scale, float xRotation, fl
     m_basicMeshes->DrawBoxMesh();
 
     // disable textures for next parts/items
-    m_pShaderManager->setIntValue("bUseTexture", false);
+    m_pShaderManager->setDrawTexture(-1);
 }
\ No newline at end of file
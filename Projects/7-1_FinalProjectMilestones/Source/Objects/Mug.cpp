@@ -23,11 +23,11 @@ void Mug::Render(glm::vec3 position, float scale, float xRotation, float yRotati
     glm::mat4 rotation = BuildRotationMatrix(xRotation, yRotation, zRotation);
 
     // no texture, mug uses flat colors
-    m_pShaderManager->setIntValue("bUseTexture", false);
+    m_pShaderManager->setDrawTexture(-1);
 
     // --- base ring --- brown band at the bottom
     SetShaderMaterial(MAT_BROWN);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.545f, 0.271f, 0.075f, 1.0f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.545f, 0.271f, 0.075f, 1.0f));
 
     // offset -0.01 down to sit flush at the base
     glm::vec3 outerBottomOffset = ScaledOffset(rotation, scale, 0.0f, -0.01f, 0.0f);
@@ -36,7 +36,7 @@ void Mug::Render(glm::vec3 position, float scale, float xRotation, float yRotati
     m_basicMeshes->DrawCylinderMesh(false, true, true);
 
     // --- white band --- decorative stripe, material carries over from base ring
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.8f, 0.8f, 0.8f, 1.0f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.8f, 0.8f, 0.8f, 1.0f));
 
     // offset 0.05 up from base
     glm::vec3 middleBottomOffset = ScaledOffset(rotation, scale, 0.0f, 0.05f, 0.0f);
@@ -45,7 +45,7 @@ void Mug::Render(glm::vec3 position, float scale, float xRotation, float yRotati
     m_basicMeshes->DrawCylinderMesh(false, false, true);
 
     // --- top ring --- brown band matching base
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.545f, 0.271f, 0.075f, 1.0f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.545f, 0.271f, 0.075f, 1.0f));
 
     // offset 0.35 up
     glm::vec3 topBottomOffset = ScaledOffset(rotation, scale, 0.0f, 0.35f, 0.0f);
@@ -54,16 +54,19 @@ void Mug::Render(glm::vec3 position, float scale, float xRotation, float yRotati
     m_basicMeshes->DrawCylinderMesh(false, false, true);
 
     // --- outer body --- main teal cylinder drawn over the bands, no offset
+    // occluder for the inner wall behind it
     SetShaderMaterial(MAT_TEAL);
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.4f, 0.55f, 0.5f, 1.0f));
+    m_pShaderManager->setDrawOccluder(true);
+    m_pShaderManager->setDrawColor(glm::vec4(0.4f, 0.55f, 0.5f, 1.0f));
 
     SetTransformations(glm::vec3(0.6f * scale, 1.2f * scale, 0.6f * scale),
         xRotation, yRotation, zRotation, position);
     m_basicMeshes->DrawCylinderMesh(false, true, true);
+    m_pShaderManager->setDrawOccluder(false);
 
     // --- inner wall --- slightly smaller radius to create hollow look
     // objectColor only - slightly darker teal, material carries over from outer body
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.35f, 0.5f, 0.45f, 1.0f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.35f, 0.5f, 0.45f, 1.0f));
 
     // offset 0.05 up so it sits inside the rim
     glm::vec3 innerOffset = ScaledOffset(rotation, scale, 0.0f, 0.05f, 0.0f);
@@ -74,7 +77,7 @@ void Mug::Render(glm::vec3 position, float scale, float xRotation, float yRotati
     // --- handle --- half torus, base rotation 270 on Z orients it upright
     // mug rotation matrix applied on top to follow object rotation
     // objectColor only - same teal as body, material carries over
-    m_pShaderManager->setVec4Value("objectColor", glm::vec4(0.4f, 0.55f, 0.5f, 1.0f));
+    m_pShaderManager->setDrawColor(glm::vec4(0.4f, 0.55f, 0.5f, 1.0f));
     glm::mat4 handleBaseRot = glm::rotate(glm::radians(270.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     glm::mat4 handleRotation = rotation * handleBaseRot;
 
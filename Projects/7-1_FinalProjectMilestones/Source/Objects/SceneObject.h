@@ -2,6 +2,7 @@
 #include <glm/glm.hpp>
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "../MaterialLibrary.h"
 
 /***********************************************************
  *  SceneObject
@@ -43,52 +44,17 @@ protected:
     ShapeMeshes* m_basicMeshes;
 
 
-    /***********************************************************
-     *  ShaderMaterial
-     *
-     *  Holds the three material properties used by the
-     *  lighting shader. Used with SetShaderMaterial() to apply
-     *  a material to the next draw call in one step rather than
-     *  setting each shader individually. 
-     *  (similiar to the OpenGLSample project)
-     ***********************************************************/
-    struct ShaderMaterial {
-        glm::vec3 diffuse;
-        glm::vec3 specular;
-        float shininess;
-    };
-
-    // shared materials reused across multiple objects.
-    // defined here so all derived classes have access without
-    // repeating the same magic values in each object's source file.
-    // static since we only need one instance of each material to apply
-    // which helps reduce memory
-    static const ShaderMaterial MAT_SILVER;
-    static const ShaderMaterial MAT_SCREEN;
-    static const ShaderMaterial MAT_DECK_OUTLINE;
-    static const ShaderMaterial MAT_DARK_KEY;
-    static const ShaderMaterial MAT_CENTERPIECE_BASE;
-    static const ShaderMaterial MAT_CRYSTAL_BODY;
-    static const ShaderMaterial MAT_CRYSTAL_INNER;
-    static const ShaderMaterial MAT_WOOD;
-    static const ShaderMaterial MAT_TEAL;
-    static const ShaderMaterial MAT_BROWN;
-    static const ShaderMaterial MAT_COASTER;
-    static const ShaderMaterial MAT_BOOK_COVER;
-    static const ShaderMaterial MAT_BOOK_PAGES;
-
     /***********************************************************
      *  SetShaderMaterial()
      *
-     *  wrapper to upload diffuse color, specular color,
-     *  and shininess into the shader in one call.
+     *  selects the material for the next draw call. The shared
+     *  material values live in the MaterialLibrary's GPU table,
+     *  so only the material index has to be uploaded.
      *
-     *  mat - the ShaderMaterial to apply to the next draw call
+     *  material - the MaterialID of the material to apply
      ***********************************************************/
-    void SetShaderMaterial(const ShaderMaterial& mat) {
-        m_pShaderManager->setVec3Value("material.diffuseColor", mat.diffuse);
-        m_pShaderManager->setVec3Value("material.specularColor", mat.specular);
-        m_pShaderManager->setFloatValue("material.shininess", mat.shininess);
+    void SetShaderMaterial(MaterialID material) {
+        m_pShaderManager->setDrawMaterial((int)material);
     }
 
     // builds and uploads the model matrix from X, Y, Z
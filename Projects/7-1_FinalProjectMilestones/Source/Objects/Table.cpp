@@ -24,9 +24,8 @@ void Table::Render(glm::vec3 position, float scale, float xRotation, float yRota
     glm::mat4 rotation = BuildRotationMatrix(xRotation, yRotation, zRotation);
 
     // table_leg texture at slot 2, shared across all legs
-    m_pShaderManager->setIntValue("bUseTexture", true);
-    m_pShaderManager->setSampler2DValue("objectTexture", m_woodLegTexture);
-    m_pShaderManager->setVec2Value("UVscale", glm::vec2(1.0f, 1.0f));
+    m_pShaderManager->setDrawTexture(m_woodLegTexture);
+    m_pShaderManager->setDrawUVScale(glm::vec2(1.0f, 1.0f));
 
     // scales and offsets for the table legs
     float SLANT_LEG_Y_SCALE = 2.5f;
@@ -126,12 +125,15 @@ void Table::Render(glm::vec3 position, float scale, float xRotation, float yRota
     m_basicMeshes->DrawBoxMesh();
 
     // --- table top --- flat cylinder, table_wood texture at slot 1
-    m_pShaderManager->setSampler2DValue("objectTexture", m_tableTopTexture);
-    m_pShaderManager->setVec2Value("UVscale", glm::vec2(1.0f, 1.0f));
+    // the top hides most of the legs, so it is drawn as an occluder
+    m_pShaderManager->setDrawTexture(m_tableTopTexture);
+    m_pShaderManager->setDrawOccluder(true);
+    m_pShaderManager->setDrawUVScale(glm::vec2(1.0f, 1.0f));
 
     // offset 5.03 up to sit above all legs
     glm::vec3 tableTopOffset = ScaledOffset(rotation, scale, 0.0f, 5.03f, 0.0f);
     SetTransformations(glm::vec3(6.0f * scale, 0.2f * scale, 6.0f * scale),
         xRotation, yRotation, zRotation, position + tableTopOffset);
     m_basicMeshes->DrawCylinderMesh();
+    m_pShaderManager->setDrawOccluder(false);
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "RenderSettings.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+/***********************************************************
+ *  ParseArgument()
+ *
+ *  The command line options for benchmarking the draw paths,
+ *  shared by the application and the headless benchmark:
+ *    --indirect    start with the multi-draw indirect path
+ *    --copies N    render N copies of the scene
+ *    --cull        start with frustum culling enabled
+ *    --occlusion   start with occlusion culling enabled
+ *    --prepass     start with the depth pre-pass enabled
+ *    --lightlists  start with the per-draw light lists enabled
+ *    --clustered   start with clustered lighting enabled
+ *    --lights N    add N small point lights to the scene
+ *    --deferred    start with deferred shading
+ *    --shadows     start with shadows enabled
+ *    --baked       start with the baked lighting of the static draws
+ *    --oit         start with the weighted blended transparency
+ *    --impostors   start with the ray-cast sphere impostors
+ *    --spheres N   add N small spheres above the table
+ *    --gpu-timers  start with the GPU pass and object timers
+ *    --stats       start with the render statistics overlay
+ *    --trace       write the timing zones to a Chrome trace on exit
+ *    --gl-debug    log the driver messages on a debug context
+ *  and the GL call capture for GlReplay:
+ *    --capture FILE      record the GL calls into FILE
+ *    --capture-start N   first frame of the window (default 10)
+ *    --capture-frames N  frames in the window (default 10)
+ *  and the camera fly-throughs:
+ *    --record-camera FILE  write the camera of every frame to FILE
+ *    --play-camera FILE    drive the camera from the path in FILE
+ ***********************************************************/
+bool RenderSettings::ParseArgument(int argc, char* argv[], int& index)
+{
+	const char* argument = argv[index];
+	bool bHasValue = (index + 1 < argc);
+
+	if (strcmp(argument, "--indirect") == 0)
+	{
+		bIndirectDraw = true;
+	}
+	else if (strcmp(argument, "--cull") == 0)
+	{
+		bFrustumCulling = true;
+	}
+	else if (strcmp(argument, "--occlusion") == 0)
+	{
+		bOcclusionCulling = true;
+	}
+	else if (strcmp(argument, "--prepass") == 0)
+	{
+		bDepthPrepass = true;
+	}
+	else if (strcmp(argument, "--lightlists") == 0)
+	{
+		bLightLists = true;
+	}
+	else if (strcmp(argument, "--clustered") == 0)
+	{
+		bClusteredLighting = true;
+	}
+	else if (strcmp(argument, "--deferred") == 0)
+	{
+		bDeferredShading = true;
+	}
+	else if (strcmp(argument, "--shadows") == 0)
+	{
+		bShadows = true;
+	}
+	else if (strcmp(argument, "--baked") == 0)
+	{
+		bBakedLighting = true;
+	}
+	else if (strcmp(argument, "--oit") == 0)
+	{
+		bOrderIndependentTransparency = true;
+	}
+	else if (strcmp(argument, "--impostors") == 0)
+	{
+		bSphereImpostors = true;
+	}
+	else if (strcmp(argument, "--gpu-timers") == 0)
+	{
+		bGpuTimers = true;
+	}
+	else if (strcmp(argument, "--stats") == 0)
+	{
+		bStatsOverlay = true;
+	}
+	else if (strcmp(argument, "--trace") == 0)
+	{
+		bTrace = true;
+	}
+	else if (strcmp(argument, "--gl-debug") == 0)
+	{
+		bDebugOutput = true;
+	}
+	else if ((strcmp(argument, "--spheres") == 0) && (bHasValue == true))
+	{
+		extraSphereCount = std::max(0, atoi(argv[++index]));
+	}
+	else if ((strcmp(argument, "--lights") == 0) && (bHasValue == true))
+	{
+		extraLightCount = std::max(0, atoi(argv[++index]));
+	}
+	else if ((strcmp(argument, "--copies") == 0) && (bHasValue == true))
+	{
+		sceneCopies = std::max(1, atoi(argv[++index]));
+	}
+	else if ((strcmp(argument, "--capture") == 0) && (bHasValue == true))
+	{
+		captureFile = argv[++index];
+	}
+	else if ((strcmp(argument, "--capture-start") == 0) && (bHasValue == true))
+	{
+		captureFirstFrame = std::max(0, atoi(argv[++index]));
+	}
+	else if ((strcmp(argument, "--capture-frames") == 0) && (bHasValue == true))
+	{
+		captureFrameCount = std::max(1, atoi(argv[++index]));
+	}
+	else if ((strcmp(argument, "--record-camera") == 0) && (bHasValue == true))
+	{
+		cameraRecordFile = argv[++index];
+	}
+	else if ((strcmp(argument, "--play-camera") == 0) && (bHasValue == true))
+	{
+		cameraPlaybackFile = argv[++index];
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
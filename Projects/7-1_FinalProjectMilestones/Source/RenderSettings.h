@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+
+/***********************************************************
+ *  RenderSettings
+ *
+ *  Options that choose how the SceneManager renders the
+ *  scene. They are set from the command line at startup and
+ *  can be toggled with the function keys while running.
+ ***********************************************************/
+struct RenderSettings
+{
+	// draw the recorded scene with one multi-draw indirect call
+	// instead of one draw call per mesh
+	bool bIndirectDraw = false;
+	// number of copies of the scene laid out in a grid, used to
+	// benchmark the draw paths on heavier scenes
+	int sceneCopies = 1;
+	// skip draws whose bounding sphere is outside the view frustum -
+	// culled by a compute shader on the indirect path when possible
+	bool bFrustumCulling = false;
+	// skip draws hidden behind the large occluder parts - tested
+	// against a depth pyramid by the GPU culling pass, so it only
+	// works on the indirect path
+	bool bOcclusionCulling = false;
+	// draw the opaque draws depth only first, then shade them with
+	// an equal depth test so every pixel is shaded only once
+	bool bDepthPrepass = false;
+	// give every recorded draw a short list of the lights whose range
+	// reaches its bounds, so the forward shaders only evaluate those
+	bool bLightLists = false;
+	// light the indirect path from per cluster light lists, so only
+	// the lights in range of a fragment are evaluated
+	bool bClusteredLighting = false;
+	// number of small point lights added around the scene to stress
+	// the light lists and the clustered lighting - only those draw them
+	int extraLightCount = 0;
+	// shadows of the directional and spot light - the static draws are
+	// cached in their own shadow maps, only the dynamic ones are redrawn
+	bool bShadows = false;
+	// draw the static opaque draws with a lightmap baked on the CPU
+	// instead of lighting them per fragment - the forward paths only
+	bool bBakedLighting = false;
+	// draw the translucent draws unsorted into weighted accumulation
+	// and revealage targets, with the opaque draws unblended - the
+	// recorded paths only
+	bool bOrderIndependentTransparency = false;
+	// draw the opaque spheres as ray-cast impostors on one quad each
+	// instead of sphere meshes - the forward recorded paths only
+	bool bSphereImpostors = false;
+	// number of small spheres added above the table to stress the
+	// sphere meshes and the impostors
+	int extraSphereCount = 0;
+	// write the opaque draws to a G-buffer and light the covered
+	// pixels in screen space - only on the indirect path
+	bool bDeferredShading = false;
+	// time the render passes and, on the immediate path, the scene
+	// objects on the GPU, reported with the render time
+	bool bGpuTimers = false;
+	// draw the GL call counters of the frame, the frame time statistics
+	// and a graph of the recent frame times over the scene
+	bool bStatsOverlay = false;
+	// record the startup and the frames as timing zones and write them
+	// as a Chrome trace on exit, see TraceZones
+	bool bTrace = false;
+	// create a debug context and log the messages of the driver, like
+	// its performance warnings, with the objects and draws named - read
+	// once at startup, see DebugOutput
+	bool bDebugOutput = false;
+	// record the GL calls from startup through the capture window into
+	// this file for GlReplay, when set - read once at startup, see
+	// GlCapture
+	std::string captureFile;
+	// the first frame of the capture window, counting from 0, and the
+	// frames it records - the window starts past the first frames, which
+	// create the lazily sized targets and stream the textures
+	int captureFirstFrame = 10;
+	int captureFrameCount = 10;
+	// write the camera of every frame to this file on exit, when set -
+	// the application only, see CameraPath
+	std::string cameraRecordFile;
+	// drive the camera from this recorded path at its fixed frame rate
+	// instead of the input, when set - the application closes after the
+	// last frame and the benchmark renders the path instead of the
+	// preset views
+	std::string cameraPlaybackFile;
+
+	// apply the command line option at argv[index] - options with a
+	// value advance index past it. Returns false for unknown options.
+	bool ParseArgument(int argc, char* argv[], int& index);
+};
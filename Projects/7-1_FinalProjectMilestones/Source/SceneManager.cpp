@@ -8,6 +8,8 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "DebugOutput.h"
+#include "TraceZones.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -16,14 +18,38 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
 // declaration of global variables
 namespace
 {
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
+	// the maximum number of decoded images uploaded in a single frame
+	const int MAX_TEXTURE_UPLOADS_PER_FRAME = 2;
+	// distance between the scene copies of the draw path benchmark
+	const float SCENE_COPY_SPACING = 32.0f;
+	// number of frames averaged for each render time report
+	const int TIMED_FRAME_COUNT = 300;
+	// the GPU times of the last report, rewritten with every report
+	const char* g_GpuTimerReportFile = "gpu_timings.json";
+
 	const char* g_UseLightingName = "bUseLighting";
+	// size of the pointLights uniform array in lighting.glsl
+	const int TOTAL_POINT_LIGHTS = 5;
+	// the directional light, which also casts shadows and is baked
+	// into the lightmap
+	const glm::vec3 g_DirectionalLightDirection = glm::vec3(-0.2f, -1.0f, -0.3f);
+	const glm::vec3 g_DirectionalLightAmbient = glm::vec3(0.1f, 0.1f, 0.3f);
+	const glm::vec3 g_DirectionalLightDiffuse = glm::vec3(0.4f, 0.5f, 0.9f);
+
+	// blended draws must not be in the depth pre-pass, or they would
+	// hide the draws behind them
+	bool IsOpaqueRecord(const ShapeMeshes::DrawRecord& record)
+	{
+		return (record.parameters.color.a >= 1.0f);
+	}
 }
 
 /***********************************************************
@@ -35,6 +61,43 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 {
 	m_pShaderManager = pShaderManager;
 	m_basicMeshes = new ShapeMeshes();
+	// the meshes upload the packed per-draw parameters before each draw
+	m_basicMeshes->SetShaderManager(m_pShaderManager);
+	m_loadedTextures = 0;
+	m_pTextureLoader = new TextureLoader();
+	m_pMaterialLibrary = new MaterialLibrary();
+	m_pLightLists = new LightLists();
+	m_pIndirectRenderer = NULL;
+	m_pDepthPrepass = NULL;
+	m_pClusteredLighting = NULL;
+	m_pDeferredRenderer = NULL;
+	m_pShadowMaps = NULL;
+	m_pBakedLighting = NULL;
+	m_pTransparencyPass = NULL;
+	m_pSphereImpostors = NULL;
+	m_pGpuTimers = NULL;
+	m_pFrameTimers = NULL;
+	m_pStatsOverlay = NULL;
+	m_bFrameStarted = false;
+	m_forwardLightCount = 0;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
+	m_renderTime = std::chrono::duration<double, std::milli>::zero();
+	m_timedFrames = 0;
+	m_sceneDrawCount = 0;
+	m_culledDrawCount = 0;
+	m_occludedDrawCount = -1;
+	m_bGPUCulling = false;
+	m_bOcclusionCulling = false;
+	m_bDepthPrepass = false;
+	m_bLightLists = false;
+	m_bClusteredLighting = false;
+	m_bDeferredShading = false;
+	m_bShadows = false;
+	m_bBakedLighting = false;
+	m_bTransparencyPass = false;
+	m_bSphereImpostors = false;
 }
 
 /***********************************************************
@@ -47,80 +110,355 @@ SceneManager::~SceneManager()
 	m_pShaderManager = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
+	// stops the decode threads and frees any uncollected images
+	delete m_pTextureLoader;
+	m_pTextureLoader = NULL;
+	DestroyGLTextures();
+	delete m_pMaterialLibrary;
+	m_pMaterialLibrary = NULL;
+	delete m_pLightLists;
+	m_pLightLists = NULL;
+	delete m_pIndirectRenderer;
+	m_pIndirectRenderer = NULL;
+	delete m_pDepthPrepass;
+	m_pDepthPrepass = NULL;
+	delete m_pClusteredLighting;
+	m_pClusteredLighting = NULL;
+	delete m_pDeferredRenderer;
+	m_pDeferredRenderer = NULL;
+	delete m_pShadowMaps;
+	m_pShadowMaps = NULL;
+	// waits for a running bake
+	delete m_pBakedLighting;
+	m_pBakedLighting = NULL;
+	delete m_pTransparencyPass;
+	m_pTransparencyPass = NULL;
+	delete m_pSphereImpostors;
+	m_pSphereImpostors = NULL;
+	delete m_pGpuTimers;
+	m_pGpuTimers = NULL;
+	m_pFrameTimers = NULL;
+	delete m_pStatsOverlay;
+	m_pStatsOverlay = NULL;
 }
 
 /***********************************************************
  *  CreateGLTexture()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  This method is used for loading textures from image files
+ *  into the next available texture slot in memory. The slot
+ *  is reserved right away and shows the placeholder texture,
+ *  while the image file is decoded on a worker thread. The
+ *  decoded image is uploaded later by UpdateTextureUploads().
  ***********************************************************/
 bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 {
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+	TRACE_ZONE_DETAIL("CreateGLTexture", filename);
+	if (m_loadedTextures >= MAX_TEXTURE_SLOTS)
+	{
+		std::cout << "No free texture slot for image:" << filename << std::endl;
+		return false;
+	}
+
+	if (0 == m_placeholderTexture)
+	{
+		CreatePlaceholderTexture();
+	}
+
+	// register the slot and associate it with the special tag string
+	// so objects can look the slot up before the image has arrived
+	m_textureIDs[m_loadedTextures].ID = m_placeholderTexture;
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_pTextureLoader->QueueImage(filename, m_loadedTextures);
+	m_loadedTextures++;
+
+	return true;
+}
+
+/***********************************************************
+ *  CreatePlaceholderTexture()
+ *
+ *  This method creates a 1x1 neutral grey texture that is
+ *  bound to every texture slot until the real image for the
+ *  slot has been decoded and uploaded.
+ ***********************************************************/
+void SceneManager::CreatePlaceholderTexture()
+{
+	const unsigned char greyPixel[4] = { 128, 128, 128, 255 };
+
+	m_placeholderTexture.Create();
+	glBindTexture(GL_TEXTURE_2D, m_placeholderTexture);
+	m_placeholderTexture.SetLabel("Placeholder texture");
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, greyPixel);
+	m_placeholderTexture.SetBytes(GpuResources::TextureBytes(GL_RGBA8, 1, 1));
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/***********************************************************
+ *  UploadDecodedTexture()
+ *
+ *  This method uploads a decoded image into its texture slot.
+ *  The pixels are copied into a pixel buffer object so the
+ *  driver can transfer them without stalling, the texture
+ *  gets immutable storage for the full mipmap chain, and the
+ *  mipmaps are generated from the uploaded base level.
+ ***********************************************************/
+bool SceneManager::UploadDecodedTexture(TextureLoader::DecodedImage& image)
+{
+	GLenum internalFormat = GL_RGB8;
+	GLenum pixelFormat = GL_RGB;
+
+	if (NULL != image.compressed)
+	{
+		return UploadCompressedTexture(image);
+	}
+
+	if (NULL == image.pixels)
+	{
+		std::cout << "Could not load image:" << image.filename << std::endl;
+		return false;
+	}
+
+	// if the loaded image is in RGB format
+	if (image.channels == 3)
+	{
+		internalFormat = GL_RGB8;
+		pixelFormat = GL_RGB;
+	}
+	// if the loaded image is in RGBA format - it supports transparency
+	else if (image.channels == 4)
+	{
+		internalFormat = GL_RGBA8;
+		pixelFormat = GL_RGBA;
+	}
+	else
+	{
+		std::cout << "Not implemented to handle image with " << image.channels << " channels" << std::endl;
+		return false;
+	}
+
+	std::cout << "Successfully loaded image:" << image.filename << ", width:" << image.width << ", height:" << image.height << ", channels:" << image.channels << std::endl;
+
+	GLsizeiptr imageSize = (GLsizeiptr)image.width * image.height * image.channels;
+
+	// copy the pixels into the pixel buffer object - orphaning the
+	// previous storage means an earlier upload still in flight never
+	// has to be waited on
+	if (0 == m_pixelUnpackBuffer)
+	{
+		m_pixelUnpackBuffer.Create();
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelUnpackBuffer);
+		m_pixelUnpackBuffer.SetLabel("Texture upload buffer");
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelUnpackBuffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, imageSize, NULL, GL_STREAM_DRAW);
+	m_pixelUnpackBuffer.SetBytes(imageSize);
+	void* mappedPixels = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, imageSize,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (NULL == mappedPixels)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		std::cout << "Could not map pixel buffer for image:" << image.filename << std::endl;
+		return false;
+	}
+	memcpy(mappedPixels, image.pixels, (size_t)imageSize);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	// create the texture on the slot's own texture unit - binding it on
+	// whichever unit is active would replace another slot's texture
+	GpuTexture& texture = m_textureIDs[image.slot].texture;
+	texture.Create();
+	glActiveTexture(GL_TEXTURE0 + image.slot);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	texture.SetLabel(m_textureIDs[image.slot].tag.c_str());
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters - sample the mipmaps when minifying
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// RGB rows are not always 4 byte aligned
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// allocate immutable storage for every mip level when supported,
+	// then upload the base level out of the pixel buffer object
+	GLsizei mipLevels = 1;
+	int largestSide = std::max(image.width, image.height);
+	while ((largestSide >>= 1) > 0)
+	{
+		mipLevels++;
+	}
+	if (GLEW_ARB_texture_storage)
+	{
+		glTexStorage2D(GL_TEXTURE_2D, mipLevels, internalFormat, image.width, image.height);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width, image.height, pixelFormat, GL_UNSIGNED_BYTE, (void*)0);
+	}
+	else
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.width, image.height, 0, pixelFormat, GL_UNSIGNED_BYTE, (void*)0);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	// generate the texture mipmaps for mapping textures to lower resolutions
+	glGenerateMipmap(GL_TEXTURE_2D);
+	texture.SetBytes(GpuResources::TextureBytes(internalFormat, image.width, image.height, mipLevels));
+
+	// swap the placeholder out of the slot - the real texture is already
+	// bound on the slot's texture unit, so objects keep sampling the same slot
+	m_textureIDs[image.slot].ID = texture;
+
+	return true;
+}
+
+/***********************************************************
+ *  UploadCompressedTexture()
+ *
+ *  This method uploads a block compressed image with its
+ *  precomputed mipmap chain. All levels are packed into the
+ *  pixel buffer object in one copy and each level is then
+ *  uploaded from its offset, so no mipmaps are generated at
+ *  runtime.
+ ***********************************************************/
+bool SceneManager::UploadCompressedTexture(TextureLoader::DecodedImage& image)
+{
+	const TextureCompressor::CompressedImage& compressed = *image.compressed;
+	GLenum internalFormat = (compressed.format == TextureCompressor::BC3) ?
+		GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	GLsizei mipLevels = (GLsizei)compressed.mips.size();
+
+	std::cout << "Successfully loaded compressed image:" << image.filename << ", width:" << image.width << ", height:" << image.height << ", mip levels:" << mipLevels << std::endl;
+
+	GLsizeiptr totalSize = 0;
+	for (int i = 0; i < mipLevels; i++)
+	{
+		totalSize += (GLsizeiptr)compressed.mips[i].blocks.size();
+	}
+
+	if (0 == m_pixelUnpackBuffer)
+	{
+		m_pixelUnpackBuffer.Create();
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelUnpackBuffer);
+		m_pixelUnpackBuffer.SetLabel("Texture upload buffer");
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelUnpackBuffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, totalSize, NULL, GL_STREAM_DRAW);
+	m_pixelUnpackBuffer.SetBytes(totalSize);
+	unsigned char* mappedBlocks = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, totalSize,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (NULL == mappedBlocks)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		std::cout << "Could not map pixel buffer for image:" << image.filename << std::endl;
+		return false;
+	}
+	size_t offset = 0;
+	for (int i = 0; i < mipLevels; i++)
+	{
+		memcpy(mappedBlocks + offset, &compressed.mips[i].blocks[0], compressed.mips[i].blocks.size());
+		offset += compressed.mips[i].blocks.size();
+	}
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	// create the texture on the slot's own texture unit - binding it on
+	// whichever unit is active would replace another slot's texture
+	GpuTexture& texture = m_textureIDs[image.slot].texture;
+	texture.Create();
+	glActiveTexture(GL_TEXTURE0 + image.slot);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	texture.SetLabel(m_textureIDs[image.slot].tag.c_str());
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters - sample the mipmaps when minifying
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipLevels - 1);
+
+	if (GLEW_ARB_texture_storage)
+	{
+		glTexStorage2D(GL_TEXTURE_2D, mipLevels, internalFormat, image.width, image.height);
+	}
+
+	offset = 0;
+	for (int i = 0; i < mipLevels; i++)
+	{
+		const TextureCompressor::MipLevel& mip = compressed.mips[i];
+		if (GLEW_ARB_texture_storage)
+		{
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, mip.width, mip.height,
+				internalFormat, (GLsizei)mip.blocks.size(), (void*)offset);
+		}
 		else
 		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, mip.width, mip.height, 0,
+				(GLsizei)mip.blocks.size(), (void*)offset);
 		}
+		offset += mip.blocks.size();
+	}
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	texture.SetBytes(totalSize);
 
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+	// swap the placeholder out of the slot - the real texture is already
+	// bound on the slot's texture unit, so objects keep sampling the same slot
+	m_textureIDs[image.slot].ID = texture;
 
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+	return true;
+}
 
-		return true;
+/***********************************************************
+ *  AreTexturesResident()
+ *
+ *  True when no texture is left decoding or waiting for its
+ *  upload.
+ ***********************************************************/
+bool SceneManager::AreTexturesResident() const
+{
+	return m_pendingUploads.empty() && (m_pTextureLoader->GetPendingCount() == 0);
+}
+
+/***********************************************************
+ *  UpdateTextureUploads()
+ *
+ *  This method is called once per frame to upload the images
+ *  the worker threads finished decoding. Uploads are capped
+ *  per frame so a burst of finished images cannot cause a
+ *  visible hitch.
+ ***********************************************************/
+void SceneManager::UpdateTextureUploads()
+{
+	if ((NULL == m_pTextureLoader) ||
+		(m_pendingUploads.empty() && m_pTextureLoader->GetPendingCount() == 0))
+	{
+		return;
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	DebugGroup group("Texture uploads");
+	GpuTimerScope timer(m_pFrameTimers, "Texture uploads");
+	m_pTextureLoader->CollectDecodedImages(m_pendingUploads);
 
-	// Error loading the image
-	return false;
+	int uploaded = 0;
+	while (!m_pendingUploads.empty() && uploaded < MAX_TEXTURE_UPLOADS_PER_FRAME)
+	{
+		TextureLoader::DecodedImage image = m_pendingUploads.front();
+		m_pendingUploads.erase(m_pendingUploads.begin());
+
+		UploadDecodedTexture(image);
+		TextureLoader::FreeImage(image);
+		uploaded++;
+	}
+
+	if (m_pendingUploads.empty() && m_pTextureLoader->GetPendingCount() == 0)
+	{
+		std::cout << "INFO: All scene textures are resident" << std::endl;
+	}
 }
 
 /***********************************************************
@@ -143,14 +481,20 @@ void SceneManager::BindGLTextures()
  *  DestroyGLTextures()
  *
  *  This method is used for freeing the memory in all the
- *  used texture memory slots.
+ *  used texture memory slots, the placeholder texture and
+ *  the pixel buffer. The slots can be filled again by
+ *  CreateGLTexture() afterwards.
  ***********************************************************/
 void SceneManager::DestroyGLTextures()
 {
 	for (int i = 0; i < m_loadedTextures; i++)
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		m_textureIDs[i].texture.Reset();
+		m_textureIDs[i].ID = 0;
 	}
+	m_placeholderTexture.Reset();
+	m_pixelUnpackBuffer.Reset();
+	m_loadedTextures = 0;
 }
 
 /***********************************************************
@@ -186,14 +530,26 @@ int SceneManager::FindTextureID(std::string tag)
  *  loaded texture bitmap associated with the passed in tag.
  ***********************************************************/
 int SceneManager::FindTextureSlot(std::string tag)
+{
+	return(FindTextureTag(m_textureIDs, m_loadedTextures, tag));
+}
+
+/***********************************************************
+ *  FindTextureTag()
+ *
+ *  This method is used for getting the index of the first of
+ *  the passed texture slots that holds the passed in tag.
+ *  Returns -1 when none of the slots holds the tag.
+ ***********************************************************/
+int SceneManager::FindTextureTag(const TEXTURE_INFO* pTextures, int textureCount, const std::string& tag)
 {
 	int textureSlot = -1;
 	int index = 0;
 	bool bFound = false;
 
-	while ((index < m_loadedTextures) && (bFound == false))
+	while ((index < textureCount) && (bFound == false))
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		if (pTextures[index].tag.compare(tag) == 0)
 		{
 			textureSlot = index;
 			bFound = true;
@@ -208,34 +564,18 @@ int SceneManager::FindTextureSlot(std::string tag)
 /***********************************************************
  *  FindMaterial()
  *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
+ *  This method is used for getting the index of a material in
+ *  the material library that is associated with the passed in
+ *  tag. Returns -1 when no material uses the tag.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+int SceneManager::FindMaterial(std::string tag)
 {
-	if (m_objectMaterials.size() == 0)
+	if (NULL == m_pMaterialLibrary)
 	{
-		return(false);
+		return(-1);
 	}
 
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
-	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
-
-	return(true);
+	return(m_pMaterialLibrary->FindMaterial(tag));
 }
 
 /***********************************************************
@@ -272,7 +612,7 @@ void SceneManager::SetTransformations(
 
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+		m_pShaderManager->setDrawModel(modelView);
 	}
 }
 
@@ -298,8 +638,8 @@ void SceneManager::SetShaderColor(
 
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		m_pShaderManager->setDrawTexture(-1);
+		m_pShaderManager->setDrawColor(currentColor);
 	}
 }
 
@@ -314,11 +654,9 @@ void SceneManager::SetShaderTexture(
 {
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
 		int textureID = -1;
 		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+		m_pShaderManager->setDrawTexture(textureID);
 	}
 }
 
@@ -332,31 +670,25 @@ void SceneManager::SetTextureUVScale(float u, float v)
 {
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+		m_pShaderManager->setDrawUVScale(u, v);
 	}
 }
 
 /***********************************************************
  *  SetShaderMaterial()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for selecting the material that the
+ *  shader reads out of the material table.
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
 	std::string materialTag)
 {
-	if (m_objectMaterials.size() > 0)
+	int materialIndex = FindMaterial(materialTag);
+	if (materialIndex >= 0)
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
+		// the material values are already on the GPU in the
+		// material table, so only the index has to be passed
+		m_pShaderManager->setDrawMaterial(materialIndex);
 	}
 }
 
@@ -369,8 +701,17 @@ void SceneManager::SetShaderMaterial(
  ***********************************************************/
 void SceneManager::LoadSceneTextures()
 {
+	TRACE_ZONE("LoadSceneTextures");
 	bool bReturn = false;
 
+	// encode the images into block compressed mip chains when the
+	// driver can sample S3TC formats - the encoded levels are cached
+	// next to each image so later runs skip the JPG decoding entirely
+	m_pTextureLoader->SetCompressionEnabled(GLEW_EXT_texture_compression_s3tc != 0);
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+	m_pTextureLoader->SetMaxTextureSize(maxTextureSize);
+
 	// texture slot 0
 	bReturn = CreateGLTexture(
 		"textures/coaster_wood.jpg",
@@ -453,9 +794,10 @@ void SceneManager::LoadSceneTextures()
 		"branch"
 	);
 
-	// after the texture image data is loaded into memory, the
-	// loaded textures need to be bound to texture slots - there
-	// are a total of 16 available slots for scene textures
+	// the image files are decoded in the background - until each one
+	// is uploaded its slot is bound to the placeholder texture, so the
+	// slots can be bound right away - there are a total of 16
+	// available slots for scene textures
 	BindGLTextures();
 }
 
@@ -471,41 +813,224 @@ void SceneManager::LoadSceneTextures()
  *
  *  This method is called to add and configure the light
  *  sources for the 3D scene.  There are up to 4 light sources.
+ *  The point and spot lights are kept in a list, so the
+ *  clustered lighting can light the scene with the same ones.
  ***********************************************************/
 void SceneManager::SetupSceneLights()
 {
-	// this line of code is NEEDED for telling the shaders to render 
-	// the 3D scene with custom lighting - to use the default rendered 
-	// lighting then comment out the following line
-	m_pShaderManager->setBoolValue("bUseLighting", true);
-
-	// directional light - simulates light coming from above
-	m_pShaderManager->setBoolValue("directionalLight.bActive", true);
-	m_pShaderManager->setVec3Value("directionalLight.direction", -0.2f, -1.0f, -0.3f);
-	m_pShaderManager->setVec3Value("directionalLight.ambient", 0.1f, 0.1f, 0.3f);
-	m_pShaderManager->setVec3Value("directionalLight.diffuse", 0.4f, 0.5f, 0.9f);
-	m_pShaderManager->setVec3Value("directionalLight.specular", 0.4f, 0.4f, 0.4f);
+	m_sceneLights.clear();
 
 	// point light - positioned above and in front of the scene for direct illumination
-	m_pShaderManager->setBoolValue("pointLights[0].bActive", true);
-	m_pShaderManager->setVec3Value("pointLights[0].position", 0.0f, 10.0f, 5.0f);
-	m_pShaderManager->setVec3Value("pointLights[0].ambient", 0.05f, 0.05f, 0.05f);
-	m_pShaderManager->setVec3Value("pointLights[0].diffuse", 1.0f, 0.95f, 0.8f);
-	m_pShaderManager->setVec3Value("pointLights[0].specular", 0.5f, 0.5f, 0.5f);
+	LightSource pointLight;
+	pointLight.position = glm::vec3(0.0f, 10.0f, 5.0f);
+	pointLight.ambient = glm::vec3(0.05f, 0.05f, 0.05f);
+	pointLight.diffuse = glm::vec3(1.0f, 0.95f, 0.8f);
+	pointLight.specular = glm::vec3(0.5f, 0.5f, 0.5f);
+	m_sceneLights.push_back(pointLight);
 
 	// spotlight - centered directly above the table, wide cone to evenly light all objects
-	m_pShaderManager->setBoolValue("spotLight.bActive", true);
-	m_pShaderManager->setVec3Value("spotLight.position", 0.0f, 9.0f, 0.0f);
-	m_pShaderManager->setVec3Value("spotLight.direction", 0.0f, -1.0f, 0.0f);
-	m_pShaderManager->setVec3Value("spotLight.ambient", 0.8f, 0.8f, 0.8f);
-	m_pShaderManager->setVec3Value("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
-	m_pShaderManager->setVec3Value("spotLight.specular", 1.0f, 1.0f, 1.0f);
-	m_pShaderManager->setFloatValue("spotLight.constant", 1.0f);
-	m_pShaderManager->setFloatValue("spotLight.linear", 0.09f);
-	m_pShaderManager->setFloatValue("spotLight.quadratic", 0.032f);
+	LightSource spotLight;
+	spotLight.bSpot = true;
+	spotLight.position = glm::vec3(0.0f, 9.0f, 0.0f);
+	spotLight.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+	spotLight.ambient = glm::vec3(0.8f, 0.8f, 0.8f);
+	spotLight.diffuse = glm::vec3(1.0f, 1.0f, 1.0f);
+	spotLight.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+	spotLight.constant = 1.0f;
+	spotLight.linear = 0.09f;
+	spotLight.quadratic = 0.032f;
 	// wide cutoff angles keep the full table surface evenly lit
-	m_pShaderManager->setFloatValue("spotLight.cutOff", glm::cos(glm::radians(60.f)));
-	m_pShaderManager->setFloatValue("spotLight.outerCutOff", glm::cos(glm::radians(120.0f)));
+	spotLight.cutOff = glm::cos(glm::radians(60.f));
+	spotLight.outerCutOff = glm::cos(glm::radians(120.0f));
+	m_sceneLights.push_back(spotLight);
+
+	// the forward shaders light the scene with the lights above, the
+	// extra lights are only drawn by the light lists and the clusters
+	m_forwardLightCount = m_sceneLights.size();
+	AddExtraLights(m_renderSettings.extraLightCount);
+
+	ApplySceneLights(m_pShaderManager);
+
+	// the indirect program has its own copy of the light uniforms
+	if (NULL != m_pIndirectRenderer)
+	{
+		m_pIndirectRenderer->GetShaderManager()->use();
+		ApplySceneLights(m_pIndirectRenderer->GetShaderManager());
+		m_pShaderManager->use();
+	}
+	// and so do the G-buffer and lighting programs of the deferred path
+	if (NULL != m_pDeferredRenderer)
+	{
+		m_pDeferredRenderer->GetGeometryShader()->use();
+		ApplySceneLights(m_pDeferredRenderer->GetGeometryShader());
+		m_pDeferredRenderer->GetLightingShader()->use();
+		ApplySceneLights(m_pDeferredRenderer->GetLightingShader());
+		m_pShaderManager->use();
+	}
+	// and the impostor program, which has no light lists
+	if (NULL != m_pSphereImpostors)
+	{
+		m_pSphereImpostors->GetShaderManager()->use();
+		ApplySceneLights(m_pSphereImpostors->GetShaderManager());
+		m_pShaderManager->use();
+	}
+
+	m_pLightLists->SetLights(m_sceneLights);
+	if (NULL != m_pShadowMaps)
+	{
+		// the first spot light is the flashlight of the forward shaders
+		// and gets the second shadow map
+		const LightSource* pSpotLight = NULL;
+		int spotLightIndex = -1;
+		for (size_t i = 0; (i < m_sceneLights.size()) && (NULL == pSpotLight); i++)
+		{
+			if (m_sceneLights[i].bSpot == true)
+			{
+				pSpotLight = &m_sceneLights[i];
+				spotLightIndex = (int)i;
+			}
+		}
+		m_pShadowMaps->SetLights(g_DirectionalLightDirection, pSpotLight, spotLightIndex);
+	}
+	if (NULL != m_pBakedLighting)
+	{
+		LightmapBaker::DirectionalLight directionalLight;
+		directionalLight.direction = g_DirectionalLightDirection;
+		directionalLight.ambient = g_DirectionalLightAmbient;
+		directionalLight.diffuse = g_DirectionalLightDiffuse;
+		m_pBakedLighting->SetLights(directionalLight, m_sceneLights);
+	}
+	if (NULL != m_pClusteredLighting)
+	{
+		m_pClusteredLighting->SetLights(m_sceneLights);
+	}
+}
+
+/***********************************************************
+ *  AddExtraLights()
+ *
+ *  This method spreads small colored point lights over the
+ *  room, from the floor up to above the table, to benchmark
+ *  the light lists and the clustered lighting with hundreds
+ *  of lights.
+ ***********************************************************/
+void SceneManager::AddExtraLights(int lightCount)
+{
+	const glm::vec3 colors[4] = {
+		glm::vec3(1.0f, 0.6f, 0.3f),
+		glm::vec3(0.4f, 0.6f, 1.0f),
+		glm::vec3(1.0f, 0.9f, 0.6f),
+		glm::vec3(0.6f, 1.0f, 0.5f) };
+
+	for (int i = 0; i < lightCount; i++)
+	{
+		// golden angle spiral over the room, every other light just
+		// above the floor and just above the table top
+		float radius = 12.0f * std::sqrt((i + 0.5f) / lightCount);
+		float angle = i * 2.39996f;
+
+		LightSource light;
+		light.position = glm::vec3(radius * std::cos(angle), (i % 2 == 0) ? 0.4f : 5.7f, radius * std::sin(angle));
+		light.diffuse = colors[i % 4];
+		light.specular = colors[i % 4] * 0.5f;
+		// falls off within about 1.8 units, see GetLightRadius()
+		light.constant = 1.0f;
+		light.linear = 2.0f;
+		light.quadratic = 80.0f;
+		m_sceneLights.push_back(light);
+	}
+}
+
+/***********************************************************
+ *  RenderExtraSpheres()
+ *
+ *  This method draws the small spheres of the sphere
+ *  impostor benchmark, spread like grapes over the table
+ *  and in a layer of particles above it.
+ ***********************************************************/
+void SceneManager::RenderExtraSpheres(int sphereCount)
+{
+	if (sphereCount <= 0)
+	{
+		return;
+	}
+
+	const glm::vec4 colors[4] = {
+		glm::vec4(0.35f, 0.1f, 0.4f, 1.0f),
+		glm::vec4(0.5f, 0.7f, 0.25f, 1.0f),
+		glm::vec4(0.55f, 0.15f, 0.3f, 1.0f),
+		glm::vec4(0.85f, 0.8f, 0.5f, 1.0f) };
+
+	SetShaderMaterial("crystal_body");
+	m_pShaderManager->setDrawTexture(-1);
+	for (int i = 0; i < sphereCount; i++)
+	{
+		// golden angle spiral over the table top, stacked in layers
+		// that repeat every 16 spheres
+		float radius = 4.0f * std::sqrt((i + 0.5f) / sphereCount);
+		float angle = i * 2.39996f;
+		float height = 5.35f + 0.1f * (i % 16);
+
+		m_pShaderManager->setDrawColor(colors[i % 4]);
+		SetTransformations(glm::vec3(0.04f), 0.0f, 0.0f, 0.0f,
+			glm::vec3(radius * std::cos(angle), height, radius * std::sin(angle)));
+		m_basicMeshes->DrawSphereMesh();
+	}
+}
+
+/***********************************************************
+ *  ApplySceneLights()
+ *
+ *  This method sets the light source uniforms into the
+ *  passed shader program, which must be in use.
+ ***********************************************************/
+void SceneManager::ApplySceneLights(ShaderManager* pShaderManager)
+{
+	// this line of code is NEEDED for telling the shaders to render 
+	// the 3D scene with custom lighting - to use the default rendered 
+	// lighting then comment out the following line
+	pShaderManager->setBoolValue("bUseLighting", true);
+
+	// directional light - simulates light coming from above
+	pShaderManager->setBoolValue("directionalLight.bActive", true);
+	pShaderManager->setVec3Value("directionalLight.direction", g_DirectionalLightDirection);
+	pShaderManager->setVec3Value("directionalLight.ambient", g_DirectionalLightAmbient);
+	pShaderManager->setVec3Value("directionalLight.diffuse", g_DirectionalLightDiffuse);
+	pShaderManager->setVec3Value("directionalLight.specular", 0.4f, 0.4f, 0.4f);
+
+	// the point lights fill the pointLights array in order and the
+	// first spot light is the flashlight
+	int pointLightIndex = 0;
+	bool bSpotLightSet = false;
+	for (size_t i = 0; i < m_forwardLightCount; i++)
+	{
+		const LightSource& light = m_sceneLights[i];
+		if ((light.bSpot == true) && (bSpotLightSet == false))
+		{
+			pShaderManager->setBoolValue("spotLight.bActive", true);
+			pShaderManager->setVec3Value("spotLight.position", light.position);
+			pShaderManager->setVec3Value("spotLight.direction", light.direction);
+			pShaderManager->setVec3Value("spotLight.ambient", light.ambient);
+			pShaderManager->setVec3Value("spotLight.diffuse", light.diffuse);
+			pShaderManager->setVec3Value("spotLight.specular", light.specular);
+			pShaderManager->setFloatValue("spotLight.constant", light.constant);
+			pShaderManager->setFloatValue("spotLight.linear", light.linear);
+			pShaderManager->setFloatValue("spotLight.quadratic", light.quadratic);
+			pShaderManager->setFloatValue("spotLight.cutOff", light.cutOff);
+			pShaderManager->setFloatValue("spotLight.outerCutOff", light.outerCutOff);
+			bSpotLightSet = true;
+		}
+		else if ((light.bSpot == false) && (pointLightIndex < TOTAL_POINT_LIGHTS))
+		{
+			std::string name = "pointLights[" + std::to_string(pointLightIndex) + "].";
+			pShaderManager->setBoolValue(name + "bActive", true);
+			pShaderManager->setVec3Value(name + "position", light.position);
+			pShaderManager->setVec3Value(name + "ambient", light.ambient);
+			pShaderManager->setVec3Value(name + "diffuse", light.diffuse);
+			pShaderManager->setVec3Value(name + "specular", light.specular);
+			pointLightIndex++;
+		}
+	}
 }
 
 /***********************************************************
@@ -517,12 +1042,135 @@ void SceneManager::SetupSceneLights()
  ***********************************************************/
 void SceneManager::PrepareScene()
 {
+	TRACE_ZONE("PrepareScene");
 	// only one instance of a particular mesh needs to be
 	// loaded in memory no matter how many times it is drawn
 	// in the rendered 3D scene
 	LoadSceneTextures();
+	// the indirect backend has its own shader program, so it has to
+	// exist before the lights and materials are set up
+	if (IndirectRenderer::IsSupported())
+	{
+		m_pIndirectRenderer = new IndirectRenderer();
+		if (m_pIndirectRenderer->Initialize(m_basicMeshes, MAX_TEXTURE_SLOTS) == false)
+		{
+			delete m_pIndirectRenderer;
+			m_pIndirectRenderer = NULL;
+		}
+		m_pShaderManager->use();
+	}
+	// the depth only program of the immediate path's depth pre-pass
+	m_pDepthPrepass = new DepthPrepass();
+	if (m_pDepthPrepass->Initialize() == false)
+	{
+		delete m_pDepthPrepass;
+		m_pDepthPrepass = NULL;
+	}
+	// the cluster light lists are read by the indirect program
+	if ((NULL != m_pIndirectRenderer) && ClusteredLighting::IsSupported())
+	{
+		m_pClusteredLighting = new ClusteredLighting();
+		if (m_pClusteredLighting->Initialize() == false)
+		{
+			delete m_pClusteredLighting;
+			m_pClusteredLighting = NULL;
+		}
+	}
+	// the deferred lighting pass reads the cluster light lists
+	if (NULL != m_pClusteredLighting)
+	{
+		m_pDeferredRenderer = new DeferredRenderer();
+		if (m_pDeferredRenderer->Initialize(MAX_TEXTURE_SLOTS) == false)
+		{
+			delete m_pDeferredRenderer;
+			m_pDeferredRenderer = NULL;
+		}
+	}
+	// the shadow maps of the directional and spot light
+	m_pShadowMaps = new ShadowMaps();
+	if (m_pShadowMaps->Initialize() == false)
+	{
+		delete m_pShadowMaps;
+		m_pShadowMaps = NULL;
+	}
+	// the lightmap of the static draws, baked on the CPU when asked for
+	m_pBakedLighting = new BakedLighting();
+	if (m_pBakedLighting->Initialize() == false)
+	{
+		delete m_pBakedLighting;
+		m_pBakedLighting = NULL;
+	}
+	// the unsorted translucent draws need a blend function per target
+	if (TransparencyPass::IsSupported() == true)
+	{
+		m_pTransparencyPass = new TransparencyPass();
+		if (m_pTransparencyPass->Initialize() == false)
+		{
+			delete m_pTransparencyPass;
+			m_pTransparencyPass = NULL;
+		}
+	}
+	// the GPU times of the passes and objects
+	if (GpuTimers::IsSupported() == true)
+	{
+		m_pGpuTimers = new GpuTimers();
+	}
+	// the GL call counters and frame times over the scene
+	m_pStatsOverlay = new StatsOverlay();
+	if (m_pStatsOverlay->Initialize() == false)
+	{
+		delete m_pStatsOverlay;
+		m_pStatsOverlay = NULL;
+	}
+	// the sphere draws as ray-cast impostors
+	m_pSphereImpostors = new SphereImpostors();
+	if (m_pSphereImpostors->Initialize(MAX_TEXTURE_SLOTS) == false)
+	{
+		delete m_pSphereImpostors;
+		m_pSphereImpostors = NULL;
+	}
+	// the shadow samplers of every lit program need their own units,
+	// even while the shadows are off
+	if (NULL != m_pSphereImpostors)
+	{
+		m_pSphereImpostors->GetShaderManager()->use();
+		ShadowMaps::BindSamplers(m_pSphereImpostors->GetShaderManager());
+	}
+	m_pShaderManager->use();
+	ShadowMaps::BindSamplers(m_pShaderManager);
+	if (NULL != m_pIndirectRenderer)
+	{
+		m_pIndirectRenderer->GetShaderManager()->use();
+		ShadowMaps::BindSamplers(m_pIndirectRenderer->GetShaderManager());
+	}
+	if (NULL != m_pDeferredRenderer)
+	{
+		m_pDeferredRenderer->GetLightingShader()->use();
+		ShadowMaps::BindSamplers(m_pDeferredRenderer->GetLightingShader());
+	}
+	m_pShaderManager->use();
+	// the light table the per-draw light lists index into
+	m_pLightLists->CreateLightBuffer(m_pShaderManager->m_programID);
+	if (NULL != m_pIndirectRenderer)
+	{
+		m_pLightLists->BindLightTable(m_pIndirectRenderer->GetShaderManager()->m_programID);
+	}
 	// add and define the light sources for the scene
 	SetupSceneLights();
+	// upload the material table the shader indexes per draw
+	m_pMaterialLibrary->CreateMaterialBuffer(m_pShaderManager->m_programID);
+	if (NULL != m_pIndirectRenderer)
+	{
+		m_pMaterialLibrary->BindMaterialBlock(m_pIndirectRenderer->GetShaderManager()->m_programID);
+	}
+	if (NULL != m_pDeferredRenderer)
+	{
+		m_pMaterialLibrary->BindMaterialBlock(m_pDeferredRenderer->GetLightingShader()->m_programID);
+	}
+	if (NULL != m_pSphereImpostors)
+	{
+		m_pMaterialLibrary->BindMaterialBlock(m_pSphereImpostors->GetShaderManager()->m_programID);
+	}
 	m_basicMeshes->LoadPlaneMesh();
 	m_basicMeshes->LoadCylinderMesh();
 	m_basicMeshes->LoadTorusMesh();
@@ -535,6 +1183,9 @@ void SceneManager::PrepareScene()
 	m_book = new Book(m_pShaderManager, m_basicMeshes);
 	m_laptop = new Laptop(m_pShaderManager, m_basicMeshes, FindTextureSlot("steel"), FindTextureSlot("black_plastic"));
 	m_centerPiece = new Centerpiece(m_pShaderManager, m_basicMeshes, FindTextureSlot("branch"), FindTextureSlot("raw_cotton"));
+
+	// the calls of the loading are not part of the first frame
+	RenderStats::Frame() = RenderStats();
 }
 
 /***********************************************************
@@ -545,48 +1196,725 @@ void SceneManager::PrepareScene()
  ***********************************************************/
 void SceneManager::RenderScene()
 {
+	TRACE_ZONE("RenderScene");
+	std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+	// the overlay graphs the whole time between frames, not only the
+	// time spent in here
+	if ((m_bFrameStarted == true) && (NULL != m_pStatsOverlay))
+	{
+		m_pStatsOverlay->AddFrameTime(std::chrono::duration<double, std::milli>(frameStart - m_lastFrameStart).count());
+	}
+	m_lastFrameStart = frameStart;
+	m_bFrameStarted = true;
+
+	// the passes are only timed while the GPU timers are on
+	m_pFrameTimers = (m_renderSettings.bGpuTimers == true) ? m_pGpuTimers : NULL;
+	if (NULL != m_pFrameTimers)
+	{
+		m_pFrameTimers->BeginFrame();
+		m_pFrameTimers->BeginScope("Frame");
+	}
+
+	// swap in any texture images that finished decoding
+	UpdateTextureUploads();
+
+	bool bIndirect = (m_renderSettings.bIndirectDraw == true) && (NULL != m_pIndirectRenderer);
+	bool bCull = m_renderSettings.bFrustumCulling;
+	// occlusion culling runs in the GPU culling pass of the indirect path
+	bool bOcclusion = (m_renderSettings.bOcclusionCulling == true) && (bIndirect == true) &&
+		m_pIndirectRenderer->IsOcclusionCullingSupported();
+	// the cluster lists are read by the 4.3 shaders of the indirect path
+	bool bClustered = (m_renderSettings.bClusteredLighting == true) && (bIndirect == true) &&
+		(NULL != m_pClusteredLighting);
+	bool bDeferred = (m_renderSettings.bDeferredShading == true) && (bIndirect == true) &&
+		(NULL != m_pDeferredRenderer);
+	// the light lists are filled per recorded draw, the clusters and the
+	// deferred pass limit the lights their own way
+	bool bLightLists = (m_renderSettings.bLightLists == true) && (bClustered == false) &&
+		(bDeferred == false);
+	bool bShadows = (m_renderSettings.bShadows == true) && (NULL != m_pShadowMaps);
+	// the baked draws are drawn before the forward passes, the deferred
+	// path lights its G-buffer in one go instead
+	bool bBaked = (m_renderSettings.bBakedLighting == true) && (NULL != m_pBakedLighting) &&
+		(bDeferred == false);
+	// the deferred path already lights every pixel once, so it has no
+	// use for the depth pre-pass
+	bool bPrepass = (m_renderSettings.bDepthPrepass == true) && (NULL != m_pDepthPrepass) &&
+		(bDeferred == false);
+	// the translucent draws are split from the opaque ones on the
+	// recorded path only
+	bool bTransparency = (m_renderSettings.bOrderIndependentTransparency == true) &&
+		(NULL != m_pTransparencyPass);
+	// the impostors write their own depth before the forward passes,
+	// which the deferred lighting pass would overwrite
+	bool bImpostors = (m_renderSettings.bSphereImpostors == true) && (NULL != m_pSphereImpostors) &&
+		(bDeferred == false);
+	int sceneCopies = std::max(1, m_renderSettings.sceneCopies);
+
+	m_drawRecords.clear();
+	m_sceneDrawCount = 0;
+	m_culledDrawCount = 0;
+	m_occludedDrawCount = -1;
+	m_bGPUCulling = false;
+	// the objects that leave a draw parameter unset would record the one
+	// of the last draw of the previous frame, and the static draws of the
+	// first frame would never match the later ones
+	m_pShaderManager->resetDrawParameters();
+	m_bOcclusionCulling = bOcclusion;
+	m_bDepthPrepass = bPrepass;
+	m_bLightLists = bLightLists;
+	m_bClusteredLighting = bClustered;
+	m_bDeferredShading = bDeferred;
+	m_bShadows = bShadows;
+	m_bBakedLighting = false;
+	m_bTransparencyPass = bTransparency;
+	m_bSphereImpostors = bImpostors;
+
+	// the forward shaders only read the light lists when they are filled
+	m_pShaderManager->setBoolValue("bLightLists", bLightLists);
+	// turned on below once the shadow maps of the frame are rendered
+	m_pShaderManager->setBoolValue("bShadows", false);
+
+	if ((bIndirect == false) && (bCull == false) && (bPrepass == false) && (bLightLists == false) &&
+		(bShadows == false) && (bBaked == false) && (bTransparency == false) && (bImpostors == false) && (sceneCopies == 1))
+	{
+		// immediate path - every mesh is drawn as the objects render
+		DebugGroup group("Scene objects");
+		GpuTimerScope timer(m_pFrameTimers, "Scene objects");
+		if (NULL != m_pDepthPrepass)
+		{
+			m_pDepthPrepass->BeginShadingPass(false);
+		}
+		RenderSceneObjects();
+		if (NULL != m_pDepthPrepass)
+		{
+			m_pDepthPrepass->EndShadingPass();
+		}
+	}
+	else
+	{
+		// record the scene once, then replicate it for the extra
+		// copies so both paths pay the same object traversal cost
+		m_basicMeshes->BeginRecording(&m_drawRecords);
+		RenderSceneObjects();
+		m_basicMeshes->EndRecording();
+		// every draw casts shadows, including the ones culled below -
+		// the extra scene copies are left out
+		if (bShadows == true)
+		{
+			DebugGroup group("Shadow maps");
+			GpuTimerScope timer(m_pFrameTimers, "Shadow maps");
+			m_pShadowMaps->Update(m_basicMeshes, m_drawRecords, m_pShaderManager);
+			m_pShadowMaps->ApplyShadows(m_pShaderManager, true);
+		}
+		size_t sceneDraws = m_drawRecords.size();
+		ExpandSceneCopies(sceneCopies);
+		// the static draws of the first copy come from the lightmap once
+		// it is baked - textures still loading would bake their placeholder
+		if (bBaked == true)
+		{
+			m_bBakedLighting = m_pBakedLighting->Update(m_basicMeshes, m_drawRecords, sceneDraws,
+				m_pMaterialLibrary, AreTexturesResident());
+		}
+		m_sceneDrawCount = (int)m_drawRecords.size();
+
+		glm::mat4 viewProjection = m_projectionMatrix * m_viewMatrix;
+		m_bGPUCulling = ((bCull == true) || (bOcclusion == true)) &&
+			(bIndirect == true) && m_pIndirectRenderer->IsComputeCullingSupported();
+		if ((bCull == true) && (m_bGPUCulling == false))
+		{
+			// no compute shaders on this path - cull on the CPU instead
+			m_culledDrawCount = FrustumCuller::CullRecords(m_drawRecords, viewProjection);
+		}
+		// the visible spheres become impostor instances
+		if (bImpostors == true)
+		{
+			m_pSphereImpostors->ExtractSpheres(m_basicMeshes, m_drawRecords);
+		}
+		if (bLightLists == true)
+		{
+			m_pLightLists->AssignLights(m_drawRecords);
+		}
+
+		// the pre-pass, the G-buffer and the transparency pass cover the
+		// opaque draws, so they move ahead of the blended ones - each group
+		// keeps its draw order
+		size_t opaqueDrawCount = m_drawRecords.size();
+		if ((bPrepass == true) || (bDeferred == true) || (bTransparency == true))
+		{
+			opaqueDrawCount = std::stable_partition(m_drawRecords.begin(), m_drawRecords.end(),
+				IsOpaqueRecord) - m_drawRecords.begin();
+		}
+
+		// with the transparency pass nothing is blended in order, so the
+		// opaque draws skip the blending
+		if (bTransparency == true)
+		{
+			glDisable(GL_BLEND);
+		}
+		if (m_bBakedLighting == true)
+		{
+			DebugGroup group("Baked lighting");
+			GpuTimerScope timer(m_pFrameTimers, "Baked lighting");
+			m_pBakedLighting->Draw(m_viewMatrix, m_projectionMatrix);
+			m_pShaderManager->use();
+		}
+		if (bImpostors == true)
+		{
+			DebugGroup group("Sphere impostors");
+			GpuTimerScope timer(m_pFrameTimers, "Sphere impostors");
+			ShaderManager* pImpostorShader = m_pSphereImpostors->GetShaderManager();
+			pImpostorShader->use();
+			if (NULL != m_pShadowMaps)
+			{
+				m_pShadowMaps->ApplyShadows(pImpostorShader, bShadows);
+			}
+			m_pSphereImpostors->Draw(m_viewMatrix, m_projectionMatrix, m_viewPosition);
+			m_pShaderManager->use();
+		}
+		DrawRecordedScene(bIndirect, opaqueDrawCount,
+			(m_bGPUCulling == true) ? &viewProjection : NULL, bOcclusion);
+		if ((m_bGPUCulling == true) && (bOcclusion == true))
+		{
+			m_occludedDrawCount = m_pIndirectRenderer->GetOccludedDrawCount();
+		}
+		if (bTransparency == true)
+		{
+			glEnable(GL_BLEND);
+		}
+	}
+
+	if (NULL != m_pFrameTimers)
+	{
+		m_pFrameTimers->EndFrame();
+	}
+	ReportRenderTime(std::chrono::steady_clock::now() - frameStart, bIndirect);
+
+	// the calls of the frame are counted from the end of the last one, so
+	// the camera uniforms set before RenderScene() are included - the
+	// overlay is drawn after they are taken and not counted
+	m_frameStats = RenderStats::Frame();
+	if ((m_renderSettings.bStatsOverlay == true) && (NULL != m_pStatsOverlay))
+	{
+		m_pStatsOverlay->Draw(m_frameStats, m_occludedDrawCount);
+		m_pShaderManager->use();
+	}
+	RenderStats::Frame() = RenderStats();
+}
+
+/***********************************************************
+ *  DrawRecordedScene()
+ *
+ *  This method draws the recorded draws of the frame. The
+ *  opaque draws are shaded in one pass - after a depth only
+ *  pre-pass when it is enabled, so that every pixel is only
+ *  shaded once - and the blended draws are drawn after them.
+ ***********************************************************/
+void SceneManager::DrawRecordedScene(bool bIndirect, size_t opaqueDrawCount,
+	const glm::mat4* pCullViewProjection, bool bOcclusion)
+{
+	size_t drawCount = m_drawRecords.size();
+
+	if (bIndirect == true)
+	{
+		// uploads the draws, the light clusters and runs the GPU culling
+		DebugGroup group("Indirect setup");
+		GpuTimerScope timer(m_pFrameTimers, "Indirect setup");
+		m_pIndirectRenderer->SetCamera(m_viewMatrix, m_projectionMatrix, m_viewPosition);
+
+		ShaderManager* pIndirectShader = m_pIndirectRenderer->GetShaderManager();
+		pIndirectShader->use();
+		pIndirectShader->setBoolValue("bClusteredLighting", m_bClusteredLighting);
+		pIndirectShader->setBoolValue("bLightLists", m_bLightLists);
+		if (NULL != m_pShadowMaps)
+		{
+			m_pShadowMaps->ApplyShadows(pIndirectShader, m_bShadows);
+		}
+		// the deferred lighting pass is limited by the same clusters
+		if ((m_bClusteredLighting == true) || (m_bDeferredShading == true))
+		{
+			m_pClusteredLighting->AssignLights(m_viewMatrix, m_projectionMatrix);
+		}
+		if (m_bClusteredLighting == true)
+		{
+			m_pClusteredLighting->ApplyClusters(pIndirectShader, m_viewMatrix);
+		}
+
+		m_pIndirectRenderer->PrepareDraws(m_drawRecords, pCullViewProjection, bOcclusion, opaqueDrawCount);
+	}
+
+	if (m_bDeferredShading == true)
+	{
+		// the opaque draws only fill the G-buffer, then every covered
+		// pixel is lit once, and the blended draws are drawn lit on top
+		if (NULL != m_pFrameTimers)
+		{
+			m_pFrameTimers->BeginScope("G-buffer");
+		}
+		{
+			DebugGroup group("G-buffer");
+			m_pDeferredRenderer->BeginGeometryPass(m_viewMatrix, m_projectionMatrix);
+			m_pIndirectRenderer->DrawOpaqueWith(m_pDeferredRenderer->GetGeometryShader()->m_programID);
+			m_pDeferredRenderer->EndGeometryPass();
+		}
+		if (NULL != m_pFrameTimers)
+		{
+			m_pFrameTimers->EndScope();
+			m_pFrameTimers->BeginScope("Deferred lighting");
+		}
+
+		ShaderManager* pLightingShader = m_pDeferredRenderer->GetLightingShader();
+		pLightingShader->use();
+		pLightingShader->setBoolValue("bClusteredLighting", true);
+		if (NULL != m_pShadowMaps)
+		{
+			m_pShadowMaps->ApplyShadows(pLightingShader, m_bShadows);
+		}
+		m_pClusteredLighting->ApplyClusters(pLightingShader, m_viewMatrix);
+		if (NULL != m_pDepthPrepass)
+		{
+			m_pDepthPrepass->BeginShadingPass(false);
+		}
+		{
+			DebugGroup group("Deferred lighting");
+			m_pDeferredRenderer->LightScene(m_viewMatrix, m_projectionMatrix, m_viewPosition);
+		}
+		if (NULL != m_pDepthPrepass)
+		{
+			m_pDepthPrepass->EndShadingPass();
+		}
+		if (NULL != m_pFrameTimers)
+		{
+			m_pFrameTimers->EndScope();
+			m_pFrameTimers->BeginScope("Translucent");
+		}
+
+		DebugGroup group("Translucent");
+		if (m_bTransparencyPass == true)
+		{
+			DrawTranslucentRecords(bIndirect, opaqueDrawCount);
+		}
+		else
+		{
+			m_pIndirectRenderer->DrawTranslucent();
+		}
+		m_pShaderManager->use();
+		if (NULL != m_pFrameTimers)
+		{
+			m_pFrameTimers->EndScope();
+		}
+		return;
+	}
+
+	if (m_bDepthPrepass == true)
+	{
+		DebugGroup group("Depth pre-pass");
+		GpuTimerScope timer(m_pFrameTimers, "Depth pre-pass");
+		m_pDepthPrepass->BeginDepthPass();
+		if (bIndirect == true)
+		{
+			m_pIndirectRenderer->DrawOpaqueDepth();
+		}
+		else
+		{
+			ShaderManager* pDepthShader = m_pDepthPrepass->GetShaderManager();
+			pDepthShader->use();
+			pDepthShader->setMat4Value("view", m_viewMatrix);
+			pDepthShader->setMat4Value("projection", m_projectionMatrix);
+			m_basicMeshes->SetShaderManager(pDepthShader);
+			m_basicMeshes->ReplayRecords(m_drawRecords, 0, opaqueDrawCount);
+			m_basicMeshes->SetShaderManager(m_pShaderManager);
+			m_pShaderManager->use();
+		}
+		m_pDepthPrepass->EndDepthPass();
+	}
+
+	if (NULL != m_pFrameTimers)
+	{
+		m_pFrameTimers->BeginScope("Opaque");
+	}
+	if (NULL != m_pDepthPrepass)
+	{
+		m_pDepthPrepass->BeginShadingPass(m_bDepthPrepass);
+	}
+	{
+		DebugGroup group("Opaque");
+		if (bIndirect == true)
+		{
+			m_pIndirectRenderer->DrawOpaque();
+		}
+		else
+		{
+			m_basicMeshes->ReplayRecords(m_drawRecords, 0, opaqueDrawCount);
+		}
+	}
+	if (NULL != m_pDepthPrepass)
+	{
+		m_pDepthPrepass->EndShadingPass();
+	}
+	if (NULL != m_pFrameTimers)
+	{
+		m_pFrameTimers->EndScope();
+	}
+
+	DebugGroup group("Translucent");
+	GpuTimerScope timer(m_pFrameTimers, "Translucent");
+	if (m_bTransparencyPass == true)
+	{
+		DrawTranslucentRecords(bIndirect, opaqueDrawCount);
+	}
+	else if (bIndirect == true)
+	{
+		m_pIndirectRenderer->DrawTranslucent();
+		m_pShaderManager->use();
+	}
+	else
+	{
+		m_basicMeshes->ReplayRecords(m_drawRecords, opaqueDrawCount, drawCount - opaqueDrawCount);
+	}
+}
+
+/***********************************************************
+ *  DrawTranslucentRecords()
+ *
+ *  This method draws the translucent draws into the targets
+ *  of the transparency pass, with the lit program of the
+ *  path switched to the weighted blending, and composites
+ *  them over the scene. No sorting is needed, as the result
+ *  does not depend on the draw order.
+ ***********************************************************/
+void SceneManager::DrawTranslucentRecords(bool bIndirect, size_t opaqueDrawCount)
+{
+	size_t drawCount = m_drawRecords.size();
+	if (drawCount == opaqueDrawCount)
+	{
+		return;
+	}
+
+	ShaderManager* pShader = (bIndirect == true) ? m_pIndirectRenderer->GetShaderManager() : m_pShaderManager;
+
+	m_pTransparencyPass->BeginTranslucentPass();
+	pShader->use();
+	pShader->setBoolValue("bWeightedBlend", true);
+	if (bIndirect == true)
+	{
+		m_pIndirectRenderer->DrawTranslucent();
+	}
+	else
+	{
+		m_basicMeshes->ReplayRecords(m_drawRecords, opaqueDrawCount, drawCount - opaqueDrawCount);
+	}
+	pShader->setBoolValue("bWeightedBlend", false);
+	m_pTransparencyPass->EndTranslucentPass();
+
+	m_pShaderManager->use();
+}
+
+/***********************************************************
+ *  RenderSceneObjects()
+ *
+ *  This method transforms and draws every object of the 3D
+ *  scene once, either straight to the screen or into the
+ *  draw records when the meshes are recording.
+ ***********************************************************/
+void SceneManager::RenderSceneObjects()
+{
+	// recorded draws are drawn later by the passes, so the objects are
+	// only timed on the GPU when they draw straight away
+	GpuTimers* pObjectTimers = (m_basicMeshes->IsRecording() == true) ? NULL : m_pFrameTimers;
+
 	// set a default base color before rendering individual objects
 	SetShaderColor(0.8f, 0.6f, 0.4f, 1.0f);
 
 	// render the table centered at the world origin
-	m_table->Render();
+	{
+		DebugGroup group("Table");
+		GpuTimerScope timer(pObjectTimers, "Table");
+		m_table->Render();
+	}
+
+	// the objects on the table may move, so their shadows are drawn
+	// every frame on top of the cached static shadows
+	m_pShaderManager->setDrawDynamic(true);
 
 	// render the vase above the table's center
-	m_centerPiece->Render(glm::vec3(0.0f, 5.24f, 0.0f));
+	{
+		DebugGroup group("Centerpiece");
+		GpuTimerScope timer(pObjectTimers, "Centerpiece");
+		m_centerPiece->Render(glm::vec3(0.0f, 5.24f, 0.0f));
+	}
 
 	// render the mug on top of the table surface, rotated 165 degrees on Y
-	m_mug->Render(glm::vec3(1.4f, 5.4f, 2.8f), 0.8f, 0.0f, 165.0f);
+	{
+		DebugGroup group("Mug");
+		GpuTimerScope timer(pObjectTimers, "Mug");
+		m_mug->Render(glm::vec3(1.4f, 5.4f, 2.8f), 0.8f, 0.0f, 165.0f);
+	}
 
 	// render the coaster directly beneath the mug at the table surface height
-	m_coaster->Render(glm::vec3(1.4f, 5.24f, 2.8f), 1.12f);
+	{
+		DebugGroup group("Coaster");
+		GpuTimerScope timer(pObjectTimers, "Coaster");
+		m_coaster->Render(glm::vec3(1.4f, 5.24f, 2.8f), 1.12f);
+	}
 
 	// render the laptop on top of the table's surface and placemat, rotation -25 degress on Y
-	m_laptop->Render(glm::vec3(-1.9f, 5.32f, 3.75f), 0.95f, 0.0f, -25.0f, 0.0f);
+	{
+		DebugGroup group("Laptop");
+		GpuTimerScope timer(pObjectTimers, "Laptop");
+		m_laptop->Render(glm::vec3(-1.9f, 5.32f, 3.75f), 0.95f, 0.0f, -25.0f, 0.0f);
+	}
 
-	// set book cover and page textures then render on the table
-	m_book->SetPageTexture(FindTextureSlot("pages"));
-	m_book->SetCoverTexture(FindTextureSlot("brown_leather"));
-	m_book->Render(glm::vec3(1.3f, 5.46f, -1.5f), 0.8f, 0.0f, 60.0f, 0.0f);
+	// the small spheres of the impostor benchmark float above the table
+	if (m_renderSettings.extraSphereCount > 0)
+	{
+		DebugGroup group("Extra spheres");
+		GpuTimerScope timer(pObjectTimers, "Extra spheres");
+		RenderExtraSpheres(m_renderSettings.extraSphereCount);
+	}
 
-	// set book cover texture then render above the first book
-	m_book->SetCoverTexture(FindTextureSlot("black_leather"));	// 7 - black leather
-	m_book->Render(glm::vec3(1.3f, 5.87f, -1.5f), 0.65f, 0.0f, 240.0f, 0.0f);
+	m_pShaderManager->setDrawDynamic(false);
 
-	// set book cover texture and adjust uvscale then render above the second book
-	m_book->SetCoverTexture(FindTextureSlot("red_leather")); // 8 - red leather
-	m_book->SetUVScale(0.3f, 0.5f);
-	m_book->Render(glm::vec3(1.3f, 6.19f, -1.5f), 0.5f, 0.0f, 60.0f, 0.0f);
+	// the three books add up to one time
+	{
+		DebugGroup group("Books");
+		GpuTimerScope timer(pObjectTimers, "Books");
+
+		// set book cover and page textures then render on the table - the
+		// uv scale goes back to the default the third book changed last frame
+		m_book->SetPageTexture(FindTextureSlot("pages"));
+		m_book->SetCoverTexture(FindTextureSlot("brown_leather"));
+		m_book->SetUVScale(1.0f, 1.0f);
+		m_book->Render(glm::vec3(1.3f, 5.46f, -1.5f), 0.8f, 0.0f, 60.0f, 0.0f);
+
+		// set book cover texture then render above the first book
+		m_book->SetCoverTexture(FindTextureSlot("black_leather"));	// 7 - black leather
+		m_book->Render(glm::vec3(1.3f, 5.87f, -1.5f), 0.65f, 0.0f, 240.0f, 0.0f);
+
+		// set book cover texture and adjust uvscale then render above the second book
+		m_book->SetCoverTexture(FindTextureSlot("red_leather")); // 8 - red leather
+		m_book->SetUVScale(0.3f, 0.5f);
+		m_book->Render(glm::vec3(1.3f, 6.19f, -1.5f), 0.5f, 0.0f, 60.0f, 0.0f);
+	}
 
 	// render the wooden floor beneath the table and carpet
-	RenderFloor();
+	{
+		DebugGroup group("Floor");
+		GpuTimerScope timer(pObjectTimers, "Floor");
+		RenderFloor();
+	}
 
 	// render the carpet beneath the table
-	RenderCarpet();
+	{
+		DebugGroup group("Carpet");
+		GpuTimerScope timer(pObjectTimers, "Carpet");
+		RenderCarpet();
+	}
 
 	// render three place mats at different positions on the table surface
-	RenderPlaceMat(glm::vec3(-1.8f, 5.24f, 3.5f), 1.9f);
-	RenderPlaceMat(glm::vec3(-2.5f, 5.24f, -1.5f), 1.9f);
-	RenderPlaceMat(glm::vec3(3.7f, 5.24f, 0.7f), 1.9f);
+	{
+		DebugGroup group("Place mats");
+		GpuTimerScope timer(pObjectTimers, "Place mats");
+		RenderPlaceMat(glm::vec3(-1.8f, 5.24f, 3.5f), 1.9f);
+		RenderPlaceMat(glm::vec3(-2.5f, 5.24f, -1.5f), 1.9f);
+		RenderPlaceMat(glm::vec3(3.7f, 5.24f, 0.7f), 1.9f);
+	}
+}
+
+/***********************************************************
+ *  ExpandSceneCopies()
+ *
+ *  This method appends a translated copy of the recorded
+ *  draws for every extra scene copy. The copies are laid
+ *  out in a square grid behind the original scene.
+ ***********************************************************/
+void SceneManager::ExpandSceneCopies(int sceneCopies)
+{
+	size_t sceneDraws = m_drawRecords.size();
+	int gridSize = (int)std::ceil(std::sqrt((float)sceneCopies));
+
+	m_drawRecords.reserve(sceneDraws * sceneCopies);
+	for (int copy = 1; copy < sceneCopies; copy++)
+	{
+		glm::mat4 offset = glm::translate(glm::vec3(
+			(copy % gridSize) * SCENE_COPY_SPACING,
+			0.0f,
+			-(copy / gridSize) * SCENE_COPY_SPACING));
+
+		for (size_t i = 0; i < sceneDraws; i++)
+		{
+			ShapeMeshes::DrawRecord record = m_drawRecords[i];
+			record.parameters.model = offset * record.parameters.model;
+			m_drawRecords.push_back(record);
+		}
+	}
+}
+
+/***********************************************************
+ *  ReportRenderTime()
+ *
+ *  This method adds up the CPU time spent in RenderScene()
+ *  and prints the average every few hundred frames, along
+ *  with the draw path and the scene size, so the immediate
+ *  and indirect paths can be compared.
+ ***********************************************************/
+void SceneManager::ReportRenderTime(std::chrono::duration<double, std::milli> frameTime, bool bIndirect)
+{
+	m_renderTime += frameTime;
+	m_timedFrames++;
+
+	if (m_timedFrames < TIMED_FRAME_COUNT)
+	{
+		return;
+	}
+
+	std::cout << "INFO: " << (bIndirect ? "indirect" : "immediate") << " path, "
+		<< std::max(1, m_renderSettings.sceneCopies) << " scene copies";
+	if (m_sceneDrawCount > 0)
+	{
+		std::cout << ", " << m_sceneDrawCount << " draws";
+	}
+	if (m_bGPUCulling == true)
+	{
+		// the GPU counts of a recent frame, none before the first arrives
+		int visible = m_pIndirectRenderer->GetVisibleDrawCount();
+		int occluded = m_pIndirectRenderer->GetOccludedDrawCount();
+		if (visible >= 0)
+		{
+			std::cout << ", " << (m_sceneDrawCount - visible - occluded) << " culled on the GPU";
+			if (m_bOcclusionCulling == true)
+			{
+				std::cout << ", " << occluded << " occluded";
+			}
+		}
+	}
+	else if (m_renderSettings.bFrustumCulling == true)
+	{
+		std::cout << ", " << m_culledDrawCount << " culled on the CPU";
+	}
+	if ((m_renderSettings.bOcclusionCulling == true) && (m_bOcclusionCulling == false))
+	{
+		std::cout << ", occlusion culling needs the indirect path";
+	}
+	if (m_bLightLists == true)
+	{
+		std::cout << ", light lists of " << m_pLightLists->GetLightCount() << " lights, "
+			<< m_pLightLists->GetAverageDrawLights() << " per draw, "
+			<< m_pLightLists->GetOverflowDraws() << " draws over the limit";
+	}
+	if (m_bClusteredLighting == true)
+	{
+		std::cout << ", clustered lighting with " << m_pClusteredLighting->GetLightCount()
+			<< " lights, " << m_pClusteredLighting->GetAverageClusterLights() << " per cluster";
+	}
+	else if (m_renderSettings.bClusteredLighting == true)
+	{
+		std::cout << ", clustered lighting needs the indirect path";
+	}
+	if (m_bShadows == true)
+	{
+		// the GPU times lag a frame behind, so they are averaged separately
+		const ShadowMaps::Timings& hits = m_pShadowMaps->GetCacheHitTimings();
+		const ShadowMaps::Timings& rebuilds = m_pShadowMaps->GetRebuildTimings();
+		std::cout << ", shadow cache " << hits.frames << " hits";
+		if (hits.frames > 0)
+		{
+			std::cout << " at " << (hits.cpuMilliseconds / hits.frames) << " ms CPU / "
+				<< (hits.gpuMilliseconds / std::max(1, hits.gpuFrames)) << " ms GPU";
+		}
+		std::cout << ", " << rebuilds.frames << " rebuilds";
+		if (rebuilds.frames > 0)
+		{
+			std::cout << " at " << (rebuilds.cpuMilliseconds / rebuilds.frames) << " ms CPU / "
+				<< (rebuilds.gpuMilliseconds / std::max(1, rebuilds.gpuFrames)) << " ms GPU";
+		}
+		m_pShadowMaps->ResetTimings();
+	}
+	if (m_bBakedLighting == true)
+	{
+		std::cout << ", baked lighting of " << m_pBakedLighting->GetBakedDrawCount() << " draws, "
+			<< m_pBakedLighting->GetBakedTriangleCount() << " triangles";
+	}
+	else if (m_renderSettings.bBakedLighting == true)
+	{
+		if ((NULL != m_pBakedLighting) && (m_pBakedLighting->IsBaking() == true))
+		{
+			std::cout << ", baking the lightmap";
+		}
+		else if (m_bDeferredShading == true)
+		{
+			std::cout << ", baked lighting needs a forward path";
+		}
+	}
+	if (m_bSphereImpostors == true)
+	{
+		std::cout << ", " << m_pSphereImpostors->GetSphereCount() << " sphere impostors";
+	}
+	else if ((m_renderSettings.bSphereImpostors == true) && (m_bDeferredShading == true))
+	{
+		std::cout << ", sphere impostors need a forward path";
+	}
+	if (m_bTransparencyPass == true)
+	{
+		std::cout << ", weighted blended transparency of " << (m_drawRecords.size() -
+			std::count_if(m_drawRecords.begin(), m_drawRecords.end(), IsOpaqueRecord)) << " draws";
+	}
+	else if (m_renderSettings.bOrderIndependentTransparency == true)
+	{
+		std::cout << ", weighted blended transparency needs OpenGL 4.0";
+	}
+	if (m_bDeferredShading == true)
+	{
+		std::cout << ", deferred shading of " << m_pClusteredLighting->GetLightCount() << " lights";
+	}
+	else if (m_renderSettings.bDeferredShading == true)
+	{
+		std::cout << ", deferred shading needs the indirect path";
+	}
+
+	// the samples of the last frame - with the pre-pass the depth pass
+	// counts every fragment that would have been shaded without it
+	GLuint depthSamples = 0;
+	GLuint shadedSamples = 0;
+	if ((NULL != m_pDepthPrepass) && m_pDepthPrepass->ReadSampleCounts(depthSamples, shadedSamples))
+	{
+		if ((m_bDepthPrepass == true) && (shadedSamples > 0))
+		{
+			std::cout << ", depth pre-pass overdraw ratio " << ((double)depthSamples / shadedSamples)
+				<< " (" << depthSamples << " depth / " << shadedSamples << " shaded samples)";
+		}
+		else
+		{
+			std::cout << ", " << shadedSamples << " shaded samples";
+		}
+	}
+	std::cout << " - average RenderScene() CPU time "
+		<< (m_renderTime.count() / m_timedFrames) << " ms" << std::endl;
+
+	// the rolling GPU times, also written as JSON for scripts
+	if (NULL != m_pFrameTimers)
+	{
+		m_pFrameTimers->PrintReport(std::cout);
+		std::ofstream report(g_GpuTimerReportFile);
+		m_pFrameTimers->WriteJsonReport(report);
+	}
+
+	m_renderTime = std::chrono::duration<double, std::milli>::zero();
+	m_timedFrames = 0;
+}
+
+/***********************************************************
+ *  SetViewParameters()
+ *
+ *  This method stores the camera values of the frame. The
+ *  view manager sets them into the main shader program -
+ *  the indirect program gets them when it is submitted.
+ ***********************************************************/
+void SceneManager::SetViewParameters(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position)
+{
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+	m_viewPosition = position;
 }
 
 /***********************************************************
@@ -11,6 +11,23 @@
 
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "TextureLoader.h"
+#include "MaterialLibrary.h"
+#include "LightLists.h"
+#include "IndirectRenderer.h"
+#include "DepthPrepass.h"
+#include "ClusteredLighting.h"
+#include "DeferredRenderer.h"
+#include "ShadowMaps.h"
+#include "BakedLighting.h"
+#include "SphereImpostors.h"
+#include "TransparencyPass.h"
+#include "GpuTimers.h"
+#include "StatsOverlay.h"
+#include "RenderStats.h"
+#include "GpuResources.h"
+#include "FrustumCuller.h"
+#include "RenderSettings.h"
 #include "Objects/Mug.h"
 #include "Objects/Coaster.h"
 #include "Objects/Table.h"
@@ -20,6 +37,7 @@
 
 #include <string>
 #include <vector>
+#include <chrono>
 
 /***********************************************************
  *  SceneManager
@@ -38,16 +56,18 @@ public:
 	struct TEXTURE_INFO
 	{
 		std::string tag;
+		// the texture bound to the slot - the placeholder until
+		// the image of the slot has been uploaded
 		uint32_t ID;
+		// the uploaded texture of the slot
+		GpuTexture texture;
 	};
 
-	struct OBJECT_MATERIAL
-	{
-		glm::vec3 diffuseColor;
-		glm::vec3 specularColor;
-		float shininess;
-		std::string tag;
-	};
+	// find the slot of the first of the passed texture slots
+	// that holds the tag, or -1 when none of them holds it
+	static int FindTextureTag(const TEXTURE_INFO* pTextures, int textureCount, const std::string& tag);
+	// find a material index by tag
+	int FindMaterial(std::string tag);
 
 private:
 	// pointer to shader manager object
@@ -56,10 +76,85 @@ private:
 	ShapeMeshes* m_basicMeshes;
 	// total number of loaded textures
 	int m_loadedTextures;
+	// the number of available texture slots
+	static const int MAX_TEXTURE_SLOTS = 16;
 	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
-	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	TEXTURE_INFO m_textureIDs[MAX_TEXTURE_SLOTS];
+	// decodes texture images on worker threads
+	TextureLoader* m_pTextureLoader;
+	// 1x1 texture bound to every slot until its image is uploaded
+	GpuTexture m_placeholderTexture;
+	// pixel buffer object used to stream decoded images to the GPU
+	GpuBuffer m_pixelUnpackBuffer;
+	// decoded images waiting for their upload
+	std::vector<TextureLoader::DecodedImage> m_pendingUploads;
+	// table of all scene materials, mirrored into a uniform buffer
+	MaterialLibrary* m_pMaterialLibrary;
+	// table of the scene lights and the per-draw light lists
+	LightLists* m_pLightLists;
+	// options choosing how the scene is drawn
+	RenderSettings m_renderSettings;
+	// multi-draw indirect backend, NULL when not supported
+	IndirectRenderer* m_pIndirectRenderer;
+	// depth pre-pass state and overdraw measurement
+	DepthPrepass* m_pDepthPrepass;
+	// per cluster light lists of the indirect path, NULL when not supported
+	ClusteredLighting* m_pClusteredLighting;
+	// G-buffer and lighting pass of the deferred path, NULL when not supported
+	DeferredRenderer* m_pDeferredRenderer;
+	// cached shadow maps of the directional and spot light, NULL when
+	// they could not be created
+	ShadowMaps* m_pShadowMaps;
+	// lightmap of the static draws baked on the CPU, NULL when its
+	// program could not be loaded
+	BakedLighting* m_pBakedLighting;
+	// weighted blended transparency of the recorded translucent draws,
+	// NULL when per draw buffer blending is not supported
+	TransparencyPass* m_pTransparencyPass;
+	// ray-cast spheres in place of the sphere meshes, NULL when their
+	// program could not be loaded
+	SphereImpostors* m_pSphereImpostors;
+	// GPU times of the passes and objects, NULL without timer queries -
+	// m_pFrameTimers is the same while the timers are on, else NULL
+	GpuTimers* m_pGpuTimers;
+	GpuTimers* m_pFrameTimers;
+	// counters and frame times drawn over the scene, NULL when its
+	// program could not be loaded
+	StatsOverlay* m_pStatsOverlay;
+	// the GL calls of the last frame and when it started
+	RenderStats m_frameStats;
+	std::chrono::steady_clock::time_point m_lastFrameStart;
+	bool m_bFrameStarted;
+	// the point and spot lights of the scene - the forward shaders only
+	// have uniforms for the first m_forwardLightCount of them, the light
+	// lists and the clustered lighting draw all of them
+	std::vector<LightSource> m_sceneLights;
+	size_t m_forwardLightCount;
+	// the draws recorded this frame for replay or indirect submission
+	std::vector<ShapeMeshes::DrawRecord> m_drawRecords;
+	// camera values passed on to the indirect program
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	glm::vec3 m_viewPosition;
+	// frame timing for the draw path benchmark
+	std::chrono::duration<double, std::milli> m_renderTime;
+	int m_timedFrames;
+	// draws recorded in the last frame and how many were culled
+	int m_sceneDrawCount;
+	int m_culledDrawCount;
+	// the draws hidden by occluders, read back from a recent frame, or
+	// -1 without occlusion culling
+	int m_occludedDrawCount;
+	bool m_bGPUCulling;
+	bool m_bOcclusionCulling;
+	bool m_bDepthPrepass;
+	bool m_bLightLists;
+	bool m_bClusteredLighting;
+	bool m_bDeferredShading;
+	bool m_bShadows;
+	bool m_bBakedLighting;
+	bool m_bTransparencyPass;
+	bool m_bSphereImpostors;
 	// pointer to mug object
 	Mug* m_mug;
 	// pointer to coaster object
@@ -73,8 +168,14 @@ private:
 	// pointer to center vase object
 	Centerpiece* m_centerPiece;
 
-	// load texture images and convert to OpenGL texture data
+	// queue a texture image for decoding and reserve its slot
 	bool CreateGLTexture(const char* filename, std::string tag);
+	// create the placeholder texture shown while images decode
+	void CreatePlaceholderTexture();
+	// upload a decoded image into its texture slot
+	bool UploadDecodedTexture(TextureLoader::DecodedImage& image);
+	// upload a block compressed image and its mipmap levels
+	bool UploadCompressedTexture(TextureLoader::DecodedImage& image);
 	// bind loaded OpenGL textures to slots in memory
 	void BindGLTextures();
 	// free the loaded OpenGL textures
@@ -82,8 +183,6 @@ private:
 	// find a loaded texture by tag
 	int FindTextureID(std::string tag);
 	int FindTextureSlot(std::string tag);
-	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
 
 	// set the transformation values 
 	// into the transform buffer
@@ -113,6 +212,30 @@ private:
 	void SetShaderMaterial(
 		std::string materialTag);
 
+	// set the scene light uniforms into a shader program
+	void ApplySceneLights(ShaderManager* pShaderManager);
+	// add the small point lights of the many lights benchmark
+	void AddExtraLights(int lightCount);
+	// draw the small spheres of the sphere impostor benchmark
+	void RenderExtraSpheres(int sphereCount);
+
+	// draw every object of the scene once
+	void RenderSceneObjects();
+
+	// replicate the recorded draws for each extra scene copy
+	void ExpandSceneCopies(int sceneCopies);
+
+	// draw the recorded draws on the immediate or indirect path - the
+	// first opaqueDrawCount records get the depth pre-pass when enabled
+	void DrawRecordedScene(bool bIndirect, size_t opaqueDrawCount,
+		const glm::mat4* pCullViewProjection, bool bOcclusion);
+	// draw the records from opaqueDrawCount on with the weighted
+	// blending of the transparency pass
+	void DrawTranslucentRecords(bool bIndirect, size_t opaqueDrawCount);
+
+	// add the render time of a frame and report the average
+	void ReportRenderTime(std::chrono::duration<double, std::milli> frameTime, bool bIndirect);
+
 public:
 
 	// The following methods are for the students to 
@@ -123,6 +246,28 @@ public:
 	// load all of the needed textures before rendering
 	void LoadSceneTextures();
 
+	// upload any texture images finished decoding since last frame
+	void UpdateTextureUploads();
+	// true once every scene texture is decoded and uploaded
+	bool AreTexturesResident() const;
+	// true when the last frame drew the static draws from a current
+	// lightmap
+	bool IsLightingBaked() const { return m_bBakedLighting; }
+
+	// the render options, shared with the view manager hotkeys
+	RenderSettings* GetRenderSettings() { return &m_renderSettings; }
+	// the rolling GPU pass and object times, NULL when not supported
+	const GpuTimers* GetGpuTimers() const { return m_pGpuTimers; }
+
+	// set the camera values used by the indirect program
+	void SetViewParameters(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position);
+
+	// the draw calls, triangles and other GL calls of the last frame
+	const RenderStats& GetFrameStats() const { return m_frameStats; }
+	// the draws the GPU occlusion culling hid, as read back a frame or
+	// two after it ran - -1 when the last frame did not occlusion cull
+	int GetOccludedDrawCount() const { return m_occludedDrawCount; }
+
 	// add and define the light sources before rendering
 	void SetupSceneLights();
 
@@ -0,0 +1,440 @@
+#include "ShadowMaps.h"
+#include "FrustumCuller.h"
+#include "RenderStats.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+	const char* g_PrepassVertexShader = "shaders/prepassVertexShader.glsl";
+	const char* g_DepthFragmentShader = "shaders/depthFragmentShader.glsl";
+
+	// the spot light frustum is limited to this field of view, wider
+	// cones are only shadowed inside it
+	const float MAX_SPOT_FIELD_OF_VIEW = glm::radians(150.0f);
+	const float SPOT_NEAR_PLANE = 0.1f;
+	// far plane of spot lights without a falloff
+	const float SPOT_FAR_PLANE = 100.0f;
+
+	// slope scaled depth bias of the shadow draws
+	const float SHADOW_OFFSET_FACTOR = 2.0f;
+	const float SHADOW_OFFSET_UNITS = 4.0f;
+
+	// maps the light clip space to texture coordinates and depth
+	const glm::mat4 g_ShadowBias = glm::mat4(
+		0.5f, 0.0f, 0.0f, 0.0f,
+		0.0f, 0.5f, 0.0f, 0.0f,
+		0.0f, 0.0f, 0.5f, 0.0f,
+		0.5f, 0.5f, 0.5f, 1.0f);
+
+	// true when a draw covers the same triangles at the same place
+	bool IsSameDraw(const ShapeMeshes::DrawRecord& a, const ShapeMeshes::DrawRecord& b)
+	{
+		return (a.firstIndex == b.firstIndex) && (a.indexCount == b.indexCount) &&
+			(a.baseVertex == b.baseVertex) && (a.parameters.model == b.parameters.model);
+	}
+}
+
+/***********************************************************
+ *  ShadowMaps()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShadowMaps::ShadowMaps()
+{
+	m_pShaderManager = NULL;
+	for (int i = 0; i < SHADOW_LIGHT_COUNT; i++)
+	{
+		m_staticFramebuffers[i] = 0;
+		m_frameFramebuffers[i] = 0;
+		m_lightMatrices[i] = glm::mat4(1.0f);
+		m_cachedLightMatrices[i] = glm::mat4(1.0f);
+	}
+	m_directionalDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_bSpotLight = false;
+	m_spotLightIndex = -1;
+	m_bCacheValid = false;
+	m_bFrameMapsUsed = false;
+	m_texelSize = 0.0f;
+	for (int i = 0; i < 2; i++)
+	{
+		m_timerQueries[i] = 0;
+		m_bQueryPending[i] = false;
+		m_bQueryCacheHit[i] = false;
+	}
+	m_nextQuery = 0;
+}
+
+/***********************************************************
+ *  ~ShadowMaps()
+ *
+ *  The destructor frees the framebuffers and the queries -
+ *  the maps and the program are freed by their handles.
+ ***********************************************************/
+ShadowMaps::~ShadowMaps()
+{
+	if (NULL != m_pShaderManager)
+	{
+		delete m_pShaderManager;
+		m_pShaderManager = NULL;
+	}
+	glDeleteFramebuffers(SHADOW_LIGHT_COUNT, m_staticFramebuffers);
+	glDeleteFramebuffers(SHADOW_LIGHT_COUNT, m_frameFramebuffers);
+	if (0 != m_timerQueries[0])
+	{
+		glDeleteQueries(2, m_timerQueries);
+	}
+	for (int i = 0; i < SHADOW_LIGHT_COUNT; i++)
+	{
+		m_staticFramebuffers[i] = 0;
+		m_frameFramebuffers[i] = 0;
+	}
+	m_timerQueries[0] = 0;
+	m_timerQueries[1] = 0;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Loads the depth only program, which is shared with the
+ *  depth pre-pass, and creates a cached and a per frame
+ *  depth map for every shadowed light. The maps compare
+ *  against the reference depth when sampled, so every
+ *  filtered tap already averages four texels.
+ ***********************************************************/
+bool ShadowMaps::Initialize()
+{
+	m_pShaderManager = new ShaderManager();
+	m_program.Adopt(m_pShaderManager->LoadShaders(g_PrepassVertexShader, g_DepthFragmentShader));
+	if (0 == m_program)
+	{
+		return false;
+	}
+	m_program.SetLabel("Shadow depth");
+
+	glGenFramebuffers(SHADOW_LIGHT_COUNT, m_staticFramebuffers);
+	glGenFramebuffers(SHADOW_LIGHT_COUNT, m_frameFramebuffers);
+
+	GLint previousFramebuffer = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	// created on a shadow unit, so the scene textures stay bound
+	glActiveTexture(GL_TEXTURE0 + DIRECTIONAL_TEXTURE_UNIT);
+	bool bComplete = true;
+	for (int i = 0; i < SHADOW_LIGHT_COUNT * 2; i++)
+	{
+		GpuTexture& texture = (i < SHADOW_LIGHT_COUNT) ? m_staticMaps[i] : m_frameMaps[i - SHADOW_LIGHT_COUNT];
+		GLuint framebuffer = (i < SHADOW_LIGHT_COUNT) ? m_staticFramebuffers[i] : m_frameFramebuffers[i - SHADOW_LIGHT_COUNT];
+
+		texture.Create();
+		glBindTexture(GL_TEXTURE_2D, texture);
+		texture.SetLabel((i < SHADOW_LIGHT_COUNT) ? "Static shadow map" : "Frame shadow map");
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 0,
+			GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+		texture.SetBytes(GpuResources::TextureBytes(GL_DEPTH_COMPONENT32F, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE));
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			bComplete = false;
+		}
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+	if (bComplete == false)
+	{
+		std::cout << "Shadow map framebuffer is incomplete" << std::endl;
+		return false;
+	}
+
+	glGenQueries(2, m_timerQueries);
+
+	return true;
+}
+
+/***********************************************************
+ *  BindSamplers()
+ *
+ *  Points the shadow samplers of a lit program at the map
+ *  texture units.
+ ***********************************************************/
+void ShadowMaps::BindSamplers(ShaderManager* pShaderManager)
+{
+	pShaderManager->setSampler2DValue("directionalShadowMap", DIRECTIONAL_TEXTURE_UNIT);
+	pShaderManager->setSampler2DValue("spotShadowMap", SPOT_TEXTURE_UNIT);
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  Stores the shadowed lights. A changed light moves its
+ *  light matrix, which invalidates the cached maps on the
+ *  next update.
+ ***********************************************************/
+void ShadowMaps::SetLights(const glm::vec3& directionalDirection, const LightSource* pSpotLight, int lightIndex)
+{
+	m_directionalDirection = glm::normalize(directionalDirection);
+	m_bSpotLight = (NULL != pSpotLight);
+	m_spotLightIndex = (m_bSpotLight == true) ? lightIndex : -1;
+	if (m_bSpotLight == true)
+	{
+		m_spotLight = *pSpotLight;
+	}
+}
+
+/***********************************************************
+ *  UpdateLightMatrices()
+ *
+ *  Fits the directional light's orthographic projection
+ *  around the bounding spheres of the static draws, so it
+ *  only moves when they do. The spot light looks down its
+ *  cone with a perspective projection as far as its light
+ *  reaches.
+ ***********************************************************/
+void ShadowMaps::UpdateLightMatrices()
+{
+	glm::vec3 minimum(0.0f);
+	glm::vec3 maximum(0.0f);
+	for (size_t i = 0; i < m_staticDraws.size(); i++)
+	{
+		glm::vec4 sphere = FrustumCuller::TransformSphere(m_staticDraws[i].bounds, m_staticDraws[i].parameters.model);
+		glm::vec3 low = glm::vec3(sphere) - glm::vec3(sphere.w);
+		glm::vec3 high = glm::vec3(sphere) + glm::vec3(sphere.w);
+		minimum = (i == 0) ? low : glm::min(minimum, low);
+		maximum = (i == 0) ? high : glm::max(maximum, high);
+	}
+	glm::vec3 center = (minimum + maximum) * 0.5f;
+	float radius = std::max(glm::length(maximum - minimum) * 0.5f, 1.0f);
+
+	// a view direction straight up or down needs another up vector
+	glm::vec3 up = (std::abs(m_directionalDirection.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::mat4 view = glm::lookAt(center - (m_directionalDirection * radius), center, up);
+	glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius);
+	m_lightMatrices[DIRECTIONAL_SHADOW] = projection * view;
+	m_texelSize = (2.0f * radius) / SHADOW_MAP_SIZE;
+
+	if (m_bSpotLight == true)
+	{
+		glm::vec3 direction = glm::normalize(m_spotLight.direction);
+		up = (std::abs(direction.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		view = glm::lookAt(m_spotLight.position, m_spotLight.position + direction, up);
+
+		float coneAngle = 2.0f * std::acos(glm::clamp(m_spotLight.outerCutOff, -1.0f, 1.0f));
+		float lightRadius = GetLightRadius(m_spotLight);
+		float farPlane = (lightRadius > 0.0f) ? std::min(lightRadius, SPOT_FAR_PLANE) : SPOT_FAR_PLANE;
+		projection = glm::perspective(std::min(coneAngle, MAX_SPOT_FIELD_OF_VIEW), 1.0f, SPOT_NEAR_PLANE, farPlane);
+		m_lightMatrices[SPOT_SHADOW] = projection * view;
+	}
+}
+
+/***********************************************************
+ *  IsCacheValid()
+ *
+ *  Compares the static draws and light matrices of the
+ *  frame with the ones the cached maps were rendered from.
+ ***********************************************************/
+bool ShadowMaps::IsCacheValid() const
+{
+	if ((m_bCacheValid == false) || (m_cachedDraws.size() != m_staticDraws.size()))
+	{
+		return false;
+	}
+	for (int i = 0; i < SHADOW_LIGHT_COUNT; i++)
+	{
+		if (m_cachedLightMatrices[i] != m_lightMatrices[i])
+		{
+			return false;
+		}
+	}
+	for (size_t i = 0; i < m_staticDraws.size(); i++)
+	{
+		if (IsSameDraw(m_cachedDraws[i], m_staticDraws[i]) == false)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/***********************************************************
+ *  RenderDraws()
+ *
+ *  Draws the records depth only from the view of a light.
+ ***********************************************************/
+void ShadowMaps::RenderDraws(ShapeMeshes* pMeshes, const std::vector<ShapeMeshes::DrawRecord>& records, int light)
+{
+	m_pShaderManager->setMat4Value("view", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projection", m_lightMatrices[light]);
+	pMeshes->ReplayRecords(records);
+}
+
+/***********************************************************
+ *  ReadTimerQuery()
+ *
+ *  Adds the GPU time of the frame that last used the query
+ *  to the timings of its path. The query was submitted a
+ *  frame earlier, so the result is normally available.
+ ***********************************************************/
+void ShadowMaps::ReadTimerQuery(int query)
+{
+	if (m_bQueryPending[query] == false)
+	{
+		return;
+	}
+
+	GLuint64 nanoseconds = 0;
+	glGetQueryObjectui64v(m_timerQueries[query], GL_QUERY_RESULT, &nanoseconds);
+	Timings& timings = (m_bQueryCacheHit[query] == true) ? m_cacheHitTimings : m_rebuildTimings;
+	timings.gpuFrames++;
+	timings.gpuMilliseconds += nanoseconds / 1000000.0;
+	m_bQueryPending[query] = false;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  Splits the draws by their dynamic flag and rebuilds the
+ *  cached maps from the static ones when they or the lights
+ *  changed. When there are dynamic draws, the cached maps
+ *  are copied into the per frame maps and the dynamic draws
+ *  are added, otherwise the cached maps are sampled as they
+ *  are. The GPU and CPU time of the update is added to the
+ *  timings of the cache hit or the rebuild path.
+ ***********************************************************/
+void ShadowMaps::Update(ShapeMeshes* pMeshes, const std::vector<ShapeMeshes::DrawRecord>& records,
+	ShaderManager* pSceneShader)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	int query = m_nextQuery;
+	ReadTimerQuery(query);
+	glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[query]);
+
+	m_staticDraws.clear();
+	m_dynamicDraws.clear();
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		if (((int)records[i].parameters.surface.w & ShaderManager::DRAW_FLAG_DYNAMIC) != 0)
+		{
+			m_dynamicDraws.push_back(records[i]);
+		}
+		else
+		{
+			m_staticDraws.push_back(records[i]);
+		}
+	}
+
+	UpdateLightMatrices();
+	bool bCacheHit = IsCacheValid();
+	int lightCount = (m_bSpotLight == true) ? SHADOW_LIGHT_COUNT : 1;
+
+	GLint previousFramebuffer = 0;
+	GLint previousViewport[4];
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+	glViewport(0, 0, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE);
+	glDepthMask(GL_TRUE);
+	glEnable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(SHADOW_OFFSET_FACTOR, SHADOW_OFFSET_UNITS);
+	m_pShaderManager->use();
+	pMeshes->SetShaderManager(m_pShaderManager);
+
+	const GLfloat clearDepth = 1.0f;
+	if (bCacheHit == false)
+	{
+		for (int i = 0; i < lightCount; i++)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, m_staticFramebuffers[i]);
+			glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+			RenderDraws(pMeshes, m_staticDraws, i);
+			m_cachedLightMatrices[i] = m_lightMatrices[i];
+		}
+		m_cachedDraws = m_staticDraws;
+		m_bCacheValid = true;
+	}
+
+	m_bFrameMapsUsed = (m_dynamicDraws.empty() == false);
+	if (m_bFrameMapsUsed == true)
+	{
+		for (int i = 0; i < lightCount; i++)
+		{
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, m_staticFramebuffers[i]);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_frameFramebuffers[i]);
+			glBlitFramebuffer(0, 0, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 0, 0, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE,
+				GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+			glBindFramebuffer(GL_FRAMEBUFFER, m_frameFramebuffers[i]);
+			RenderDraws(pMeshes, m_dynamicDraws, i);
+		}
+	}
+
+	glDisable(GL_POLYGON_OFFSET_FILL);
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+	glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+	pMeshes->SetShaderManager(pSceneShader);
+	pSceneShader->use();
+
+	const GpuTexture* pMaps = (m_bFrameMapsUsed == true) ? m_frameMaps : m_staticMaps;
+	glActiveTexture(GL_TEXTURE0 + DIRECTIONAL_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, pMaps[DIRECTIONAL_SHADOW]);
+	glActiveTexture(GL_TEXTURE0 + SPOT_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, pMaps[SPOT_SHADOW]);
+	glActiveTexture(GL_TEXTURE0);
+	RenderStats::Frame().textureBinds += 2;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_bQueryPending[query] = true;
+	m_bQueryCacheHit[query] = bCacheHit;
+	m_nextQuery = 1 - query;
+
+	Timings& timings = (bCacheHit == true) ? m_cacheHitTimings : m_rebuildTimings;
+	timings.frames++;
+	timings.cpuMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/***********************************************************
+ *  ApplyShadows()
+ *
+ *  Sets the shadow uniforms of a lit program for the maps
+ *  of the last update.
+ ***********************************************************/
+void ShadowMaps::ApplyShadows(ShaderManager* pShaderManager, bool bShadows) const
+{
+	pShaderManager->setBoolValue("bShadows", bShadows);
+	if (bShadows == false)
+	{
+		return;
+	}
+
+	pShaderManager->setMat4Value("directionalShadowMatrix", g_ShadowBias * m_lightMatrices[DIRECTIONAL_SHADOW]);
+	pShaderManager->setMat4Value("spotShadowMatrix", g_ShadowBias * m_lightMatrices[SPOT_SHADOW]);
+	pShaderManager->setIntValue("shadowLightIndex", m_spotLightIndex);
+	// about a texel and a half of the directional map
+	pShaderManager->setFloatValue("shadowNormalOffset", 1.5f * m_texelSize);
+}
+
+/***********************************************************
+ *  ResetTimings()
+ *
+ *  Starts a new measurement of the update timings.
+ ***********************************************************/
+void ShadowMaps::ResetTimings()
+{
+	m_cacheHitTimings = Timings();
+	m_rebuildTimings = Timings();
+}
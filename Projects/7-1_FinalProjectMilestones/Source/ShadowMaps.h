@@ -0,0 +1,125 @@
+#pragma once
+
+#include "GpuResources.h"
+#include "LightSource.h"
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+
+#include <vector>
+
+/***********************************************************
+ *  ShadowMaps
+ *
+ *  Shadow maps of the directional light and of one spot
+ *  light. The static draws are rendered into a cached map
+ *  per light, which is only rebuilt when a light or one of
+ *  the static draws changes. Every frame the draws marked
+ *  dynamic are rendered on top of a copy of the cached map,
+ *  so a frame with a valid cache only pays for the moving
+ *  objects. The lit shaders filter the maps with PCF.
+ ***********************************************************/
+class ShadowMaps
+{
+public:
+	// texture units of the maps in the lit programs - above the scene
+	// textures, the depth pyramid and the G-buffer
+	static const GLuint DIRECTIONAL_TEXTURE_UNIT = 20;
+	static const GLuint SPOT_TEXTURE_UNIT = 21;
+	// width and height of every map
+	static const int SHADOW_MAP_SIZE = 2048;
+
+	// time spent on the frames that reused the cached maps or rebuilt
+	// them - the GPU time is only added once its query is read back
+	struct Timings
+	{
+		int frames = 0;
+		double cpuMilliseconds = 0.0;
+		int gpuFrames = 0;
+		double gpuMilliseconds = 0.0;
+	};
+
+	// constructor
+	ShadowMaps();
+	// destructor - frees the framebuffers and queries, the handles free
+	// the maps and the program
+	~ShadowMaps();
+
+	// load the depth program and create the maps
+	bool Initialize();
+
+	// point the shadow samplers of a program that includes
+	// lighting.glsl at the map texture units - needed even with
+	// shadows off, as samplers of different types may not share a unit
+	static void BindSamplers(ShaderManager* pShaderManager);
+
+	// set the shadowed lights - the spot light is the entry lightIndex
+	// of the scene light list, or none when pSpotLight is NULL
+	void SetLights(const glm::vec3& directionalDirection, const LightSource* pSpotLight, int lightIndex);
+
+	// render the shadows of the frame from the recorded draws -
+	// rebuilds the cached maps when needed, then adds the dynamic draws.
+	// The meshes are switched back to pSceneShader, which is left in use.
+	void Update(ShapeMeshes* pMeshes, const std::vector<ShapeMeshes::DrawRecord>& records,
+		ShaderManager* pSceneShader);
+
+	// turn the shadows on or off in a program that includes
+	// lighting.glsl, which must be in use
+	void ApplyShadows(ShaderManager* pShaderManager, bool bShadows) const;
+
+	// frame timings since the last reset, for the statistics report
+	const Timings& GetCacheHitTimings() const { return m_cacheHitTimings; }
+	const Timings& GetRebuildTimings() const { return m_rebuildTimings; }
+	void ResetTimings();
+
+private:
+	enum ShadowLight
+	{
+		DIRECTIONAL_SHADOW = 0,
+		SPOT_SHADOW,
+		SHADOW_LIGHT_COUNT
+	};
+
+	// fit the light matrices around the static draws
+	void UpdateLightMatrices();
+	// true when the cached maps were rendered from the same static
+	// draws and light matrices
+	bool IsCacheValid() const;
+	// render a list of draws into the bound map of one light
+	void RenderDraws(ShapeMeshes* pMeshes, const std::vector<ShapeMeshes::DrawRecord>& records, int light);
+	// add the GPU time of an earlier frame once its query is done
+	void ReadTimerQuery(int query);
+
+	ShaderManager* m_pShaderManager;
+	GpuProgram m_program;
+	// the cached static maps and the per frame copies with the dynamic
+	// draws, each with a depth only framebuffer
+	GpuTexture m_staticMaps[SHADOW_LIGHT_COUNT];
+	GpuTexture m_frameMaps[SHADOW_LIGHT_COUNT];
+	GLuint m_staticFramebuffers[SHADOW_LIGHT_COUNT];
+	GLuint m_frameFramebuffers[SHADOW_LIGHT_COUNT];
+	// light view and projection of each map
+	glm::mat4 m_lightMatrices[SHADOW_LIGHT_COUNT];
+	glm::vec3 m_directionalDirection;
+	LightSource m_spotLight;
+	bool m_bSpotLight;
+	int m_spotLightIndex;
+	// the draws of the frame split by the dynamic flag
+	std::vector<ShapeMeshes::DrawRecord> m_staticDraws;
+	std::vector<ShapeMeshes::DrawRecord> m_dynamicDraws;
+	// what the cached maps were rendered from
+	bool m_bCacheValid;
+	std::vector<ShapeMeshes::DrawRecord> m_cachedDraws;
+	glm::mat4 m_cachedLightMatrices[SHADOW_LIGHT_COUNT];
+	// the maps the lit programs sample this frame
+	bool m_bFrameMapsUsed;
+	// world size of a directional map texel, for the normal offset
+	float m_texelSize;
+	// two timer queries in turn, so reading one back does not wait
+	// for the frame that was just submitted
+	GLuint m_timerQueries[2];
+	bool m_bQueryPending[2];
+	bool m_bQueryCacheHit[2];
+	int m_nextQuery;
+	Timings m_cacheHitTimings;
+	Timings m_rebuildTimings;
+};
@@ -0,0 +1,188 @@
+#include "SphereImpostors.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace
+{
+	const char* g_ImpostorVertexShader = "shaders/impostorVertexShader.glsl";
+	const char* g_ImpostorFragmentShader = "shaders/impostorFragmentShader.glsl";
+
+	// the vertex attributes of the instance values
+	const GLuint CENTER_RADIUS_ATTRIBUTE = 0;
+	const GLuint COLOR_ATTRIBUTE = 1;
+	const GLuint SURFACE_ATTRIBUTE = 2;
+
+	// how far the axes of a sphere draw may differ in length or from
+	// a right angle before it counts as an ellipsoid
+	const float g_UniformScaleTolerance = 1e-3f;
+}
+
+/***********************************************************
+ *  SphereImpostors()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SphereImpostors::SphereImpostors()
+{
+	m_pShaderManager = NULL;
+	m_instanceCapacity = 0;
+}
+
+/***********************************************************
+ *  ~SphereImpostors()
+ *
+ *  The destructor frees the shader manager - the program
+ *  and the instance buffer are freed by their handles.
+ ***********************************************************/
+SphereImpostors::~SphereImpostors()
+{
+	if (NULL != m_pShaderManager)
+	{
+		delete m_pShaderManager;
+		m_pShaderManager = NULL;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Loads the impostor program and sets up the instance
+ *  attributes. The quad corners come from the vertex index,
+ *  so there is no vertex buffer.
+ ***********************************************************/
+bool SphereImpostors::Initialize(int textureSlots)
+{
+	m_pShaderManager = new ShaderManager();
+	m_program.Adopt(m_pShaderManager->LoadShaders(g_ImpostorVertexShader, g_ImpostorFragmentShader));
+	if (0 == m_program)
+	{
+		return false;
+	}
+	m_program.SetLabel("Sphere impostors");
+
+	// each texture slot sampler reads the texture unit of its slot
+	m_pShaderManager->use();
+	for (int i = 0; i < textureSlots; i++)
+	{
+		m_pShaderManager->setSampler2DValue("sceneTextures[" + std::to_string(i) + "]", i);
+	}
+
+	m_instanceBuffer.Create();
+	m_vertexArray.Create();
+	glBindVertexArray(m_vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	m_vertexArray.SetLabel("Sphere impostors");
+	m_instanceBuffer.SetLabel("Sphere impostor instances");
+	const GLuint attributes[3] = { CENTER_RADIUS_ATTRIBUTE, COLOR_ATTRIBUTE, SURFACE_ATTRIBUTE };
+	for (int i = 0; i < 3; i++)
+	{
+		glVertexAttribPointer(attributes[i], 4, GL_FLOAT, GL_FALSE, sizeof(SphereInstance),
+			(void*)(sizeof(glm::vec4) * i));
+		glVertexAttribDivisor(attributes[i], 1);
+		glEnableVertexAttribArray(attributes[i]);
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return true;
+}
+
+/***********************************************************
+ *  IsImpostorRecord()
+ *
+ *  The blended spheres stay in the records, so they keep
+ *  their place among the other blended draws.
+ ***********************************************************/
+bool SphereImpostors::IsImpostorRecord(const ShapeMeshes* pMeshes, const ShapeMeshes::DrawRecord& record)
+{
+	if ((record.parameters.color.a < 1.0f) || (pMeshes->IsSphereRecord(record) == false))
+	{
+		return false;
+	}
+
+	const glm::mat4& model = record.parameters.model;
+	glm::vec3 x = glm::vec3(model[0]);
+	glm::vec3 y = glm::vec3(model[1]);
+	glm::vec3 z = glm::vec3(model[2]);
+	float scale = glm::length(x);
+	float tolerance = g_UniformScaleTolerance * scale * scale;
+	return (std::fabs(glm::dot(y, y) - scale * scale) <= tolerance) &&
+		(std::fabs(glm::dot(z, z) - scale * scale) <= tolerance) &&
+		(std::fabs(glm::dot(x, y)) <= tolerance) &&
+		(std::fabs(glm::dot(x, z)) <= tolerance) &&
+		(std::fabs(glm::dot(y, z)) <= tolerance);
+}
+
+/***********************************************************
+ *  ExtractSpheres()
+ *
+ *  Turns the sphere draws into instances and removes them
+ *  from the records - the other draws keep their order. The
+ *  sphere mesh has a radius of one, so the radius is the
+ *  scale of the model matrix.
+ ***********************************************************/
+int SphereImpostors::ExtractSpheres(const ShapeMeshes* pMeshes, std::vector<ShapeMeshes::DrawRecord>& records)
+{
+	m_instances.clear();
+
+	std::vector<ShapeMeshes::DrawRecord>::iterator spheres = std::stable_partition(records.begin(), records.end(),
+		[pMeshes](const ShapeMeshes::DrawRecord& record) { return (IsImpostorRecord(pMeshes, record) == false); });
+
+	m_instances.reserve(records.end() - spheres);
+	for (std::vector<ShapeMeshes::DrawRecord>::const_iterator record = spheres; record != records.end(); ++record)
+	{
+		const ShaderManager::DrawParameters& parameters = record->parameters;
+		SphereInstance instance;
+		instance.centerRadius = glm::vec4(glm::vec3(parameters.model[3]), glm::length(glm::vec3(parameters.model[0])));
+		instance.color = parameters.color;
+		instance.surface = parameters.surface;
+		m_instances.push_back(instance);
+	}
+	records.erase(spheres, records.end());
+
+	return (int)m_instances.size();
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  Uploads the instances of the frame and draws a four
+ *  vertex strip for each of them.
+ ***********************************************************/
+void SphereImpostors::Draw(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition)
+{
+	if (m_instances.empty() == true)
+	{
+		return;
+	}
+
+	m_pShaderManager->use();
+	m_pShaderManager->setMat4Value("view", view);
+	m_pShaderManager->setMat4Value("projection", projection);
+	m_pShaderManager->setVec3Value("viewPosition", viewPosition);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+	if (m_instances.size() > m_instanceCapacity)
+	{
+		m_instanceCapacity = std::max(m_instances.size(), m_instanceCapacity * 2);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(SphereInstance) * m_instanceCapacity, NULL, GL_DYNAMIC_DRAW);
+		m_instanceBuffer.SetBytes(sizeof(SphereInstance) * m_instanceCapacity);
+	}
+	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(SphereInstance) * m_instances.size(), m_instances.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glBindVertexArray(m_vertexArray);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)m_instances.size());
+	glBindVertexArray(0);
+
+	// every sphere is one quad
+	RenderStats& stats = RenderStats::Frame();
+	stats.bufferUploads++;
+	stats.vertexArrayBinds++;
+	stats.drawCalls++;
+	stats.triangles += 2 * (long long)m_instances.size();
+}
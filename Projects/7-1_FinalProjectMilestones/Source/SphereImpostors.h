@@ -0,0 +1,70 @@
+#pragma once
+
+#include "GpuResources.h"
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+
+#include <vector>
+
+/***********************************************************
+ *  SphereImpostors
+ *
+ *  Draws the opaque sphere draws of the frame as ray-cast
+ *  impostors instead of sphere meshes. Every sphere is one
+ *  instance of a camera facing quad that covers its
+ *  silhouette, and the fragment shader intersects the view
+ *  ray with the sphere, writes the depth of the hit and
+ *  lights it with the normal of the exact sphere. The vertex
+ *  cost stays at four vertices per sphere, however many
+ *  spheres are drawn. The impostors are lit by the forward
+ *  lights and shadows, like the baked draws they are drawn
+ *  ahead of the forward passes.
+ ***********************************************************/
+class SphereImpostors
+{
+public:
+	// constructor
+	SphereImpostors();
+	// destructor - the program and the instance buffer are freed by
+	// their handles
+	~SphereImpostors();
+
+	// load the impostor program, which samples the first textureSlots
+	// texture units like the indirect program
+	bool Initialize(int textureSlots);
+
+	// the program, for the light, material and shadow setup
+	ShaderManager* GetShaderManager() const { return m_pShaderManager; }
+
+	// move the opaque, uniformly scaled sphere draws out of the records
+	// into the impostor instances of the frame - returns how many
+	int ExtractSpheres(const ShapeMeshes* pMeshes, std::vector<ShapeMeshes::DrawRecord>& records);
+
+	// draw the instances of the frame - leaves the impostor program
+	// in use
+	void Draw(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition);
+
+	int GetSphereCount() const { return (int)m_instances.size(); }
+
+private:
+	// per instance values - world space center and radius, and the
+	// color and surface values of the draw parameters
+	struct SphereInstance
+	{
+		glm::vec4 centerRadius;
+		glm::vec4 color;
+		glm::vec4 surface;
+	};
+
+	// true when the model matrix of a sphere draw only rotates,
+	// scales evenly and moves it, so it stays a sphere
+	static bool IsImpostorRecord(const ShapeMeshes* pMeshes, const ShapeMeshes::DrawRecord& record);
+
+	ShaderManager* m_pShaderManager;
+	GpuProgram m_program;
+	GpuVertexArray m_vertexArray;
+	GpuBuffer m_instanceBuffer;
+	// the buffer is grown to the largest frame
+	size_t m_instanceCapacity;
+	std::vector<SphereInstance> m_instances;
+};
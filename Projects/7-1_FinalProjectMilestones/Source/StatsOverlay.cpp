@@ -0,0 +1,426 @@
+#include "StatsOverlay.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	const char* g_OverlayVertexShader = "shaders/overlayVertexShader.glsl";
+	const char* g_OverlayFragmentShader = "shaders/overlayFragmentShader.glsl";
+
+	// the vertex attributes of the overlay quads
+	const GLuint POSITION_ATTRIBUTE = 0;
+	const GLuint TEXCOORD_ATTRIBUTE = 1;
+	const GLuint COLOR_ATTRIBUTE = 2;
+
+	// one 5x7 glyph - the top row first, the left pixel in bit 4
+	struct Glyph
+	{
+		char character;
+		unsigned char rows[7];
+	};
+
+	// the characters the overlay needs, lower case is drawn as upper case
+	const Glyph g_Glyphs[] = {
+		{ ' ', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+		{ '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+		{ '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+		{ '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+		{ '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+		{ '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+		{ '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+		{ '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+		{ '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+		{ '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+		{ '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+		{ 'A', { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 } },
+		{ 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+		{ 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+		{ 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+		{ 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+		{ 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+		{ 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } },
+		{ 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+		{ 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+		{ 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+		{ 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+		{ 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+		{ 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+		{ 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+		{ 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+		{ 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+		{ 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } },
+		{ 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+		{ 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } },
+		{ 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+		{ 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+		{ 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+		{ 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } },
+		{ 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+		{ 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } },
+		{ 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+		{ ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+		{ '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+		{ '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } },
+		{ '%', { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 } },
+		{ '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+		{ '(', { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 } },
+		{ ')', { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 } },
+		{ '=', { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 } }
+	};
+	const int GLYPH_COUNT = sizeof(g_Glyphs) / sizeof(g_Glyphs[0]);
+
+	// every glyph has a cell with a blank column and row around it,
+	// and the cell after the last glyph is solid for the panel and bars
+	const int GLYPH_WIDTH = 5;
+	const int GLYPH_HEIGHT = 7;
+	const int CELL_WIDTH = 6;
+	const int CELL_HEIGHT = 8;
+
+	// the layout of the overlay in pixels
+	const float g_TextScale = 2.0f;
+	const float g_Margin = 8.0f;
+	const float g_Padding = 6.0f;
+	const float g_LineSpacing = 4.0f;
+	const float g_GraphHeight = 64.0f;
+	// the graph is twice the frame time of 60 frames per second high
+	const double g_TargetMilliseconds = 1000.0 / 60.0;
+
+	const glm::vec4 g_PanelColor(0.0f, 0.0f, 0.0f, 0.6f);
+	const glm::vec4 g_TextColor(1.0f, 1.0f, 1.0f, 1.0f);
+	const glm::vec4 g_TargetLineColor(1.0f, 1.0f, 1.0f, 0.5f);
+	const glm::vec4 g_FastFrameColor(0.3f, 0.9f, 0.3f, 0.9f);
+	const glm::vec4 g_SlowFrameColor(0.95f, 0.8f, 0.2f, 0.9f);
+	const glm::vec4 g_VerySlowFrameColor(0.95f, 0.25f, 0.2f, 0.9f);
+
+	// the text lines of the overlay
+	const int LINE_COUNT = 5;
+	const int LINE_LENGTH = 96;
+}
+
+/***********************************************************
+ *  StatsOverlay()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StatsOverlay::StatsOverlay()
+{
+	m_pShaderManager = NULL;
+	m_fontWidth = 0;
+	m_frameTimes.reserve(HISTORY_FRAMES);
+	m_nextFrame = 0;
+}
+
+/***********************************************************
+ *  ~StatsOverlay()
+ *
+ *  The destructor frees the shader manager - the program,
+ *  the vertex buffer and the font texture are freed by
+ *  their handles.
+ ***********************************************************/
+StatsOverlay::~StatsOverlay()
+{
+	if (NULL != m_pShaderManager)
+	{
+		delete m_pShaderManager;
+		m_pShaderManager = NULL;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Loads the overlay program, sets up the vertex layout of
+ *  the quads and builds the font texture.
+ ***********************************************************/
+bool StatsOverlay::Initialize()
+{
+	m_pShaderManager = new ShaderManager();
+	m_program.Adopt(m_pShaderManager->LoadShaders(g_OverlayVertexShader, g_OverlayFragmentShader));
+	if (0 == m_program)
+	{
+		return false;
+	}
+	m_program.SetLabel("Stats overlay");
+	m_pShaderManager->use();
+	m_pShaderManager->setSampler2DValue("fontTexture", FONT_TEXTURE_UNIT);
+
+	m_vertexBuffer.Create();
+	m_vertexArray.Create();
+	glBindVertexArray(m_vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	m_vertexArray.SetLabel("Stats overlay");
+	m_vertexBuffer.SetLabel("Stats overlay vertices");
+	glVertexAttribPointer(POSITION_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex),
+		(void*)offsetof(OverlayVertex, position));
+	glEnableVertexAttribArray(POSITION_ATTRIBUTE);
+	glVertexAttribPointer(TEXCOORD_ATTRIBUTE, 2, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex),
+		(void*)offsetof(OverlayVertex, texCoord));
+	glEnableVertexAttribArray(TEXCOORD_ATTRIBUTE);
+	glVertexAttribPointer(COLOR_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex),
+		(void*)offsetof(OverlayVertex, color));
+	glEnableVertexAttribArray(COLOR_ATTRIBUTE);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	CreateFontTexture();
+
+	return true;
+}
+
+/***********************************************************
+ *  CreateFontTexture()
+ *
+ *  Writes the glyphs side by side into a one channel
+ *  texture, one cell each, followed by the solid cell. The
+ *  texture is sampled without filtering, so the glyphs stay
+ *  sharp at any whole number scale.
+ ***********************************************************/
+void StatsOverlay::CreateFontTexture()
+{
+	m_fontWidth = (GLYPH_COUNT + 1) * CELL_WIDTH;
+	std::vector<unsigned char> pixels(m_fontWidth * CELL_HEIGHT, 0);
+	for (int glyph = 0; glyph < GLYPH_COUNT; glyph++)
+	{
+		for (int row = 0; row < GLYPH_HEIGHT; row++)
+		{
+			for (int column = 0; column < GLYPH_WIDTH; column++)
+			{
+				if ((g_Glyphs[glyph].rows[row] & (0x10 >> column)) != 0)
+				{
+					pixels[row * m_fontWidth + glyph * CELL_WIDTH + column] = 255;
+				}
+			}
+		}
+	}
+	for (int row = 0; row < CELL_HEIGHT; row++)
+	{
+		memset(&pixels[row * m_fontWidth + GLYPH_COUNT * CELL_WIDTH], 255, CELL_WIDTH);
+	}
+
+	m_fontTexture.Create();
+	glActiveTexture(GL_TEXTURE0 + FONT_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_fontTexture);
+	m_fontTexture.SetLabel("Stats overlay font");
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m_fontWidth, CELL_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+	m_fontTexture.SetBytes(GpuResources::TextureBytes(GL_R8, m_fontWidth, CELL_HEIGHT));
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+/***********************************************************
+ *  AddFrameTime()
+ *
+ *  Adds a frame time to the ring of the last frames.
+ ***********************************************************/
+void StatsOverlay::AddFrameTime(double milliseconds)
+{
+	if (m_frameTimes.size() < HISTORY_FRAMES)
+	{
+		m_frameTimes.push_back(milliseconds);
+	}
+	else
+	{
+		m_frameTimes[m_nextFrame] = milliseconds;
+	}
+	m_nextFrame = (m_nextFrame + 1) % HISTORY_FRAMES;
+}
+
+/***********************************************************
+ *  AddQuad()
+ *
+ *  Adds the two triangles of a rectangle, textured with a
+ *  rectangle of the font texture given as (u0, v0, u1, v1).
+ ***********************************************************/
+void StatsOverlay::AddQuad(float x, float y, float width, float height,
+	const glm::vec4& texCoords, const glm::vec4& color)
+{
+	OverlayVertex corners[4] = {
+		{ glm::vec2(x, y), glm::vec2(texCoords.x, texCoords.y), color },
+		{ glm::vec2(x + width, y), glm::vec2(texCoords.z, texCoords.y), color },
+		{ glm::vec2(x + width, y + height), glm::vec2(texCoords.z, texCoords.w), color },
+		{ glm::vec2(x, y + height), glm::vec2(texCoords.x, texCoords.w), color }
+	};
+	const int order[6] = { 0, 1, 2, 0, 2, 3 };
+	for (int i = 0; i < 6; i++)
+	{
+		m_vertices.push_back(corners[order[i]]);
+	}
+}
+
+/***********************************************************
+ *  AddSolidQuad()
+ *
+ *  Adds a rectangle filled with the color, textured with
+ *  the middle of the solid cell.
+ ***********************************************************/
+void StatsOverlay::AddSolidQuad(float x, float y, float width, float height, const glm::vec4& color)
+{
+	float u = (GLYPH_COUNT * CELL_WIDTH + CELL_WIDTH * 0.5f) / m_fontWidth;
+	AddQuad(x, y, width, height, glm::vec4(u, 0.5f, u, 0.5f), color);
+}
+
+/***********************************************************
+ *  AddText()
+ *
+ *  Adds a quad per visible character. Characters missing
+ *  from the font are left blank.
+ ***********************************************************/
+float StatsOverlay::AddText(float x, float y, const char* text, const glm::vec4& color)
+{
+	float advance = CELL_WIDTH * g_TextScale;
+	float left = x;
+	for (const char* pCharacter = text; *pCharacter != '\0'; pCharacter++)
+	{
+		char character = (char)toupper((unsigned char)*pCharacter);
+		// the glyphs are few, so a linear search is enough
+		for (int glyph = 1; glyph < GLYPH_COUNT; glyph++)
+		{
+			if (g_Glyphs[glyph].character == character)
+			{
+				float u0 = (float)(glyph * CELL_WIDTH) / m_fontWidth;
+				float u1 = (float)(glyph * CELL_WIDTH + GLYPH_WIDTH) / m_fontWidth;
+				AddQuad(x, y, GLYPH_WIDTH * g_TextScale, GLYPH_HEIGHT * g_TextScale,
+					glm::vec4(u0, 0.0f, u1, (float)GLYPH_HEIGHT / CELL_HEIGHT), color);
+				break;
+			}
+		}
+		x += advance;
+	}
+	return x - left;
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  Builds the panel, the text and the frame time graph into
+ *  the vertex buffer and draws them with one call, blended
+ *  over the frame without the depth test. The oldest frame
+ *  is on the left of the graph, and each bar is colored by
+ *  how it compares to the 60 frames per second line.
+ ***********************************************************/
+void StatsOverlay::Draw(const RenderStats& stats, int occludedDraws)
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	double minTime = 0.0;
+	double averageTime = 0.0;
+	double p99Time = 0.0;
+	if (m_frameTimes.empty() == false)
+	{
+		std::vector<double> sortedTimes(m_frameTimes);
+		std::sort(sortedTimes.begin(), sortedTimes.end());
+		minTime = sortedTimes.front();
+		for (double time : sortedTimes)
+		{
+			averageTime += time;
+		}
+		averageTime /= sortedTimes.size();
+		p99Time = sortedTimes[(size_t)((sortedTimes.size() - 1) * 0.99 + 0.5)];
+	}
+
+	char lines[LINE_COUNT][LINE_LENGTH];
+	snprintf(lines[0], LINE_LENGTH, "Frame ms  min %.2f  avg %.2f  p99 %.2f", minTime, averageTime, p99Time);
+	if (occludedDraws >= 0)
+	{
+		snprintf(lines[1], LINE_LENGTH, "Draws %d  triangles %lld  occluded %d", stats.drawCalls, stats.triangles,
+			occludedDraws);
+	}
+	else
+	{
+		snprintf(lines[1], LINE_LENGTH, "Draws %d  triangles %lld", stats.drawCalls, stats.triangles);
+	}
+	snprintf(lines[2], LINE_LENGTH, "VAO binds %d  programs %d  textures %d",
+		stats.vertexArrayBinds, stats.programBinds, stats.textureBinds);
+	snprintf(lines[3], LINE_LENGTH, "Uniforms %d  uploads %d", stats.uniformCalls, stats.bufferUploads);
+	const double megabyte = 1024.0 * 1024.0;
+	snprintf(lines[4], LINE_LENGTH, "VRAM MB %.1f  buffers %.1f  textures %.1f", GpuResources::GetLiveBytes() / megabyte,
+		GpuResources::GetUsage(GpuResources::BUFFERS).liveBytes / megabyte,
+		GpuResources::GetUsage(GpuResources::TEXTURES).liveBytes / megabyte);
+
+	float lineHeight = GLYPH_HEIGHT * g_TextScale + g_LineSpacing;
+	float contentWidth = (float)HISTORY_FRAMES;
+	for (int i = 0; i < LINE_COUNT; i++)
+	{
+		contentWidth = std::max(contentWidth, strlen(lines[i]) * CELL_WIDTH * g_TextScale);
+	}
+	float contentHeight = LINE_COUNT * lineHeight + g_GraphHeight;
+
+	m_vertices.clear();
+	AddSolidQuad(g_Margin, g_Margin, contentWidth + 2.0f * g_Padding, contentHeight + 2.0f * g_Padding, g_PanelColor);
+
+	float x = g_Margin + g_Padding;
+	float y = g_Margin + g_Padding;
+	for (int i = 0; i < LINE_COUNT; i++)
+	{
+		AddText(x, y, lines[i], g_TextColor);
+		y += lineHeight;
+	}
+
+	// the bars grow up from the bottom of the graph, the newest on the right
+	float graphBottom = y + g_GraphHeight;
+	size_t frameCount = m_frameTimes.size();
+	size_t oldest = (frameCount < HISTORY_FRAMES) ? 0 : m_nextFrame;
+	float barX = x + (float)(HISTORY_FRAMES - frameCount);
+	for (size_t i = 0; i < frameCount; i++)
+	{
+		double time = m_frameTimes[(oldest + i) % frameCount];
+		float height = (float)std::min(time / (2.0 * g_TargetMilliseconds), 1.0) * g_GraphHeight;
+		const glm::vec4& color = (time <= g_TargetMilliseconds) ? g_FastFrameColor :
+			((time <= 2.0 * g_TargetMilliseconds) ? g_SlowFrameColor : g_VerySlowFrameColor);
+		AddSolidQuad(barX + i, graphBottom - height, 1.0f, std::max(height, 1.0f), color);
+	}
+	AddSolidQuad(x, graphBottom - 0.5f * g_GraphHeight, (float)HISTORY_FRAMES, 1.0f, g_TargetLineColor);
+
+	GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+	GLboolean bBlend = glIsEnabled(GL_BLEND);
+	GLboolean bCullFace = glIsEnabled(GL_CULL_FACE);
+	GLint previousBlend[4];
+	glGetIntegerv(GL_BLEND_SRC_RGB, &previousBlend[0]);
+	glGetIntegerv(GL_BLEND_DST_RGB, &previousBlend[1]);
+	glGetIntegerv(GL_BLEND_SRC_ALPHA, &previousBlend[2]);
+	glGetIntegerv(GL_BLEND_DST_ALPHA, &previousBlend[3]);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	m_pShaderManager->use();
+	m_pShaderManager->setVec2Value("viewportSize", (float)viewport[2], (float)viewport[3]);
+	glActiveTexture(GL_TEXTURE0 + FONT_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_fontTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	// a new store every frame, so the draw of the last frame never stalls it
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(OverlayVertex) * m_vertices.size(), m_vertices.data(), GL_STREAM_DRAW);
+	m_vertexBuffer.SetBytes(sizeof(OverlayVertex) * m_vertices.size());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(m_vertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)m_vertices.size());
+	glBindVertexArray(0);
+
+	glBlendFuncSeparate(previousBlend[0], previousBlend[1], previousBlend[2], previousBlend[3]);
+	if (bBlend == GL_FALSE)
+	{
+		glDisable(GL_BLEND);
+	}
+	if (bCullFace == GL_TRUE)
+	{
+		glEnable(GL_CULL_FACE);
+	}
+	if (bDepthTest == GL_TRUE)
+	{
+		glEnable(GL_DEPTH_TEST);
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "GpuResources.h"
+#include "ShaderManager.h"
+#include "RenderStats.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  StatsOverlay
+ *
+ *  Draws the GL call counters of the last frame, the frame
+ *  time statistics and a graph of the recent frame times in
+ *  the top left corner of the window. The text and the
+ *  graph are rebuilt into one vertex buffer every frame and
+ *  drawn with a single draw call from a small built in font
+ *  texture, so the overlay barely adds to what it measures.
+ ***********************************************************/
+class StatsOverlay
+{
+public:
+	// the unit the font texture is bound to, past the pass textures
+	static const GLuint FONT_TEXTURE_UNIT = 25;
+	// frames the graph and the frame time statistics cover
+	static const int HISTORY_FRAMES = 240;
+
+	// constructor
+	StatsOverlay();
+	// destructor - the program, the buffer and the font texture are
+	// freed by their handles
+	~StatsOverlay();
+
+	// load the overlay program and build the font texture
+	bool Initialize();
+
+	// add the time from the start of the previous frame to this one
+	void AddFrameTime(double milliseconds);
+
+	// draw the counters and the frame times over the current viewport,
+	// with the draws hidden by occlusion culling unless it is negative -
+	// leaves the overlay program in use
+	void Draw(const RenderStats& stats, int occludedDraws);
+
+private:
+	// one corner of a text or graph quad, in pixels from the top left
+	struct OverlayVertex
+	{
+		glm::vec2 position;
+		glm::vec2 texCoord;
+		glm::vec4 color;
+	};
+
+	// fill the font texture from the glyph table
+	void CreateFontTexture();
+	// add a quad showing the passed rectangle of the font texture
+	void AddQuad(float x, float y, float width, float height,
+		const glm::vec4& texCoords, const glm::vec4& color);
+	// add a quad of the solid cell of the font texture
+	void AddSolidQuad(float x, float y, float width, float height, const glm::vec4& color);
+	// add a line of text - returns its width in pixels
+	float AddText(float x, float y, const char* text, const glm::vec4& color);
+
+	ShaderManager* m_pShaderManager;
+	GpuProgram m_program;
+	GpuVertexArray m_vertexArray;
+	GpuBuffer m_vertexBuffer;
+	GpuTexture m_fontTexture;
+	int m_fontWidth;
+	// ring of the last HISTORY_FRAMES frame times
+	std::vector<double> m_frameTimes;
+	size_t m_nextFrame;
+	// the quads of the frame, kept to reuse their memory
+	std::vector<OverlayVertex> m_vertices;
+};
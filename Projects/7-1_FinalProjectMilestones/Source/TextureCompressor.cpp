@@ -0,0 +1,488 @@
+#include "TextureCompressor.h"
+
+#include <sys/stat.h>
+#include <cstdio>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	// identifies cache files and the layout version they were written with -
+	// bump the version whenever the encoder or the file layout changes
+	const char CACHE_MAGIC[4] = { 'B', 'C', 'T', 'X' };
+	const uint32_t CACHE_VERSION = 1;
+
+	// fixed size header at the start of every cache file, followed by
+	// one (width, height, byte count, blocks) record per mip level
+	struct CacheHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t format;
+		uint32_t mipCount;
+		uint64_t sourceSize;
+		int64_t sourceModifiedTime;
+	};
+
+	// pack an 8 bit per channel color into 5:6:5
+	uint16_t PackColor565(const unsigned char* color)
+	{
+		return (uint16_t)(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+	}
+
+	// expand a 5:6:5 color back to 8 bits per channel
+	void UnpackColor565(uint16_t packed, unsigned char* color)
+	{
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+		color[0] = (unsigned char)((r << 3) | (r >> 2));
+		color[1] = (unsigned char)((g << 2) | (g >> 4));
+		color[2] = (unsigned char)((b << 3) | (b >> 2));
+	}
+
+	int ColorDistance(const unsigned char* a, const unsigned char* b)
+	{
+		int dr = (int)a[0] - (int)b[0];
+		int dg = (int)a[1] - (int)b[1];
+		int db = (int)a[2] - (int)b[2];
+		return dr * dr + dg * dg + db * db;
+	}
+}
+
+/***********************************************************
+ *  CompressImage()
+ *
+ *  Expands the source pixels to RGBA, then encodes the base
+ *  level and every box filtered mip level below it. Images
+ *  with an alpha channel are encoded as BC3, everything else
+ *  as BC1.
+ ***********************************************************/
+bool TextureCompressor::CompressImage(const unsigned char* pixels, int width, int height,
+	int channels, CompressedImage& image)
+{
+	if ((NULL == pixels) || (width <= 0) || (height <= 0) ||
+		((channels != 3) && (channels != 4)))
+	{
+		return false;
+	}
+
+	image.format = (channels == 4) ? BC3 : BC1;
+	image.mips.clear();
+
+	// the encoder and the box filter both work on RGBA
+	std::vector<unsigned char> level((size_t)width * height * 4);
+	for (int i = 0; i < width * height; i++)
+	{
+		level[i * 4 + 0] = pixels[i * channels + 0];
+		level[i * 4 + 1] = pixels[i * channels + 1];
+		level[i * 4 + 2] = pixels[i * channels + 2];
+		level[i * 4 + 3] = (channels == 4) ? pixels[i * channels + 3] : 255;
+	}
+
+	int blockSize = GetBlockSize(image.format);
+	int levelWidth = width;
+	int levelHeight = height;
+
+	while (true)
+	{
+		int blocksWide = (levelWidth + 3) / 4;
+		int blocksHigh = (levelHeight + 3) / 4;
+
+		MipLevel mip;
+		mip.width = levelWidth;
+		mip.height = levelHeight;
+		mip.blocks.resize((size_t)blocksWide * blocksHigh * blockSize);
+
+		for (int by = 0; by < blocksHigh; by++)
+		{
+			for (int bx = 0; bx < blocksWide; bx++)
+			{
+				// gather the 4x4 block, repeating the edge texels for
+				// levels that are not a multiple of 4 in size
+				unsigned char block[64];
+				for (int y = 0; y < 4; y++)
+				{
+					int sourceY = std::min(by * 4 + y, levelHeight - 1);
+					for (int x = 0; x < 4; x++)
+					{
+						int sourceX = std::min(bx * 4 + x, levelWidth - 1);
+						memcpy(&block[(y * 4 + x) * 4], &level[((size_t)sourceY * levelWidth + sourceX) * 4], 4);
+					}
+				}
+
+				unsigned char* output = &mip.blocks[((size_t)by * blocksWide + bx) * blockSize];
+				if (image.format == BC3)
+				{
+					EncodeAlphaBlock(block, output);
+					output += 8;
+				}
+				EncodeColorBlock(block, output);
+			}
+		}
+
+		image.mips.push_back(mip);
+
+		if ((levelWidth == 1) && (levelHeight == 1))
+		{
+			break;
+		}
+
+		std::vector<unsigned char> nextLevel;
+		DownsampleImage(level, levelWidth, levelHeight, nextLevel, levelWidth, levelHeight);
+		level.swap(nextLevel);
+	}
+
+	return true;
+}
+
+/***********************************************************
+ *  EncodeColorBlock()
+ *
+ *  Encodes a BC1 color block. The endpoints come from the
+ *  bounding box of the block colors, inset slightly so the
+ *  two interpolated colors land closer to the actual texels,
+ *  and each texel picks the nearest of the four palette
+ *  colors.
+ ***********************************************************/
+void TextureCompressor::EncodeColorBlock(const unsigned char block[64], unsigned char* output)
+{
+	unsigned char minColor[3] = { 255, 255, 255 };
+	unsigned char maxColor[3] = { 0, 0, 0 };
+
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			minColor[c] = std::min(minColor[c], block[i * 4 + c]);
+			maxColor[c] = std::max(maxColor[c], block[i * 4 + c]);
+		}
+	}
+
+	for (int c = 0; c < 3; c++)
+	{
+		int inset = (maxColor[c] - minColor[c]) >> 4;
+		minColor[c] = (unsigned char)std::min(255, minColor[c] + inset);
+		maxColor[c] = (unsigned char)std::max(0, maxColor[c] - inset);
+	}
+
+	uint16_t color0 = PackColor565(maxColor);
+	uint16_t color1 = PackColor565(minColor);
+
+	uint32_t indices = 0;
+	if (color0 != color1)
+	{
+		// the first endpoint must be the larger one to select the
+		// four color mode instead of the three color + black mode
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+
+		unsigned char palette[4][3];
+		UnpackColor565(color0, palette[0]);
+		UnpackColor565(color1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (unsigned char)((2 * palette[0][c] + palette[1][c]) / 3);
+			palette[3][c] = (unsigned char)((palette[0][c] + 2 * palette[1][c]) / 3);
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int bestIndex = 0;
+			int bestDistance = ColorDistance(&block[i * 4], palette[0]);
+			for (int p = 1; p < 4; p++)
+			{
+				int distance = ColorDistance(&block[i * 4], palette[p]);
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = p;
+				}
+			}
+			indices |= (uint32_t)bestIndex << (i * 2);
+		}
+	}
+
+	output[0] = (unsigned char)(color0 & 0xFF);
+	output[1] = (unsigned char)(color0 >> 8);
+	output[2] = (unsigned char)(color1 & 0xFF);
+	output[3] = (unsigned char)(color1 >> 8);
+	output[4] = (unsigned char)(indices & 0xFF);
+	output[5] = (unsigned char)((indices >> 8) & 0xFF);
+	output[6] = (unsigned char)((indices >> 16) & 0xFF);
+	output[7] = (unsigned char)(indices >> 24);
+}
+
+/***********************************************************
+ *  EncodeAlphaBlock()
+ *
+ *  Encodes a BC3 alpha block using the eight value mode
+ *  between the lowest and highest alpha of the block, with a
+ *  3 bit nearest value index per texel.
+ ***********************************************************/
+void TextureCompressor::EncodeAlphaBlock(const unsigned char block[64], unsigned char* output)
+{
+	int minAlpha = 255;
+	int maxAlpha = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		minAlpha = std::min(minAlpha, (int)block[i * 4 + 3]);
+		maxAlpha = std::max(maxAlpha, (int)block[i * 4 + 3]);
+	}
+
+	output[0] = (unsigned char)maxAlpha;
+	output[1] = (unsigned char)minAlpha;
+
+	uint64_t indices = 0;
+	if (maxAlpha != minAlpha)
+	{
+		int palette[8];
+		palette[0] = maxAlpha;
+		palette[1] = minAlpha;
+		for (int p = 1; p < 7; p++)
+		{
+			palette[p + 1] = ((7 - p) * maxAlpha + p * minAlpha) / 7;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int alpha = block[i * 4 + 3];
+			int bestIndex = 0;
+			int bestDistance = abs(alpha - palette[0]);
+			for (int p = 1; p < 8; p++)
+			{
+				int distance = abs(alpha - palette[p]);
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = p;
+				}
+			}
+			indices |= (uint64_t)bestIndex << (i * 3);
+		}
+	}
+
+	for (int i = 0; i < 6; i++)
+	{
+		output[2 + i] = (unsigned char)((indices >> (i * 8)) & 0xFF);
+	}
+}
+
+/***********************************************************
+ *  DownsampleImage()
+ *
+ *  Halves an RGBA image with a 2x2 box filter. Odd sized
+ *  edges reuse the last row or column.
+ ***********************************************************/
+void TextureCompressor::DownsampleImage(const std::vector<unsigned char>& source, int width, int height,
+	std::vector<unsigned char>& destination, int& newWidth, int& newHeight)
+{
+	int sourceWidth = width;
+	int sourceHeight = height;
+	newWidth = std::max(1, sourceWidth / 2);
+	newHeight = std::max(1, sourceHeight / 2);
+	destination.resize((size_t)newWidth * newHeight * 4);
+
+	for (int y = 0; y < newHeight; y++)
+	{
+		int y0 = std::min(y * 2, sourceHeight - 1);
+		int y1 = std::min(y * 2 + 1, sourceHeight - 1);
+		for (int x = 0; x < newWidth; x++)
+		{
+			int x0 = std::min(x * 2, sourceWidth - 1);
+			int x1 = std::min(x * 2 + 1, sourceWidth - 1);
+			for (int c = 0; c < 4; c++)
+			{
+				int sum = source[((size_t)y0 * sourceWidth + x0) * 4 + c] +
+					source[((size_t)y0 * sourceWidth + x1) * 4 + c] +
+					source[((size_t)y1 * sourceWidth + x0) * 4 + c] +
+					source[((size_t)y1 * sourceWidth + x1) * 4 + c];
+				destination[((size_t)y * newWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GetCachePath()
+ *
+ *  The cache file sits next to the source image with an
+ *  extra extension, e.g. textures/wood.jpg.bctex
+ ***********************************************************/
+std::string TextureCompressor::GetCachePath(const std::string& sourceFile)
+{
+	return sourceFile + ".bctex";
+}
+
+/***********************************************************
+ *  GetSourceStamp()
+ *
+ *  Reads the size and modification time of the source image
+ *  file, which are stored in the cache header.
+ ***********************************************************/
+bool TextureCompressor::GetSourceStamp(const std::string& sourceFile, uint64_t& size, int64_t& modifiedTime)
+{
+	struct stat fileInfo;
+	if (stat(sourceFile.c_str(), &fileInfo) != 0)
+	{
+		return false;
+	}
+
+	size = (uint64_t)fileInfo.st_size;
+	modifiedTime = (int64_t)fileInfo.st_mtime;
+	return true;
+}
+
+/***********************************************************
+ *  ReadCache()
+ *
+ *  Loads the compressed mip chain from the cache file of the
+ *  source image. The cache is rejected when the source image
+ *  changed since the cache was written, and when the levels
+ *  are not the halving chain of a texture the driver can
+ *  create - the loader encodes the image again then.
+ ***********************************************************/
+bool TextureCompressor::ReadCache(const std::string& sourceFile, CompressedImage& image, int maxTextureSize)
+{
+	uint64_t sourceSize = 0;
+	int64_t sourceTime = 0;
+	if (!GetSourceStamp(sourceFile, sourceSize, sourceTime))
+	{
+		return false;
+	}
+
+	std::ifstream file(GetCachePath(sourceFile).c_str(), std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	CacheHeader header;
+	bool bValid = file.read((char*)&header, sizeof(header)) &&
+		(memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0) &&
+		(header.version == CACHE_VERSION) &&
+		((header.format == BC1) || (header.format == BC3)) &&
+		(header.mipCount > 0) && (header.mipCount <= 32) &&
+		(header.sourceSize == sourceSize) &&
+		(header.sourceModifiedTime == sourceTime);
+
+	if (bValid)
+	{
+		image.format = (BlockFormat)header.format;
+		image.mips.resize(header.mipCount);
+
+		int blockSize = GetBlockSize(image.format);
+		for (uint32_t i = 0; (i < header.mipCount) && bValid; i++)
+		{
+			uint32_t levelInfo[3];
+			bValid = !!file.read((char*)levelInfo, sizeof(levelInfo));
+			if (bValid && (i == 0))
+			{
+				// the top level fits the driver and the chain ends at 1x1 -
+				// the size is checked first, so the shifts stay below 32
+				bValid = (levelInfo[0] >= 1) && (levelInfo[1] >= 1) &&
+					(levelInfo[0] <= (uint32_t)maxTextureSize) && (levelInfo[1] <= (uint32_t)maxTextureSize);
+				uint32_t largest = std::max(levelInfo[0], levelInfo[1]);
+				uint32_t chainLength = 1;
+				while (bValid && ((largest >> chainLength) > 0))
+				{
+					chainLength++;
+				}
+				bValid = bValid && (header.mipCount <= chainLength);
+			}
+			else if (bValid)
+			{
+				// every other level halves the one above it
+				bValid = (levelInfo[0] == (uint32_t)std::max(1, image.mips[0].width >> i)) &&
+					(levelInfo[1] == (uint32_t)std::max(1, image.mips[0].height >> i));
+			}
+			if (bValid)
+			{
+				MipLevel& mip = image.mips[i];
+				mip.width = (int)levelInfo[0];
+				mip.height = (int)levelInfo[1];
+				size_t expectedSize = (size_t)((mip.width + 3) / 4) * ((mip.height + 3) / 4) * blockSize;
+				bValid = (levelInfo[2] == expectedSize);
+				if (bValid)
+				{
+					mip.blocks.resize(expectedSize);
+					bValid = !!file.read((char*)&mip.blocks[0], expectedSize);
+				}
+			}
+		}
+	}
+
+	file.close();
+
+	if (!bValid)
+	{
+		image.mips.clear();
+	}
+
+	return bValid;
+}
+
+/***********************************************************
+ *  WriteCache()
+ *
+ *  Writes the compressed mip chain to the cache file of the
+ *  source image, stamped with the source image size and
+ *  modification time. The file is written under a temporary
+ *  name and renamed when complete, so a crash while writing
+ *  never leaves a partial cache behind.
+ ***********************************************************/
+bool TextureCompressor::WriteCache(const std::string& sourceFile, const CompressedImage& image)
+{
+	CacheHeader header;
+	memset(&header, 0, sizeof(header));
+	if (image.mips.empty() ||
+		!GetSourceStamp(sourceFile, header.sourceSize, header.sourceModifiedTime))
+	{
+		return false;
+	}
+
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.format = (uint32_t)image.format;
+	header.mipCount = (uint32_t)image.mips.size();
+
+	std::string cachePath = GetCachePath(sourceFile);
+	std::string temporaryPath = cachePath + ".tmp";
+	std::ofstream file(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	bool bWritten = !!file.write((const char*)&header, sizeof(header));
+	for (size_t i = 0; (i < image.mips.size()) && bWritten; i++)
+	{
+		const MipLevel& mip = image.mips[i];
+		uint32_t levelInfo[3] = { (uint32_t)mip.width, (uint32_t)mip.height, (uint32_t)mip.blocks.size() };
+		bWritten = file.write((const char*)levelInfo, sizeof(levelInfo)) &&
+			file.write((const char*)&mip.blocks[0], mip.blocks.size());
+	}
+
+	file.close();
+	bWritten = bWritten && !file.fail();
+
+	// rename does not replace an existing file on Windows, so the old
+	// cache is removed first when the plain rename fails
+	if (bWritten && (rename(temporaryPath.c_str(), cachePath.c_str()) != 0))
+	{
+		remove(cachePath.c_str());
+		bWritten = (rename(temporaryPath.c_str(), cachePath.c_str()) == 0);
+	}
+
+	// never leave a partly written file behind
+	if (!bWritten)
+	{
+		remove(temporaryPath.c_str());
+	}
+
+	return bWritten;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/***********************************************************
+ *  TextureCompressor
+ *
+ *  Converts decoded images into block compressed textures
+ *  (BC1 for RGB images, BC3 for RGBA images) with a full
+ *  precomputed mipmap chain, and reads and writes them to a
+ *  small cache file stored next to the source image. Once a
+ *  cache file exists the JPG never has to be decoded again.
+ *
+ *  Everything in here is plain CPU code, so it can run on
+ *  the texture loader's worker threads.
+ ***********************************************************/
+class TextureCompressor
+{
+public:
+	// the block compression formats written to the cache
+	enum BlockFormat
+	{
+		BC1 = 1,    // RGB, 8 bytes per 4x4 block
+		BC3 = 3     // RGBA, 16 bytes per 4x4 block
+	};
+
+	// one compressed level of the mipmap chain
+	struct MipLevel
+	{
+		int width;
+		int height;
+		std::vector<unsigned char> blocks;
+	};
+
+	// a compressed texture with its complete mipmap chain
+	struct CompressedImage
+	{
+		BlockFormat format;
+		std::vector<MipLevel> mips;
+	};
+
+	// compress 3 or 4 channel pixels into BC1 or BC3 and build all of
+	// the mipmap levels down to 1x1
+	static bool CompressImage(const unsigned char* pixels, int width, int height,
+		int channels, CompressedImage& image);
+
+	// the cache file used for the passed source image file
+	static std::string GetCachePath(const std::string& sourceFile);
+
+	// read a cache file - fails when the file is missing, was written
+	// for a different version of the source image, or holds a mip
+	// chain that is not a valid texture of at most maxTextureSize texels
+	// on a side
+	static bool ReadCache(const std::string& sourceFile, CompressedImage& image, int maxTextureSize);
+
+	// write a compressed image to the cache file of the source image
+	static bool WriteCache(const std::string& sourceFile, const CompressedImage& image);
+
+	// the number of bytes used by one 4x4 block of the format
+	static int GetBlockSize(BlockFormat format) { return (format == BC1) ? 8 : 16; }
+
+private:
+	// encode one 4x4 RGBA block as a BC1 color block
+	static void EncodeColorBlock(const unsigned char block[64], unsigned char* output);
+	// encode the alpha of one 4x4 RGBA block as a BC3 alpha block
+	static void EncodeAlphaBlock(const unsigned char block[64], unsigned char* output);
+	// halve an RGBA image with a 2x2 box filter
+	static void DownsampleImage(const std::vector<unsigned char>& source, int width, int height,
+		std::vector<unsigned char>& destination, int& newWidth, int& newHeight);
+	// size and modification time of the source file, used to detect stale caches
+	static bool GetSourceStamp(const std::string& sourceFile, uint64_t& size, int64_t& modifiedTime);
+};
@@ -0,0 +1,244 @@
+#include "TextureLoader.h"
+#include "TraceZones.h"
+
+// the stb_image implementation is compiled in SceneManager.cpp
+#include "stb_image.h"
+
+#include <algorithm>
+
+namespace
+{
+	// never spin up more decode threads than there are textures worth
+	// decoding in parallel - the scene only loads around a dozen images
+	const int MAX_DECODE_THREADS = 4;
+
+	// the texture size every 4.1 and later driver supports, used
+	// until SetMaxTextureSize() passes the real limit
+	const int DEFAULT_MAX_TEXTURE_SIZE = 16384;
+}
+
+/***********************************************************
+ *  TextureLoader()
+ *
+ *  Starts the worker threads. When threadCount is 0 the
+ *  count is picked from the available hardware threads,
+ *  leaving one free for the main render thread.
+ ***********************************************************/
+TextureLoader::TextureLoader(int threadCount)
+{
+	m_pendingCount = 0;
+	m_bShutdown = false;
+	m_bCompress = false;
+	m_maxTextureSize = DEFAULT_MAX_TEXTURE_SIZE;
+
+	if (threadCount <= 0)
+	{
+		int hardwareThreads = (int)std::thread::hardware_concurrency();
+		threadCount = std::max(1, std::min(hardwareThreads - 1, MAX_DECODE_THREADS));
+	}
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		m_workers.push_back(std::thread(&TextureLoader::WorkerThread, this));
+	}
+}
+
+/***********************************************************
+ *  ~TextureLoader()
+ *
+ *  Signals the worker threads to stop, waits for them and
+ *  frees any decoded images that were never collected.
+ ***********************************************************/
+TextureLoader::~TextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bShutdown = true;
+		m_requests.clear();
+	}
+	m_condition.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+
+	for (size_t i = 0; i < m_decodedImages.size(); i++)
+	{
+		FreeImage(m_decodedImages[i]);
+	}
+}
+
+/***********************************************************
+ *  SetCompressionEnabled()
+ *
+ *  Turns block compression of the decoded images on or off
+ *  for every image queued from now on.
+ ***********************************************************/
+void TextureLoader::SetCompressionEnabled(bool bEnabled)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_bCompress = bEnabled;
+}
+
+/***********************************************************
+ *  SetMaxTextureSize()
+ *
+ *  Sets the largest texture side the cache files may hold -
+ *  the workers have no context to query it themselves.
+ ***********************************************************/
+void TextureLoader::SetMaxTextureSize(int size)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_maxTextureSize = size;
+}
+
+/***********************************************************
+ *  QueueImage()
+ *
+ *  Adds an image file to the decode queue. The decoded
+ *  result is returned later from CollectDecodedImages().
+ ***********************************************************/
+void TextureLoader::QueueImage(const char* filename, int slot)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		ImageRequest request;
+		request.filename = filename;
+		request.slot = slot;
+		request.bCompress = m_bCompress;
+		request.maxTextureSize = m_maxTextureSize;
+		m_requests.push_back(request);
+		m_pendingCount++;
+	}
+	m_condition.notify_one();
+}
+
+/***********************************************************
+ *  CollectDecodedImages()
+ *
+ *  Moves all images decoded so far into the passed list.
+ *  The caller takes ownership of the pixel memory and must
+ *  release it with FreeImage().
+ ***********************************************************/
+int TextureLoader::CollectDecodedImages(std::vector<DecodedImage>& images)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	int count = (int)m_decodedImages.size();
+	images.insert(images.end(), m_decodedImages.begin(), m_decodedImages.end());
+	m_decodedImages.clear();
+	m_pendingCount -= count;
+
+	return(count);
+}
+
+/***********************************************************
+ *  GetPendingCount()
+ *
+ *  Returns the number of queued images not yet collected.
+ ***********************************************************/
+int TextureLoader::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return(m_pendingCount);
+}
+
+/***********************************************************
+ *  FreeImage()
+ *
+ *  Releases the pixel memory and the compressed mip levels
+ *  held by a decoded image.
+ ***********************************************************/
+void TextureLoader::FreeImage(DecodedImage& image)
+{
+	if (NULL != image.pixels)
+	{
+		stbi_image_free(image.pixels);
+		image.pixels = NULL;
+	}
+	delete image.compressed;
+	image.compressed = NULL;
+}
+
+/***********************************************************
+ *  WorkerThread()
+ *
+ *  Runs on each worker thread. Waits for requests, decodes
+ *  the image file and pushes the result to the decoded list.
+ *  Compressed requests are served from the cache file when
+ *  it is current, otherwise the decoded image is encoded
+ *  and the cache file is written for the next run.
+ ***********************************************************/
+void TextureLoader::WorkerThread()
+{
+	// the flip flag is stored per thread, so each worker sets its own
+	stbi_set_flip_vertically_on_load_thread(true);
+	TraceZones::SetThreadName("Texture decode");
+
+	while (true)
+	{
+		ImageRequest request;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_bShutdown || !m_requests.empty(); });
+			if (m_bShutdown)
+			{
+				return;
+			}
+			request = m_requests.front();
+			m_requests.pop_front();
+		}
+		TRACE_ZONE_DETAIL("DecodeImage", request.filename.c_str());
+
+		DecodedImage image;
+		image.filename = request.filename;
+		image.slot = request.slot;
+		image.width = 0;
+		image.height = 0;
+		image.channels = 0;
+		image.pixels = NULL;
+		image.compressed = NULL;
+
+		if (request.bCompress)
+		{
+			image.compressed = new TextureCompressor::CompressedImage();
+			if (TextureCompressor::ReadCache(request.filename, *image.compressed, request.maxTextureSize))
+			{
+				image.width = image.compressed->mips[0].width;
+				image.height = image.compressed->mips[0].height;
+				image.channels = (image.compressed->format == TextureCompressor::BC3) ? 4 : 3;
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_decodedImages.push_back(image);
+				continue;
+			}
+		}
+
+		image.pixels = stbi_load(
+			request.filename.c_str(),
+			&image.width,
+			&image.height,
+			&image.channels,
+			0);
+
+		if (NULL != image.compressed)
+		{
+			if ((NULL != image.pixels) &&
+				TextureCompressor::CompressImage(image.pixels, image.width, image.height, image.channels, *image.compressed))
+			{
+				TextureCompressor::WriteCache(request.filename, *image.compressed);
+				// the uncompressed pixels are not needed anymore
+				stbi_image_free(image.pixels);
+				image.pixels = NULL;
+			}
+			else
+			{
+				delete image.compressed;
+				image.compressed = NULL;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_decodedImages.push_back(image);
+	}
+}
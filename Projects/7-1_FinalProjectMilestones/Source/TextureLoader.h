@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "TextureCompressor.h"
+
+/***********************************************************
+ *  TextureLoader
+ *
+ *  Decodes texture image files on a small pool of worker
+ *  threads so the main thread never blocks on stbi_load.
+ *  Only the decoding happens off the main thread - the
+ *  decoded pixels are handed back to the SceneManager, which
+ *  uploads them to OpenGL since GL calls must stay on the
+ *  thread that owns the context.
+ *
+ *  With compression enabled the workers also encode each
+ *  image into BC1/BC3 mip levels, and read those straight
+ *  from the cache file on later runs instead of decoding.
+ ***********************************************************/
+class TextureLoader
+{
+public:
+	// a fully decoded image waiting to be uploaded to the GPU
+	struct DecodedImage
+	{
+		std::string filename;   // file the image was read from
+		int slot;               // texture slot the image was requested for
+		int width;
+		int height;
+		int channels;
+		unsigned char* pixels;  // NULL when the image could not be read
+		// block compressed mip chain, NULL unless compression is enabled
+		TextureCompressor::CompressedImage* compressed;
+	};
+
+	// constructor - threadCount of 0 picks a count from the hardware
+	TextureLoader(int threadCount = 0);
+	// destructor - stops and joins the worker threads
+	~TextureLoader();
+
+	// enable encoding images into block compressed mip chains -
+	// only affects images queued after the call
+	void SetCompressionEnabled(bool bEnabled);
+	// the largest texture side the driver supports - cache files of
+	// larger textures are encoded again, only affects images queued
+	// after the call
+	void SetMaxTextureSize(int size);
+
+	// queue an image file to be decoded for the given texture slot
+	void QueueImage(const char* filename, int slot);
+
+	// move every image decoded since the last call into the passed
+	// list, returns the number of images that were added
+	int CollectDecodedImages(std::vector<DecodedImage>& images);
+
+	// number of queued images that have not been collected yet
+	int GetPendingCount();
+
+	// free the pixel memory and compressed levels of a decoded image
+	static void FreeImage(DecodedImage& image);
+
+private:
+	struct ImageRequest
+	{
+		std::string filename;
+		int slot;
+		bool bCompress;
+		int maxTextureSize;
+	};
+
+	// worker thread loop - pops requests and decodes them
+	void WorkerThread();
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<ImageRequest> m_requests;
+	std::vector<DecodedImage> m_decodedImages;
+	int m_pendingCount;
+	bool m_bShutdown;
+	bool m_bCompress;
+	int m_maxTextureSize;
+};
@@ -0,0 +1,232 @@
+#include "TransparencyPass.h"
+#include "RenderStats.h"
+
+#include <iostream>
+
+namespace
+{
+	const char* g_CompositeVertexShader = "shaders/compositeVertexShader.glsl";
+	const char* g_CompositeFragmentShader = "shaders/compositeFragmentShader.glsl";
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  The accumulation target adds up its inputs while the
+ *  revealage target multiplies them, so each draw buffer
+ *  needs its own blend function.
+ ***********************************************************/
+bool TransparencyPass::IsSupported()
+{
+	return (GLEW_VERSION_4_0 != 0);
+}
+
+/***********************************************************
+ *  TransparencyPass()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransparencyPass::TransparencyPass()
+{
+	m_pShaderManager = NULL;
+	m_framebuffer = 0;
+	m_width = 0;
+	m_height = 0;
+	m_previousFramebuffer = 0;
+	m_bBlendEnabled = false;
+	for (int i = 0; i < 4; i++)
+	{
+		m_previousViewport[i] = 0;
+		m_previousBlend[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~TransparencyPass()
+ *
+ *  The destructor frees the framebuffer - the targets and
+ *  the program are freed by their handles.
+ ***********************************************************/
+TransparencyPass::~TransparencyPass()
+{
+	if (NULL != m_pShaderManager)
+	{
+		delete m_pShaderManager;
+		m_pShaderManager = NULL;
+	}
+	if (0 != m_framebuffer)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  Loads the composite program and points its samplers at
+ *  the target texture units. The targets are created by the
+ *  first translucent pass, once the viewport size is known.
+ ***********************************************************/
+bool TransparencyPass::Initialize()
+{
+	if (IsSupported() == false)
+	{
+		std::cout << "Per draw buffer blending is not supported by this OpenGL context" << std::endl;
+		return false;
+	}
+
+	m_pShaderManager = new ShaderManager();
+	m_program.Adopt(m_pShaderManager->LoadShaders(g_CompositeVertexShader, g_CompositeFragmentShader));
+	if (0 == m_program)
+	{
+		return false;
+	}
+	m_program.SetLabel("Transparency composite");
+	m_pShaderManager->use();
+	m_pShaderManager->setSampler2DValue("accumulationTexture", ACCUMULATION_TEXTURE_UNIT);
+	m_pShaderManager->setSampler2DValue("revealageTexture", REVEALAGE_TEXTURE_UNIT);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	m_emptyVertexArray.Create();
+	glBindVertexArray(m_emptyVertexArray);
+	m_emptyVertexArray.SetLabel("Transparency composite");
+	glBindVertexArray(0);
+
+	return true;
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  Creates the targets at the viewport size. The weighted
+ *  colors need a float target, the revealage only one
+ *  channel, and the depth copy keeps the translucent draws
+ *  behind the opaque ones.
+ ***********************************************************/
+void TransparencyPass::Resize(int width, int height)
+{
+	if ((width == m_width) && (height == m_height))
+	{
+		return;
+	}
+
+	m_width = width;
+	m_height = height;
+
+	const GLenum formats[3] = { GL_RGBA16F, GL_R16F, GL_DEPTH_COMPONENT32F };
+	GpuTexture* pTextures[3] = { &m_accumulationTexture, &m_revealageTexture, &m_depthTexture };
+	// created on a target unit, so the scene textures stay bound -
+	// creating a texture frees the one of the previous size
+	const char* const labels[3] = { "Transparency accumulation", "Transparency revealage", "Transparency depth" };
+	glActiveTexture(GL_TEXTURE0 + ACCUMULATION_TEXTURE_UNIT);
+	for (int i = 0; i < 3; i++)
+	{
+		pTextures[i]->Create();
+		glBindTexture(GL_TEXTURE_2D, *pTextures[i]);
+		pTextures[i]->SetLabel(labels[i]);
+		glTexStorage2D(GL_TEXTURE_2D, 1, formats[i], width, height);
+		pTextures[i]->SetBytes(GpuResources::TextureBytes(formats[i], width, height));
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_accumulationTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_revealageTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+	const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Transparency framebuffer is incomplete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, m_previousFramebuffer);
+}
+
+/***********************************************************
+ *  BeginTranslucentPass()
+ *
+ *  Remembers the framebuffer, viewport and blending of the
+ *  scene, copies its depth into the depth target and binds
+ *  the targets. The accumulation target adds the weighted
+ *  colors and the revealage target multiplies by one minus
+ *  the coverage of every fragment. Depth writes are off, so
+ *  no translucent draw hides another.
+ ***********************************************************/
+void TransparencyPass::BeginTranslucentPass()
+{
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+	m_bBlendEnabled = (glIsEnabled(GL_BLEND) == GL_TRUE);
+	glGetIntegerv(GL_BLEND_SRC_RGB, &m_previousBlend[0]);
+	glGetIntegerv(GL_BLEND_DST_RGB, &m_previousBlend[1]);
+	glGetIntegerv(GL_BLEND_SRC_ALPHA, &m_previousBlend[2]);
+	glGetIntegerv(GL_BLEND_DST_ALPHA, &m_previousBlend[3]);
+
+	Resize(m_previousViewport[2], m_previousViewport[3]);
+
+	// the opaque depth of the scene, read from its framebuffer
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_previousFramebuffer);
+	glActiveTexture(GL_TEXTURE0 + ACCUMULATION_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_depthTexture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_previousViewport[0], m_previousViewport[1], m_width, m_height);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, m_width, m_height);
+	const GLfloat clearAccumulation[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const GLfloat clearRevealage[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+	glClearBufferfv(GL_COLOR, 0, clearAccumulation);
+	glClearBufferfv(GL_COLOR, 1, clearRevealage);
+
+	glDepthMask(GL_FALSE);
+	glEnable(GL_BLEND);
+	glBlendFunci(0, GL_ONE, GL_ONE);
+	glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+}
+
+/***********************************************************
+ *  EndTranslucentPass()
+ *
+ *  Switches back to the scene framebuffer and draws one
+ *  screen covering triangle with the composite program,
+ *  blended by the total coverage of every pixel. Leaves the
+ *  composite program active.
+ ***********************************************************/
+void TransparencyPass::EndTranslucentPass()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_previousFramebuffer);
+	glViewport(m_previousViewport[0], m_previousViewport[1], m_previousViewport[2], m_previousViewport[3]);
+
+	m_pShaderManager->use();
+	glActiveTexture(GL_TEXTURE0 + ACCUMULATION_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_accumulationTexture);
+	glActiveTexture(GL_TEXTURE0 + REVEALAGE_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_revealageTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDepthFunc(GL_ALWAYS);
+	glBindVertexArray(m_emptyVertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+
+	// the opaque depth copy and the two composite inputs
+	RenderStats& stats = RenderStats::Frame();
+	stats.textureBinds += 3;
+	stats.vertexArrayBinds++;
+	stats.drawCalls++;
+	stats.triangles++;
+
+	glBlendFuncSeparate(m_previousBlend[0], m_previousBlend[1], m_previousBlend[2], m_previousBlend[3]);
+	if (m_bBlendEnabled == false)
+	{
+		glDisable(GL_BLEND);
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "GpuResources.h"
+#include "ShaderManager.h"
+
+/***********************************************************
+ *  TransparencyPass
+ *
+ *  Weighted blended order-independent transparency. The
+ *  translucent draws are not sorted - they add a depth
+ *  weighted, premultiplied color into an accumulation
+ *  target and multiply their coverage into a revealage
+ *  target, depth tested against a copy of the opaque depth.
+ *  A screen covering triangle then blends the weighted
+ *  average color over the scene by the total coverage. The
+ *  renderers draw the translucent draws with bWeightedBlend
+ *  set in between, see transparency.glsl.
+ ***********************************************************/
+class TransparencyPass
+{
+public:
+	// texture units of the targets in the composite program - above
+	// the lightmap
+	static const GLuint ACCUMULATION_TEXTURE_UNIT = 23;
+	static const GLuint REVEALAGE_TEXTURE_UNIT = 24;
+
+	// the two targets need their own blend functions, which are
+	// core from OpenGL 4.0
+	static bool IsSupported();
+
+	// constructor
+	TransparencyPass();
+	// destructor - frees the framebuffer, the handles free the targets
+	// and the program
+	~TransparencyPass();
+
+	// load the composite program
+	bool Initialize();
+
+	// copy the opaque depth, then bind and clear the targets, sized to
+	// the current viewport, and switch to the weighted blending
+	void BeginTranslucentPass();
+	// switch back to the framebuffer of the scene and blend the
+	// average translucent color over it - the blending and depth
+	// state are restored
+	void EndTranslucentPass();
+
+private:
+	// recreate the targets when the viewport size changes
+	void Resize(int width, int height);
+
+	ShaderManager* m_pShaderManager;
+	GpuProgram m_program;
+	GLuint m_framebuffer;
+	GpuTexture m_accumulationTexture;
+	GpuTexture m_revealageTexture;
+	GpuTexture m_depthTexture;
+	// the composite pass draws without vertex buffers
+	GpuVertexArray m_emptyVertexArray;
+	int m_width;
+	int m_height;
+	GLint m_previousFramebuffer;
+	GLint m_previousViewport[4];
+	bool m_bBlendEnabled;
+	GLint m_previousBlend[4];
+};
@@ -8,6 +8,8 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "ViewManager.h"
+#include "CameraPresets.h"
+#include "TraceZones.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
@@ -52,6 +54,13 @@ ViewManager::ViewManager(
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
 	m_pWindow = NULL;
+	m_pRenderSettings = NULL;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_bRecordingCamera = false;
+	m_recordStartTime = 0.0;
+	m_bPlayingCamera = false;
+	m_playbackFrame = 0;
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(-3.31f, 8.94f, 7.42f);
@@ -89,6 +98,7 @@ ViewManager::~ViewManager()
  ***********************************************************/
 GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 {
+	TRACE_ZONE("CreateDisplayWindow");
 	GLFWwindow* window = nullptr;
 
 	// try to create the displayed OpenGL window
@@ -200,6 +210,14 @@ void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, doub
  *    P          - cycle through perspective presets (4 views)
  *    O          - cycle through orthographic presets (5 views)
  *
+ *  Render Options:
+ *    F2         - switch between the immediate and indirect draw paths
+ *    F3         - toggle frustum culling
+ *    F4         - toggle occlusion culling (indirect path)
+ *    F5         - toggle the depth pre-pass
+ *    F6         - toggle clustered lighting (indirect path)
+ *    F7         - toggle deferred shading (indirect path)
+ *
  *    ESC        - close the window
  ***********************************************************/
 void ViewManager::ProcessKeyboardEvents()
@@ -208,6 +226,19 @@ void ViewManager::ProcessKeyboardEvents()
 	// holding the key from firing multiple times per press
 	static bool pWasPressed = false;
 	static bool oWasPressed = false;
+	static bool f2WasPressed = false;
+	static bool f3WasPressed = false;
+	static bool f4WasPressed = false;
+	static bool f5WasPressed = false;
+	static bool f6WasPressed = false;
+	static bool f7WasPressed = false;
+	static bool f8WasPressed = false;
+	static bool f9WasPressed = false;
+	static bool f10WasPressed = false;
+	static bool f11WasPressed = false;
+	static bool f12WasPressed = false;
+	static bool tWasPressed = false;
+	static bool f1WasPressed = false;
 
 	// track which preset index we are on for each cycle group
 	static int perspIndex = 0;
@@ -275,130 +306,265 @@ void ViewManager::ProcessKeyboardEvents()
 		g_pCamera->ProcessMouseMovement(0.0f, -50.0f);
 	}
 
-	// helper lambda to set camera position, front vector, up vector,
-	// and recalculate pitch/yaw so free-look stays consistent after
-	// snapping to a preset view
-	auto SetCameraView = [](glm::vec3 position, glm::vec3 front, glm::vec3 up) {
-		g_pCamera->Position = position;
-		g_pCamera->Front = front;
-		g_pCamera->Up = up;
-		glm::vec3 f = glm::normalize(front);
+	// helper lambda to snap the camera to a preset view, and
+	// recalculate pitch/yaw so free-look stays consistent after
+	// snapping to it - the perspective presets reset the zoom
+	auto SetCameraPreset = [](int presetIndex) {
+		const CameraPreset& preset = g_CameraPresets[presetIndex];
+		bOrthographicProjection = preset.bOrthographic;
+		g_pCamera->Position = preset.position;
+		g_pCamera->Front = preset.front;
+		g_pCamera->Up = preset.up;
+		glm::vec3 f = glm::normalize(preset.front);
 		g_pCamera->Pitch = glm::degrees(asin(f.y));
 		g_pCamera->Yaw = glm::degrees(atan2(f.z, f.x));
+		if (preset.bOrthographic == false)
+		{
+			g_pCamera->Zoom = CAMERA_PRESET_ZOOM;
+		}
 		};
 
-	// 1 - orthographic front view, looking straight down the -Z axis
-	if (glfwGetKey(m_pWindow, GLFW_KEY_1) == GLFW_PRESS)
+	// 1 to 9 - the preset views, see CameraPresets.h - 1 to 5 are
+	// orthographic, 6 to 9 perspective
+	for (int i = 0; i < CAMERA_PRESET_COUNT; i++)
 	{
-		bOrthographicProjection = true;
-		SetCameraView(glm::vec3(0.0f, 7.0f, 10.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		if (glfwGetKey(m_pWindow, GLFW_KEY_1 + i) == GLFW_PRESS)
+		{
+			SetCameraPreset(i);
+		}
 	}
-	// 2 - orthographic left side view, looking in the +X direction
-	if (glfwGetKey(m_pWindow, GLFW_KEY_2) == GLFW_PRESS)
+
+	// P - cycle forward through the 4 perspective preset views one press at a time
+	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
 	{
-		bOrthographicProjection = true;
-		SetCameraView(glm::vec3(-10.0f, 7.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		if (!pWasPressed)
+		{
+			// front, front-left, front-right, back
+			perspIndex = (perspIndex + 1) % 4;
+			SetCameraPreset(5 + perspIndex);
+
+			pWasPressed = true;
+		}
 	}
-	// 3 - orthographic back view, looking in the +Z direction
-	if (glfwGetKey(m_pWindow, GLFW_KEY_3) == GLFW_PRESS)
+	else if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_RELEASE)
 	{
-		bOrthographicProjection = true;
-		SetCameraView(glm::vec3(0.0f, 7.0f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		// reset flag when key is released so next press registers as a new event
+		pWasPressed = false;
 	}
-	// 4 - orthographic right side view, looking in the -X direction
-	if (glfwGetKey(m_pWindow, GLFW_KEY_4) == GLFW_PRESS)
+
+	// O - cycle forward through the 5 orthographic preset views one press at a time
+	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
 	{
-		bOrthographicProjection = true;
-		SetCameraView(glm::vec3(10.0f, 7.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		if (!oWasPressed)
+		{
+			// front, left side, back, top, right side
+			const int orthoPresets[5] = { 0, 1, 2, 4, 3 };
+			orthoIndex = (orthoIndex + 1) % 5;
+			SetCameraPreset(orthoPresets[orthoIndex]);
+
+			oWasPressed = true;
+		}
 	}
-	// 5 - orthographic top view, looking straight down the -Y axis
-	if (glfwGetKey(m_pWindow, GLFW_KEY_5) == GLFW_PRESS)
+	else if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_RELEASE)
 	{
-		bOrthographicProjection = true;
-		SetCameraView(glm::vec3(0.0f, 15.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f));
+		// reset flag when key is released so next press registers as a new event
+		oWasPressed = false;
 	}
-	// 6 - perspective view from the front at a slight downward angle
-	if (glfwGetKey(m_pWindow, GLFW_KEY_6) == GLFW_PRESS)
+
+	// F2 - switch the scene between the immediate and indirect draw paths
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F2) == GLFW_PRESS)
 	{
-		bOrthographicProjection = false;
-		SetCameraView(glm::vec3(0.0f, 8.5f, 8.0f), glm::vec3(0.0f, -1.0f, -2.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		g_pCamera->Zoom = 80;
+		if (!f2WasPressed && (NULL != m_pRenderSettings))
+		{
+			m_pRenderSettings->bIndirectDraw = !m_pRenderSettings->bIndirectDraw;
+			std::cout << "Draw path: " << (m_pRenderSettings->bIndirectDraw ? "indirect" : "immediate") << std::endl;
+		}
+		f2WasPressed = true;
 	}
-	// 7 - perspective view from the front-left diagonal
-	if (glfwGetKey(m_pWindow, GLFW_KEY_7) == GLFW_PRESS)
+	else
 	{
-		bOrthographicProjection = false;
-		SetCameraView(glm::vec3(-6.0f, 8.5f, 6.0f), glm::vec3(0.6f, -0.6f, -0.6f), glm::vec3(0.0f, 1.0f, 0.0f));
-		g_pCamera->Zoom = 80;
+		f2WasPressed = false;
 	}
-	// 8 - perspective view from the front-right diagonal
-	if (glfwGetKey(m_pWindow, GLFW_KEY_8) == GLFW_PRESS)
+
+	// F3 - toggle frustum culling of the recorded draws
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F3) == GLFW_PRESS)
 	{
-		bOrthographicProjection = false;
-		SetCameraView(glm::vec3(6.0f, 8.5f, 6.0f), glm::vec3(-0.6f, -0.6f, -0.6f), glm::vec3(0.0f, 1.0f, 0.0f));
-		g_pCamera->Zoom = 80;
+		if (!f3WasPressed && (NULL != m_pRenderSettings))
+		{
+			m_pRenderSettings->bFrustumCulling = !m_pRenderSettings->bFrustumCulling;
+			std::cout << "Frustum culling: " << (m_pRenderSettings->bFrustumCulling ? "on" : "off") << std::endl;
+		}
+		f3WasPressed = true;
 	}
-	// 9 - perspective view from behind the scene
-	if (glfwGetKey(m_pWindow, GLFW_KEY_9) == GLFW_PRESS)
+	else
 	{
-		bOrthographicProjection = false;
-		SetCameraView(glm::vec3(0.0f, 8.5f, -8.0f), glm::vec3(0.0f, -0.5f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		g_pCamera->Zoom = 80;
+		f3WasPressed = false;
 	}
 
-	// P - cycle forward through the 4 perspective preset views one press at a time
-	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
+	// F4 - toggle occlusion culling of the recorded draws
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F4) == GLFW_PRESS)
 	{
-		if (!pWasPressed)
+		if (!f4WasPressed && (NULL != m_pRenderSettings))
 		{
-			bOrthographicProjection = false;
-			perspIndex = (perspIndex + 1) % 4;
+			m_pRenderSettings->bOcclusionCulling = !m_pRenderSettings->bOcclusionCulling;
+			std::cout << "Occlusion culling: " << (m_pRenderSettings->bOcclusionCulling ? "on" : "off") << std::endl;
+		}
+		f4WasPressed = true;
+	}
+	else
+	{
+		f4WasPressed = false;
+	}
 
-			if (perspIndex == 0)      // front
-				SetCameraView(glm::vec3(0.0f, 8.5f, 8.0f), glm::vec3(0.0f, -1.0f, -2.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-			else if (perspIndex == 1) // front-left
-				SetCameraView(glm::vec3(-6.0f, 8.5f, 6.0f), glm::vec3(0.6f, -0.6f, -0.6f), glm::vec3(0.0f, 1.0f, 0.0f));
-			else if (perspIndex == 2) // front-right
-				SetCameraView(glm::vec3(6.0f, 8.5f, 6.0f), glm::vec3(-0.6f, -0.6f, -0.6f), glm::vec3(0.0f, 1.0f, 0.0f));
-			else if (perspIndex == 3) // back
-				SetCameraView(glm::vec3(0.0f, 8.5f, -8.0f), glm::vec3(0.0f, -0.5f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	// F5 - toggle the depth pre-pass
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F5) == GLFW_PRESS)
+	{
+		if (!f5WasPressed && (NULL != m_pRenderSettings))
+		{
+			m_pRenderSettings->bDepthPrepass = !m_pRenderSettings->bDepthPrepass;
+			std::cout << "Depth pre-pass: " << (m_pRenderSettings->bDepthPrepass ? "on" : "off") << std::endl;
+		}
+		f5WasPressed = true;
+	}
+	else
+	{
+		f5WasPressed = false;
+	}
 
-			g_pCamera->Zoom = 80;
-			pWasPressed = true;
+	// F6 - toggle the clustered lighting
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F6) == GLFW_PRESS)
+	{
+		if (!f6WasPressed && (NULL != m_pRenderSettings))
+		{
+			m_pRenderSettings->bClusteredLighting = !m_pRenderSettings->bClusteredLighting;
+			std::cout << "Clustered lighting: " << (m_pRenderSettings->bClusteredLighting ? "on" : "off") << std::endl;
 		}
+		f6WasPressed = true;
 	}
-	else if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_RELEASE)
+	else
 	{
-		// reset flag when key is released so next press registers as a new event
-		pWasPressed = false;
+		f6WasPressed = false;
 	}
 
-	// O - cycle forward through the 5 orthographic preset views one press at a time
-	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
+	// F7 - switch between forward and deferred shading
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F7) == GLFW_PRESS)
 	{
-		if (!oWasPressed)
+		if (!f7WasPressed && (NULL != m_pRenderSettings))
 		{
-			bOrthographicProjection = true;
-			orthoIndex = (orthoIndex + 1) % 5;
+			m_pRenderSettings->bDeferredShading = !m_pRenderSettings->bDeferredShading;
+			std::cout << "Deferred shading: " << (m_pRenderSettings->bDeferredShading ? "on" : "off") << std::endl;
+		}
+		f7WasPressed = true;
+	}
+	else
+	{
+		f7WasPressed = false;
+	}
 
-			if (orthoIndex == 0)      // front
-				SetCameraView(glm::vec3(0.0f, 7.0f, 10.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-			else if (orthoIndex == 1) // left side
-				SetCameraView(glm::vec3(-10.0f, 7.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-			else if (orthoIndex == 2) // back
-				SetCameraView(glm::vec3(0.0f, 7.0f, -10.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-			else if (orthoIndex == 3) // top
-				SetCameraView(glm::vec3(0.0f, 15.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f));
-			else if (orthoIndex == 4) // right side
-				SetCameraView(glm::vec3(10.0f, 7.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	// F8 - limit the forward lights to the per-draw light lists
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F8) == GLFW_PRESS)
+	{
+		if (!f8WasPressed && (NULL != m_pRenderSettings))
+		{
+			m_pRenderSettings->bLightLists = !m_pRenderSettings->bLightLists;
+			std::cout << "Per-draw light lists: " << (m_pRenderSettings->bLightLists ? "on" : "off") << std::endl;
+		}
+		f8WasPressed = true;
+	}
+	else
+	{
+		f8WasPressed = false;
+	}
 
-			oWasPressed = true;
+	// F9 - toggle the cached shadow maps
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F9) == GLFW_PRESS)
+	{
+		if (!f9WasPressed && (NULL != m_pRenderSettings))
+		{
+			m_pRenderSettings->bShadows = !m_pRenderSettings->bShadows;
+			std::cout << "Shadows: " << (m_pRenderSettings->bShadows ? "on" : "off") << std::endl;
 		}
+		f9WasPressed = true;
 	}
-	else if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_RELEASE)
+	else
 	{
-		// reset flag when key is released so next press registers as a new event
-		oWasPressed = false;
+		f9WasPressed = false;
+	}
+
+	// F10 - draw the static draws with the baked lightmap
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F10) == GLFW_PRESS)
+	{
+		if (!f10WasPressed && (NULL != m_pRenderSettings))
+		{
+			m_pRenderSettings->bBakedLighting = !m_pRenderSettings->bBakedLighting;
+			std::cout << "Baked lighting: " << (m_pRenderSettings->bBakedLighting ? "on" : "off") << std::endl;
+		}
+		f10WasPressed = true;
+	}
+	else
+	{
+		f10WasPressed = false;
+	}
+
+	// F11 - draw the translucent draws with weighted blended transparency
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F11) == GLFW_PRESS)
+	{
+		if (!f11WasPressed && (NULL != m_pRenderSettings))
+		{
+			m_pRenderSettings->bOrderIndependentTransparency = !m_pRenderSettings->bOrderIndependentTransparency;
+			std::cout << "Order-independent transparency: "
+				<< (m_pRenderSettings->bOrderIndependentTransparency ? "on" : "off") << std::endl;
+		}
+		f11WasPressed = true;
+	}
+	else
+	{
+		f11WasPressed = false;
+	}
+
+	// F12 - draw the opaque spheres as ray-cast impostors
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F12) == GLFW_PRESS)
+	{
+		if (!f12WasPressed && (NULL != m_pRenderSettings))
+		{
+			m_pRenderSettings->bSphereImpostors = !m_pRenderSettings->bSphereImpostors;
+			std::cout << "Sphere impostors: " << (m_pRenderSettings->bSphereImpostors ? "on" : "off") << std::endl;
+		}
+		f12WasPressed = true;
+	}
+	else
+	{
+		f12WasPressed = false;
+	}
+
+	// T - time the render passes and scene objects on the GPU
+	if (glfwGetKey(m_pWindow, GLFW_KEY_T) == GLFW_PRESS)
+	{
+		if (!tWasPressed && (NULL != m_pRenderSettings))
+		{
+			m_pRenderSettings->bGpuTimers = !m_pRenderSettings->bGpuTimers;
+			std::cout << "GPU timers: " << (m_pRenderSettings->bGpuTimers ? "on" : "off") << std::endl;
+		}
+		tWasPressed = true;
+	}
+	else
+	{
+		tWasPressed = false;
+	}
+
+	// F1 - show the GL call counters and frame times over the scene
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F1) == GLFW_PRESS)
+	{
+		if (!f1WasPressed && (NULL != m_pRenderSettings))
+		{
+			m_pRenderSettings->bStatsOverlay = !m_pRenderSettings->bStatsOverlay;
+			std::cout << "Stats overlay: " << (m_pRenderSettings->bStatsOverlay ? "on" : "off") << std::endl;
+		}
+		f1WasPressed = true;
+	}
+	else
+	{
+		f1WasPressed = false;
 	}
 }
 
@@ -411,6 +577,7 @@ void ViewManager::ProcessKeyboardEvents()
  ***********************************************************/
 void ViewManager::PrepareSceneView()
 {
+	TRACE_ZONE("PrepareSceneView");
 	glm::mat4 view;
 	glm::mat4 projection;
 
@@ -423,14 +590,33 @@ void ViewManager::PrepareSceneView()
 	// event queue
 	ProcessKeyboardEvents();
 
+	// a played path overrides whatever the input did to the camera,
+	// and holds the last frame once it is finished
+	if (m_bPlayingCamera == true)
+	{
+		CameraPath::Key key = m_playbackPath.GetFrameKey(m_playbackFrame);
+		CameraPath::ApplyKey(key, *g_pCamera);
+		bOrthographicProjection = key.bOrthographic;
+		if (m_playbackFrame < m_playbackPath.GetFrameCount())
+		{
+			m_playbackFrame++;
+		}
+	}
+	if (m_bRecordingCamera == true)
+	{
+		m_recordedPath.AddKey(CameraPath::CaptureKey(*g_pCamera, bOrthographicProjection,
+			(float)(glfwGetTime() - m_recordStartTime)));
+	}
+
 	// get the current view matrix from the camera
 	view = g_pCamera->GetViewMatrix();
 
 	// define the current projection matrix
-	if (bOrthographicProjection)
-		projection = glm::ortho(-15.0f, 15.0f, -15.0f, 15.0f, 0.1f, 100.0f);
-	else
-		projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
+	projection = BuildSceneProjection(bOrthographicProjection, g_pCamera->Zoom,
+		(GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT);
+
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
 
 	// if the shader manager object is valid
 	if (NULL != m_pShaderManager)
@@ -465,4 +651,81 @@ void ViewManager::PrepareSceneView()
 		glfwSetWindowTitle(m_pWindow, title.c_str());
 	}
 	*/
-}
\ No newline at end of file
+}
+
+/***********************************************************
+ *  SetRenderSettings()
+ *
+ *  This method sets the render options that the function
+ *  key controls change.
+ ***********************************************************/
+void ViewManager::SetRenderSettings(RenderSettings* pRenderSettings)
+{
+	m_pRenderSettings = pRenderSettings;
+}
+
+/***********************************************************
+ *  GetCameraPosition()
+ *
+ *  This method returns the current camera position.
+ ***********************************************************/
+glm::vec3 ViewManager::GetCameraPosition() const
+{
+	if (NULL == g_pCamera)
+	{
+		return glm::vec3(0.0f);
+	}
+	return g_pCamera->Position;
+}
+
+/***********************************************************
+ *  StartCameraRecording()
+ *
+ *  This method starts recording the camera of every frame
+ *  prepared from now on, timed from this call.
+ ***********************************************************/
+void ViewManager::StartCameraRecording()
+{
+	m_recordedPath = CameraPath();
+	m_recordStartTime = glfwGetTime();
+	m_bRecordingCamera = true;
+}
+
+/***********************************************************
+ *  SaveCameraRecording()
+ *
+ *  This method writes the frames recorded so far to a path
+ *  file for StartCameraPlayback().
+ ***********************************************************/
+bool ViewManager::SaveCameraRecording(const char* filename)
+{
+	return m_recordedPath.Save(filename);
+}
+
+/***********************************************************
+ *  StartCameraPlayback()
+ *
+ *  This method loads a recorded path - the frames prepared
+ *  from now on follow it instead of the input.
+ ***********************************************************/
+bool ViewManager::StartCameraPlayback(const char* filename)
+{
+	if (m_playbackPath.Load(filename) == false)
+	{
+		return false;
+	}
+	m_playbackFrame = 0;
+	m_bPlayingCamera = true;
+	return true;
+}
+
+/***********************************************************
+ *  IsCameraPlaybackFinished()
+ *
+ *  This method returns true once every frame of the played
+ *  path has been prepared.
+ ***********************************************************/
+bool ViewManager::IsCameraPlaybackFinished() const
+{
+	return (m_bPlayingCamera == true) && (m_playbackFrame >= m_playbackPath.GetFrameCount());
+}
@@ -10,6 +10,8 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "RenderSettings.h"
+#include "CameraPath.h"
 #include "camera.h"
 
 // GLFW library
@@ -34,6 +36,19 @@ private:
 	ShaderManager* m_pShaderManager;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// render options toggled with the function keys, may be NULL
+	RenderSettings* m_pRenderSettings;
+	// the view and projection matrices of the current frame
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	// the camera of the frames so far while recording a path
+	CameraPath m_recordedPath;
+	bool m_bRecordingCamera;
+	double m_recordStartTime;
+	// the path driving the camera and its next frame while playing one
+	CameraPath m_playbackPath;
+	bool m_bPlayingCamera;
+	int m_playbackFrame;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
@@ -44,4 +59,23 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+
+	// set the render options changed by the function keys
+	void SetRenderSettings(RenderSettings* pRenderSettings);
+
+	// the camera values used by the current frame
+	glm::mat4 GetViewMatrix() const { return m_viewMatrix; }
+	glm::mat4 GetProjectionMatrix() const { return m_projectionMatrix; }
+	glm::vec3 GetCameraPosition() const;
+
+	// record the camera of every frame from now on, and write the
+	// frames recorded so far to a file
+	void StartCameraRecording();
+	bool SaveCameraRecording(const char* filename);
+	// drive the camera from the path in the file, one frame of its
+	// fixed frame rate per rendered frame, instead of the input
+	bool StartCameraPlayback(const char* filename);
+	// true once the last frame of the path has been prepared
+	bool IsCameraPlaybackFinished() const;
+	int GetCameraPlaybackFrame() const { return m_playbackFrame; }
 };
\ No newline at end of file
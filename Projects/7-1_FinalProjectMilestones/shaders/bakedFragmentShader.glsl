@@ -0,0 +1,26 @@
+#version 330 core
+out vec4 fragmentColor;
+
+in vec2 fragmentTextureCoordinate;
+in vec2 fragmentLightmapCoordinate;
+
+// packed per-draw parameters:
+//   [4]    object color
+//   [5]    w flags (bit 0 use texture)
+uniform vec4 drawParams[7];
+uniform sampler2D objectTexture;
+// the ambient and diffuse light of the static lights, baked with
+// shadows and one bounce - the base color only has to be scaled by it
+uniform sampler2D lightmap;
+
+void main()
+{
+    vec4 baseColor = drawParams[4];
+    if((int(drawParams[5].w) & 1) != 0)
+    {
+        baseColor = texture(objectTexture, fragmentTextureCoordinate);
+    }
+
+    vec3 light = texture(lightmap, fragmentLightmapCoordinate).rgb;
+    fragmentColor = vec4(baseColor.rgb * light, baseColor.a);
+}
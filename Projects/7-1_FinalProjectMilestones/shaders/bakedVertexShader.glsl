@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 2) in vec2 inTextureCoordinate;
+layout (location = 3) in vec2 inLightmapCoordinate;
+
+out vec2 fragmentTextureCoordinate;
+out vec2 fragmentLightmapCoordinate;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// the baked triangles are already in world space
+void main()
+{
+   gl_Position = projection * view * vec4(inVertexPosition, 1.0f);
+   fragmentTextureCoordinate = inTextureCoordinate;
+   fragmentLightmapCoordinate = inLightmapCoordinate;
+}
@@ -0,0 +1,30 @@
+#version 330 core
+out vec4 fragmentColor;
+
+// sum of the weighted, premultiplied translucent colors and product of
+// their remaining transmission, see transparency.glsl
+uniform sampler2D accumulationTexture;
+uniform sampler2D revealageTexture;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float revealage = texelFetch(revealageTexture, pixel, 0).r;
+    // no translucent fragment here - keep the scene
+    if(revealage >= 1.0f)
+    {
+        discard;
+    }
+
+    vec4 accumulation = texelFetch(accumulationTexture, pixel, 0);
+    // the half float sum may overflow for many near fragments
+    if(isinf(accumulation.a))
+    {
+        accumulation.a = max(max(accumulation.r, accumulation.g), accumulation.b);
+    }
+
+    // the weighted average color, blended over the scene by the total
+    // coverage
+    vec3 averageColor = accumulation.rgb / max(accumulation.a, 1e-5);
+    fragmentColor = vec4(averageColor, 1.0f - revealage);
+}
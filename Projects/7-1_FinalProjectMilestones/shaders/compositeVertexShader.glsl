@@ -0,0 +1,8 @@
+#version 330 core
+
+// one triangle covering the whole screen, made from the vertex index
+void main()
+{
+    vec2 corner = vec2(float((gl_VertexID & 1) << 2), float((gl_VertexID & 2) << 1));
+    gl_Position = vec4(corner - 1.0f, 0.0f, 1.0f);
+}
@@ -0,0 +1,227 @@
+#version 430 core
+
+// GPU frustum culling for the indirect path. A single work group tests
+// the bounding sphere of every recorded draw, then writes the indirect
+// commands of the visible draws to the front of the command buffer.
+// Each thread handles one contiguous chunk of draws and the chunk
+// offsets come from a prefix sum, so the surviving draws keep their
+// order and blending is unaffected. The unused tail of the buffer is
+// zeroed so it can also be drawn without a draw count.
+// With occlusion culling the draws inside the frustum are also tested
+// against the depth pyramid of this frame's occluders - see
+// depthPyramidComputeShader.glsl.
+// The draws may be split into an opaque and a translucent segment for
+// the depth pre-pass. Each segment is culled by its own dispatch, which
+// compacts the segment's commands in place and writes its own counts.
+#define CULL_GROUP_SIZE 256
+
+layout (local_size_x = CULL_GROUP_SIZE) in;
+
+// the per-draw parameters, shared with indirectVertexShader.glsl
+struct DrawParameters {
+    mat4 model;
+    vec4 color;
+    vec4 surface;
+    vec4 lights;
+};
+
+layout (std430, binding = 2) readonly buffer DrawBlock {
+    DrawParameters draws[];
+};
+
+// must match IndirectRenderer::CullInput
+struct CullInput {
+    vec4 bounds;        // object space sphere - xyz center, w radius
+    vec4 extents;       // object space box half size around the center
+    uint count;
+    uint firstIndex;
+    int baseVertex;
+    uint padding;
+};
+
+layout (std430, binding = 3) readonly buffer CullBlock {
+    CullInput cullInputs[];
+};
+
+// the DrawElementsIndirectCommand layout defined by OpenGL
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 4) writeonly buffer CommandBlock {
+    DrawCommand commands[];
+};
+
+// per segment counts - the visible counts are read as draw counts
+layout (std430, binding = 5) writeonly buffer CountBlock {
+    uint visibleDrawCounts[2];
+    uint occludedDrawCounts[2];
+};
+
+uniform vec4 frustumPlanes[6];
+// the draws from segmentStart up to segmentEnd are culled
+uniform uint segment;
+uniform uint segmentStart;
+uniform uint segmentEnd;
+
+// occlusion culling against the depth pyramid
+uniform bool bOcclusionCulling;
+uniform mat4 viewProjection;
+uniform sampler2D depthPyramid;
+
+// matches ShaderManager::DRAW_FLAG_OCCLUDER
+#define DRAW_FLAG_OCCLUDER 2
+
+#define DRAW_VISIBLE 0u
+#define DRAW_OUTSIDE_FRUSTUM 1u
+#define DRAW_OCCLUDED 2u
+
+shared uint chunkOffsets[CULL_GROUP_SIZE];
+shared uint occludedTotal;
+
+// true when the whole bounding box is behind the occluder depth. The
+// box is tighter than the sphere for the flat parts like book pages.
+// Its screen rectangle picks the pyramid level where it spans at most
+// two texels, so the four corner samples cover all of it.
+bool IsBoxOccluded(mat4 model, vec3 center, vec3 extents)
+{
+    vec2 minUV = vec2(1.0);
+    vec2 maxUV = vec2(0.0);
+    float nearestDepth = 1.0;
+    for (int i = 0; i < 8; i++)
+    {
+        vec3 corner = center + extents * vec3(
+            ((i & 1) != 0) ? 1.0 : -1.0,
+            ((i & 2) != 0) ? 1.0 : -1.0,
+            ((i & 4) != 0) ? 1.0 : -1.0);
+        vec4 clipPosition = viewProjection * model * vec4(corner, 1.0);
+        if (clipPosition.w <= 0.0)
+        {
+            // reaches behind the camera
+            return false;
+        }
+
+        vec3 ndc = clipPosition.xyz / clipPosition.w;
+        minUV = min(minUV, ndc.xy * 0.5 + 0.5);
+        maxUV = max(maxUV, ndc.xy * 0.5 + 0.5);
+        nearestDepth = min(nearestDepth, ndc.z * 0.5 + 0.5);
+    }
+    minUV = clamp(minUV, 0.0, 1.0);
+    maxUV = clamp(maxUV, 0.0, 1.0);
+
+    vec2 texels = (maxUV - minUV) * vec2(textureSize(depthPyramid, 0));
+    float level = ceil(log2(max(max(texels.x, texels.y), 1.0)));
+    level = min(level, float(textureQueryLevels(depthPyramid) - 1));
+
+    float farthestDepth = max(
+        max(textureLod(depthPyramid, minUV, level).r, textureLod(depthPyramid, vec2(maxUV.x, minUV.y), level).r),
+        max(textureLod(depthPyramid, vec2(minUV.x, maxUV.y), level).r, textureLod(depthPyramid, maxUV, level).r));
+
+    return nearestDepth > farthestDepth;
+}
+
+// the frustum test is the same as FrustumCuller::IsSphereVisible() on
+// the CPU. The occluders themselves are never occlusion culled.
+uint ClassifyDraw(uint drawIndex)
+{
+    mat4 model = draws[drawIndex].model;
+    vec4 bounds = cullInputs[drawIndex].bounds;
+
+    vec3 center = vec3(model * vec4(bounds.xyz, 1.0));
+    float scale = max(length(model[0].xyz), max(length(model[1].xyz), length(model[2].xyz)));
+    float radius = bounds.w * scale;
+
+    for (int i = 0; i < 6; i++)
+    {
+        if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+        {
+            return DRAW_OUTSIDE_FRUSTUM;
+        }
+    }
+
+    if (bOcclusionCulling && ((int(draws[drawIndex].surface.w) & DRAW_FLAG_OCCLUDER) == 0) &&
+        IsBoxOccluded(model, bounds.xyz, cullInputs[drawIndex].extents.xyz))
+    {
+        return DRAW_OCCLUDED;
+    }
+    return DRAW_VISIBLE;
+}
+
+void main()
+{
+    uint thread = gl_LocalInvocationIndex;
+    uint chunkSize = (segmentEnd - segmentStart + CULL_GROUP_SIZE - 1u) / CULL_GROUP_SIZE;
+    uint chunkStart = min(segmentStart + thread * chunkSize, segmentEnd);
+    uint chunkEnd = min(chunkStart + chunkSize, segmentEnd);
+
+    if (thread == 0u)
+    {
+        occludedTotal = 0u;
+    }
+
+    // count the visible draws of this thread's chunk
+    uint visible = 0u;
+    uint occluded = 0u;
+    for (uint i = chunkStart; i < chunkEnd; i++)
+    {
+        uint visibility = ClassifyDraw(i);
+        if (visibility == DRAW_VISIBLE)
+        {
+            visible++;
+        }
+        else if (visibility == DRAW_OCCLUDED)
+        {
+            occluded++;
+        }
+    }
+    barrier();
+    atomicAdd(occludedTotal, occluded);
+
+    // inclusive prefix sum of the chunk counts
+    chunkOffsets[thread] = visible;
+    barrier();
+    for (uint stride = 1u; stride < CULL_GROUP_SIZE; stride *= 2u)
+    {
+        uint previous = (thread >= stride) ? chunkOffsets[thread - stride] : 0u;
+        barrier();
+        chunkOffsets[thread] += previous;
+        barrier();
+    }
+
+    // write the commands of the visible draws in their original order
+    uint commandIndex = segmentStart + chunkOffsets[thread] - visible;
+    for (uint i = chunkStart; i < chunkEnd; i++)
+    {
+        if (ClassifyDraw(i) == DRAW_VISIBLE)
+        {
+            commands[commandIndex].count = cullInputs[i].count;
+            commands[commandIndex].instanceCount = 1u;
+            commands[commandIndex].firstIndex = cullInputs[i].firstIndex;
+            commands[commandIndex].baseVertex = cullInputs[i].baseVertex;
+            // selects the draw parameters through the draw index attribute
+            commands[commandIndex].baseInstance = i;
+            commandIndex++;
+        }
+    }
+
+    // zero the commands past the visible draws
+    uint total = chunkOffsets[CULL_GROUP_SIZE - 1];
+    for (uint i = segmentStart + total + thread; i < segmentEnd; i += CULL_GROUP_SIZE)
+    {
+        commands[i].count = 0u;
+        commands[i].instanceCount = 0u;
+        commands[i].firstIndex = 0u;
+        commands[i].baseVertex = 0;
+        commands[i].baseInstance = 0u;
+    }
+
+    if (thread == 0u)
+    {
+        visibleDrawCounts[segment] = total;
+        occludedDrawCounts[segment] = occludedTotal;
+    }
+}
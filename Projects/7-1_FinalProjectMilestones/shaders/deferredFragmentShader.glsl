@@ -0,0 +1,41 @@
+#version 430 core
+out vec4 fragmentColor;
+
+#include "lighting.glsl"
+
+uniform sampler2D gBufferAlbedo;
+uniform sampler2D gBufferNormal;
+uniform sampler2D gBufferDepth;
+// turns the window position and depth of a pixel back into world space
+uniform mat4 inverseViewProjection;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gBufferDepth, pixel, 0).r;
+    // nothing was drawn here - keep the clear color
+    if(depth >= 1.0f)
+    {
+        discard;
+    }
+
+    vec3 albedo = texelFetch(gBufferAlbedo, pixel, 0).rgb;
+    vec4 normalMaterial = texelFetch(gBufferNormal, pixel, 0);
+
+    vec2 screenPosition = (gl_FragCoord.xy / vec2(textureSize(gBufferDepth, 0))) * 2.0f - 1.0f;
+    vec4 worldPosition = inverseViewProjection * vec4(screenPosition, depth * 2.0f - 1.0f, 1.0f);
+    vec3 fragPos = worldPosition.xyz / worldPosition.w;
+
+    if(normalMaterial.w < 0.0f)
+    {
+        fragmentColor = vec4(albedo, 1.0f);
+    }
+    else
+    {
+        Material material = GetMaterial(int(normalMaterial.w + 0.5f));
+        fragmentColor = vec4(CalcPhongLighting(material, albedo, normalize(normalMaterial.xyz), fragPos), 1.0f);
+    }
+
+    // the translucent draws are depth tested against the G-buffer depth
+    gl_FragDepth = depth;
+}
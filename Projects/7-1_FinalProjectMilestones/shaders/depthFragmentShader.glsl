@@ -0,0 +1,6 @@
+#version 330 core
+
+// depth only - the depth test and write are all that is needed
+void main()
+{
+}
@@ -0,0 +1,44 @@
+#version 430 core
+
+// Builds one level of the hierarchical depth pyramid used for occlusion
+// culling. Every texel keeps the farthest depth of the source texels it
+// covers, so a draw whose nearest depth is behind it is hidden for sure.
+// Level 0 reads the occluder depth texture and may cover up to 2x2 depth
+// pixels per texel since the pyramid is rounded down to a power of two.
+layout (local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D sourceDepth;
+layout (r32f, binding = 0) uniform readonly image2D sourceLevel;
+layout (r32f, binding = 1) uniform writeonly image2D destinationLevel;
+
+uniform ivec2 sourceSize;
+uniform ivec2 destinationSize;
+// read the depth texture instead of the previous pyramid level
+uniform bool bReadDepth;
+
+void main()
+{
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(coord, destinationSize)))
+    {
+        return;
+    }
+
+    // the source texels covered by this texel, rounded outward
+    ivec2 first = (coord * sourceSize) / destinationSize;
+    ivec2 last = ((coord + 1) * sourceSize + destinationSize - 1) / destinationSize;
+
+    float farthest = 0.0;
+    for (int y = first.y; y < last.y; y++)
+    {
+        for (int x = first.x; x < last.x; x++)
+        {
+            float depth = bReadDepth ?
+                texelFetch(sourceDepth, ivec2(x, y), 0).r :
+                imageLoad(sourceLevel, ivec2(x, y)).r;
+            farthest = max(farthest, depth);
+        }
+    }
+
+    imageStore(destinationLevel, coord, vec4(farthest));
+}
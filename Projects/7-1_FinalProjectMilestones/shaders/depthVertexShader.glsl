@@ -0,0 +1,31 @@
+#version 430 core
+layout (location = 0) in vec3 inVertexPosition;
+// index of the draw in the draw parameter buffer, the same
+// instanced attribute as in indirectVertexShader.glsl
+layout (location = 3) in uint inDrawIndex;
+
+// the per-draw parameters, shared with indirectVertexShader.glsl
+struct DrawParameters {
+    mat4 model;
+    vec4 color;
+    vec4 surface;
+    vec4 lights;
+};
+
+layout (std430, binding = 2) readonly buffer DrawBlock {
+    DrawParameters draws[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// the same position as indirectVertexShader.glsl, so the depth pre-pass
+// can be followed by an equal depth test
+invariant gl_Position;
+
+// depth only - positions the recorded draws without any shading inputs
+void main()
+{
+   DrawParameters draw = draws[inDrawIndex];
+   gl_Position = projection * view * draw.model * vec4(inVertexPosition, 1.0f);
+}
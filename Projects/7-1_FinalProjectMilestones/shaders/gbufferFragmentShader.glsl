@@ -0,0 +1,36 @@
+#version 430 core
+// the G-buffer of the deferred path - lit later in screen space
+layout (location = 0) out vec4 gBufferAlbedo;
+layout (location = 1) out vec4 gBufferNormal;
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+// xy UV scale, z material index, w flags (bit 0 use texture, bit 1 occluder,
+// texture slot from bit 8)
+flat in vec4 drawColor;
+flat in vec4 drawSurface;
+
+#include "sceneTextures.glsl"
+
+uniform bool bUseLighting = false;
+
+void main()
+{
+    int flags = int(drawSurface.w);
+    bool bUseTexture = (flags & 1) != 0;
+    int textureSlot = flags >> 8;
+
+    // the same base color the forward shaders light - the lit path
+    // samples without the UV scale, as in indirectFragmentShader.glsl
+    vec4 baseColor = drawColor;
+    if(bUseTexture == true)
+    {
+        vec2 uv = (bUseLighting == true) ? fragmentTextureCoordinate : fragmentTextureCoordinate * drawSurface.xy;
+        baseColor = SampleSlot(textureSlot, uv);
+    }
+
+    gBufferAlbedo = vec4(baseColor.rgb, 1.0f);
+    // w is the material index, or -1 when the pixel is not lit
+    gBufferNormal = vec4(normalize(fragmentVertexNormal), (bUseLighting == true) ? drawSurface.z : -1.0f);
+}
@@ -0,0 +1,83 @@
+#version 330 core
+out vec4 fragmentColor;
+
+in vec3 fragmentPosition;
+flat in vec4 sphereCenterRadius;
+flat in vec4 drawColor;
+// xy UV scale, z material index, w flags (bit 0 use texture, texture
+// slot from bit 8)
+flat in vec4 drawSurface;
+
+#include "lighting.glsl"
+
+#include "sceneTextures.glsl"
+
+uniform mat4 view;
+uniform mat4 projection;
+
+#define PI 3.14159265f
+
+void main()
+{
+    vec3 center = sphereCenterRadius.xyz;
+    float radius = sphereCenterRadius.w;
+
+    // the view ray of the fragment - from the camera, or along the
+    // view direction for the orthographic views, starting in front of
+    // the sphere
+    vec3 rayDirection = normalize(fragmentPosition - viewPosition);
+    vec3 rayOrigin = viewPosition;
+    if(projection[3][3] == 1.0f)
+    {
+        rayDirection = -vec3(view[0][2], view[1][2], view[2][2]);
+        rayOrigin = fragmentPosition - rayDirection * (2.0f * radius);
+    }
+
+    // nearest hit of the ray with the sphere, the quad corners miss it
+    vec3 offset = rayOrigin - center;
+    float b = dot(offset, rayDirection);
+    float c = dot(offset, offset) - radius * radius;
+    float discriminant = b * b - c;
+    if(discriminant < 0.0f)
+    {
+        discard;
+    }
+    vec3 hit = rayOrigin + rayDirection * (-b - sqrt(discriminant));
+    vec3 norm = (hit - center) / radius;
+
+    vec4 clip = projection * view * vec4(hit, 1.0f);
+    gl_FragDepth = (clip.z / clip.w) * 0.5f + 0.5f;
+
+    int flags = int(drawSurface.w);
+    bool bUseTexture = (flags & 1) != 0;
+    int textureSlot = flags >> 8;
+
+    // latitude and longitude mapping like the sphere mesh
+    vec2 uv = vec2(atan(norm.x, norm.z) / (2.0f * PI) + 0.5f, asin(clamp(norm.y, -1.0f, 1.0f)) / PI + 0.5f);
+
+    if(bUseLighting == true)
+    {
+        Material material = GetMaterial(int(drawSurface.z));
+
+        if(bUseTexture == true)
+        {
+            vec4 textureColor = SampleSlot(textureSlot, uv);
+            fragmentColor = vec4(CalcPhongLighting(material, textureColor.rgb, norm, hit), textureColor.a);
+        }
+        else
+        {
+            fragmentColor = vec4(CalcPhongLighting(material, drawColor.rgb, norm, hit), drawColor.a);
+        }
+    }
+    else
+    {
+        if(bUseTexture == true)
+        {
+            fragmentColor = SampleSlot(textureSlot, uv * drawSurface.xy);
+        }
+        else
+        {
+            fragmentColor = drawColor;
+        }
+    }
+}
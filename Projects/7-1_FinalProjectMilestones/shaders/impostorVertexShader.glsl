@@ -0,0 +1,56 @@
+#version 330 core
+// one instance per sphere - world space center and radius, and the
+// color and surface values of its draw
+layout (location = 0) in vec4 inCenterRadius;
+layout (location = 1) in vec4 inColor;
+layout (location = 2) in vec4 inSurface;
+
+// the point of the quad, the ray of the fragment passes through it
+out vec3 fragmentPosition;
+flat out vec4 sphereCenterRadius;
+flat out vec4 drawColor;
+flat out vec4 drawSurface;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPosition;
+
+void main()
+{
+    vec3 center = inCenterRadius.xyz;
+    float radius = inCenterRadius.w;
+    sphereCenterRadius = inCenterRadius;
+    drawColor = inColor;
+    drawSurface = inSurface;
+
+    // the camera axes in world space, from the rows of the view matrix
+    vec3 cameraUp = vec3(view[0][1], view[1][1], view[2][1]);
+    vec3 cameraBack = vec3(view[0][2], view[1][2], view[2][2]);
+
+    // the quad faces the camera through the center of the sphere and
+    // covers the cone of rays that touch it - the orthographic views
+    // have parallel rays, so their quad only needs the radius
+    vec3 direction = -cameraBack;
+    float halfSize = radius;
+    if(projection[3][3] != 1.0f)
+    {
+        vec3 toCenter = center - viewPosition;
+        float distance = length(toCenter);
+        // the camera is inside the sphere - leave it out
+        if(distance <= radius * 1.001f)
+        {
+            gl_Position = vec4(2.0f, 2.0f, 2.0f, 1.0f);
+            fragmentPosition = center;
+            return;
+        }
+        direction = toCenter / distance;
+        halfSize = radius * distance / sqrt(distance * distance - radius * radius);
+    }
+
+    vec3 right = normalize(cross(direction, (abs(dot(direction, cameraUp)) < 0.99f) ? cameraUp : cameraBack));
+    vec3 up = cross(right, direction);
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1)) * 2.0f - 1.0f;
+
+    fragmentPosition = center + (right * corner.x + up * corner.y) * halfSize;
+    gl_Position = projection * view * vec4(fragmentPosition, 1.0f);
+}
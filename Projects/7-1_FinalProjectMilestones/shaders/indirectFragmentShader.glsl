@@ -0,0 +1,57 @@
+#version 430 core
+layout(location = 0) out vec4 fragmentColor;
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+// xy UV scale, z material index, w flags (bit 0 use texture, bit 1 occluder,
+// texture slot from bit 8)
+flat in vec4 drawColor;
+flat in vec4 drawSurface;
+// the light list of the draw, see CalcListedLights()
+flat in vec4 drawLights;
+
+#include "lighting.glsl"
+
+#include "sceneTextures.glsl"
+
+#include "transparency.glsl"
+
+void main()
+{    
+    int flags = int(drawSurface.w);
+    bool bUseTexture = (flags & 1) != 0;
+    int textureSlot = flags >> 8;
+
+    if(bUseLighting == true)
+    {
+        Material material = GetMaterial(int(drawSurface.z));
+        vec3 norm = normalize(fragmentVertexNormal);
+
+        if(bUseTexture == true)
+        {
+            vec4 textureColor = SampleSlot(textureSlot, fragmentTextureCoordinate);
+            fragmentColor = vec4(CalcPhongLighting(material, textureColor.rgb, norm, fragmentPosition, drawLights), textureColor.a);
+        }
+        else
+        {
+            fragmentColor = vec4(CalcPhongLighting(material, drawColor.rgb, norm, fragmentPosition, drawLights), drawColor.a);
+        }
+    }
+    else
+    {
+        if(bUseTexture == true)
+        {
+            fragmentColor = SampleSlot(textureSlot, fragmentTextureCoordinate * drawSurface.xy);
+        }
+        else
+        {
+            fragmentColor = drawColor;
+        }
+    }
+
+    if(bWeightedBlend == true)
+    {
+        fragmentColor = WeightBlendedColor(fragmentColor);
+    }
+}
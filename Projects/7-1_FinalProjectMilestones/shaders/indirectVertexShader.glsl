@@ -0,0 +1,45 @@
+#version 430 core
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+// index of the draw in the draw parameter buffer - an instanced
+// attribute, so each indirect command selects it with baseInstance
+layout (location = 3) in uint inDrawIndex;
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+flat out vec4 drawColor;
+flat out vec4 drawSurface;
+flat out vec4 drawLights;
+// the depth pre-pass computes the same position in
+// depthVertexShader.glsl, so both must match exactly
+invariant gl_Position;
+
+// the same packed per-draw parameters as the drawParams uniform
+// of the immediate path, one entry per recorded draw
+struct DrawParameters {
+    mat4 model;
+    vec4 color;
+    vec4 surface;
+    vec4 lights;
+};
+
+layout (std430, binding = 2) readonly buffer DrawBlock {
+    DrawParameters draws[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+   DrawParameters draw = draws[inDrawIndex];
+   fragmentPosition = vec3(draw.model * vec4(inVertexPosition, 1.0));
+   gl_Position = projection * view * draw.model * vec4(inVertexPosition, 1.0f);
+   fragmentVertexNormal = inVertexNormal;
+   fragmentTextureCoordinate = inTextureCoordinate;
+   drawColor = draw.color;
+   drawSurface = draw.surface;
+   drawLights = draw.lights;
+}
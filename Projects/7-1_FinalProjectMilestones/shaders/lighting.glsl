@@ -0,0 +1,402 @@
+// shared lighting code - included by the fragment shaders after their
+// #version line, so the immediate and indirect draw paths light every
+// surface the same way
+
+struct Material {
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float shininess;
+}; 
+
+// one entry of the material table - must match the MaterialLibrary
+// GPUMaterial struct, packed in std140 layout
+struct MaterialData {
+    vec4 diffuseColor;
+    vec4 specularShininess;
+};
+
+struct DirectionalLight {
+    vec3 direction;
+	
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct PointLight {
+    vec3 position;
+    
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+  
+    float constant;
+    float linear;
+    float quadratic;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;       
+
+    bool bActive;
+};
+
+#define TOTAL_POINT_LIGHTS 5
+#define MAX_MATERIALS 64
+
+// every scene material, uploaded once by the MaterialLibrary
+layout (std140) uniform MaterialBlock {
+    MaterialData materials[MAX_MATERIALS];
+};
+
+uniform bool bUseLighting=false;
+uniform vec3 viewPosition;
+uniform DirectionalLight directionalLight;
+uniform PointLight pointLights[TOTAL_POINT_LIGHTS];
+uniform SpotLight spotLight;
+
+// one point or spot light of the light table and the cluster light
+// buffer - must match the GPULight struct in LightSource.h
+struct LightData {
+    vec4 positionRadius;      // xyz position, w radius, 0 for unbounded
+    vec4 directionType;       // xyz spot direction, w 1 for spot lights
+    vec4 ambientConstant;     // w constant attenuation
+    vec4 diffuseLinear;       // w linear attenuation
+    vec4 specularQuadratic;   // w quadratic attenuation
+    vec4 cone;                // x cutoff, y outer cutoff
+};
+
+#define MAX_SCENE_LIGHTS 128
+
+// per-draw light lists - every scene light in a uniform buffer, and per
+// draw up to 8 indices of the lights in range of it, uploaded by the
+// LightLists class
+layout (std140) uniform LightTableBlock {
+    LightData lightTable[MAX_SCENE_LIGHTS];
+};
+
+uniform bool bLightLists = false;
+
+// shadow maps of the directional light and of one spot light, filled by
+// the ShadowMaps class - the matrices go from world space to the map
+// coordinates and depth
+uniform bool bShadows = false;
+uniform sampler2DShadow directionalShadowMap;
+uniform sampler2DShadow spotShadowMap;
+uniform mat4 directionalShadowMatrix;
+uniform mat4 spotShadowMatrix;
+// the shadowed spot light in the light table and cluster lists
+uniform int shadowLightIndex = -1;
+// the fragment moves this far along its normal before the lookup, so
+// lit surfaces do not shadow themselves
+uniform float shadowNormalOffset;
+
+#if __VERSION__ >= 430
+// clustered lighting - every light of the scene, and per cluster of the
+// view frustum a range of the light index list. Must match the
+// ClusteredLighting buffers.
+layout (std430, binding = 6) readonly buffer LightBlock {
+    LightData clusterLights[];
+};
+
+// offset and count into the light index list of each cluster
+layout (std430, binding = 7) readonly buffer ClusterBlock {
+    uvec2 clusterRanges[];
+};
+
+layout (std430, binding = 8) readonly buffer LightIndexBlock {
+    uint clusterLightIndices[];
+};
+
+uniform bool bClusteredLighting = false;
+// x, y tiles and z depth slices, and the pixel size of a tile
+uniform ivec3 clusterGrid;
+uniform vec2 clusterTileSize;
+// depth slice = log(view depth) * x + y
+uniform vec2 clusterDepth;
+uniform vec3 clusterViewForward;
+#endif
+
+// the lit fraction of a fragment in one shadow map, filtered over 3x3
+// texels - every tap compares the 4 nearest texels, so the edges fade
+// over about two texels. Fragments outside the map are lit.
+float SampleShadow(sampler2DShadow shadowMap, mat4 shadowMatrix, vec3 fragPos, vec3 normal)
+{
+    vec4 position = shadowMatrix * vec4(fragPos + normal * shadowNormalOffset, 1.0f);
+    if(position.w <= 0.0f)
+    {
+        return 1.0f;
+    }
+    vec3 coords = position.xyz / position.w;
+    if(any(lessThan(coords, vec3(0.0f))) || any(greaterThan(coords, vec3(1.0f))))
+    {
+        return 1.0f;
+    }
+
+    vec2 texelSize = 1.0f / vec2(textureSize(shadowMap, 0));
+    float lit = 0.0f;
+    for(int y = -1; y <= 1; y++)
+    {
+        for(int x = -1; x <= 1; x++)
+        {
+            lit += texture(shadowMap, vec3(coords.xy + vec2(x, y) * texelSize, coords.z));
+        }
+    }
+    return lit / 9.0f;
+}
+
+// the lit fraction of the directional light
+float GetDirectionalShadow(vec3 fragPos, vec3 normal)
+{
+    if(bShadows == false)
+    {
+        return 1.0f;
+    }
+    return SampleShadow(directionalShadowMap, directionalShadowMatrix, fragPos, normal);
+}
+
+// the lit fraction of a light of the light table or the cluster lists
+float GetLightShadow(int lightIndex, vec3 fragPos, vec3 normal)
+{
+    if((bShadows == false) || (shadowLightIndex < 0) || (lightIndex != shadowLightIndex))
+    {
+        return 1.0f;
+    }
+    return SampleShadow(spotShadowMap, spotShadowMatrix, fragPos, normal);
+}
+
+// looks up a material in the material table
+Material GetMaterial(int materialIndex)
+{
+    Material material;
+    material.diffuseColor = materials[materialIndex].diffuseColor.rgb;
+    material.specularColor = materials[materialIndex].specularShininess.rgb;
+    material.shininess = materials[materialIndex].specularShininess.a;
+    return material;
+}
+
+// calculates the color when using a directional light.
+// the shadow only darkens the diffuse and specular terms
+vec3 CalcDirectionalLight(DirectionalLight light, Material material, vec3 baseColor, vec3 normal, vec3 viewDir, float shadow)
+{
+    vec3 lightDirection = normalize(-light.direction);
+    // diffuse shading
+    float diff = max(dot(normal, lightDirection), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDirection, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    // combine results
+    vec3 ambient = light.ambient * baseColor;
+    vec3 diffuse = light.diffuse * diff * material.diffuseColor * baseColor;
+    vec3 specular = light.specular * spec * material.specularColor * baseColor;
+    
+    return (ambient + (diffuse + specular) * shadow);
+}
+
+// calculates the color when using a point light.
+vec3 CalcPointLight(PointLight light, Material material, vec3 baseColor, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    // Calculate specular component
+    float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+   
+    // combine results - point light highlights are not tinted by the surface
+    vec3 ambient = light.ambient * baseColor;
+    vec3 diffuse = light.diffuse * diff * material.diffuseColor * baseColor;
+    vec3 specular = light.specular * specularComponent * material.specularColor;
+    
+    return (ambient + diffuse + specular);
+}
+
+// calculates the color when using a spot light.
+// the shadow only darkens the diffuse and specular terms
+vec3 CalcSpotLight(SpotLight light, Material material, vec3 baseColor, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    // spotlight intensity
+    float theta = dot(lightDir, normalize(-light.direction)); 
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    // combine results
+    vec3 ambient = light.ambient * baseColor;
+    vec3 diffuse = light.diffuse * diff * material.diffuseColor * baseColor;
+    vec3 specular = light.specular * spec * material.specularColor * baseColor;
+    
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity * shadow;
+    specular *= attenuation * intensity * shadow;
+    return (ambient + diffuse + specular);
+}
+
+// calculates the color of one light of the light table or the cluster
+// lists - point lights without attenuation terms match CalcPointLight exactly
+vec3 CalcSceneLight(LightData light, Material material, vec3 baseColor, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow)
+{
+    if(light.directionType.w > 0.5f)
+    {
+        SpotLight spot;
+        spot.position = light.positionRadius.xyz;
+        spot.direction = light.directionType.xyz;
+        spot.cutOff = light.cone.x;
+        spot.outerCutOff = light.cone.y;
+        spot.constant = light.ambientConstant.w;
+        spot.linear = light.diffuseLinear.w;
+        spot.quadratic = light.specularQuadratic.w;
+        spot.ambient = light.ambientConstant.rgb;
+        spot.diffuse = light.diffuseLinear.rgb;
+        spot.specular = light.specularQuadratic.rgb;
+        spot.bActive = true;
+        return CalcSpotLight(spot, material, baseColor, normal, fragPos, viewDir, shadow);
+    }
+
+    PointLight point;
+    point.position = light.positionRadius.xyz;
+    point.ambient = light.ambientConstant.rgb;
+    point.diffuse = light.diffuseLinear.rgb;
+    point.specular = light.specularQuadratic.rgb;
+    point.bActive = true;
+
+    float distance = length(point.position - fragPos);
+    float attenuation = 1.0 / (light.ambientConstant.w + light.diffuseLinear.w * distance +
+        light.specularQuadratic.w * (distance * distance));
+    return CalcPointLight(point, material, baseColor, normal, fragPos, viewDir) * attenuation;
+}
+
+// true when the fragment is within the radius of the light - the lists
+// are built from whole draws or clusters, so the fragments at their far
+// side skip the lighting math
+bool IsLightInRange(LightData light, vec3 fragPos)
+{
+    vec3 toLight = light.positionRadius.xyz - fragPos;
+    float radius = light.positionRadius.w;
+    return (radius <= 0.0f) || (dot(toLight, toLight) <= (radius * radius));
+}
+
+// sums up the lights in the per-draw list - every component holds two
+// light indices + 1, in the low and high byte, and the list ends at 0
+vec3 CalcListedLights(vec4 drawLights, Material material, vec3 baseColor, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 result = vec3(0.0f);
+    for(int i = 0; i < 8; i++)
+    {
+        int pair = int(drawLights[i / 2]);
+        int index = (((i & 1) == 0) ? (pair & 255) : (pair >> 8)) - 1;
+        if(index < 0)
+        {
+            break;
+        }
+        LightData light = lightTable[index];
+        if(IsLightInRange(light, fragPos) == true)
+        {
+            result += CalcSceneLight(light, material, baseColor, normal, fragPos, viewDir,
+                GetLightShadow(index, fragPos, normal));
+        }
+    }
+    return result;
+}
+
+#if __VERSION__ >= 430
+// sums up the lights assigned to the cluster of this fragment
+vec3 CalcClusterLights(Material material, vec3 baseColor, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    float depth = max(dot(fragPos - viewPosition, clusterViewForward), 1.0e-4f);
+    int slice = clamp(int(log(depth) * clusterDepth.x + clusterDepth.y), 0, clusterGrid.z - 1);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / clusterTileSize), ivec2(0), clusterGrid.xy - 1);
+    uvec2 range = clusterRanges[(slice * clusterGrid.y + tile.y) * clusterGrid.x + tile.x];
+
+    vec3 result = vec3(0.0f);
+    for(uint i = 0u; i < range.y; i++)
+    {
+        int index = int(clusterLightIndices[range.x + i]);
+        LightData light = clusterLights[index];
+        if(IsLightInRange(light, fragPos) == true)
+        {
+            result += CalcSceneLight(light, material, baseColor, normal, fragPos, viewDir,
+                GetLightShadow(index, fragPos, normal));
+        }
+    }
+    return result;
+}
+#endif
+
+// == =====================================================
+// Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
+// With light lists or clustered lighting the point and spot lights come from the per-draw
+// or the cluster lists instead. For each phase, a calculate function is defined that
+// calculates the corresponding color per light source. The results of every active light
+// are summed up for the final color.
+// == =====================================================
+vec3 CalcPhongLighting(Material material, vec3 baseColor, vec3 normal, vec3 fragPos, vec4 drawLights)
+{
+    vec3 phongResult = vec3(0.0f);
+    vec3 viewDir = normalize(viewPosition - fragPos);
+
+    // phase 1: directional lighting
+    if(directionalLight.bActive == true)
+    {
+        phongResult += CalcDirectionalLight(directionalLight, material, baseColor, normal, viewDir,
+            GetDirectionalShadow(fragPos, normal));
+    }
+#if __VERSION__ >= 430
+    // phases 2 and 3 from the cluster lists, which hold the point and
+    // spot lights in range of this fragment
+    if(bClusteredLighting == true)
+    {
+        phongResult += CalcClusterLights(material, baseColor, normal, fragPos, viewDir);
+        return phongResult;
+    }
+#endif
+    // phases 2 and 3 from the light list of the draw, which holds the
+    // lights whose range reaches its bounds
+    if(bLightLists == true)
+    {
+        phongResult += CalcListedLights(drawLights, material, baseColor, normal, fragPos, viewDir);
+        return phongResult;
+    }
+    // phase 2: point lights
+    for(int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+    {
+        if(pointLights[i].bActive == true)
+        {
+            phongResult += CalcPointLight(pointLights[i], material, baseColor, normal, fragPos, viewDir);   
+        }
+    } 
+    // phase 3: spot light
+    if(spotLight.bActive == true)
+    {
+        // the flashlight is the first spot light, the one with the shadow map
+        phongResult += CalcSpotLight(spotLight, material, baseColor, normal, fragPos, viewDir,
+            GetLightShadow(shadowLightIndex, fragPos, normal));    
+    }
+
+    return phongResult;
+}
+
+// the same lighting for shaders without a per-draw light list
+vec3 CalcPhongLighting(Material material, vec3 baseColor, vec3 normal, vec3 fragPos)
+{
+    return CalcPhongLighting(material, baseColor, normal, fragPos, vec4(0.0f));
+}
@@ -0,0 +1,14 @@
+#version 330 core
+in vec2 fragmentTexCoord;
+in vec4 fragmentColor;
+
+out vec4 outColor;
+
+// one channel font texture - the glyph pixels and the solid cell are one
+uniform sampler2D fontTexture;
+
+void main()
+{
+    float coverage = texture(fontTexture, fragmentTexCoord).r;
+    outColor = vec4(fragmentColor.rgb, fragmentColor.a * coverage);
+}
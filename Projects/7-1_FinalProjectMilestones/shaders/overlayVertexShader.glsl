@@ -0,0 +1,19 @@
+#version 330 core
+// the corners of the overlay quads in pixels from the top left of the
+// viewport, and where they sample the font texture
+layout (location = 0) in vec2 inPosition;
+layout (location = 1) in vec2 inTexCoord;
+layout (location = 2) in vec4 inColor;
+
+out vec2 fragmentTexCoord;
+out vec4 fragmentColor;
+
+uniform vec2 viewportSize;
+
+void main()
+{
+    vec2 ndc = inPosition / viewportSize * 2.0f - 1.0f;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0f, 1.0f);
+    fragmentTexCoord = inTexCoord;
+    fragmentColor = inColor;
+}
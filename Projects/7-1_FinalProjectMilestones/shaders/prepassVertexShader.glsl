@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec3 inVertexPosition;
+
+// packed per-draw parameters - drawParams[0..3] hold the model matrix
+uniform vec4 drawParams[7];
+uniform mat4 view;
+uniform mat4 projection;
+
+// the same position as vertexShader.glsl, so the lit pass can
+// use an equal depth test against the pre-pass depth
+invariant gl_Position;
+
+// depth only - the depth pre-pass of the immediate path
+void main()
+{
+   mat4 model = mat4(drawParams[0], drawParams[1], drawParams[2], drawParams[3]);
+   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
+}
@@ -0,0 +1,37 @@
+// the texture slots of the indirect draws - included by the fragment
+// shaders that draw the recorded scene with multi-draw indirect
+
+#define MAX_TEXTURE_SLOTS 16
+
+// every texture slot - one indirect draw covers objects with
+// different textures, so the slot is picked per fragment
+uniform sampler2D sceneTextures[MAX_TEXTURE_SLOTS];
+
+// samples a texture slot - sampler arrays may only be indexed with
+// constant expressions here, and the gradients are taken before the
+// branch so mipmap selection stays well defined
+vec4 SampleSlot(int slot, vec2 uv)
+{
+    vec2 dx = dFdx(uv);
+    vec2 dy = dFdy(uv);
+
+    switch(slot)
+    {
+    case 0:  return textureGrad(sceneTextures[0], uv, dx, dy);
+    case 1:  return textureGrad(sceneTextures[1], uv, dx, dy);
+    case 2:  return textureGrad(sceneTextures[2], uv, dx, dy);
+    case 3:  return textureGrad(sceneTextures[3], uv, dx, dy);
+    case 4:  return textureGrad(sceneTextures[4], uv, dx, dy);
+    case 5:  return textureGrad(sceneTextures[5], uv, dx, dy);
+    case 6:  return textureGrad(sceneTextures[6], uv, dx, dy);
+    case 7:  return textureGrad(sceneTextures[7], uv, dx, dy);
+    case 8:  return textureGrad(sceneTextures[8], uv, dx, dy);
+    case 9:  return textureGrad(sceneTextures[9], uv, dx, dy);
+    case 10: return textureGrad(sceneTextures[10], uv, dx, dy);
+    case 11: return textureGrad(sceneTextures[11], uv, dx, dy);
+    case 12: return textureGrad(sceneTextures[12], uv, dx, dy);
+    case 13: return textureGrad(sceneTextures[13], uv, dx, dy);
+    case 14: return textureGrad(sceneTextures[14], uv, dx, dy);
+    default: return textureGrad(sceneTextures[15], uv, dx, dy);
+    }
+}
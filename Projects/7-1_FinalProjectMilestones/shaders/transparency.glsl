@@ -0,0 +1,23 @@
+// weighted blended order-independent transparency - included by the
+// fragment shaders that draw the translucent draws of the recorded
+// scene, see TransparencyPass
+
+// set while the translucent draws go into the accumulation and
+// revealage targets instead of the scene
+uniform bool bWeightedBlend = false;
+
+// coverage of the fragment, multiplied into the revealage target
+layout(location = 1) out vec4 fragmentRevealage;
+
+// turns a color into its weighted, premultiplied contribution to the
+// accumulation target - near and opaque fragments weigh more, so the
+// average is dominated by what would be in front when sorted
+vec4 WeightBlendedColor(vec4 color)
+{
+    float alpha = color.a;
+    float weight = clamp(pow(min(1.0f, alpha * 10.0f) + 0.01f, 3.0f) * 1e8 *
+        pow(1.0f - gl_FragCoord.z * 0.9f, 3.0f), 1e-2, 3e3);
+
+    fragmentRevealage = vec4(alpha);
+    return vec4(color.rgb * alpha, alpha) * weight;
+}
@@ -6,13 +6,18 @@ layout (location = 2) in vec2 inTextureCoordinate;
 out vec3 fragmentPosition;
 out vec3 fragmentVertexNormal;
 out vec2 fragmentTextureCoordinate;
+// the depth pre-pass computes the same position in
+// prepassVertexShader.glsl, so both must match exactly
+invariant gl_Position;
 
-uniform mat4 model;
+// packed per-draw parameters - drawParams[0..3] hold the model matrix
+uniform vec4 drawParams[7];
 uniform mat4 view;
 uniform mat4 projection;
 
 void main()
 {
+   mat4 model = mat4(drawParams[0], drawParams[1], drawParams[2], drawParams[3]);
    fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
    gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
    fragmentVertexNormal = inVertexNormal;
@@ -0,0 +1,1093 @@
+///////////////////////////////////////////////////////////////////////////////
+// glcapture.h
+// ===========
+// records the GL calls of the scene with their arguments and data into a
+// file for the standalone replayer
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include "GlCaptureFormat.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/***********************************************************
+ *  GlCapture
+ *
+ *  Records the calls that change the GL state, upload data
+ *  or draw, from the start of the application through a
+ *  window of frames, into a file in GlCaptureFormat. The
+ *  functions below replace the GL functions of the same
+ *  name through the macros at the end of this header, so
+ *  every file that includes it, directly or through the
+ *  ShaderManager and GpuResources headers, is recorded.
+ *  Queries, like glGetIntegerv and the timer queries, do
+ *  not change what is drawn and are not recorded. While no
+ *  capture runs a call costs one test of the file pointer.
+ *  The calls have to come from the thread of the context.
+ ***********************************************************/
+class GlCapture
+{
+public:
+	// open the file and record from now through the end of the frame
+	// firstFrame + frameCount - 1, counting from 0. The frames are
+	// rendered into defaultFramebuffer, 0 for a window. The context
+	// has to be current, its state is recorded first.
+	static bool Start(const char* path, int width, int height, GLuint defaultFramebuffer,
+		int firstFrame, int frameCount)
+	{
+		State& state = GetState();
+		Stop();
+		state.file = fopen(path, "wb");
+		if (NULL == state.file)
+		{
+			return false;
+		}
+
+		GlCaptureFormat::Header header;
+		header.magic = GlCaptureFormat::MAGIC;
+		header.version = GlCaptureFormat::VERSION;
+		header.width = width;
+		header.height = height;
+		header.defaultFramebuffer = defaultFramebuffer;
+		header.firstFrame = firstFrame;
+		fwrite(&header, sizeof(header), 1, state.file);
+
+		state.bWritten = true;
+		state.frame = 0;
+		state.lastFrame = firstFrame + frameCount;
+		state.unpackBuffer = 0;
+		state.unpackAlignment = 4;
+		state.mappings.clear();
+		RecordState();
+		return true;
+	}
+
+	// close the frame - the capture stops after the last one
+	static void EndFrame()
+	{
+		State& state = GetState();
+		if (NULL != state.file)
+		{
+			Record(GlCaptureFormat::FRAME_END);
+			state.frame++;
+			Flush();
+			if (state.frame >= state.lastFrame)
+			{
+				Stop();
+			}
+		}
+	}
+
+	// write out the calls recorded so far and close the file - false
+	// when writing the last capture failed, even if it closed earlier
+	static bool Stop()
+	{
+		State& state = GetState();
+		if (NULL != state.file)
+		{
+			Flush();
+			state.bWritten = (ferror(state.file) == 0);
+			state.bWritten = (fclose(state.file) == 0) && state.bWritten;
+			state.file = NULL;
+		}
+		return state.bWritten;
+	}
+
+	static bool IsRecording()
+	{
+		return NULL != GetState().file;
+	}
+
+	// the frames closed since the capture started
+	static int GetFrame()
+	{
+		return GetState().frame;
+	}
+
+	// fixed function state ///////////////////////////////////
+
+	static void Enable(GLenum capability)
+	{
+		Record(GlCaptureFormat::ENABLE, capability);
+		glEnable(capability);
+	}
+	static void Disable(GLenum capability)
+	{
+		Record(GlCaptureFormat::DISABLE, capability);
+		glDisable(capability);
+	}
+	static void Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+	{
+		Record(GlCaptureFormat::VIEWPORT, x, y, width, height);
+		glViewport(x, y, width, height);
+	}
+	static void DepthMask(GLboolean flag)
+	{
+		Record(GlCaptureFormat::DEPTH_MASK, flag);
+		glDepthMask(flag);
+	}
+	static void DepthFunc(GLenum func)
+	{
+		Record(GlCaptureFormat::DEPTH_FUNC, func);
+		glDepthFunc(func);
+	}
+	static void ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+	{
+		Record(GlCaptureFormat::COLOR_MASK, red, green, blue, alpha);
+		glColorMask(red, green, blue, alpha);
+	}
+	static void BlendFunc(GLenum source, GLenum destination)
+	{
+		Record(GlCaptureFormat::BLEND_FUNC, source, destination);
+		glBlendFunc(source, destination);
+	}
+	static void BlendFunci(GLuint buffer, GLenum source, GLenum destination)
+	{
+		Record(GlCaptureFormat::BLEND_FUNCI, buffer, source, destination);
+		glBlendFunci(buffer, source, destination);
+	}
+	static void BlendFuncSeparate(GLenum sourceRGB, GLenum destinationRGB, GLenum sourceAlpha, GLenum destinationAlpha)
+	{
+		Record(GlCaptureFormat::BLEND_FUNC_SEPARATE, sourceRGB, destinationRGB, sourceAlpha, destinationAlpha);
+		glBlendFuncSeparate(sourceRGB, destinationRGB, sourceAlpha, destinationAlpha);
+	}
+	static void PolygonOffset(GLfloat factor, GLfloat units)
+	{
+		Record(GlCaptureFormat::POLYGON_OFFSET, factor, units);
+		glPolygonOffset(factor, units);
+	}
+	static void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+	{
+		Record(GlCaptureFormat::CLEAR_COLOR, red, green, blue, alpha);
+		glClearColor(red, green, blue, alpha);
+	}
+	static void Clear(GLbitfield mask)
+	{
+		Record(GlCaptureFormat::CLEAR, mask);
+		glClear(mask);
+	}
+	static void ClearBufferfv(GLenum buffer, GLint drawBuffer, const GLfloat* value)
+	{
+		if (Begin(GlCaptureFormat::CLEAR_BUFFERFV) == true)
+		{
+			Put(buffer);
+			Put(drawBuffer);
+			// a color is four values, depth only one
+			PutBlob(value, sizeof(GLfloat) * ((GL_COLOR == buffer) ? 4 : 1));
+		}
+		glClearBufferfv(buffer, drawBuffer, value);
+	}
+	static void PixelStorei(GLenum name, GLint value)
+	{
+		if ((IsRecording() == true) && (GL_UNPACK_ALIGNMENT == name))
+		{
+			GetState().unpackAlignment = value;
+		}
+		Record(GlCaptureFormat::PIXEL_STOREI, name, value);
+		glPixelStorei(name, value);
+	}
+
+	// buffers and vertex arrays //////////////////////////////
+
+	static void BindBuffer(GLenum target, GLuint buffer)
+	{
+		if ((IsRecording() == true) && (GL_PIXEL_UNPACK_BUFFER == target))
+		{
+			// the pixels of the texture uploads are offsets into it then
+			GetState().unpackBuffer = buffer;
+		}
+		Record(GlCaptureFormat::BIND_BUFFER, target, buffer);
+		glBindBuffer(target, buffer);
+	}
+	static void BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+	{
+		Record(GlCaptureFormat::BIND_BUFFER_BASE, target, index, buffer);
+		glBindBufferBase(target, index, buffer);
+	}
+	static void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+	{
+		if (Begin(GlCaptureFormat::BUFFER_DATA) == true)
+		{
+			Put(target);
+			Put((long long)size);
+			PutBlob(data, size);
+			Put(usage);
+		}
+		glBufferData(target, size, data, usage);
+	}
+	static void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+	{
+		if (Begin(GlCaptureFormat::BUFFER_SUB_DATA) == true)
+		{
+			Put(target);
+			Put((long long)offset);
+			PutBlob(data, size);
+		}
+		glBufferSubData(target, offset, size, data);
+	}
+	static void* MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+	{
+		void* pointer = glMapBufferRange(target, offset, length, access);
+		if ((IsRecording() == true) && (NULL != pointer))
+		{
+			// the contents are only known once the buffer is unmapped
+			Mapping mapping = { target, pointer, (long long)length, access };
+			GetState().mappings.push_back(mapping);
+			Record(GlCaptureFormat::MAP_BUFFER_RANGE, target, (long long)offset, (long long)length, access);
+		}
+		return pointer;
+	}
+	static GLboolean UnmapBuffer(GLenum target)
+	{
+		if (Begin(GlCaptureFormat::UNMAP_BUFFER) == true)
+		{
+			std::vector<Mapping>& mappings = GetState().mappings;
+			const void* written = NULL;
+			long long length = 0;
+			for (size_t i = 0; i < mappings.size(); i++)
+			{
+				if (mappings[i].target == target)
+				{
+					if ((mappings[i].access & GL_MAP_WRITE_BIT) != 0)
+					{
+						written = mappings[i].pointer;
+						length = mappings[i].length;
+					}
+					mappings.erase(mappings.begin() + i);
+					break;
+				}
+			}
+			Put(target);
+			PutBlob(written, length);
+		}
+		return glUnmapBuffer(target);
+	}
+	static void DeleteBuffers(GLsizei count, const GLuint* buffers)
+	{
+		if (Begin(GlCaptureFormat::DELETE_BUFFERS) == true)
+		{
+			PutNames(count, buffers);
+		}
+		glDeleteBuffers(count, buffers);
+	}
+	static void BindVertexArray(GLuint vertexArray)
+	{
+		Record(GlCaptureFormat::BIND_VERTEX_ARRAY, vertexArray);
+		glBindVertexArray(vertexArray);
+	}
+	static void DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays)
+	{
+		if (Begin(GlCaptureFormat::DELETE_VERTEX_ARRAYS) == true)
+		{
+			PutNames(count, vertexArrays);
+		}
+		glDeleteVertexArrays(count, vertexArrays);
+	}
+	static void EnableVertexAttribArray(GLuint index)
+	{
+		Record(GlCaptureFormat::ENABLE_VERTEX_ATTRIB_ARRAY, index);
+		glEnableVertexAttribArray(index);
+	}
+	static void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride,
+		const void* pointer)
+	{
+		// core profiles only source the attributes from buffers, so the
+		// pointer is an offset
+		Record(GlCaptureFormat::VERTEX_ATTRIB_POINTER, index, size, type, normalized, stride, Offset(pointer));
+		glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+	}
+	static void VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer)
+	{
+		Record(GlCaptureFormat::VERTEX_ATTRIB_I_POINTER, index, size, type, stride, Offset(pointer));
+		glVertexAttribIPointer(index, size, type, stride, pointer);
+	}
+	static void VertexAttribDivisor(GLuint index, GLuint divisor)
+	{
+		Record(GlCaptureFormat::VERTEX_ATTRIB_DIVISOR, index, divisor);
+		glVertexAttribDivisor(index, divisor);
+	}
+
+	// textures ///////////////////////////////////////////////
+
+	static void ActiveTexture(GLenum texture)
+	{
+		Record(GlCaptureFormat::ACTIVE_TEXTURE, texture);
+		glActiveTexture(texture);
+	}
+	static void BindTexture(GLenum target, GLuint texture)
+	{
+		Record(GlCaptureFormat::BIND_TEXTURE, target, texture);
+		glBindTexture(target, texture);
+	}
+	static void DeleteTextures(GLsizei count, const GLuint* textures)
+	{
+		if (Begin(GlCaptureFormat::DELETE_TEXTURES) == true)
+		{
+			PutNames(count, textures);
+		}
+		glDeleteTextures(count, textures);
+	}
+	static void TexParameteri(GLenum target, GLenum name, GLint value)
+	{
+		Record(GlCaptureFormat::TEX_PARAMETERI, target, name, value);
+		glTexParameteri(target, name, value);
+	}
+	static void TexStorage2D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height)
+	{
+		Record(GlCaptureFormat::TEX_STORAGE_2D, target, levels, internalFormat, width, height);
+		glTexStorage2D(target, levels, internalFormat, width, height);
+	}
+	static void TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+		GLint border, GLenum format, GLenum type, const void* pixels)
+	{
+		if (Begin(GlCaptureFormat::TEX_IMAGE_2D) == true)
+		{
+			Put(target);
+			Put(level);
+			Put(internalFormat);
+			Put(width);
+			Put(height);
+			Put(border);
+			Put(format);
+			Put(type);
+			PutPixels(pixels, PixelBytes(width, height, format, type));
+		}
+		glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+	}
+	static void TexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+		GLenum format, GLenum type, const void* pixels)
+	{
+		if (Begin(GlCaptureFormat::TEX_SUB_IMAGE_2D) == true)
+		{
+			Put(target);
+			Put(level);
+			Put(x);
+			Put(y);
+			Put(width);
+			Put(height);
+			Put(format);
+			Put(type);
+			PutPixels(pixels, PixelBytes(width, height, format, type));
+		}
+		glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+	}
+	static void CompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width,
+		GLsizei height, GLint border, GLsizei imageSize, const void* data)
+	{
+		if (Begin(GlCaptureFormat::COMPRESSED_TEX_IMAGE_2D) == true)
+		{
+			Put(target);
+			Put(level);
+			Put(internalFormat);
+			Put(width);
+			Put(height);
+			Put(border);
+			Put(imageSize);
+			PutPixels(data, imageSize);
+		}
+		glCompressedTexImage2D(target, level, internalFormat, width, height, border, imageSize, data);
+	}
+	static void CompressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width,
+		GLsizei height, GLenum format, GLsizei imageSize, const void* data)
+	{
+		if (Begin(GlCaptureFormat::COMPRESSED_TEX_SUB_IMAGE_2D) == true)
+		{
+			Put(target);
+			Put(level);
+			Put(x);
+			Put(y);
+			Put(width);
+			Put(height);
+			Put(format);
+			Put(imageSize);
+			PutPixels(data, imageSize);
+		}
+		glCompressedTexSubImage2D(target, level, x, y, width, height, format, imageSize, data);
+	}
+	static void GenerateMipmap(GLenum target)
+	{
+		Record(GlCaptureFormat::GENERATE_MIPMAP, target);
+		glGenerateMipmap(target);
+	}
+	static void CopyTexSubImage2D(GLenum target, GLint level, GLint xOffset, GLint yOffset, GLint x, GLint y,
+		GLsizei width, GLsizei height)
+	{
+		Record(GlCaptureFormat::COPY_TEX_SUB_IMAGE_2D, target, level, xOffset, yOffset, x, y, width, height);
+		glCopyTexSubImage2D(target, level, xOffset, yOffset, x, y, width, height);
+	}
+	static void BindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer,
+		GLenum access, GLenum format)
+	{
+		Record(GlCaptureFormat::BIND_IMAGE_TEXTURE, unit, texture, level, layered, layer, access, format);
+		glBindImageTexture(unit, texture, level, layered, layer, access, format);
+	}
+
+	// framebuffers ///////////////////////////////////////////
+
+	static void BindFramebuffer(GLenum target, GLuint framebuffer)
+	{
+		Record(GlCaptureFormat::BIND_FRAMEBUFFER, target, framebuffer);
+		glBindFramebuffer(target, framebuffer);
+	}
+	static void DeleteFramebuffers(GLsizei count, const GLuint* framebuffers)
+	{
+		if (Begin(GlCaptureFormat::DELETE_FRAMEBUFFERS) == true)
+		{
+			PutNames(count, framebuffers);
+		}
+		glDeleteFramebuffers(count, framebuffers);
+	}
+	static void FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture,
+		GLint level)
+	{
+		Record(GlCaptureFormat::FRAMEBUFFER_TEXTURE_2D, target, attachment, textureTarget, texture, level);
+		glFramebufferTexture2D(target, attachment, textureTarget, texture, level);
+	}
+	static void DrawBuffers(GLsizei count, const GLenum* buffers)
+	{
+		if (Begin(GlCaptureFormat::DRAW_BUFFERS) == true)
+		{
+			PutNames(count, buffers);
+		}
+		glDrawBuffers(count, buffers);
+	}
+	static void DrawBuffer(GLenum buffer)
+	{
+		Record(GlCaptureFormat::DRAW_BUFFER, buffer);
+		glDrawBuffer(buffer);
+	}
+	static void ReadBuffer(GLenum buffer)
+	{
+		Record(GlCaptureFormat::READ_BUFFER, buffer);
+		glReadBuffer(buffer);
+	}
+	static void BlitFramebuffer(GLint sourceX0, GLint sourceY0, GLint sourceX1, GLint sourceY1,
+		GLint destinationX0, GLint destinationY0, GLint destinationX1, GLint destinationY1,
+		GLbitfield mask, GLenum filter)
+	{
+		Record(GlCaptureFormat::BLIT_FRAMEBUFFER, sourceX0, sourceY0, sourceX1, sourceY1,
+			destinationX0, destinationY0, destinationX1, destinationY1, mask, filter);
+		glBlitFramebuffer(sourceX0, sourceY0, sourceX1, sourceY1,
+			destinationX0, destinationY0, destinationX1, destinationY1, mask, filter);
+	}
+
+	// shaders and programs ///////////////////////////////////
+
+	static GLuint CreateShader(GLenum type)
+	{
+		GLuint shader = glCreateShader(type);
+		Record(GlCaptureFormat::CREATE_SHADER, type, shader);
+		return shader;
+	}
+	static void ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+	{
+		if (Begin(GlCaptureFormat::SHADER_SOURCE) == true)
+		{
+			Put(shader);
+			Put(count);
+			for (GLsizei i = 0; i < count; i++)
+			{
+				bool bTerminated = (NULL == lengths) || (lengths[i] < 0);
+				PutBlob(strings[i], (bTerminated == true) ? strlen(strings[i]) : lengths[i]);
+			}
+		}
+		glShaderSource(shader, count, strings, lengths);
+	}
+	static void CompileShader(GLuint shader)
+	{
+		Record(GlCaptureFormat::COMPILE_SHADER, shader);
+		glCompileShader(shader);
+	}
+	static void DeleteShader(GLuint shader)
+	{
+		Record(GlCaptureFormat::DELETE_SHADER, shader);
+		glDeleteShader(shader);
+	}
+	static GLuint CreateProgram()
+	{
+		GLuint program = glCreateProgram();
+		Record(GlCaptureFormat::CREATE_PROGRAM, program);
+		return program;
+	}
+	static void AttachShader(GLuint program, GLuint shader)
+	{
+		Record(GlCaptureFormat::ATTACH_SHADER, program, shader);
+		glAttachShader(program, shader);
+	}
+	static void DetachShader(GLuint program, GLuint shader)
+	{
+		Record(GlCaptureFormat::DETACH_SHADER, program, shader);
+		glDetachShader(program, shader);
+	}
+	static void LinkProgram(GLuint program)
+	{
+		Record(GlCaptureFormat::LINK_PROGRAM, program);
+		glLinkProgram(program);
+	}
+	static void DeleteProgram(GLuint program)
+	{
+		Record(GlCaptureFormat::DELETE_PROGRAM, program);
+		glDeleteProgram(program);
+	}
+	static void UseProgram(GLuint program)
+	{
+		Record(GlCaptureFormat::USE_PROGRAM, program);
+		glUseProgram(program);
+	}
+	static GLint GetUniformLocation(GLuint program, const GLchar* name)
+	{
+		GLint location = glGetUniformLocation(program, name);
+		if (Begin(GlCaptureFormat::GET_UNIFORM_LOCATION) == true)
+		{
+			Put(program);
+			PutBlob(name, strlen(name));
+			Put(location);
+		}
+		return location;
+	}
+	static GLuint GetUniformBlockIndex(GLuint program, const GLchar* name)
+	{
+		GLuint index = glGetUniformBlockIndex(program, name);
+		if (Begin(GlCaptureFormat::GET_UNIFORM_BLOCK_INDEX) == true)
+		{
+			Put(program);
+			PutBlob(name, strlen(name));
+			Put(index);
+		}
+		return index;
+	}
+	static void UniformBlockBinding(GLuint program, GLuint index, GLuint binding)
+	{
+		Record(GlCaptureFormat::UNIFORM_BLOCK_BINDING, program, index, binding);
+		glUniformBlockBinding(program, index, binding);
+	}
+	static void Uniform1i(GLint location, GLint x)
+	{
+		Record(GlCaptureFormat::UNIFORM_1I, location, x);
+		glUniform1i(location, x);
+	}
+	static void Uniform1ui(GLint location, GLuint x)
+	{
+		Record(GlCaptureFormat::UNIFORM_1UI, location, x);
+		glUniform1ui(location, x);
+	}
+	static void Uniform1f(GLint location, GLfloat x)
+	{
+		Record(GlCaptureFormat::UNIFORM_1F, location, x);
+		glUniform1f(location, x);
+	}
+	static void Uniform2i(GLint location, GLint x, GLint y)
+	{
+		Record(GlCaptureFormat::UNIFORM_2I, location, x, y);
+		glUniform2i(location, x, y);
+	}
+	static void Uniform2f(GLint location, GLfloat x, GLfloat y)
+	{
+		Record(GlCaptureFormat::UNIFORM_2F, location, x, y);
+		glUniform2f(location, x, y);
+	}
+	static void Uniform3i(GLint location, GLint x, GLint y, GLint z)
+	{
+		Record(GlCaptureFormat::UNIFORM_3I, location, x, y, z);
+		glUniform3i(location, x, y, z);
+	}
+	static void Uniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z)
+	{
+		Record(GlCaptureFormat::UNIFORM_3F, location, x, y, z);
+		glUniform3f(location, x, y, z);
+	}
+	static void Uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+	{
+		Record(GlCaptureFormat::UNIFORM_4F, location, x, y, z, w);
+		glUniform4f(location, x, y, z, w);
+	}
+	static void Uniform2fv(GLint location, GLsizei count, const GLfloat* values)
+	{
+		RecordUniform(GlCaptureFormat::UNIFORM_FV, 2, location, count, GL_FALSE, values);
+		glUniform2fv(location, count, values);
+	}
+	static void Uniform3fv(GLint location, GLsizei count, const GLfloat* values)
+	{
+		RecordUniform(GlCaptureFormat::UNIFORM_FV, 3, location, count, GL_FALSE, values);
+		glUniform3fv(location, count, values);
+	}
+	static void Uniform4fv(GLint location, GLsizei count, const GLfloat* values)
+	{
+		RecordUniform(GlCaptureFormat::UNIFORM_FV, 4, location, count, GL_FALSE, values);
+		glUniform4fv(location, count, values);
+	}
+	static void UniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* values)
+	{
+		RecordUniform(GlCaptureFormat::UNIFORM_MATRIX_FV, 2, location, count, transpose, values);
+		glUniformMatrix2fv(location, count, transpose, values);
+	}
+	static void UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* values)
+	{
+		RecordUniform(GlCaptureFormat::UNIFORM_MATRIX_FV, 3, location, count, transpose, values);
+		glUniformMatrix3fv(location, count, transpose, values);
+	}
+	static void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* values)
+	{
+		RecordUniform(GlCaptureFormat::UNIFORM_MATRIX_FV, 4, location, count, transpose, values);
+		glUniformMatrix4fv(location, count, transpose, values);
+	}
+
+	// draws and dispatches ///////////////////////////////////
+
+	static void DrawArrays(GLenum mode, GLint first, GLsizei count)
+	{
+		Record(GlCaptureFormat::DRAW_ARRAYS, mode, first, count);
+		glDrawArrays(mode, first, count);
+	}
+	static void DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount)
+	{
+		Record(GlCaptureFormat::DRAW_ARRAYS_INSTANCED, mode, first, count, instanceCount);
+		glDrawArraysInstanced(mode, first, count, instanceCount);
+	}
+	static void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+	{
+		// the indices come from the element buffer, so this is an offset
+		Record(GlCaptureFormat::DRAW_ELEMENTS, mode, count, type, Offset(indices));
+		glDrawElements(mode, count, type, indices);
+	}
+	static void DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices,
+		GLint baseVertex)
+	{
+		Record(GlCaptureFormat::DRAW_ELEMENTS_BASE_VERTEX, mode, count, type, Offset(indices), baseVertex);
+		// older GLEW headers declare the indices without const
+		glDrawElementsBaseVertex(mode, count, type, (void*)indices, baseVertex);
+	}
+	static void MultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount,
+		GLsizei stride)
+	{
+		Record(GlCaptureFormat::MULTI_DRAW_ELEMENTS_INDIRECT, mode, type, Offset(indirect), drawCount, stride);
+		glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+	}
+	static void MultiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount,
+		GLsizei maxDrawCount, GLsizei stride)
+	{
+		Record(GlCaptureFormat::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT, mode, type, Offset(indirect),
+			(long long)drawCount, maxDrawCount, stride);
+		glMultiDrawElementsIndirectCount(mode, type, indirect, drawCount, maxDrawCount, stride);
+	}
+	static void MultiDrawElementsIndirectCountARB(GLenum mode, GLenum type, const void* indirect,
+		GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride)
+	{
+		// the same call as the core one, the replay picks whichever it has
+		Record(GlCaptureFormat::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT, mode, type, Offset(indirect),
+			(long long)drawCount, maxDrawCount, stride);
+		glMultiDrawElementsIndirectCountARB(mode, type, indirect, drawCount, maxDrawCount, stride);
+	}
+	static void DispatchCompute(GLuint groupsX, GLuint groupsY, GLuint groupsZ)
+	{
+		Record(GlCaptureFormat::DISPATCH_COMPUTE, groupsX, groupsY, groupsZ);
+		glDispatchCompute(groupsX, groupsY, groupsZ);
+	}
+	// not MemoryBarrier, which the Windows headers define as a macro
+	static void MemoryBarrierBits(GLbitfield barriers)
+	{
+		Record(GlCaptureFormat::MEMORY_BARRIER, barriers);
+		glMemoryBarrier(barriers);
+	}
+
+private:
+	// the writes of a mapped buffer are recorded when it is unmapped
+	struct Mapping
+	{
+		GLenum target;
+		const void* pointer;
+		long long length;
+		GLbitfield access;
+	};
+
+	struct State
+	{
+		FILE* file = NULL;
+		bool bWritten = true;
+		// the calls since the last flush
+		std::vector<unsigned char> buffer;
+		int frame = 0;
+		int lastFrame = 0;
+		// the state the sizes of the recorded pixels depend on
+		GLuint unpackBuffer = 0;
+		GLint unpackAlignment = 4;
+		std::vector<Mapping> mappings;
+	};
+
+	// the calls are written out once this many bytes are buffered
+	static const size_t FLUSH_BYTES = 4 * 1024 * 1024;
+
+	static State& GetState()
+	{
+		static State state;
+		return state;
+	}
+
+	static void Flush()
+	{
+		State& state = GetState();
+		if (state.buffer.empty() == false)
+		{
+			fwrite(state.buffer.data(), 1, state.buffer.size(), state.file);
+			state.buffer.clear();
+		}
+	}
+
+	// start a call - false while no capture runs
+	static bool Begin(GlCaptureFormat::Command command)
+	{
+		State& state = GetState();
+		if (NULL == state.file)
+		{
+			return false;
+		}
+		if (state.buffer.size() > FLUSH_BYTES)
+		{
+			Flush();
+		}
+		Put((unsigned short)command);
+		return true;
+	}
+
+	// the argument types of the format - anything else has to be cast
+	// to one of them, so a call records the same on 32 and 64 bits
+	static void PutBytes(const void* data, size_t size)
+	{
+		std::vector<unsigned char>& buffer = GetState().buffer;
+		const unsigned char* bytes = (const unsigned char*)data;
+		buffer.insert(buffer.end(), bytes, bytes + size);
+	}
+	static void Put(unsigned short value) { PutBytes(&value, sizeof(value)); }
+	static void Put(unsigned int value) { PutBytes(&value, sizeof(value)); }
+	static void Put(int value) { PutBytes(&value, sizeof(value)); }
+	static void Put(float value) { PutBytes(&value, sizeof(value)); }
+	static void Put(unsigned char value) { PutBytes(&value, sizeof(value)); }
+	static void Put(long long value) { PutBytes(&value, sizeof(value)); }
+
+	static void PutBlob(const void* data, long long size)
+	{
+		unsigned int length = (NULL != data) ? (unsigned int)size : 0;
+		Put(length);
+		PutBytes(data, length);
+	}
+
+	static void PutNames(GLsizei count, const GLuint* names)
+	{
+		Put(count);
+		for (GLsizei i = 0; i < count; i++)
+		{
+			Put(names[i]);
+		}
+	}
+
+	// the pixels are an offset into the unpack buffer while one is
+	// bound, client memory of the passed size otherwise
+	static void PutPixels(const void* pixels, long long bytes)
+	{
+		if (0 != GetState().unpackBuffer)
+		{
+			Put(Offset(pixels));
+			PutBlob(NULL, 0);
+		}
+		else
+		{
+			Put(0LL);
+			PutBlob(pixels, bytes);
+		}
+	}
+
+	static long long Offset(const void* pointer)
+	{
+		return (long long)(intptr_t)pointer;
+	}
+
+	// the bytes of client pixels read by an upload, with the rows
+	// padded to the unpack alignment
+	static long long PixelBytes(GLsizei width, GLsizei height, GLenum format, GLenum type)
+	{
+		long long components = 4;
+		switch (format)
+		{
+		case GL_RED:
+		case GL_RED_INTEGER:
+		case GL_DEPTH_COMPONENT:
+			components = 1;
+			break;
+		case GL_RG:
+			components = 2;
+			break;
+		case GL_RGB:
+		case GL_BGR:
+			components = 3;
+			break;
+		default:
+			break;
+		}
+		long long componentBytes = 4;
+		switch (type)
+		{
+		case GL_UNSIGNED_BYTE:
+		case GL_BYTE:
+			componentBytes = 1;
+			break;
+		case GL_UNSIGNED_SHORT:
+		case GL_SHORT:
+		case GL_HALF_FLOAT:
+			componentBytes = 2;
+			break;
+		default:
+			break;
+		}
+		long long alignment = GetState().unpackAlignment;
+		long long rowBytes = width * components * componentBytes;
+		long long rowStride = ((rowBytes + alignment - 1) / alignment) * alignment;
+		return (height > 0) ? rowStride * (height - 1) + rowBytes : 0;
+	}
+
+	// the state set before the capture started, which the scene
+	// relies on without setting it again, like the blending the
+	// view manager enables with the window
+	static void RecordState()
+	{
+		const GLenum capabilities[] = { GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_POLYGON_OFFSET_FILL };
+		for (GLenum capability : capabilities)
+		{
+			Record((glIsEnabled(capability) == GL_TRUE) ? GlCaptureFormat::ENABLE : GlCaptureFormat::DISABLE,
+				capability);
+		}
+
+		GLint blend[4] = { GL_ONE, GL_ZERO, GL_ONE, GL_ZERO };
+		glGetIntegerv(GL_BLEND_SRC_RGB, &blend[0]);
+		glGetIntegerv(GL_BLEND_DST_RGB, &blend[1]);
+		glGetIntegerv(GL_BLEND_SRC_ALPHA, &blend[2]);
+		glGetIntegerv(GL_BLEND_DST_ALPHA, &blend[3]);
+		Record(GlCaptureFormat::BLEND_FUNC_SEPARATE, (GLenum)blend[0], (GLenum)blend[1], (GLenum)blend[2],
+			(GLenum)blend[3]);
+
+		GLint depthFunction = GL_LESS;
+		glGetIntegerv(GL_DEPTH_FUNC, &depthFunction);
+		Record(GlCaptureFormat::DEPTH_FUNC, (GLenum)depthFunction);
+
+		GLint viewport[4] = { 0, 0, 0, 0 };
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		Record(GlCaptureFormat::VIEWPORT, viewport[0], viewport[1], viewport[2], viewport[3]);
+	}
+
+	static void PutArguments()
+	{
+	}
+	template <typename First, typename... Rest>
+	static void PutArguments(First first, Rest... rest)
+	{
+		Put(first);
+		PutArguments(rest...);
+	}
+
+	// record a call whose arguments are all plain values
+	template <typename... Arguments>
+	static void Record(GlCaptureFormat::Command command, Arguments... arguments)
+	{
+		if (Begin(command) == true)
+		{
+			PutArguments(arguments...);
+		}
+	}
+
+	// the vector and matrix uploads - components is the vector size or
+	// the matrix columns and rows
+	static void RecordUniform(GlCaptureFormat::Command command, int components, GLint location, GLsizei count,
+		GLboolean transpose, const GLfloat* values)
+	{
+		if (Begin(command) == true)
+		{
+			long long floats = (long long)count * components;
+			if (GlCaptureFormat::UNIFORM_MATRIX_FV == command)
+			{
+				floats *= components;
+				Put(components);
+				Put(location);
+				Put(count);
+				Put(transpose);
+			}
+			else
+			{
+				Put(components);
+				Put(location);
+				Put(count);
+			}
+			PutBlob(values, sizeof(GLfloat) * floats);
+		}
+	}
+};
+
+// route the GL functions of the including file through the recorder
+#undef glEnable
+#define glEnable GlCapture::Enable
+#undef glDisable
+#define glDisable GlCapture::Disable
+#undef glViewport
+#define glViewport GlCapture::Viewport
+#undef glDepthMask
+#define glDepthMask GlCapture::DepthMask
+#undef glDepthFunc
+#define glDepthFunc GlCapture::DepthFunc
+#undef glColorMask
+#define glColorMask GlCapture::ColorMask
+#undef glBlendFunc
+#define glBlendFunc GlCapture::BlendFunc
+#undef glBlendFunci
+#define glBlendFunci GlCapture::BlendFunci
+#undef glBlendFuncSeparate
+#define glBlendFuncSeparate GlCapture::BlendFuncSeparate
+#undef glPolygonOffset
+#define glPolygonOffset GlCapture::PolygonOffset
+#undef glClearColor
+#define glClearColor GlCapture::ClearColor
+#undef glClear
+#define glClear GlCapture::Clear
+#undef glClearBufferfv
+#define glClearBufferfv GlCapture::ClearBufferfv
+#undef glPixelStorei
+#define glPixelStorei GlCapture::PixelStorei
+#undef glBindBuffer
+#define glBindBuffer GlCapture::BindBuffer
+#undef glBindBufferBase
+#define glBindBufferBase GlCapture::BindBufferBase
+#undef glBufferData
+#define glBufferData GlCapture::BufferData
+#undef glBufferSubData
+#define glBufferSubData GlCapture::BufferSubData
+#undef glMapBufferRange
+#define glMapBufferRange GlCapture::MapBufferRange
+#undef glUnmapBuffer
+#define glUnmapBuffer GlCapture::UnmapBuffer
+#undef glDeleteBuffers
+#define glDeleteBuffers GlCapture::DeleteBuffers
+#undef glBindVertexArray
+#define glBindVertexArray GlCapture::BindVertexArray
+#undef glDeleteVertexArrays
+#define glDeleteVertexArrays GlCapture::DeleteVertexArrays
+#undef glEnableVertexAttribArray
+#define glEnableVertexAttribArray GlCapture::EnableVertexAttribArray
+#undef glVertexAttribPointer
+#define glVertexAttribPointer GlCapture::VertexAttribPointer
+#undef glVertexAttribIPointer
+#define glVertexAttribIPointer GlCapture::VertexAttribIPointer
+#undef glVertexAttribDivisor
+#define glVertexAttribDivisor GlCapture::VertexAttribDivisor
+#undef glActiveTexture
+#define glActiveTexture GlCapture::ActiveTexture
+#undef glBindTexture
+#define glBindTexture GlCapture::BindTexture
+#undef glDeleteTextures
+#define glDeleteTextures GlCapture::DeleteTextures
+#undef glTexParameteri
+#define glTexParameteri GlCapture::TexParameteri
+#undef glTexStorage2D
+#define glTexStorage2D GlCapture::TexStorage2D
+#undef glTexImage2D
+#define glTexImage2D GlCapture::TexImage2D
+#undef glTexSubImage2D
+#define glTexSubImage2D GlCapture::TexSubImage2D
+#undef glCompressedTexImage2D
+#define glCompressedTexImage2D GlCapture::CompressedTexImage2D
+#undef glCompressedTexSubImage2D
+#define glCompressedTexSubImage2D GlCapture::CompressedTexSubImage2D
+#undef glGenerateMipmap
+#define glGenerateMipmap GlCapture::GenerateMipmap
+#undef glCopyTexSubImage2D
+#define glCopyTexSubImage2D GlCapture::CopyTexSubImage2D
+#undef glBindImageTexture
+#define glBindImageTexture GlCapture::BindImageTexture
+#undef glBindFramebuffer
+#define glBindFramebuffer GlCapture::BindFramebuffer
+#undef glDeleteFramebuffers
+#define glDeleteFramebuffers GlCapture::DeleteFramebuffers
+#undef glFramebufferTexture2D
+#define glFramebufferTexture2D GlCapture::FramebufferTexture2D
+#undef glDrawBuffers
+#define glDrawBuffers GlCapture::DrawBuffers
+#undef glDrawBuffer
+#define glDrawBuffer GlCapture::DrawBuffer
+#undef glReadBuffer
+#define glReadBuffer GlCapture::ReadBuffer
+#undef glBlitFramebuffer
+#define glBlitFramebuffer GlCapture::BlitFramebuffer
+#undef glCreateShader
+#define glCreateShader GlCapture::CreateShader
+#undef glShaderSource
+#define glShaderSource GlCapture::ShaderSource
+#undef glCompileShader
+#define glCompileShader GlCapture::CompileShader
+#undef glDeleteShader
+#define glDeleteShader GlCapture::DeleteShader
+#undef glCreateProgram
+#define glCreateProgram GlCapture::CreateProgram
+#undef glAttachShader
+#define glAttachShader GlCapture::AttachShader
+#undef glDetachShader
+#define glDetachShader GlCapture::DetachShader
+#undef glLinkProgram
+#define glLinkProgram GlCapture::LinkProgram
+#undef glDeleteProgram
+#define glDeleteProgram GlCapture::DeleteProgram
+#undef glUseProgram
+#define glUseProgram GlCapture::UseProgram
+#undef glGetUniformLocation
+#define glGetUniformLocation GlCapture::GetUniformLocation
+#undef glGetUniformBlockIndex
+#define glGetUniformBlockIndex GlCapture::GetUniformBlockIndex
+#undef glUniformBlockBinding
+#define glUniformBlockBinding GlCapture::UniformBlockBinding
+#undef glUniform1i
+#define glUniform1i GlCapture::Uniform1i
+#undef glUniform1ui
+#define glUniform1ui GlCapture::Uniform1ui
+#undef glUniform1f
+#define glUniform1f GlCapture::Uniform1f
+#undef glUniform2i
+#define glUniform2i GlCapture::Uniform2i
+#undef glUniform2f
+#define glUniform2f GlCapture::Uniform2f
+#undef glUniform3i
+#define glUniform3i GlCapture::Uniform3i
+#undef glUniform3f
+#define glUniform3f GlCapture::Uniform3f
+#undef glUniform4f
+#define glUniform4f GlCapture::Uniform4f
+#undef glUniform2fv
+#define glUniform2fv GlCapture::Uniform2fv
+#undef glUniform3fv
+#define glUniform3fv GlCapture::Uniform3fv
+#undef glUniform4fv
+#define glUniform4fv GlCapture::Uniform4fv
+#undef glUniformMatrix2fv
+#define glUniformMatrix2fv GlCapture::UniformMatrix2fv
+#undef glUniformMatrix3fv
+#define glUniformMatrix3fv GlCapture::UniformMatrix3fv
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv GlCapture::UniformMatrix4fv
+#undef glDrawArrays
+#define glDrawArrays GlCapture::DrawArrays
+#undef glDrawArraysInstanced
+#define glDrawArraysInstanced GlCapture::DrawArraysInstanced
+#undef glDrawElements
+#define glDrawElements GlCapture::DrawElements
+#undef glDrawElementsBaseVertex
+#define glDrawElementsBaseVertex GlCapture::DrawElementsBaseVertex
+#undef glMultiDrawElementsIndirect
+#define glMultiDrawElementsIndirect GlCapture::MultiDrawElementsIndirect
+#undef glMultiDrawElementsIndirectCount
+#define glMultiDrawElementsIndirectCount GlCapture::MultiDrawElementsIndirectCount
+#undef glMultiDrawElementsIndirectCountARB
+#define glMultiDrawElementsIndirectCountARB GlCapture::MultiDrawElementsIndirectCountARB
+#undef glDispatchCompute
+#define glDispatchCompute GlCapture::DispatchCompute
+#undef glMemoryBarrier
+#define glMemoryBarrier GlCapture::MemoryBarrierBits
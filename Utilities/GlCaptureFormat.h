@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////////
+// glcaptureformat.h
+// =================
+// the file format of the GL call captures, shared by the recorder and the
+// replayer
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  GlCaptureFormat
+ *
+ *  A capture starts with the Header and continues with the
+ *  recorded calls, each a Command followed by its arguments
+ *  in the order of the GL function. The arguments are
+ *  written as 32 bit unsigned and signed integers, floats,
+ *  8 bit booleans and 64 bit offsets and sizes, in the byte
+ *  order of the machine that recorded them. Client memory,
+ *  like buffer contents, pixels and shader sources, is a
+ *  blob of a 32 bit length and the bytes - an empty blob is
+ *  a NULL pointer. FRAME_END closes every frame, the calls
+ *  before the first one are the startup of the application.
+ ***********************************************************/
+struct GlCaptureFormat
+{
+	// "GLCP" in a little endian file
+	static const unsigned int MAGIC = 0x50434c47;
+	static const unsigned int VERSION = 1;
+
+	struct Header
+	{
+		unsigned int magic;
+		unsigned int version;
+		// the size of the default framebuffer
+		int width;
+		int height;
+		// the framebuffer the application rendered the frames into -
+		// 0 for a window, the replay draws into its own instead
+		unsigned int defaultFramebuffer;
+		// the frames before the capture window only set up the state
+		// the window starts with, the window runs to the end of the file
+		int firstFrame;
+	};
+
+	enum Command
+	{
+		FRAME_END = 1,
+
+		// fixed function state
+		ENABLE,
+		DISABLE,
+		VIEWPORT,
+		DEPTH_MASK,
+		DEPTH_FUNC,
+		COLOR_MASK,
+		BLEND_FUNC,
+		BLEND_FUNCI,
+		BLEND_FUNC_SEPARATE,
+		POLYGON_OFFSET,
+		CLEAR_COLOR,
+		CLEAR,
+		CLEAR_BUFFERFV,
+		PIXEL_STOREI,
+
+		// buffers and vertex arrays
+		BIND_BUFFER,
+		BIND_BUFFER_BASE,
+		BUFFER_DATA,
+		BUFFER_SUB_DATA,
+		MAP_BUFFER_RANGE,
+		UNMAP_BUFFER,
+		DELETE_BUFFERS,
+		BIND_VERTEX_ARRAY,
+		DELETE_VERTEX_ARRAYS,
+		ENABLE_VERTEX_ATTRIB_ARRAY,
+		VERTEX_ATTRIB_POINTER,
+		VERTEX_ATTRIB_I_POINTER,
+		VERTEX_ATTRIB_DIVISOR,
+
+		// textures
+		ACTIVE_TEXTURE,
+		BIND_TEXTURE,
+		DELETE_TEXTURES,
+		TEX_PARAMETERI,
+		TEX_STORAGE_2D,
+		TEX_IMAGE_2D,
+		TEX_SUB_IMAGE_2D,
+		COMPRESSED_TEX_IMAGE_2D,
+		COMPRESSED_TEX_SUB_IMAGE_2D,
+		GENERATE_MIPMAP,
+		COPY_TEX_SUB_IMAGE_2D,
+		BIND_IMAGE_TEXTURE,
+
+		// framebuffers
+		BIND_FRAMEBUFFER,
+		DELETE_FRAMEBUFFERS,
+		FRAMEBUFFER_TEXTURE_2D,
+		DRAW_BUFFERS,
+		DRAW_BUFFER,
+		READ_BUFFER,
+		BLIT_FRAMEBUFFER,
+
+		// shaders and programs - the uniform locations and block
+		// indices are recorded with the names they were looked up by
+		CREATE_SHADER,
+		SHADER_SOURCE,
+		COMPILE_SHADER,
+		DELETE_SHADER,
+		CREATE_PROGRAM,
+		ATTACH_SHADER,
+		DETACH_SHADER,
+		LINK_PROGRAM,
+		DELETE_PROGRAM,
+		USE_PROGRAM,
+		GET_UNIFORM_LOCATION,
+		GET_UNIFORM_BLOCK_INDEX,
+		UNIFORM_BLOCK_BINDING,
+		UNIFORM_1I,
+		UNIFORM_1UI,
+		UNIFORM_1F,
+		UNIFORM_2I,
+		UNIFORM_2F,
+		UNIFORM_3I,
+		UNIFORM_3F,
+		UNIFORM_4F,
+		// the vector and matrix uploads carry their component count
+		UNIFORM_FV,
+		UNIFORM_MATRIX_FV,
+
+		// draws and dispatches
+		DRAW_ARRAYS,
+		DRAW_ARRAYS_INSTANCED,
+		DRAW_ELEMENTS,
+		DRAW_ELEMENTS_BASE_VERTEX,
+		MULTI_DRAW_ELEMENTS_INDIRECT,
+		MULTI_DRAW_ELEMENTS_INDIRECT_COUNT,
+		DISPATCH_COMPUTE,
+		MEMORY_BARRIER,
+
+		COMMAND_COUNT
+	};
+};
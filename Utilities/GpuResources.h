@@ -0,0 +1,307 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuresources.h
+// ==============
+// owning handles of OpenGL objects and the video memory they hold
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+#include "GlCapture.h"      // GL call recorder
+
+#include <cstdio>
+#include <ostream>
+
+/***********************************************************
+ *  GpuResources
+ *
+ *  Keeps count of the live OpenGL buffers, textures, vertex
+ *  arrays and programs, and of the bytes of video memory the
+ *  buffers and textures hold. The counts are kept by the
+ *  GpuHandle objects below, so an object freed through its
+ *  handle can never be missed, and the report lists what is
+ *  still alive - at shutdown anything left is a leak. The
+ *  bytes are the sizes the objects were created with, the
+ *  driver may pad them.
+ ***********************************************************/
+class GpuResources
+{
+public:
+	enum Category
+	{
+		BUFFERS,
+		TEXTURES,
+		VERTEX_ARRAYS,
+		PROGRAMS,
+		CATEGORY_COUNT
+	};
+
+	// the objects and the bytes of one category
+	struct Usage
+	{
+		long long liveObjects = 0;
+		long long liveBytes = 0;
+		long long peakBytes = 0;
+		long long createdObjects = 0;
+	};
+
+	static const char* GetCategoryName(Category category)
+	{
+		static const char* const names[CATEGORY_COUNT] = { "buffers", "textures", "vertex arrays", "programs" };
+		return names[category];
+	}
+
+	static const Usage& GetUsage(Category category)
+	{
+		return Usages()[category];
+	}
+
+	// the bytes held by every category together
+	static long long GetLiveBytes()
+	{
+		long long bytes = 0;
+		for (int i = 0; i < CATEGORY_COUNT; i++)
+		{
+			bytes += Usages()[i].liveBytes;
+		}
+		return bytes;
+	}
+
+	// the objects alive in every category together
+	static long long GetLiveObjects()
+	{
+		long long objects = 0;
+		for (int i = 0; i < CATEGORY_COUNT; i++)
+		{
+			objects += Usages()[i].liveObjects;
+		}
+		return objects;
+	}
+
+	// called by the handles as their objects come and go
+	static void AddObject(Category category)
+	{
+		Usages()[category].liveObjects++;
+		Usages()[category].createdObjects++;
+	}
+	static void RemoveObject(Category category, long long bytes)
+	{
+		Usages()[category].liveObjects--;
+		ChangeBytes(category, -bytes);
+	}
+	static void ChangeBytes(Category category, long long bytes)
+	{
+		Usage& usage = Usages()[category];
+		usage.liveBytes += bytes;
+		if (usage.liveBytes > usage.peakBytes)
+		{
+			usage.peakBytes = usage.liveBytes;
+		}
+	}
+
+	// the bytes of a 2D texture with the passed mip levels
+	static long long TextureBytes(GLenum internalFormat, GLsizei width, GLsizei height, GLsizei levels = 1)
+	{
+		long long bytes = 0;
+		for (GLsizei level = 0; level < levels; level++)
+		{
+			bytes += LevelBytes(internalFormat, width, height);
+			width = (width > 1) ? width / 2 : 1;
+			height = (height > 1) ? height / 2 : 1;
+		}
+		return bytes;
+	}
+
+	// write the live objects and bytes of every category
+	static void WriteReport(std::ostream& output)
+	{
+		char line[128];
+		snprintf(line, sizeof(line), "  %-16s %8s %10s %10s\n", "GPU resources", "live", "MB", "peak MB");
+		output << line;
+		for (int i = 0; i < CATEGORY_COUNT; i++)
+		{
+			const Usage& usage = Usages()[i];
+			snprintf(line, sizeof(line), "  %-16s %8lld %10.2f %10.2f\n", GetCategoryName((Category)i),
+				usage.liveObjects, usage.liveBytes / (1024.0 * 1024.0), usage.peakBytes / (1024.0 * 1024.0));
+			output << line;
+		}
+		snprintf(line, sizeof(line), "  %-16s %8lld %10.2f\n", "total", GetLiveObjects(), GetLiveBytes() / (1024.0 * 1024.0));
+		output << line;
+	}
+
+private:
+	static Usage* Usages()
+	{
+		static Usage usages[CATEGORY_COUNT];
+		return usages;
+	}
+
+	static long long LevelBytes(GLenum internalFormat, long long width, long long height)
+	{
+		// the block compressed formats store 4x4 texel blocks
+		long long blocks = ((width + 3) / 4) * ((height + 3) / 4);
+		switch (internalFormat)
+		{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+			return blocks * 8;
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return blocks * 16;
+		case GL_R8:
+			return width * height;
+		case GL_R16F:
+			return width * height * 2;
+		case GL_RGB8:
+			return width * height * 3;
+		case GL_RGB16F:
+			return width * height * 6;
+		case GL_RGBA16F:
+			return width * height * 8;
+		case GL_RGBA32F:
+			return width * height * 16;
+		default:
+			// GL_RGBA8, GL_R32F, GL_DEPTH_COMPONENT32F and the other 32 bit formats
+			return width * height * 4;
+		}
+	}
+};
+
+/***********************************************************
+ *  GpuHandle
+ *
+ *  Owns one OpenGL object of the category and frees it when
+ *  the handle is reset, replaced or destroyed. The handle
+ *  converts to the object name, so it can be passed to the
+ *  OpenGL calls directly. Handles can be moved but not
+ *  copied, and have to be freed while the context is still
+ *  current.
+ ***********************************************************/
+template <GpuResources::Category CATEGORY>
+class GpuHandle
+{
+public:
+	GpuHandle() : m_name(0), m_bytes(0)
+	{
+	}
+	~GpuHandle()
+	{
+		Reset();
+	}
+
+	GpuHandle(GpuHandle&& other) : m_name(other.m_name), m_bytes(other.m_bytes)
+	{
+		other.m_name = 0;
+		other.m_bytes = 0;
+	}
+	GpuHandle& operator=(GpuHandle&& other)
+	{
+		if (this != &other)
+		{
+			Reset();
+			m_name = other.m_name;
+			m_bytes = other.m_bytes;
+			other.m_name = 0;
+			other.m_bytes = 0;
+		}
+		return *this;
+	}
+
+	// create a new object, freeing the one held before
+	void Create()
+	{
+		GLuint name = 0;
+		switch (CATEGORY)
+		{
+		case GpuResources::BUFFERS:
+			glGenBuffers(1, &name);
+			break;
+		case GpuResources::TEXTURES:
+			glGenTextures(1, &name);
+			break;
+		case GpuResources::VERTEX_ARRAYS:
+			glGenVertexArrays(1, &name);
+			break;
+		default:
+			name = glCreateProgram();
+			break;
+		}
+		Adopt(name);
+	}
+
+	// take over an object created elsewhere, like a linked program
+	void Adopt(GLuint name)
+	{
+		Reset();
+		if (0 != name)
+		{
+			m_name = name;
+			GpuResources::AddObject(CATEGORY);
+		}
+	}
+
+	// free the object
+	void Reset()
+	{
+		if (0 != m_name)
+		{
+			switch (CATEGORY)
+			{
+			case GpuResources::BUFFERS:
+				glDeleteBuffers(1, &m_name);
+				break;
+			case GpuResources::TEXTURES:
+				glDeleteTextures(1, &m_name);
+				break;
+			case GpuResources::VERTEX_ARRAYS:
+				glDeleteVertexArrays(1, &m_name);
+				break;
+			default:
+				glDeleteProgram(m_name);
+				break;
+			}
+			GpuResources::RemoveObject(CATEGORY, m_bytes);
+			m_name = 0;
+			m_bytes = 0;
+		}
+	}
+
+	// the bytes of video memory the object holds now - set after
+	// every glBufferData or texture storage call
+	void SetBytes(long long bytes)
+	{
+		if (0 != m_name)
+		{
+			GpuResources::ChangeBytes(CATEGORY, bytes - m_bytes);
+			m_bytes = bytes;
+		}
+	}
+
+	// name the object for the debug output and frame debuggers, when
+	// the context has KHR_debug - the object has to be bound once first
+	void SetLabel(const char* label)
+	{
+		if ((0 != m_name) && (NULL != glObjectLabel))
+		{
+			static const GLenum identifiers[GpuResources::CATEGORY_COUNT] = {
+				GL_BUFFER, GL_TEXTURE, GL_VERTEX_ARRAY, GL_PROGRAM };
+			glObjectLabel(identifiers[CATEGORY], m_name, -1, label);
+		}
+	}
+
+	GLuint Get() const { return m_name; }
+	long long GetBytes() const { return m_bytes; }
+	operator GLuint() const { return m_name; }
+
+private:
+	GLuint m_name;
+	long long m_bytes;
+
+	GpuHandle(const GpuHandle&);
+	GpuHandle& operator=(const GpuHandle&);
+};
+
+typedef GpuHandle<GpuResources::BUFFERS> GpuBuffer;
+typedef GpuHandle<GpuResources::TEXTURES> GpuTexture;
+typedef GpuHandle<GpuResources::VERTEX_ARRAYS> GpuVertexArray;
+typedef GpuHandle<GpuResources::PROGRAMS> GpuProgram;
@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderstats.h
+// ============
+// per frame counters of the OpenGL calls made while rendering
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+/***********************************************************
+ *  RenderStats
+ *
+ *  Counts the calls that make up the CPU cost of a frame.
+ *  ShaderManager and ShapeMeshes count their own calls, and
+ *  renderers that call OpenGL directly count theirs, into
+ *  the counters returned by Frame(). Whoever renders the
+ *  frame resets them at its start.
+ ***********************************************************/
+struct RenderStats
+{
+	int drawCalls = 0;
+	long long triangles = 0;
+	int vertexArrayBinds = 0;
+	int programBinds = 0;
+	int textureBinds = 0;
+	int uniformCalls = 0;
+	int bufferUploads = 0;
+
+	// the counters of the frame being rendered
+	static RenderStats& Frame()
+	{
+		static RenderStats stats;
+		return stats;
+	}
+
+	// the triangles of a non-indexed or indexed draw of count vertices
+	static long long CountTriangles(GLenum mode, long long count)
+	{
+		switch (mode)
+		{
+		case GL_TRIANGLES:
+			return count / 3;
+		case GL_TRIANGLE_STRIP:
+		case GL_TRIANGLE_FAN:
+			return (count > 2) ? count - 2 : 0;
+		default:
+			return 0;
+		}
+	}
+};
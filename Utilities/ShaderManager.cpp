@@ -22,6 +22,7 @@ using namespace std;
 #include <GL/glew.h>
 
 #include "ShaderManager.h"
+#include "TraceZones.h"
 
 /***********************************************************
  *  LoadShaders()
@@ -30,6 +31,7 @@ using namespace std;
  *  external GLSL compatible files.
  ***********************************************************/
 GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fragment_file_path){
+	TRACE_ZONE_DETAIL("LoadShaders", vertex_file_path);
 
 	// Create the shaders
 	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
@@ -37,13 +39,7 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 
 	// Read the Vertex Shader code from the file
 	std::string VertexShaderCode;
-	std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-	if(VertexShaderStream.is_open()){
-		std::stringstream sstr;
-		sstr << VertexShaderStream.rdbuf();
-		VertexShaderCode = sstr.str();
-		VertexShaderStream.close();
-	}else{
+	if(!ReadShaderFile(vertex_file_path, VertexShaderCode)){
 		printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", vertex_file_path);
 		getchar();
 		return 0;
@@ -51,13 +47,7 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 
 	// Read the Fragment Shader code from the file
 	std::string FragmentShaderCode;
-	std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-	if(FragmentShaderStream.is_open()){
-		std::stringstream sstr;
-		sstr << FragmentShaderStream.rdbuf();
-		FragmentShaderCode = sstr.str();
-		FragmentShaderStream.close();
-	}
+	ReadShaderFile(fragment_file_path, FragmentShaderCode);
 
 	GLint Result = GL_FALSE;
 	int InfoLogLength;
@@ -125,4 +115,116 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 	return ProgramID;
 }
 
+/***********************************************************
+ *  LoadComputeShader()
+ *
+ *  This method is called to load a compute shader from an
+ *  external GLSL file into its own shader program. Compute
+ *  shaders need OpenGL 4.3 or ARB_compute_shader.
+ ***********************************************************/
+GLuint ShaderManager::LoadComputeShader(const char * compute_file_path){
+
+	std::string ComputeShaderCode;
+	if(!ReadShaderFile(compute_file_path, ComputeShaderCode)){
+		printf("Impossible to open %s. Are you in the right directory ?\n", compute_file_path);
+		return 0;
+	}
+
+	GLint Result = GL_FALSE;
+	int InfoLogLength;
+
+	// Compile Compute Shader
+	printf("Compiling shader : %s...", compute_file_path);
+	GLuint ComputeShaderID = glCreateShader(GL_COMPUTE_SHADER);
+	char const * ComputeSourcePointer = ComputeShaderCode.c_str();
+	glShaderSource(ComputeShaderID, 1, &ComputeSourcePointer , NULL);
+	glCompileShader(ComputeShaderID);
+
+	// Check Compute Shader
+	glGetShaderiv(ComputeShaderID, GL_COMPILE_STATUS, &Result);
+	glGetShaderiv(ComputeShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 0 ){
+		std::vector<char> ComputeShaderErrorMessage(InfoLogLength+1);
+		glGetShaderInfoLog(ComputeShaderID, InfoLogLength, NULL, &ComputeShaderErrorMessage[0]);
+		printf("\n%s\n", &ComputeShaderErrorMessage[0]);
+	}
+
+	printf("success\n");
 
+	// Link the program
+	printf("Linking shader program...");
+	GLuint ProgramID = glCreateProgram();
+	m_programID = ProgramID;
+	glAttachShader(ProgramID, ComputeShaderID);
+	glLinkProgram(ProgramID);
+
+	// Check the program
+	glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+	glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+	if ( InfoLogLength > 1 ){
+		std::vector<char> ProgramErrorMessage(InfoLogLength+1);
+		glGetProgramInfoLog(ProgramID, InfoLogLength, NULL, &ProgramErrorMessage[0]);
+		printf("\n%s\n", &ProgramErrorMessage[0]);
+	}
+
+	printf("success\n");
+
+	glDetachShader(ProgramID, ComputeShaderID);
+	glDeleteShader(ComputeShaderID);
+
+	if (Result == GL_FALSE){
+		glDeleteProgram(ProgramID);
+		m_programID = 0;
+		return 0;
+	}
+
+	return ProgramID;
+}
+
+/***********************************************************
+ *  ReadShaderFile()
+ *
+ *  This method is called to read the text of a GLSL file.
+ *  Lines of the form #include "file" are replaced by the
+ *  text of the named file, which is looked up in the same
+ *  folder as the including file, so shaders can share
+ *  common code such as the lighting functions.
+ ***********************************************************/
+bool ShaderManager::ReadShaderFile(const std::string& filePath, std::string& shaderCode, int depth){
+
+	std::ifstream ShaderStream(filePath.c_str(), std::ios::in);
+	if(!ShaderStream.is_open()){
+		return false;
+	}
+
+	// included files are looked up relative to this file
+	std::string folder;
+	size_t slash = filePath.find_last_of("/\\");
+	if(slash != std::string::npos){
+		folder = filePath.substr(0, slash + 1);
+	}
+
+	std::string line;
+	while(std::getline(ShaderStream, line)){
+		size_t start = line.find_first_not_of(" \t");
+		if((start != std::string::npos) && (line.compare(start, 8, "#include") == 0)){
+			size_t open = line.find('"', start);
+			size_t close = (open != std::string::npos) ? line.find('"', open + 1) : std::string::npos;
+			if((close == std::string::npos) || (depth >= 8)){
+				printf("Bad #include in %s: %s\n", filePath.c_str(), line.c_str());
+				return false;
+			}
+
+			std::string includePath = folder + line.substr(open + 1, close - open - 1);
+			if(!ReadShaderFile(includePath, shaderCode, depth + 1)){
+				printf("Impossible to open included shader %s\n", includePath.c_str());
+				return false;
+			}
+		}else{
+			shaderCode += line;
+			shaderCode += "\n";
+		}
+	}
+
+	return true;
+}
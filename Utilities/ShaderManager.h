@@ -10,6 +10,9 @@
 #pragma once
 
 #include <GL/glew.h>        // GLEW library
+#include "GlCapture.h"      // GL call recorder
+
+#include "RenderStats.h"    // per frame call counters
 
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
@@ -29,11 +32,19 @@ public:
 		const char* vertex_file_path, 
 		const char* fragment_file_path);
 
+	// load a compute shader into its own program, returns 0 on failure
+	GLuint LoadComputeShader(
+		const char* compute_file_path);
+
+	// read a shader source file, expanding any #include "file" lines
+	static bool ReadShaderFile(const std::string& filePath, std::string& shaderCode, int depth = 0);
+
 	// activate the shader
 	// ------------------------------------------------------------------------
 	inline void use()
 	{
 		glUseProgram(m_programID);
+		RenderStats::Frame().programBinds++;
 	}
 
 	// utility uniform functions
@@ -41,72 +52,247 @@ public:
 	inline void setBoolValue(const std::string &name, bool value) const
 	{
 		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), (int)value);
+		RenderStats::Frame().uniformCalls++;
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setIntValue(const std::string &name, int value) const
 	{
 		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		RenderStats::Frame().uniformCalls++;
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setFloatValue(const std::string &name, float value) const
 	{
 		glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
+		RenderStats::Frame().uniformCalls++;
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec2Value(const std::string &name, const glm::vec2 &value) const
 	{
 		glUniform2fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		RenderStats::Frame().uniformCalls++;
 	}
 
 	inline void setVec2Value(const std::string &name, float x, float y) const
 	{
 		glUniform2f(glGetUniformLocation(m_programID, name.c_str()), x, y);
+		RenderStats::Frame().uniformCalls++;
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec3Value(const std::string &name, const glm::vec3 &value) const
 	{
 		glUniform3fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		RenderStats::Frame().uniformCalls++;
 	}
 	inline void setVec3Value(const std::string &name, float x, float y, float z) const
 	{
 		glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
+		RenderStats::Frame().uniformCalls++;
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec4Value(const std::string &name, const glm::vec4 &value) const
 	{
 		glUniform4fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		RenderStats::Frame().uniformCalls++;
 	}
 	inline void setVec4Value(const std::string &name, float x, float y, float z, float w)
 	{
 		glUniform4f(glGetUniformLocation(m_programID, name.c_str()), x, y, z, w);
+		RenderStats::Frame().uniformCalls++;
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat2Value(const std::string &name, const glm::mat2 &mat) const
 	{
 		glUniformMatrix2fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		RenderStats::Frame().uniformCalls++;
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat3Value(const std::string &name, const glm::mat3 &mat) const
 	{
 		glUniformMatrix3fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		RenderStats::Frame().uniformCalls++;
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat4Value(const std::string &name, const glm::mat4 &mat) const
 	{
 		glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+		RenderStats::Frame().uniformCalls++;
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setSampler2DValue(const std::string& name, const int &value) const
 	{
 		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		RenderStats::Frame().uniformCalls++;
+	}
+
+	// packed per-draw parameters
+	// ------------------------------------------------------------------------
+	// shaders that declare "uniform vec4 drawParams[7]" get everything that
+	// changes between draw calls in one upload instead of one uniform call
+	// per value. The draw setters only update the CPU copy - the values are
+	// sent by flushDrawParameters(), which ShapeMeshes calls before each draw
+	// once it has been given the shader manager.
+	struct DrawParameters
+	{
+		glm::mat4 model;        // drawParams[0..3] - model matrix
+		glm::vec4 color;        // drawParams[4]    - object color
+		glm::vec4 surface;      // drawParams[5]    - xy UV scale, z material index, w flags
+		glm::vec4 lights;       // drawParams[6]    - per-draw light list, two light
+		                        //                    indices + 1 per component, 0 is empty
+	};
+
+	// number of vec4 values in the packed block
+	static const int DRAW_PARAMS_VEC4_COUNT = 7;
+	static_assert(sizeof(DrawParameters) == DRAW_PARAMS_VEC4_COUNT * sizeof(glm::vec4),
+		"DrawParameters must be tightly packed vec4 values");
+	// flag bits stored in surface.w - the texture slot sits above bit 8
+	static const int DRAW_FLAG_USE_TEXTURE = 1;
+	static const int DRAW_FLAG_OCCLUDER = 2;
+	static const int DRAW_FLAG_DYNAMIC = 4;
+	static const int DRAW_FLAG_TEXTURE_SHIFT = 8;
+
+	// ------------------------------------------------------------------------
+	inline void setDrawModel(const glm::mat4 &model)
+	{
+		m_drawParameters.model = model;
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setDrawColor(const glm::vec4 &color)
+	{
+		m_drawParameters.color = color;
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setDrawUVScale(const glm::vec2 &uvScale)
+	{
+		m_drawParameters.surface.x = uvScale.x;
+		m_drawParameters.surface.y = uvScale.y;
+	}
+	inline void setDrawUVScale(float u, float v)
+	{
+		m_drawParameters.surface.x = u;
+		m_drawParameters.surface.y = v;
+	}
+
+	// ------------------------------------------------------------------------
+	inline void setDrawMaterial(int materialIndex)
+	{
+		m_drawParameters.surface.z = (float)materialIndex;
+	}
+
+	// ------------------------------------------------------------------------
+	// sample the texture bound to the passed slot - a negative slot
+	// turns texturing off and the object color is used instead
+	inline void setDrawTexture(int textureSlot)
+	{
+		int flags = (int)m_drawParameters.surface.w & (DRAW_FLAG_OCCLUDER | DRAW_FLAG_DYNAMIC);
+		if (textureSlot >= 0)
+		{
+			flags |= DRAW_FLAG_USE_TEXTURE | (textureSlot << DRAW_FLAG_TEXTURE_SHIFT);
+			m_drawTextureSlot = textureSlot;
+		}
+		m_drawParameters.surface.w = (float)flags;
+	}
+
+	// ------------------------------------------------------------------------
+	// mark the following draws as large opaque parts that hide what is
+	// behind them - renderers may draw them first for occlusion culling
+	inline void setDrawOccluder(bool bOccluder)
+	{
+		int flags = (int)m_drawParameters.surface.w & ~DRAW_FLAG_OCCLUDER;
+		if (bOccluder == true)
+		{
+			flags |= DRAW_FLAG_OCCLUDER;
+		}
+		m_drawParameters.surface.w = (float)flags;
+	}
+
+	// ------------------------------------------------------------------------
+	// mark the following draws as parts of objects that may move every
+	// frame - cached passes such as static shadow maps leave them out
+	inline void setDrawDynamic(bool bDynamic)
+	{
+		int flags = (int)m_drawParameters.surface.w & ~DRAW_FLAG_DYNAMIC;
+		if (bDynamic == true)
+		{
+			flags |= DRAW_FLAG_DYNAMIC;
+		}
+		m_drawParameters.surface.w = (float)flags;
+	}
+
+	// ------------------------------------------------------------------------
+	// replace every draw parameter at once, e.g. with a recorded copy
+	inline void setDrawParameters(const DrawParameters &parameters)
+	{
+		m_drawParameters = parameters;
+
+		int flags = (int)parameters.surface.w;
+		if ((flags & DRAW_FLAG_USE_TEXTURE) != 0)
+		{
+			m_drawTextureSlot = flags >> DRAW_FLAG_TEXTURE_SHIFT;
+		}
+	}
+
+	// ------------------------------------------------------------------------
+	inline const DrawParameters& getDrawParameters() const
+	{
+		return m_drawParameters;
+	}
+
+	// ------------------------------------------------------------------------
+	// go back to the parameters the shader manager starts with - a frame
+	// that resets them first records the same values for the draws that
+	// leave one unset, instead of the ones the previous frame ended with
+	inline void resetDrawParameters()
+	{
+		m_drawParameters = defaultDrawParameters();
 	}
+
+	// ------------------------------------------------------------------------
+	// upload the packed draw parameters with a single glUniform4fv call -
+	// the texture sampler is only touched when the slot actually changes
+	inline void flushDrawParameters()
+	{
+		if (m_drawLocationsProgram != m_programID)
+		{
+			m_drawParamsLocation = glGetUniformLocation(m_programID, "drawParams");
+			m_drawTextureLocation = glGetUniformLocation(m_programID, "objectTexture");
+			m_drawLocationsProgram = m_programID;
+			m_uploadedTextureSlot = -1;
+		}
+
+		glUniform4fv(m_drawParamsLocation, DRAW_PARAMS_VEC4_COUNT, (const GLfloat*)&m_drawParameters);
+		RenderStats::Frame().uniformCalls++;
+
+		if ((m_drawTextureSlot >= 0) && (m_drawTextureSlot != m_uploadedTextureSlot))
+		{
+			glUniform1i(m_drawTextureLocation, m_drawTextureSlot);
+			RenderStats::Frame().uniformCalls++;
+			m_uploadedTextureSlot = m_drawTextureSlot;
+		}
+	}
+
+private:
+	static DrawParameters defaultDrawParameters()
+	{
+		DrawParameters parameters = { glm::mat4(1.0f), glm::vec4(1.0f), glm::vec4(1.0f, 1.0f, 0.0f, 0.0f), glm::vec4(0.0f) };
+		return parameters;
+	}
+
+	DrawParameters m_drawParameters = defaultDrawParameters();
+	GLuint m_drawLocationsProgram = 0;
+	GLint m_drawParamsLocation = -1;
+	GLint m_drawTextureLocation = -1;
+	int m_drawTextureSlot = -1;
+	int m_uploadedTextureSlot = -1;
 };
\ No newline at end of file
@@ -0,0 +1,270 @@
+///////////////////////////////////////////////////////////////////////////////
+// tracezones.h
+// ============
+// scoped timing zones written out as a Chrome trace_event timeline
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TraceZones
+ *
+ *  Records when named zones of the code start and how long
+ *  they take, per thread, and writes them as a Chrome
+ *  trace_event JSON file that chrome://tracing and Perfetto
+ *  show as a timeline. Every thread writes into a ring of
+ *  its last RING_EVENTS zones with its own lock, so threads
+ *  never wait on each other while recording. While tracing
+ *  is off a zone only loads one flag on entry and tests a
+ *  pointer on exit, and defining DISABLE_TRACE_ZONES takes
+ *  the zones out of the build altogether.
+ ***********************************************************/
+class TraceZones
+{
+public:
+	// zones kept per thread - the oldest are overwritten first
+	static const size_t RING_EVENTS = 16384;
+	// characters of the zone detail kept, like a file name
+	static const size_t DETAIL_LENGTH = 64;
+
+	// recording is off until enabled
+	static bool IsEnabled()
+	{
+		return Enabled().load(std::memory_order_relaxed);
+	}
+	static void SetEnabled(bool bEnabled)
+	{
+		// the clock starts with the first enable
+		Now();
+		Enabled().store(bEnabled, std::memory_order_relaxed);
+	}
+
+	// the name of the calling thread in the timeline
+	static void SetThreadName(const char* name)
+	{
+		ThreadBuffer& thread = CurrentThread();
+		std::lock_guard<std::mutex> lock(thread.mutex);
+		thread.name = name;
+	}
+
+	// nanoseconds since the trace clock started
+	static long long Now()
+	{
+		static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// add a finished zone to the ring of the calling thread - the name
+	// has to outlive the trace, the detail is copied
+	static void Record(const char* name, const char* detail, long long start, long long end)
+	{
+		ThreadBuffer& thread = CurrentThread();
+		std::lock_guard<std::mutex> lock(thread.mutex);
+		Event event;
+		event.name = name;
+		event.detail[0] = '\0';
+		if (NULL != detail)
+		{
+			strncpy(event.detail, detail, DETAIL_LENGTH - 1);
+			event.detail[DETAIL_LENGTH - 1] = '\0';
+		}
+		event.start = start;
+		event.duration = end - start;
+		if (thread.events.size() < RING_EVENTS)
+		{
+			thread.events.push_back(event);
+		}
+		else
+		{
+			thread.events[thread.nextEvent] = event;
+		}
+		thread.nextEvent = (thread.nextEvent + 1) % RING_EVENTS;
+	}
+
+	// write the zones of every thread as trace_event JSON - threads may
+	// keep recording while this runs
+	static bool WriteChromeTrace(const std::string& filename)
+	{
+		std::ofstream output(filename.c_str());
+		if (!output)
+		{
+			return false;
+		}
+
+		output << "{\n\"displayTimeUnit\": \"ms\",\n\"traceEvents\": [\n";
+		bool bFirst = true;
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> registryLock(registry.mutex);
+		for (size_t i = 0; i < registry.threads.size(); i++)
+		{
+			ThreadBuffer& thread = *registry.threads[i];
+			std::lock_guard<std::mutex> lock(thread.mutex);
+
+			output << (bFirst ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+				<< thread.threadId << ", \"args\": {\"name\": \"";
+			WriteEscaped(output, thread.name.c_str());
+			output << "\"}}";
+			bFirst = false;
+
+			// the oldest zone first once the ring has wrapped
+			size_t oldest = (thread.events.size() < RING_EVENTS) ? 0 : thread.nextEvent;
+			for (size_t j = 0; j < thread.events.size(); j++)
+			{
+				const Event& event = thread.events[(oldest + j) % thread.events.size()];
+				char times[64];
+				snprintf(times, sizeof(times), "\"ts\": %.3f, \"dur\": %.3f", event.start / 1000.0, event.duration / 1000.0);
+				output << ",\n{\"name\": \"";
+				WriteEscaped(output, event.name);
+				output << "\", \"cat\": \"zone\", \"ph\": \"X\", " << times << ", \"pid\": 1, \"tid\": " << thread.threadId;
+				if (event.detail[0] != '\0')
+				{
+					output << ", \"args\": {\"detail\": \"";
+					WriteEscaped(output, event.detail);
+					output << "\"}";
+				}
+				output << "}";
+			}
+		}
+		output << "\n]\n}\n";
+		return output.good();
+	}
+
+private:
+	// one finished zone, in nanoseconds of the trace clock
+	struct Event
+	{
+		const char* name;
+		char detail[DETAIL_LENGTH];
+		long long start;
+		long long duration;
+	};
+
+	// the ring of one thread - kept after the thread ends, so its
+	// zones are still written
+	struct ThreadBuffer
+	{
+		std::mutex mutex;
+		std::string name;
+		int threadId;
+		std::vector<Event> events;
+		size_t nextEvent;
+	};
+
+	// every thread that recorded a zone
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<ThreadBuffer*> threads;
+
+		~Registry()
+		{
+			for (size_t i = 0; i < threads.size(); i++)
+			{
+				delete threads[i];
+			}
+		}
+	};
+
+	static std::atomic<bool>& Enabled()
+	{
+		static std::atomic<bool> bEnabled(false);
+		return bEnabled;
+	}
+
+	static Registry& GetRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	// the ring of the calling thread, registered on first use
+	static ThreadBuffer& CurrentThread()
+	{
+		thread_local ThreadBuffer* pThread = NULL;
+		if (NULL == pThread)
+		{
+			Registry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			pThread = new ThreadBuffer();
+			pThread->threadId = (int)registry.threads.size() + 1;
+			pThread->name = "Thread " + std::to_string(pThread->threadId);
+			pThread->nextEvent = 0;
+			registry.threads.push_back(pThread);
+		}
+		return *pThread;
+	}
+
+	// JSON string characters - file names may hold backslashes
+	static void WriteEscaped(std::ostream& output, const char* text)
+	{
+		for (const char* pCharacter = text; *pCharacter != '\0'; pCharacter++)
+		{
+			if ((*pCharacter == '"') || (*pCharacter == '\\'))
+			{
+				output << '\\' << *pCharacter;
+			}
+			else if ((unsigned char)*pCharacter >= 0x20)
+			{
+				output << *pCharacter;
+			}
+		}
+	}
+};
+
+/***********************************************************
+ *  TraceZone
+ *
+ *  Records the C++ scope it lives in as a zone, when tracing
+ *  was enabled as the scope started. Use the macros below
+ *  so the zones can be compiled out.
+ ***********************************************************/
+class TraceZone
+{
+public:
+	TraceZone(const char* name, const char* detail = NULL) : m_name(NULL)
+	{
+		if (TraceZones::IsEnabled() == true)
+		{
+			m_name = name;
+			m_detail = detail;
+			m_start = TraceZones::Now();
+		}
+	}
+	~TraceZone()
+	{
+		if (NULL != m_name)
+		{
+			TraceZones::Record(m_name, m_detail, m_start, TraceZones::Now());
+		}
+	}
+
+private:
+	const char* m_name;
+	const char* m_detail;
+	long long m_start;
+
+	TraceZone(const TraceZone&);
+	TraceZone& operator=(const TraceZone&);
+};
+
+// TRACE_ZONE("name") times the rest of the enclosing scope, the name has
+// to be a string literal - TRACE_ZONE_DETAIL("name", detail) adds a string
+// like a file name, which only has to stay valid until the scope ends
+#ifndef DISABLE_TRACE_ZONES
+#define TRACE_ZONE_JOIN(a, b) a##b
+#define TRACE_ZONE_VARIABLE(line) TRACE_ZONE_JOIN(traceZone, line)
+#define TRACE_ZONE(name) TraceZone TRACE_ZONE_VARIABLE(__LINE__)(name)
+#define TRACE_ZONE_DETAIL(name, detail) TraceZone TRACE_ZONE_VARIABLE(__LINE__)(name, detail)
+#else
+#define TRACE_ZONE(name)
+#define TRACE_ZONE_DETAIL(name, detail)
+#endif